@@ -467,6 +467,33 @@ tBleStatus aci_gap_update_adv_data( uint8_t AdvDataLen,
   return status;
 }
 
+uint8_t* aci_gap_update_adv_data_reserve( uint8_t AdvDataLen )
+{
+  aci_gap_update_adv_data_cp0 *cp0 = (aci_gap_update_adv_data_cp0*)hci_cmd_reserve( );
+  cp0->AdvDataLen = AdvDataLen;
+  return cp0->AdvData;
+}
+
+tBleStatus aci_gap_update_adv_data_commit( void )
+{
+  struct hci_request rq;
+  aci_gap_update_adv_data_cp0 *cp0 = (aci_gap_update_adv_data_cp0*)hci_cmd_reserve( );
+  tBleStatus status = 0;
+  int index_input = 0;
+  index_input += 1;
+  index_input += cp0->AdvDataLen;
+  Osal_MemSet( &rq, 0, sizeof(rq) );
+  rq.ogf = 0x3f;
+  rq.ocf = 0x08e;
+  rq.cparam = cp0;
+  rq.clen = index_input;
+  rq.rparam = &status;
+  rq.rlen = 1;
+  if ( hci_send_req(&rq, FALSE) < 0 )
+    return BLE_STATUS_TIMEOUT;
+  return status;
+}
+
 tBleStatus aci_gap_delete_ad_type( uint8_t ADType )
 {
   struct hci_request rq;
@@ -529,6 +529,27 @@ tBleStatus aci_gap_slave_security_req( uint16_t Connection_Handle );
 tBleStatus aci_gap_update_adv_data( uint8_t AdvDataLen,
                                     const uint8_t* AdvData );
 
+/**
+ * @brief ACI_GAP_UPDATE_ADV_DATA (in place)
+ * Reserve variant of aci_gap_update_adv_data: the length is encoded in the
+ * command packet shared with the CPU2 and the address where the advertising
+ * data shall be written is returned. The command is sent with
+ * aci_gap_update_adv_data_commit(). No other command shall be sent in
+ * between.
+ * 
+ * @param AdvDataLen Length of AdvData in octets
+ * @return Address where the AdvDataLen octets of data are written.
+ */
+uint8_t* aci_gap_update_adv_data_reserve( uint8_t AdvDataLen );
+
+/**
+ * @brief ACI_GAP_UPDATE_ADV_DATA (in place)
+ * Send the command prepared with aci_gap_update_adv_data_reserve().
+ * 
+ * @return Value indicating success or error code.
+ */
+tBleStatus aci_gap_update_adv_data_commit( void );
+
 /**
  * @brief ACI_GAP_DELETE_AD_TYPE
  * This command can be used to delete the specified AD type from the
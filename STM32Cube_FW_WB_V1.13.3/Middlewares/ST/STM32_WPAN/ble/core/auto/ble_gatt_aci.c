@@ -312,6 +312,73 @@ tBleStatus aci_gatt_update_char_value( uint16_t Service_Handle,
   return status;
 }
 
+uint8_t* aci_gatt_update_char_value_reserve( uint16_t Service_Handle,
+                                             uint16_t Char_Handle,
+                                             uint8_t Val_Offset,
+                                             uint8_t Char_Value_Length )
+{
+  aci_gatt_update_char_value_cp0 *cp0 = (aci_gatt_update_char_value_cp0*)hci_cmd_reserve( );
+  cp0->Service_Handle = Service_Handle;
+  cp0->Char_Handle = Char_Handle;
+  cp0->Val_Offset = Val_Offset;
+  cp0->Char_Value_Length = Char_Value_Length;
+  return cp0->Char_Value;
+}
+
+tBleStatus aci_gatt_update_char_value_commit( void )
+{
+  struct hci_request rq;
+  aci_gatt_update_char_value_cp0 *cp0 = (aci_gatt_update_char_value_cp0*)hci_cmd_reserve( );
+  tBleStatus status = 0;
+  int index_input = 0;
+  index_input += 2;
+  index_input += 2;
+  index_input += 1;
+  index_input += 1;
+  index_input += cp0->Char_Value_Length;
+  Osal_MemSet( &rq, 0, sizeof(rq) );
+  rq.ogf = 0x3f;
+  rq.ocf = 0x106;
+  rq.cparam = cp0;
+  rq.clen = index_input;
+  rq.rparam = &status;
+  rq.rlen = 1;
+  if ( hci_send_req(&rq, FALSE) < 0 )
+    return BLE_STATUS_TIMEOUT;
+  return status;
+}
+
+tBleStatus aci_gatt_update_char_value_async( uint16_t Service_Handle,
+                                             uint16_t Char_Handle,
+                                             uint8_t Val_Offset,
+                                             uint8_t Char_Value_Length,
+                                             const uint8_t* Char_Value,
+                                             hci_cmd_callback_t CallBack,
+                                             void* Context )
+{
+  struct hci_request rq;
+  aci_gatt_update_char_value_cp0 *cp0 = (aci_gatt_update_char_value_cp0*)hci_cmd_reserve_async( 6 + Char_Value_Length );
+  int index_input = 0;
+  cp0->Service_Handle = Service_Handle;
+  index_input += 2;
+  cp0->Char_Handle = Char_Handle;
+  index_input += 2;
+  cp0->Val_Offset = Val_Offset;
+  index_input += 1;
+  cp0->Char_Value_Length = Char_Value_Length;
+  index_input += 1;
+  Osal_MemCpy( (void*)&cp0->Char_Value, (const void*)Char_Value, Char_Value_Length );
+  index_input += Char_Value_Length;
+  Osal_MemSet( &rq, 0, sizeof(rq) );
+  rq.ogf = 0x3f;
+  rq.ocf = 0x106;
+  rq.cparam = cp0;
+  rq.clen = index_input;
+  if ( hci_send_req_async(&rq, CallBack, Context) < 0 )
+    return BLE_STATUS_TIMEOUT;
+  return BLE_STATUS_SUCCESS;
+}
+
 tBleStatus aci_gatt_del_char( uint16_t Serv_Handle,
                               uint16_t Char_Handle )
 {
@@ -1400,6 +1467,51 @@ tBleStatus aci_gatt_update_char_value_ext( uint16_t Conn_Handle_To_Notify,
   return status;
 }
 
+uint8_t* aci_gatt_update_char_value_ext_reserve( uint16_t Conn_Handle_To_Notify,
+                                                 uint16_t Service_Handle,
+                                                 uint16_t Char_Handle,
+                                                 uint8_t Update_Type,
+                                                 uint16_t Char_Length,
+                                                 uint16_t Value_Offset,
+                                                 uint8_t Value_Length )
+{
+  aci_gatt_update_char_value_ext_cp0 *cp0 = (aci_gatt_update_char_value_ext_cp0*)hci_cmd_reserve( );
+  cp0->Conn_Handle_To_Notify = Conn_Handle_To_Notify;
+  cp0->Service_Handle = Service_Handle;
+  cp0->Char_Handle = Char_Handle;
+  cp0->Update_Type = Update_Type;
+  cp0->Char_Length = Char_Length;
+  cp0->Value_Offset = Value_Offset;
+  cp0->Value_Length = Value_Length;
+  return cp0->Value;
+}
+
+tBleStatus aci_gatt_update_char_value_ext_commit( void )
+{
+  struct hci_request rq;
+  aci_gatt_update_char_value_ext_cp0 *cp0 = (aci_gatt_update_char_value_ext_cp0*)hci_cmd_reserve( );
+  tBleStatus status = 0;
+  int index_input = 0;
+  index_input += 2;
+  index_input += 2;
+  index_input += 2;
+  index_input += 1;
+  index_input += 2;
+  index_input += 2;
+  index_input += 1;
+  index_input += cp0->Value_Length;
+  Osal_MemSet( &rq, 0, sizeof(rq) );
+  rq.ogf = 0x3f;
+  rq.ocf = 0x12c;
+  rq.cparam = cp0;
+  rq.clen = index_input;
+  rq.rparam = &status;
+  rq.rlen = 1;
+  if ( hci_send_req(&rq, FALSE) < 0 )
+    return BLE_STATUS_TIMEOUT;
+  return status;
+}
+
 tBleStatus aci_gatt_deny_read( uint16_t Connection_Handle,
                                uint8_t Error_Code )
 {
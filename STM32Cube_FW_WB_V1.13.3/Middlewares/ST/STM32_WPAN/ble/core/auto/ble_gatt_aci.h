@@ -261,6 +261,59 @@ tBleStatus aci_gatt_update_char_value( uint16_t Service_Handle,
                                        uint8_t Char_Value_Length,
                                        const uint8_t* Char_Value );
 
+/**
+ * @brief ACI_GATT_UPDATE_CHAR_VALUE (in place)
+ * Reserve variant of aci_gatt_update_char_value: the fixed parameters are
+ * encoded in the command packet shared with the CPU2 and the address where the
+ * characteristic value shall be written is returned. The command is sent with
+ * aci_gatt_update_char_value_commit(). No other command shall be sent in
+ * between.
+ * 
+ * @param Service_Handle Handle of service to which the characteristic belongs
+ * @param Char_Handle Handle of the characteristic declaration
+ * @param Val_Offset The offset from which the attribute value has to be
+ *        updated.
+ * @param Char_Value_Length Length of the characteristic value in octets
+ * @return Address where the Char_Value_Length octets of the value are written.
+ */
+uint8_t* aci_gatt_update_char_value_reserve( uint16_t Service_Handle,
+                                             uint16_t Char_Handle,
+                                             uint8_t Val_Offset,
+                                             uint8_t Char_Value_Length );
+
+/**
+ * @brief ACI_GATT_UPDATE_CHAR_VALUE (in place)
+ * Send the command prepared with aci_gatt_update_char_value_reserve().
+ * 
+ * @return Value indicating success or error code.
+ */
+tBleStatus aci_gatt_update_char_value_commit( void );
+
+/**
+ * @brief ACI_GATT_UPDATE_CHAR_VALUE (asynchronous)
+ * Asynchronous variant of aci_gatt_update_char_value: the command is queued
+ * and the function returns without waiting for its response. The status of
+ * the command is reported to CallBack, if not NULL, from hci_user_evt_proc().
+ * The parameters are encoded in place with hci_cmd_reserve_async().
+ * 
+ * @param Service_Handle Handle of service to which the characteristic belongs
+ * @param Char_Handle Handle of the characteristic declaration
+ * @param Val_Offset The offset from which the attribute value has to be
+ *        updated.
+ * @param Char_Value_Length Length of the characteristic value in octets
+ * @param Char_Value Characteristic value
+ * @param CallBack Called with the status of the command
+ * @param Context Passed to CallBack
+ * @return Value indicating whether the command has been queued.
+ */
+tBleStatus aci_gatt_update_char_value_async( uint16_t Service_Handle,
+                                             uint16_t Char_Handle,
+                                             uint8_t Val_Offset,
+                                             uint8_t Char_Value_Length,
+                                             const uint8_t* Char_Value,
+                                             hci_cmd_callback_t CallBack,
+                                             void* Context );
+
 /**
  * @brief ACI_GATT_DEL_CHAR
  * Delete the specified characteristic from the service.
@@ -1027,6 +1080,42 @@ tBleStatus aci_gatt_update_char_value_ext( uint16_t Conn_Handle_To_Notify,
                                            uint8_t Value_Length,
                                            const uint8_t* Value );
 
+/**
+ * @brief ACI_GATT_UPDATE_CHAR_VALUE_EXT (in place)
+ * Reserve variant of aci_gatt_update_char_value_ext: the fixed parameters are
+ * encoded in the command packet shared with the CPU2 and the address where the
+ * value shall be written is returned. The command is sent with
+ * aci_gatt_update_char_value_ext_commit(). No other command shall be sent in
+ * between.
+ * 
+ * @param Conn_Handle_To_Notify Connection handle to notify. Notify all
+ *        subscribed clients if equal to 0x0000
+ * @param Service_Handle Handle of service to which the characteristic belongs
+ * @param Char_Handle Handle of the characteristic declaration
+ * @param Update_Type Allow Notification or Indication generation,
+ *         if enabled in the client characteristic configuration descriptor
+ * @param Char_Length Total length of the characteristic value.
+ * @param Value_Offset The offset from which the attribute value has to be
+ *        updated.
+ * @param Value_Length Length of the Value parameter in octets
+ * @return Address where the Value_Length octets of the value are written.
+ */
+uint8_t* aci_gatt_update_char_value_ext_reserve( uint16_t Conn_Handle_To_Notify,
+                                                 uint16_t Service_Handle,
+                                                 uint16_t Char_Handle,
+                                                 uint8_t Update_Type,
+                                                 uint16_t Char_Length,
+                                                 uint16_t Value_Offset,
+                                                 uint8_t Value_Length );
+
+/**
+ * @brief ACI_GATT_UPDATE_CHAR_VALUE_EXT (in place)
+ * Send the command prepared with aci_gatt_update_char_value_ext_reserve().
+ * 
+ * @return Value indicating success or error code.
+ */
+tBleStatus aci_gatt_update_char_value_ext_commit( void );
+
 /**
  * @brief ACI_GATT_DENY_READ
  * Deny the GATT server to send a response to a read request from a client.
@@ -105,6 +105,21 @@ struct hci_request
 };
 extern int hci_send_req( struct hci_request* req, uint8_t async );
 
+/* Asynchronous mode: the command is queued (rparam and rlen are not used) and
+ * its status is reported to the callback from hci_user_evt_proc().
+ * The commands are sent in submission order without pausing the tasks.
+ * A blocking command waits for the one in flight and may overtake the pending
+ * ones. When the queue (HCI_TL_ASYNC_CMD_NBR) is full, the caller is held
+ * until a slot is released; a command longer than
+ * HCI_TL_ASYNC_CMD_MAX_PARAM_LEN is sent in blocking mode.
+ * The callback may itself send a blocking or an asynchronous command. */
+typedef void (* hci_cmd_callback_t)( uint16_t opcode, uint8_t status, void* context );
+extern int hci_send_req_async( struct hci_request* req, hci_cmd_callback_t callback, void* context );
+
+/* In place mode: see hci_cmd_reserve() and hci_cmd_reserve_async() in hci_tl.h */
+extern void* hci_cmd_reserve( void );
+extern void* hci_cmd_reserve_async( uint16_t plen );
+
 
 #ifndef FALSE
 #define FALSE 0
@@ -141,6 +141,23 @@ typedef enum
   BCS_FLAG_MULTIPLE_PACKET_MEASUREMENT = 1<<12,/* 0 = False, 1 = True */
 } BCS_MeasurementFlags_t;
 
+typedef enum
+{
+  BCS_FIELD_BODY_FAT_PERCENTAGE = 0,
+  BCS_FIELD_TIME_STAMP,
+  BCS_FIELD_USER_ID,
+  BCS_FIELD_BASAL_METABOLISM,
+  BCS_FIELD_MUSCLE_PERCENTAGE,
+  BCS_FIELD_MUSCLE_MASS,
+  BCS_FIELD_FAT_FREE_MASS,
+  BCS_FIELD_SOFT_LEAN_MASS,
+  BCS_FIELD_BODY_WATER_MASS,
+  BCS_FIELD_IMPEDANCE,
+  BCS_FIELD_WEIGHT,
+  BCS_FIELD_HEIGHT,
+  BCS_FIELD_NBR
+} BCS_MeasurementField_t;
+
 typedef struct
 {
   uint32_t Value;
@@ -149,6 +166,7 @@ typedef struct
 
 typedef struct{
   BCS_App_Opcode_Notification_evt_t  BCS_Evt_Opcode;
+  uint16_t                           ConnectionHandle;
 }BCS_App_Notification_evt_t;
 
 typedef struct{
@@ -177,12 +195,19 @@ typedef struct {
 } BCS_MeasurementValue_t;
 
 /* Exported constants --------------------------------------------------------*/
+#define BCS_MEASUREMENT_MAX_LENGTH       (2 + 2 + 7 + 1 + (9 * 2))
+
 /* External variables --------------------------------------------------------*/
 /* Exported macros -----------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 void BCS_Init(void);
 void BCS_App_Notification(BCS_App_Notification_evt_t * pNotification);
 void BCS_Update_Char(uint16_t UUID, uint8_t *pPayload);
+void BCS_Measurement_SetFlags(uint16_t Flags);
+void BCS_Measurement_SetField(BCS_MeasurementField_t Field, uint16_t Value);
+void BCS_Measurement_SetUserID(uint8_t UserID);
+void BCS_Measurement_SetTimeStamp(BCS_TimeStamp_t *pTimeStamp);
+tBleStatus BCS_Measurement_Send(void);
 
 #ifdef __cplusplus
 }
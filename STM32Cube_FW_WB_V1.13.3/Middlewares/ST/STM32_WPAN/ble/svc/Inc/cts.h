@@ -56,11 +56,14 @@ typedef struct {
 typedef enum
 {
   CTS_NOTIFY_DISABLED_EVT=0,
-  CTS_NOTIFY_ENABLED_EVT
+  CTS_NOTIFY_ENABLED_EVT,
+  CTS_CURRENT_TIME_WRITE_EVT
 } CTS_App_Opcode_Notification_evt_t;
 
 typedef struct{
   CTS_App_Opcode_Notification_evt_t  CTS_Evt_Opcode;
+  uint16_t                           ConnectionHandle;
+  CTS_Ch_t                           CurrentTime;     /* time written by the client, CTS_CURRENT_TIME_WRITE_EVT only */
 }CTS_App_Notification_evt_t;
 
 typedef enum {
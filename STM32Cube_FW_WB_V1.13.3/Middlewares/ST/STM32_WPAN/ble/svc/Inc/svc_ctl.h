@@ -27,6 +27,8 @@
  *    the registered handlers to the BLE controller. When no registered handler acknowledges positively the GATT event,
  *    it is reported to the application.
  *  + A GAP event is not relevant to either a Service or a Client. It is sent to the application
+ *  + Any module may subscribe to a given event. The subscribers of an event are notified before the Services, Clients
+ *    and application, with the event parameters already decoded.
  *  + In case the application does not want to take benefit from the ble_controller, it could bypass it. In that case,
  *  the application shall:
  *    - call  SVCCTL_Init() to initialize the BLE core device (or implement on its own what is inside that function
@@ -58,6 +60,22 @@ extern "C" {
 
   typedef SVCCTL_EvtAckStatus_t (*SVC_CTL_p_EvtHandler_t)(void *p_evt);
 
+  /**
+   * Subscriber of an event, p_evt points to the parameters of the event (the *_event_rp0 structure of the event)
+   */
+  typedef SVCCTL_EvtAckStatus_t (*SVCCTL_p_EvtSubscriber_t)(void *p_evt);
+
+  /**
+   * Processing statistics of an event, recorded when BLE_CFG_EVT_PROFILE is enabled
+   * The times are given in the unit of BLE_CFG_EVT_PROFILE_GET_TIME()
+   */
+  typedef struct
+  {
+    uint32_t Count;         /**< Number of events processed */
+    uint32_t TimeMax;       /**< Longest processing of the event */
+    uint64_t TimeTotal;     /**< Cumulated processing time of the event */
+  } SVCCTL_EvtProfile_t;
+
   /* Exported constants --------------------------------------------------------*/
   /* External variables --------------------------------------------------------*/
   /* Exported macros -----------------------------------------------------------*/
@@ -104,6 +122,64 @@ extern "C" {
    */
   void SVCCTL_RegisterCltHandler( SVC_CTL_p_EvtHandler_t pfBLE_SVC_Client_Event_Handler );
 
+  /**
+   * @brief  This API registers the attribute handle range of a Service once its characteristics have been added.
+   *         A GATT event referring to an attribute handle (attribute modified, read/write/prepare write permit
+   *         request) in that range is reported to the given handler only, without going through the other registered
+   *         Service handlers. The other GATT events are still reported to all the registered handlers.
+   *         Up to BLE_CFG_SVC_MAX_NBR_CB ranges may be registered.
+   *
+   * @param  StartHandle: First handle of the range, usually the Service handle
+   * @param  EndHandle: Last handle of the range
+   * @param  pfBLE_SVC_Service_Event_Handler: The Service handler already registered with SVCCTL_RegisterSvcHandler()
+   * @retval None
+   */
+  void SVCCTL_RegisterHandleRange( uint16_t StartHandle,
+                                   uint16_t EndHandle,
+                                   SVC_CTL_p_EvtHandler_t pfBLE_SVC_Service_Event_Handler );
+
+  /**
+   * @brief  This API subscribes to an event. The subscribers of an event are notified with the event parameters, in the
+   *         order of their subscription, before the event is reported to the Services, Clients and application.
+   *         As soon as one subscriber acknowledges positively the event, it is not reported to the Services, Clients
+   *         and application anymore. The other subscribers of the event are still notified.
+   *         When several modules subscribe to the same event, none of them shall return SVCCTL_EvtAckFlowDisable as
+   *         the event is notified again to all of them when the flow is resumed.
+   *         The HCI events 0x00 to 0x3F, the LE meta subevents 0x00 to 0x1F and the vendor specific events
+   *         known to the BLE core device may be subscribed to.
+   *         Up to BLE_CFG_EVT_MAX_NBR_SUBSCRIBER subscriptions may be registered, the subscription is refused beyond.
+   *         The subscribers are called in the TL_BLE_HCI_UserEvtProc() context
+   *
+   * @param  EvtCode: HCI event code, HCI_LE_META_EVT_CODE or HCI_VENDOR_SPECIFIC_DEBUG_EVT_CODE for the LE meta and
+   *         vendor specific events
+   * @param  SubCode: LE meta subevent code or vendor specific event code, ignored for the other events
+   * @param  pfSubscriber: The subscriber
+   * @retval BLE_STATUS_SUCCESS when the subscriber is registered
+   *         BLE_STATUS_INVALID_PARAMS when the event cannot be subscribed to
+   *         BLE_STATUS_INSUFFICIENT_RESOURCES when BLE_CFG_EVT_MAX_NBR_SUBSCRIBER subscriptions are already registered
+   */
+  tBleStatus SVCCTL_SubscribeEvt( uint8_t EvtCode, uint16_t SubCode, SVCCTL_p_EvtSubscriber_t pfSubscriber );
+
+  /**
+   * @brief  This API returns the processing statistics of an event, from its reception by SVCCTL_UserEvtRx() to the
+   *         return of the subscribers, Services, Clients and application. Available when BLE_CFG_EVT_PROFILE is enabled.
+   *
+   * @param  EvtCode: HCI event code, HCI_LE_META_EVT_CODE or HCI_VENDOR_SPECIFIC_DEBUG_EVT_CODE for the LE meta and
+   *         vendor specific events
+   * @param  SubCode: LE meta subevent code or vendor specific event code, ignored for the other events
+   * @param  pProfile: Statistics of the event
+   * @retval None
+   */
+  void SVCCTL_EvtProfileGet( uint8_t EvtCode, uint16_t SubCode, SVCCTL_EvtProfile_t *pProfile );
+
+  /**
+   * @brief  This API clears the processing statistics of all events. Available when BLE_CFG_EVT_PROFILE is enabled.
+   *
+   * @param  None
+   * @retval None
+   */
+  void SVCCTL_EvtProfileReset( void );
+
   /**
    * @brief  This API is used to resume the User Event Flow that has been stopped in return of SVCCTL_UserEvtRx()
    *
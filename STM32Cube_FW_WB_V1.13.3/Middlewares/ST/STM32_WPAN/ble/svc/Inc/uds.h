@@ -101,7 +101,7 @@ void UDS_Init(void);
 void UDS_App_Notification(UDS_App_Notification_evt_t *pNotification);
 void UDS_Update_Char(uint16_t UUID, uint8_t *pPayload);
 
-uint8_t UDS_App_AccessPermitted(void);
+uint8_t UDS_App_AccessPermitted(uint16_t ConnectionHandle);
 
 
 #ifdef __cplusplus
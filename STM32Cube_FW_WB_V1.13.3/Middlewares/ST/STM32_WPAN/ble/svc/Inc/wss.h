@@ -49,9 +49,43 @@ extern "C"
 typedef enum
 {
   WSS_MEASUREMENT_IND_DISABLED_EVT=0,
-  WSS_MEASUREMENT_IND_ENABLED_EVT
+  WSS_MEASUREMENT_IND_ENABLED_EVT,
+  WSS_MEASUREMENT_IND_CONFIRMED_EVT,
+  WSS_HISTORY_NOTIF_DISABLED_EVT,
+  WSS_HISTORY_NOTIF_ENABLED_EVT,
+  WSS_HISTORY_CONTROL_POINT_EVT
 } WSS_App_Opcode_Notification_evt_t;
 
+/**
+ * Weight History Control Point requests, the sequence number follows RESUME and ACK
+ */
+typedef enum
+{
+  WSS_HISTORY_OPCODE_START  = 0x01,  /**< send the stored measurements from the oldest one, numbered from 0 */
+  WSS_HISTORY_OPCODE_RESUME = 0x02,  /**< send again from a sequence number */
+  WSS_HISTORY_OPCODE_ACK    = 0x03,  /**< the measurements before a sequence number are received, drop them */
+  WSS_HISTORY_OPCODE_ABORT  = 0x04,  /**< end of the transfer, the measurements not acknowledged are kept */
+} WSS_HistoryOpCode_t;
+
+/**
+ * Weight History Data frames: type, sequence number (2 octets) and content
+ * Records: compact records of the measurements, the first one has the sequence number of the frame
+ * Status: request opcode and status, the sequence number is the one of the next measurement to send
+ */
+typedef enum
+{
+  WSS_HISTORY_FRAME_RECORDS = 0x01,
+  WSS_HISTORY_FRAME_STATUS  = 0x02,
+} WSS_HistoryFrame_t;
+
+typedef enum
+{
+  WSS_HISTORY_STATUS_SUCCESS          = 0x01,  /**< every stored measurement has been sent */
+  WSS_HISTORY_STATUS_BUSY             = 0x02,  /**< a transfer is in progress on another link */
+  WSS_HISTORY_STATUS_INVALID_SEQUENCE = 0x03,
+  WSS_HISTORY_STATUS_RECORDS_LOST     = 0x04,  /**< the store has been full, the oldest measurements are lost */
+} WSS_HistoryStatus_t;
+
 typedef enum
 {
   WSS_NO_FLAGS = 0,
@@ -61,6 +95,16 @@ typedef enum
   WSS_FLAGS_BMI_AND_HEIGHT_PRESENT = (1<<3),
 } WSS_WM_Flags_t;
 
+typedef enum
+{
+  WSS_FIELD_WEIGHT = 0,
+  WSS_FIELD_TIME_STAMP,
+  WSS_FIELD_USER_ID,
+  WSS_FIELD_BMI,
+  WSS_FIELD_HEIGHT,
+  WSS_FIELD_NBR
+} WSS_MeasurementField_t;
+
 typedef struct
 {
   uint32_t Value;
@@ -69,6 +113,9 @@ typedef struct
 
 typedef struct{
   WSS_App_Opcode_Notification_evt_t  WSS_Evt_Opcode;
+  uint16_t                           ConnectionHandle;
+  uint8_t                            HistoryOpCode;     /**< WSS_HISTORY_CONTROL_POINT_EVT only */
+  uint16_t                           HistorySequence;   /**< WSS_HISTORY_CONTROL_POINT_EVT only */
 }WSS_App_Notification_evt_t;
 
 typedef struct{
@@ -90,12 +137,53 @@ typedef struct {
 } WSS_MeasurementValue_t;
 
 /* Exported constants --------------------------------------------------------*/
+#define WSS_MEASUREMENT_MAX_LENGTH       (1 + 2 + 7 + 1 + 2 + 2)
+
+/**
+ * Weight History Data layout
+ * A record is the User ID, the flags, the weight, the time stamp in seconds since 1970,
+ * the BMI and the height, the fields absent with the flags are 0
+ */
+#define WSS_HISTORY_HEADER_LENGTH        (1 + 2)
+#define WSS_HISTORY_RECORD_LENGTH        (1 + 1 + 2 + 4 + 2 + 2)
+#define WSS_HISTORY_STATUS_LENGTH        (WSS_HISTORY_HEADER_LENGTH + 2)
+
+/* Write response errors of the Weight History Control Point */
+#define WSS_ERR_CODE_OPCODE_NOT_SUPPORTED          (0x80)
+#define WSS_ERR_CODE_CCCD_IMPROPERLY_CONFIGURED    (0xFD)
+
+/* Collectors the Weight Measurement is indicated to at the same time (8 at most) */
+#ifndef BLE_CFG_WSS_MAX_NBR_LINK
+#define BLE_CFG_WSS_MAX_NBR_LINK         (1)
+#endif
+
+/* Vendor specific Weight History characteristics, bulk transfer of the stored measurements */
+#ifndef BLE_CFG_WSS_HISTORY
+#define BLE_CFG_WSS_HISTORY              (0)
+#endif
+
+/* Largest Weight History Data frame, the ATT_MTU of the links less the notification header */
+#ifndef BLE_CFG_WSS_HISTORY_DATA_MAX_LENGTH
+#define BLE_CFG_WSS_HISTORY_DATA_MAX_LENGTH  (BLE_DEFAULT_ATT_MTU - 3)
+#endif
+
 /* External variables --------------------------------------------------------*/
 /* Exported macros -----------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 void WSS_Init(void);
 void WSS_App_Notification(WSS_App_Notification_evt_t * pNotification);
-void WSS_Update_Char(uint16_t UUID, uint8_t *pPayload);
+tBleStatus WSS_Update_Char(uint16_t UUID, uint8_t *pPayload);
+void WSS_Measurement_SetFlags(uint8_t Flags);
+void WSS_Measurement_SetField(WSS_MeasurementField_t Field, uint16_t Value);
+void WSS_Measurement_SetUserID(uint8_t UserID);
+void WSS_Measurement_SetTimeStamp(WSS_TimeStamp_t *pTimeStamp);
+tBleStatus WSS_Measurement_Send(void);
+void WSS_Disconnection(uint16_t ConnectionHandle);
+#if (BLE_CFG_WSS_HISTORY != 0)
+void WSS_History_SetRecord(uint8_t *pRecord, const WSS_MeasurementValue_t *pMeasurement, uint32_t Epoch);
+uint8_t* WSS_History_Reserve(uint16_t ConnectionHandle, uint8_t Length);
+tBleStatus WSS_History_Send(void);
+#endif
 
 #ifdef __cplusplus
 }
@@ -33,25 +33,58 @@
 
 
 /* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  uint8_t Value[BCS_MEASUREMENT_MAX_LENGTH];  /**< Body Composition Measurement as sent over the air */
+  uint8_t Length;
+  uint8_t FieldOffset[BCS_FIELD_NBR];         /**< Position of each field, computed when the flags change */
+} BCS_MeasurementBuffer_t;
+
+typedef struct {
+  uint16_t Flag;                              /**< Flag telling the field is present, 0 when always present */
+  uint8_t Size;
+} BCS_FieldLayout_t;
+
 typedef struct {
   uint16_t SvcHdle;                     /**< Service handle, Body Composition Service */
   /* Mandatory Service Characteristics */
   uint16_t FeatureCharHdle;             /**< Service Characteristic handle, Body Composition Feature */
   uint16_t MeasurementCharHdle;         /**< Service Characteristic handle, Body Composition Measurement */
   /* No optional Service Characteristics */
+  BCS_MeasurementBuffer_t Measurement;  /**< Body Composition Measurement wire buffer */
 } BCS_Context_t;
 
 
 /* Private defines -----------------------------------------------------------*/
+#define BCS_FIELD_NOT_PRESENT    (0xFF)
 /* Private macros ------------------------------------------------------------*/
 /* Store Value into a buffer in Little Endian Format */
 #define STORE_LE_16(buf, val)    ( ((buf)[0] =  (uint8_t) (val)    ) , \
                                    ((buf)[1] =  (uint8_t) (val>>8) ) )
+#define LOAD_LE_16(buf)          ( (uint16_t)((buf)[0]) | ((uint16_t)((buf)[1]) << 8) )
 
 
 /* Private variables ---------------------------------------------------------*/
 static BCS_Context_t BCS_Context;
 
+/**
+ * Body Composition Measurement fields in the order they are sent, after the Flags
+ */
+static const BCS_FieldLayout_t BCS_FieldLayout[BCS_FIELD_NBR] =
+{
+  { 0,                                  2 },  /* Body Fat Percentage */
+  { BCS_FLAG_TIME_STAMP_PRESENT,        7 },  /* Time Stamp */
+  { BCS_FLAG_USER_ID_PRESENT,           1 },  /* User ID */
+  { BCS_FLAG_BASAL_METABOLISM_PRESENT,  2 },  /* Basal Metabolism */
+  { BCS_FLAG_MUSCLE_PERCENTAGE_PRESENT, 2 },  /* Muscle Percentage */
+  { BCS_FLAG_MUSCLE_MASS_PRESENT,       2 },  /* Muscle Mass */
+  { BCS_FLAG_FAT_FREE_MASS_PRESENT,     2 },  /* Fat Free Mass */
+  { BCS_FLAG_SOFT_LEAN_MASS_PRESENT,    2 },  /* Soft Lean Mass */
+  { BCS_FLAG_BODY_WATER_MASS_PRESENT,   2 },  /* Body Water Mass */
+  { BCS_FLAG_IMPEDANCE_PRESENT,         2 },  /* Impedance */
+  { BCS_FLAG_WEIGHT_PRESENT,            2 },  /* Weight */
+  { BCS_FLAG_HEIGHT_PRESENT,            2 }   /* Height */
+};
+
 
 /* Private function prototypes -----------------------------------------------*/
 static SVCCTL_EvtAckStatus_t BCS_Event_Handler(void *pckt);
@@ -74,6 +107,8 @@ void BCS_Init(void){
    */
   SVCCTL_RegisterSvcHandler(BCS_Event_Handler);
 
+  BCS_Measurement_SetFlags(BCS_FLAG_MEASUREMENT_UNITS_SI);
+
   /**
    *  Add Body Composition Service
    *
@@ -167,6 +202,14 @@ void BCS_Init(void){
     BLE_DBG_BCS_MSG ("FAILED to add Body Composition Measurement Characteristic: Error: %02X !!\n\r",
                  hciCmdResult);
   }
+
+  /**
+   *  Route the events of the service attributes straight to the event handler
+   *  The last attribute is the client char configuration descriptor of the measurement
+   */
+  SVCCTL_RegisterHandleRange(BCS_Context.SvcHdle,
+                             BCS_Context.MeasurementCharHdle + 2,
+                             BCS_Event_Handler);
 }
 
 void BCS_Update_Char(uint16_t UUID, uint8_t *pPayload){
@@ -183,6 +226,89 @@ void BCS_Update_Char(uint16_t UUID, uint8_t *pPayload){
   }
 }
 
+/**
+ * @brief  Lay out the Body Composition Measurement wire buffer for a set of flags
+ *         The fields absent with these flags are ignored by the setters
+ * @param  Flags: Body Composition Measurement flags
+ * @retval None
+ */
+void BCS_Measurement_SetFlags(uint16_t Flags){
+  BCS_MeasurementBuffer_t *p_measurement = &BCS_Context.Measurement;
+  uint8_t length = 2;
+  uint8_t field;
+
+  STORE_LE_16(p_measurement->Value, Flags);
+
+  for(field = 0; field < BCS_FIELD_NBR; field++){
+    if((BCS_FieldLayout[field].Flag == 0) || (Flags & BCS_FieldLayout[field].Flag)){
+      p_measurement->FieldOffset[field] = length;
+      length += BCS_FieldLayout[field].Size;
+    }
+    else{
+      p_measurement->FieldOffset[field] = BCS_FIELD_NOT_PRESENT;
+    }
+  }
+
+  p_measurement->Length = length;
+}
+
+/**
+ * @brief  Write a 2 octets field in the Body Composition Measurement wire buffer
+ * @param  Field: any field but BCS_FIELD_TIME_STAMP and BCS_FIELD_USER_ID
+ * @param  Value: Field value
+ * @retval None
+ */
+void BCS_Measurement_SetField(BCS_MeasurementField_t Field, uint16_t Value){
+  uint8_t offset = BCS_Context.Measurement.FieldOffset[Field];
+
+  if((offset != BCS_FIELD_NOT_PRESENT) && (BCS_FieldLayout[Field].Size == 2)){
+    STORE_LE_16(BCS_Context.Measurement.Value + offset, Value);
+  }
+}
+
+void BCS_Measurement_SetUserID(uint8_t UserID){
+  uint8_t offset = BCS_Context.Measurement.FieldOffset[BCS_FIELD_USER_ID];
+
+  if(offset != BCS_FIELD_NOT_PRESENT){
+    BCS_Context.Measurement.Value[offset] = UserID;
+  }
+}
+
+void BCS_Measurement_SetTimeStamp(BCS_TimeStamp_t *pTimeStamp){
+  uint8_t offset = BCS_Context.Measurement.FieldOffset[BCS_FIELD_TIME_STAMP];
+  uint8_t *p_value;
+
+  if(offset != BCS_FIELD_NOT_PRESENT){
+    p_value = BCS_Context.Measurement.Value + offset;
+    STORE_LE_16(p_value, pTimeStamp->Year);
+    p_value[2] = pTimeStamp->Month;
+    p_value[3] = pTimeStamp->Day;
+    p_value[4] = pTimeStamp->Hours;
+    p_value[5] = pTimeStamp->Minutes;
+    p_value[6] = pTimeStamp->Seconds;
+  }
+}
+
+/**
+ * @brief  Indicate the Body Composition Measurement wire buffer as it is
+ * @param  None
+ * @retval BLE_STATUS_SUCCESS when the indication has been sent
+ */
+tBleStatus BCS_Measurement_Send(void){
+  uint8_t *p_value;
+
+  /**
+   * The wire buffer is encoded straight into the command packet shared with the CPU2
+   */
+  p_value = aci_gatt_update_char_value_reserve(BCS_Context.SvcHdle,
+                                               BCS_Context.MeasurementCharHdle,
+                                               0,                                /* charValOffset */
+                                               BCS_Context.Measurement.Length);  /* charValLength */
+  Osal_MemCpy(p_value, BCS_Context.Measurement.Value, BCS_Context.Measurement.Length);
+
+  return aci_gatt_update_char_value_commit();
+}
+
 
 /* Private functions ---------------------------------------------------------*/
 /**
@@ -214,6 +340,7 @@ static SVCCTL_EvtAckStatus_t BCS_Event_Handler(void *Event)
           if(attribute_modified->Attr_Handle == (BCS_Context.MeasurementCharHdle + 2))
           {
             return_value = SVCCTL_EvtAckFlowEnable;
+            Notification.ConnectionHandle = attribute_modified->Connection_Handle;
             /**
              * Notify to application to start measurement
              */
@@ -251,133 +378,27 @@ static SVCCTL_EvtAckStatus_t BCS_Event_Handler(void *Event)
  * @retval None
  */
 static void Update_Char_Measurement(BCS_MeasurementValue_t *pMeasurement){
-  uint8_t bcm_value [
-					2                                         /** Flags, 2 octets */
-				   +2                                         /** Body Fat Percentage, 2 octets */
-				   +7                                         /** Time Stamp, 7 octets */
-				   +1                                         /** User ID, 1 octets */
-				   +2                                         /** Basal Metabolism, 2 octets */
-				   +2                                         /** Muscle Percentage, 2 octets */
-				   +2                                         /** Muscle Mass, 2 octets */
-				   +2                                         /** Fat Free Mass, 2 octets */
-				   +2                                         /** Soft Lean Mass, 2 octets */
-				   +2                                         /** Body Water Mass, 2 octets */
-				   +2                                         /** Impedance, 2 octets */
-				   +2                                         /** Weight, 2 octets */
-				   +2                                         /** Height, 2 octets */
-				   +0                                        /** The empty as the last one */
-                    ];
-  uint8_t length = 0;
-  
-  /*
-   * Flags update
-   */
-  STORE_LE_16(bcm_value, pMeasurement->Flags);
-  length = 2;
-  
-  /*
-   * Body Fat Percentage
-   */
-  STORE_LE_16(bcm_value + length, pMeasurement->BodyFatPercentage);
-  length += 2;
-  
-  /*
-   * Time Stamp
-   */
-  if (pMeasurement->Flags & BCS_FLAG_TIME_STAMP_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->TimeStamp.Year);
-    length += 2;
-    bcm_value[length++] = pMeasurement->TimeStamp.Month;
-    bcm_value[length++] = pMeasurement->TimeStamp.Day;
-    bcm_value[length++] = pMeasurement->TimeStamp.Hours;
-    bcm_value[length++] = pMeasurement->TimeStamp.Minutes;
-    bcm_value[length++] = pMeasurement->TimeStamp.Seconds;
-  }
-  
-  /*
-   * User ID
-   */
-  if (pMeasurement->Flags & BCS_FLAG_USER_ID_PRESENT){
-    bcm_value[length++] = pMeasurement->UserID;
-  }
-  
-  /*
-   * Basal Metabolism
-   */
-  if (pMeasurement->Flags & BCS_FLAG_BASAL_METABOLISM_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->BasalMetabolism);
-    length += 2;
-  }
-
-  /*
-   * Muscle Percentage
-   */
-  if (pMeasurement->Flags & BCS_FLAG_MUSCLE_PERCENTAGE_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->MusclePercentage);
-    length += 2;
-  }
-
-  /*
-   * Muscle Mass
-   */
-  if (pMeasurement->Flags & BCS_FLAG_MUSCLE_MASS_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->MuscleMass);
-    length += 2;
-  }
-
-  /*
-   * Fat Free Mass
-   */
-  if (pMeasurement->Flags & BCS_FLAG_FAT_FREE_MASS_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->FatFreeMass);
-    length += 2;
-  }
-
-  /*
-   * Soft Lean Mass
-   */
-  if (pMeasurement->Flags & BCS_FLAG_SOFT_LEAN_MASS_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->SoftLeanMass);
-    length += 2;
-  }
-
-  /*
-   * Body Water Mass
-   */
-  if (pMeasurement->Flags & BCS_FLAG_BODY_WATER_MASS_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->BodyWaterMass);
-    length += 2;
-  }
-
-  /*
-   * Impedance
-   */
-  if (pMeasurement->Flags & BCS_FLAG_IMPEDANCE_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->Impedance);
-    length += 2;
-  }
-
-  /*
-   * Weight
-   */
-  if (pMeasurement->Flags & BCS_FLAG_WEIGHT_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->Weight);
-    length += 2;
-  }
-
   /*
-   * Height
+   * Flags update, the layout is only computed again when they change
    */
-  if (pMeasurement->Flags & BCS_FLAG_HEIGHT_PRESENT){
-    STORE_LE_16(bcm_value + length, pMeasurement->Height);
-    length += 2;
+  if(pMeasurement->Flags != LOAD_LE_16(BCS_Context.Measurement.Value)){
+    BCS_Measurement_SetFlags(pMeasurement->Flags);
   }
 
-  aci_gatt_update_char_value(BCS_Context.SvcHdle,
-                             BCS_Context.MeasurementCharHdle,
-                             0,               /* charValOffset */
-                             length,          /* charValLength */
-                             bcm_value);
+  BCS_Measurement_SetField(BCS_FIELD_BODY_FAT_PERCENTAGE, pMeasurement->BodyFatPercentage);
+  BCS_Measurement_SetTimeStamp(&pMeasurement->TimeStamp);
+  BCS_Measurement_SetUserID(pMeasurement->UserID);
+  BCS_Measurement_SetField(BCS_FIELD_BASAL_METABOLISM, pMeasurement->BasalMetabolism);
+  BCS_Measurement_SetField(BCS_FIELD_MUSCLE_PERCENTAGE, pMeasurement->MusclePercentage);
+  BCS_Measurement_SetField(BCS_FIELD_MUSCLE_MASS, pMeasurement->MuscleMass);
+  BCS_Measurement_SetField(BCS_FIELD_FAT_FREE_MASS, pMeasurement->FatFreeMass);
+  BCS_Measurement_SetField(BCS_FIELD_SOFT_LEAN_MASS, pMeasurement->SoftLeanMass);
+  BCS_Measurement_SetField(BCS_FIELD_BODY_WATER_MASS, pMeasurement->BodyWaterMass);
+  BCS_Measurement_SetField(BCS_FIELD_IMPEDANCE, pMeasurement->Impedance);
+  BCS_Measurement_SetField(BCS_FIELD_WEIGHT, pMeasurement->Weight);
+  BCS_Measurement_SetField(BCS_FIELD_HEIGHT, pMeasurement->Height);
+
+  BCS_Measurement_Send();
 }
 
 /**
@@ -397,10 +418,10 @@ static void Update_Char_Feature(BCS_FeatureValue_t *pFeatureValue)
   wsf_value[2] = (uint8_t)((pFeatureValue->Value >> 16) & 0xFF);
   wsf_value[3] = (uint8_t)((pFeatureValue->Value >> 24) & 0xFF);
   
-  aci_gatt_update_char_value(BCS_Context.SvcHdle,
-                             BCS_Context.FeatureCharHdle,
-                             0, /* charValOffset */
-                             4, /* charValueLen */
-                             (uint8_t *)  &wsf_value[0]);
+  aci_gatt_update_char_value_async(BCS_Context.SvcHdle,
+                                   BCS_Context.FeatureCharHdle,
+                                   0, /* charValOffset */
+                                   4, /* charValueLen */
+                                   (uint8_t *)  &wsf_value[0], NULL, NULL);
 }/* end Update_Char_Feature() */
 
@@ -40,17 +40,30 @@ typedef struct {
 } CTS_Context_t;
 
 /* Private defines -----------------------------------------------------------*/
+/* Years accepted in the Current Time, the range of the characteristic unless restricted in ble_conf.h */
+#ifndef BLE_CFG_CTS_YEAR_MIN
+#define BLE_CFG_CTS_YEAR_MIN     (1582)
+#endif
+#ifndef BLE_CFG_CTS_YEAR_MAX
+#define BLE_CFG_CTS_YEAR_MAX     (9999)
+#endif
+
 /* Private macros ------------------------------------------------------------*/
 /* Store Value into a buffer in Little Endian Format */
 #define STORE_LE_16(buf, val)    ( ((buf)[0] =  (uint8_t) (val)    ) , \
                                    ((buf)[1] =  (uint8_t) (val>>8) ) )
+/* Load a Little Endian Format buffer into a Value */
+#define LOAD_LE_16(buf)          ( (uint16_t)(buf)[0] | ((uint16_t)(buf)[1] << 8) )
 
 /* Private variables ---------------------------------------------------------*/
 static CTS_Context_t CTS_Context;
 
+static const uint8_t DaysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
 /* Private function prototypes -----------------------------------------------*/
 static SVCCTL_EvtAckStatus_t CTS_Event_Handler(void *Event);
 static void UpateCurrentTime(CTS_Ch_t *data);
+static uint8_t ParseCurrentTime(uint8_t length, const uint8_t *buf, CTS_Ch_t *data);
 
 /* Public functions ----------------------------------------------------------*/
 
@@ -93,16 +106,17 @@ void CTS_Init(void) {
 	}
 
 	/**
-	 *  Add Weight Scale Feature Characteristic
+	 *  Add Current Time Characteristic
+	 *  It is writable so that a collector may set the time of the server
 	 */
 	uuid = CURRENT_TIME_CHAR_UUID;
 	hciCmdResult = aci_gatt_add_char(CTS_Context.SvcHdle,
 			UUID_TYPE_16,
 			(Char_UUID_t*) &uuid,
 			10, /** 10 octets */
-			CHAR_PROP_READ | CHAR_PROP_NOTIFY,
+			CHAR_PROP_READ | CHAR_PROP_WRITE | CHAR_PROP_NOTIFY,
 			ATTR_PERMISSION_NONE,
-			GATT_DONT_NOTIFY_EVENTS, /* gattEvtMask */
+			GATT_NOTIFY_WRITE_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
 			10, /* encryKeySize */
 			0, /* fixed-length */
 			&(CTS_Context.CurrentTimeCharHdle));
@@ -114,6 +128,14 @@ void CTS_Init(void) {
 		BLE_DBG_CTS_MSG ("FAILED to add Current Time Characteristic: Error: %02X !!\n\r",
 				hciCmdResult);
 	}
+
+	/**
+	 *  Route the events of the service attributes straight to the event handler
+	 *  The last attribute is the client char configuration descriptor of the current time
+	 */
+	SVCCTL_RegisterHandleRange(CTS_Context.SvcHdle,
+			CTS_Context.CurrentTimeCharHdle + 2,
+			CTS_Event_Handler);
 }
 
 void CTS_Update_Char(uint16_t UUID, uint8_t *pPayload) {
@@ -158,6 +180,7 @@ static SVCCTL_EvtAckStatus_t CTS_Event_Handler(void *Event) {
 					Notification.CTS_Evt_Opcode = CTS_NOTIFY_DISABLED_EVT;
 				}
 
+				Notification.ConnectionHandle = attribute_modified->Connection_Handle;
 				CTS_App_Notification(&Notification);
 
 				return_value = SVCCTL_EvtAckFlowEnable;
@@ -170,11 +193,27 @@ static SVCCTL_EvtAckStatus_t CTS_Event_Handler(void *Event) {
 			write_perm_req = (aci_gatt_write_permit_req_event_rp0*) blue_evt->data;
 			if (write_perm_req->Attribute_Handle == (CTS_Context.CurrentTimeCharHdle + 1)) {
 				BLE_DBG_CTS_MSG("CTS event -> ACI_GATT_WRITE_PERMIT_REQ_VSEVT_CODE -> (CurrentTimeCharHdle + 1)\n\r");
-				aci_gatt_write_resp(write_perm_req->Connection_Handle,
-						write_perm_req->Attribute_Handle, 0x01, /* write_status = 1 (error))*/
-						CTS_ERR_CODE_DATA_FIELD_IGNORED, /* err_code */
-						write_perm_req->Data_Length,
-						(uint8_t*) &(write_perm_req->Data[0]));
+				if (ParseCurrentTime(write_perm_req->Data_Length,
+						write_perm_req->Data,
+						&(Notification.CurrentTime))) {
+					aci_gatt_write_resp(write_perm_req->Connection_Handle,
+							write_perm_req->Attribute_Handle, 0x00, /* write_status = 0 (no error))*/
+							0x00, /* err_code */
+							write_perm_req->Data_Length,
+							(uint8_t*) &(write_perm_req->Data[0]));
+
+					Notification.CTS_Evt_Opcode = CTS_CURRENT_TIME_WRITE_EVT;
+					Notification.ConnectionHandle = write_perm_req->Connection_Handle;
+					CTS_App_Notification(&Notification);
+				} else {
+					aci_gatt_write_resp(write_perm_req->Connection_Handle,
+							write_perm_req->Attribute_Handle, 0x01, /* write_status = 1 (error))*/
+							CTS_ERR_CODE_DATA_FIELD_IGNORED, /* err_code */
+							write_perm_req->Data_Length,
+							(uint8_t*) &(write_perm_req->Data[0]));
+				}
+
+				return_value = SVCCTL_EvtAckFlowEnable;
 			}
 		}
 			break;
@@ -215,8 +254,56 @@ static void UpateCurrentTime(CTS_Ch_t *data) {
 	/* Adjust Reason */
 	buf[length++] = data->adjust_reason;
 
-	aci_gatt_update_char_value(CTS_Context.SvcHdle,
+	aci_gatt_update_char_value_async(CTS_Context.SvcHdle,
 			CTS_Context.CurrentTimeCharHdle, 0, /* charValOffset */
 			length, /* charValLength */
-			buf);
+			buf, NULL, NULL);
+}
+
+/**
+ * @brief  Parse a Current Time written by the client
+ *         The adjust reason is left to the server
+ * @param  length: Length of the written value
+ * @param  buf: Written value
+ * @param  data: Updated with the current time
+ * @retval 1 when the value is a valid time, 0 otherwise
+ */
+static uint8_t ParseCurrentTime(uint8_t length, const uint8_t *buf, CTS_Ch_t *data) {
+	CTS_DateTime_t *date = &(data->exact_time_256.day_date_time.date_time);
+
+	if (length != 10) {
+		return 0;
+	}
+
+	/* Day Date time */
+	date->Year = LOAD_LE_16(buf);
+	date->Month = buf[2];
+	date->Day = buf[3];
+	date->Hours = buf[4];
+	date->Minutes = buf[5];
+	date->Seconds = buf[6];
+
+	/* day of week */
+	data->exact_time_256.day_date_time.day_of_week = buf[7];
+
+	/* Fractions 256 */
+	data->exact_time_256.fractions256 = buf[8];
+
+	/* Adjust Reason */
+	data->adjust_reason = buf[9];
+
+	/* an unknown field cannot set the time */
+	if ((date->Year < BLE_CFG_CTS_YEAR_MIN) || (date->Year > BLE_CFG_CTS_YEAR_MAX) ||
+			(date->Month < 1) || (date->Month > 12) ||
+			(date->Hours > 23) || (date->Minutes > 59) || (date->Seconds > 59) ||
+			(data->exact_time_256.day_date_time.day_of_week > 7)) {
+		return 0;
+	}
+
+	/* the day exists in the month, February 29 in the leap years of the Gregorian calendar only */
+	if ((date->Month == 2) && (date->Day == 29)) {
+		return (((date->Year % 4) == 0) && (((date->Year % 100) != 0) || ((date->Year % 400) == 0)));
+	}
+
+	return ((date->Day >= 1) && (date->Day <= DaysInMonth[date->Month - 1]));
 }
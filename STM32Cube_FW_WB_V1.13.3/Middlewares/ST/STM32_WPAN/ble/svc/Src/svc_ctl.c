@@ -21,6 +21,38 @@
 #include "common_blesvc.h"
 #include "cmsis_compiler.h"
 
+/* Private defines -----------------------------------------------------------*/
+#define SVCCTL_EGID_EVT_MASK   0xFF00
+#define SVCCTL_GATT_EVT_TYPE   0x0C00
+#define SVCCTL_GAP_DEVICE_NAME_LENGTH 7
+
+#ifndef BLE_CFG_EVT_MAX_NBR_SUBSCRIBER
+#define BLE_CFG_EVT_MAX_NBR_SUBSCRIBER  0
+#endif
+
+#ifndef BLE_CFG_EVT_PROFILE
+#define BLE_CFG_EVT_PROFILE             0
+#endif
+
+/**
+ * The events are looked up with a direct index when they may be subscribed to or profiled
+ */
+#define SVCCTL_EVT_INDEX                ((BLE_CFG_EVT_MAX_NBR_SUBSCRIBER > 0) || (BLE_CFG_EVT_PROFILE != 0))
+
+#define SVCCTL_HCI_EVT_SLOT_NBR         0x40    /**< HCI events 0x00 to 0x3F, indexed by their code */
+#define SVCCTL_LE_EVT_SLOT_BASE         SVCCTL_HCI_EVT_SLOT_NBR
+#define SVCCTL_LE_EVT_SLOT_NBR          0x20    /**< LE meta subevents 0x00 to 0x1F, indexed by their code */
+#define SVCCTL_VS_EVT_SLOT_BASE         (SVCCTL_LE_EVT_SLOT_BASE + SVCCTL_LE_EVT_SLOT_NBR)
+#define SVCCTL_VS_EVT_SLOT_NBR          (8 + 16 + 32 + 32)
+#define SVCCTL_EVT_SLOT_NBR             (SVCCTL_VS_EVT_SLOT_BASE + SVCCTL_VS_EVT_SLOT_NBR)
+#define SVCCTL_EVT_NO_SLOT              0xFF
+
+#define SVCCTL_VS_EVT_GROUP_NBR         4       /**< HAL, GAP, L2CAP and GATT vendor specific events */
+#define SVCCTL_VS_EVT_GROUP_POS         10
+#define SVCCTL_VS_EVT_CODE_MASK         0x03FF
+
+#define SVCCTL_NO_SUBSCRIBER            0xFF
+
 /* Private typedef -----------------------------------------------------------*/
 typedef struct
 {
@@ -38,10 +70,35 @@ SVC_CTL_p_EvtHandler_t SVCCTL_CltHandlerTable[BLE_CFG_CLT_MAX_NBR_CB];
 uint8_t NbreOfRegisteredHandler;
 } SVCCTL_CltHandler_t;
 
-/* Private defines -----------------------------------------------------------*/
-#define SVCCTL_EGID_EVT_MASK   0xFF00
-#define SVCCTL_GATT_EVT_TYPE   0x0C00
-#define SVCCTL_GAP_DEVICE_NAME_LENGTH 7
+typedef struct
+{
+uint16_t StartHandle;
+uint16_t EndHandle;
+SVC_CTL_p_EvtHandler_t pfHandler;
+} SVCCTL_HandleRange_t;
+
+typedef struct
+{
+#if (BLE_CFG_SVC_MAX_NBR_CB > 0)
+SVCCTL_HandleRange_t SVCCTL_HandleRangeTab[BLE_CFG_SVC_MAX_NBR_CB]; /**< Sorted by StartHandle */
+#endif
+uint8_t NbreOfRegisteredRange;
+} SVCCTL_HandleRangeTable_t;
+
+typedef struct
+{
+SVCCTL_p_EvtSubscriber_t pfSubscriber;
+uint8_t Next;                                         /**< Next subscriber of the same event */
+} SVCCTL_Subscriber_t;
+
+typedef struct
+{
+#if (BLE_CFG_EVT_MAX_NBR_SUBSCRIBER > 0)
+uint8_t SVCCTL_EvtSlotHead[SVCCTL_EVT_SLOT_NBR];      /**< First subscriber of each event */
+SVCCTL_Subscriber_t SVCCTL_SubscriberTab[BLE_CFG_EVT_MAX_NBR_SUBSCRIBER];
+#endif
+uint8_t NbreOfSubscriber;
+} SVCCTL_EvtSubscription_t;
 
 /* Private macros ------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
@@ -51,12 +108,170 @@ uint8_t NbreOfRegisteredHandler;
 
 PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") SVCCTL_EvtHandler_t SVCCTL_EvtHandler;
 PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") SVCCTL_CltHandler_t SVCCTL_CltHandler;
+PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") SVCCTL_HandleRangeTable_t SVCCTL_HandleRangeTable;
+PLACE_IN_SECTION("BLE_DRIVER_CONTEXT") SVCCTL_EvtSubscription_t SVCCTL_EvtSubscription;
 
 /**
  * END of Section BLE_DRIVER_CONTEXT
  */
 
+#if (SVCCTL_EVT_INDEX != 0)
+/**
+ * Vendor specific events of each group, sized after the highest event code of the group
+ */
+static const uint8_t SVCCTL_VsEvtGroupSize[SVCCTL_VS_EVT_GROUP_NBR] = { 8, 16, 32, 32 };
+static const uint8_t SVCCTL_VsEvtGroupBase[SVCCTL_VS_EVT_GROUP_NBR] = { 0, 8, 24, 56 };
+#endif
+
+#if (BLE_CFG_EVT_PROFILE != 0)
+static SVCCTL_EvtProfile_t SVCCTL_EvtProfileTab[SVCCTL_EVT_SLOT_NBR];
+#endif
+
 /* Private functions ----------------------------------------------------------*/
+#if (BLE_CFG_SVC_MAX_NBR_CB > 0)
+/**
+ * @brief  Attribute handle of a GATT event
+ * @param  blecore_evt: GATT event
+ * @param  p_attr_handle: Attribute handle of the event
+ * @retval 1 when the event refers to an attribute, 0 otherwise
+ */
+static uint8_t SVCCTL_GetAttrHandle( evt_blecore_aci *blecore_evt, uint16_t *p_attr_handle )
+{
+  switch (blecore_evt->ecode)
+  {
+    case ACI_GATT_ATTRIBUTE_MODIFIED_VSEVT_CODE:
+    case ACI_GATT_WRITE_PERMIT_REQ_VSEVT_CODE:
+    case ACI_GATT_READ_PERMIT_REQ_VSEVT_CODE:
+    case ACI_GATT_PREPARE_WRITE_PERMIT_REQ_VSEVT_CODE:
+      /**
+       * These events start with the Connection_Handle followed by the attribute handle
+       */
+      *p_attr_handle = (uint16_t)blecore_evt->data[2] | ((uint16_t)blecore_evt->data[3] << 8);
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief  Handler of the Service owning an attribute handle
+ * @param  attr_handle: Attribute handle
+ * @retval Handler registered with SVCCTL_RegisterHandleRange(), NULL when no range holds the handle
+ */
+static SVC_CTL_p_EvtHandler_t SVCCTL_FindHandleOwner( uint16_t attr_handle )
+{
+  SVCCTL_HandleRange_t *p_range;
+  uint8_t low, high, mid;
+
+  /**
+   * Look for the last range starting at or before the handle
+   */
+  low = 0;
+  high = SVCCTL_HandleRangeTable.NbreOfRegisteredRange;
+  while (low < high)
+  {
+    mid = (low + high) / 2;
+    if (SVCCTL_HandleRangeTable.SVCCTL_HandleRangeTab[mid].StartHandle <= attr_handle)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+
+  if (low == 0)
+  {
+    return NULL;
+  }
+
+  p_range = &SVCCTL_HandleRangeTable.SVCCTL_HandleRangeTab[low - 1];
+  if (attr_handle > p_range->EndHandle)
+  {
+    return NULL;
+  }
+
+  return p_range->pfHandler;
+}
+#endif
+
+#if (SVCCTL_EVT_INDEX != 0)
+/**
+ * @brief  Direct index of an event
+ *         The HCI events and the LE meta subevents are indexed by their code, the vendor specific events by their
+ *         group (HAL, GAP, L2CAP, GATT) and their code within the group
+ * @param  evt_code: HCI event code
+ * @param  sub_code: LE meta subevent code or vendor specific event code, ignored for the other events
+ * @retval Index of the event, SVCCTL_EVT_NO_SLOT when the event is out of the index
+ */
+static uint8_t SVCCTL_GetEvtSlot( uint8_t evt_code, uint16_t sub_code )
+{
+  uint16_t group;
+
+  switch (evt_code)
+  {
+    case HCI_LE_META_EVT_CODE:
+      if (sub_code < SVCCTL_LE_EVT_SLOT_NBR)
+      {
+        return (uint8_t)(SVCCTL_LE_EVT_SLOT_BASE + sub_code);
+      }
+      break;
+
+    case HCI_VENDOR_SPECIFIC_DEBUG_EVT_CODE:
+      group = sub_code >> SVCCTL_VS_EVT_GROUP_POS;
+      if ((group < SVCCTL_VS_EVT_GROUP_NBR)
+          && ((sub_code & SVCCTL_VS_EVT_CODE_MASK) < SVCCTL_VsEvtGroupSize[group]))
+      {
+        return (uint8_t)(SVCCTL_VS_EVT_SLOT_BASE + SVCCTL_VsEvtGroupBase[group] + (sub_code & SVCCTL_VS_EVT_CODE_MASK));
+      }
+      break;
+
+    default:
+      if (evt_code < SVCCTL_HCI_EVT_SLOT_NBR)
+      {
+        return evt_code;
+      }
+      break;
+  }
+
+  return SVCCTL_EVT_NO_SLOT;
+}
+#endif
+
+#if (BLE_CFG_EVT_MAX_NBR_SUBSCRIBER > 0)
+/**
+ * @brief  Notify an event to its subscribers, in the order of their subscription
+ * @param  slot: Index of the event
+ * @param  p_evt: Event parameters
+ * @retval SVCCTL_EvtNotAck when no subscriber has acknowledged the event
+ */
+static SVCCTL_EvtAckStatus_t SVCCTL_NotifySubscribers( uint8_t slot, void *p_evt )
+{
+  SVCCTL_EvtAckStatus_t event_notification_status;
+  SVCCTL_EvtAckStatus_t subscriber_status;
+  uint8_t index;
+
+  event_notification_status = SVCCTL_EvtNotAck;
+  index = SVCCTL_EvtSubscription.SVCCTL_EvtSlotHead[slot];
+  while (index != SVCCTL_NO_SUBSCRIBER)
+  {
+    subscriber_status = SVCCTL_EvtSubscription.SVCCTL_SubscriberTab[index].pfSubscriber(p_evt);
+    /**
+     * A flow disable request is kept whatever the status of the next subscribers
+     */
+    if ((subscriber_status != SVCCTL_EvtNotAck) && (event_notification_status != SVCCTL_EvtAckFlowDisable))
+    {
+      event_notification_status = subscriber_status;
+    }
+    index = SVCCTL_EvtSubscription.SVCCTL_SubscriberTab[index].Next;
+  }
+
+  return event_notification_status;
+}
+#endif
+
 /* Weak functions ----------------------------------------------------------*/
 void BVOPUS_STM_Init(void);
 
@@ -138,12 +353,27 @@ __WEAK void SVCCTL_InitCustomSvc( void )
 
 void SVCCTL_Init( void )
 {
- 
+#if (BLE_CFG_EVT_MAX_NBR_SUBSCRIBER > 0)
+  uint8_t index;
+#endif
+
   /**
    * Initialize the number of registered Handler
    */
   SVCCTL_EvtHandler.NbreOfRegisteredHandler = 0;
   SVCCTL_CltHandler.NbreOfRegisteredHandler = 0;
+  SVCCTL_HandleRangeTable.NbreOfRegisteredRange = 0;
+  SVCCTL_EvtSubscription.NbreOfSubscriber = 0;
+#if (BLE_CFG_EVT_MAX_NBR_SUBSCRIBER > 0)
+  for (index = 0; index < SVCCTL_EVT_SLOT_NBR; index++)
+  {
+    SVCCTL_EvtSubscription.SVCCTL_EvtSlotHead[index] = SVCCTL_NO_SUBSCRIBER;
+  }
+#endif
+#if (BLE_CFG_EVT_PROFILE != 0)
+  BLE_CFG_EVT_PROFILE_INIT( );
+  SVCCTL_EvtProfileReset();
+#endif
 
   /**
    * Add and Initialize requested services
@@ -228,6 +458,145 @@ void SVCCTL_RegisterCltHandler( SVC_CTL_p_EvtHandler_t pfBLE_SVC_Client_Event_Ha
   return;
 }
 
+/**
+ * @brief  Register the attribute handle range of a Service
+ * @param  StartHandle: First handle of the range, usually the Service handle
+ * @param  EndHandle: Last handle of the range
+ * @param  pfBLE_SVC_Service_Event_Handler: Handler of the Service
+ * @retval None
+ */
+void SVCCTL_RegisterHandleRange( uint16_t StartHandle,
+                                 uint16_t EndHandle,
+                                 SVC_CTL_p_EvtHandler_t pfBLE_SVC_Service_Event_Handler )
+{
+#if (BLE_CFG_SVC_MAX_NBR_CB > 0)
+  uint8_t index;
+
+  if (SVCCTL_HandleRangeTable.NbreOfRegisteredRange < BLE_CFG_SVC_MAX_NBR_CB)
+  {
+    /**
+     * Keep the table sorted by StartHandle
+     */
+    index = SVCCTL_HandleRangeTable.NbreOfRegisteredRange;
+    while ((index > 0) && (SVCCTL_HandleRangeTable.SVCCTL_HandleRangeTab[index - 1].StartHandle > StartHandle))
+    {
+      SVCCTL_HandleRangeTable.SVCCTL_HandleRangeTab[index] = SVCCTL_HandleRangeTable.SVCCTL_HandleRangeTab[index - 1];
+      index--;
+    }
+    SVCCTL_HandleRangeTable.SVCCTL_HandleRangeTab[index].StartHandle = StartHandle;
+    SVCCTL_HandleRangeTable.SVCCTL_HandleRangeTab[index].EndHandle = EndHandle;
+    SVCCTL_HandleRangeTable.SVCCTL_HandleRangeTab[index].pfHandler = pfBLE_SVC_Service_Event_Handler;
+    SVCCTL_HandleRangeTable.NbreOfRegisteredRange++;
+  }
+#else
+  (void)(StartHandle);
+  (void)(EndHandle);
+  (void)(pfBLE_SVC_Service_Event_Handler);
+#endif
+
+  return;
+}
+
+/**
+ * @brief  Subscribe to an event
+ * @param  EvtCode: HCI event code
+ * @param  SubCode: LE meta subevent code or vendor specific event code, ignored for the other events
+ * @param  pfSubscriber: Subscriber, called with the event parameters
+ * @retval BLE_STATUS_SUCCESS, BLE_STATUS_INVALID_PARAMS when the event cannot be subscribed to,
+ *         BLE_STATUS_INSUFFICIENT_RESOURCES when BLE_CFG_EVT_MAX_NBR_SUBSCRIBER subscriptions are registered
+ */
+tBleStatus SVCCTL_SubscribeEvt( uint8_t EvtCode, uint16_t SubCode, SVCCTL_p_EvtSubscriber_t pfSubscriber )
+{
+  tBleStatus status;
+#if (BLE_CFG_EVT_MAX_NBR_SUBSCRIBER > 0)
+  uint8_t slot;
+  uint8_t index;
+  uint8_t *p_next;
+
+  slot = SVCCTL_GetEvtSlot(EvtCode, SubCode);
+  if (slot == SVCCTL_EVT_NO_SLOT)
+  {
+    status = BLE_STATUS_INVALID_PARAMS;
+  }
+  else if (SVCCTL_EvtSubscription.NbreOfSubscriber >= BLE_CFG_EVT_MAX_NBR_SUBSCRIBER)
+  {
+    status = BLE_STATUS_INSUFFICIENT_RESOURCES;
+  }
+  else
+  {
+    index = SVCCTL_EvtSubscription.NbreOfSubscriber;
+    SVCCTL_EvtSubscription.SVCCTL_SubscriberTab[index].pfSubscriber = pfSubscriber;
+    SVCCTL_EvtSubscription.SVCCTL_SubscriberTab[index].Next = SVCCTL_NO_SUBSCRIBER;
+
+    /**
+     * Append the subscriber to the ones of the event
+     */
+    p_next = &SVCCTL_EvtSubscription.SVCCTL_EvtSlotHead[slot];
+    while (*p_next != SVCCTL_NO_SUBSCRIBER)
+    {
+      p_next = &SVCCTL_EvtSubscription.SVCCTL_SubscriberTab[*p_next].Next;
+    }
+    *p_next = index;
+    SVCCTL_EvtSubscription.NbreOfSubscriber++;
+    status = BLE_STATUS_SUCCESS;
+  }
+#else
+  (void)(EvtCode);
+  (void)(SubCode);
+  (void)(pfSubscriber);
+  status = BLE_STATUS_INSUFFICIENT_RESOURCES;
+#endif
+
+  return status;
+}
+
+#if (BLE_CFG_EVT_PROFILE != 0)
+/**
+ * @brief  Processing statistics of an event
+ * @param  EvtCode: HCI event code
+ * @param  SubCode: LE meta subevent code or vendor specific event code, ignored for the other events
+ * @param  pProfile: Statistics of the event, cleared when the event is out of the index
+ * @retval None
+ */
+void SVCCTL_EvtProfileGet( uint8_t EvtCode, uint16_t SubCode, SVCCTL_EvtProfile_t *pProfile )
+{
+  uint8_t slot;
+
+  slot = SVCCTL_GetEvtSlot(EvtCode, SubCode);
+  if (slot != SVCCTL_EVT_NO_SLOT)
+  {
+    *pProfile = SVCCTL_EvtProfileTab[slot];
+  }
+  else
+  {
+    pProfile->Count = 0;
+    pProfile->TimeMax = 0;
+    pProfile->TimeTotal = 0;
+  }
+
+  return;
+}
+
+/**
+ * @brief  Clear the processing statistics of all events
+ * @param  None
+ * @retval None
+ */
+void SVCCTL_EvtProfileReset( void )
+{
+  uint8_t index;
+
+  for (index = 0; index < SVCCTL_EVT_SLOT_NBR; index++)
+  {
+    SVCCTL_EvtProfileTab[index].Count = 0;
+    SVCCTL_EvtProfileTab[index].TimeMax = 0;
+    SVCCTL_EvtProfileTab[index].TimeTotal = 0;
+  }
+
+  return;
+}
+#endif
+
 __WEAK SVCCTL_UserEvtFlowStatus_t SVCCTL_UserEvtRx( void *pckt )
 {
   hci_event_pckt *event_pckt;
@@ -235,66 +604,136 @@ __WEAK SVCCTL_UserEvtFlowStatus_t SVCCTL_UserEvtRx( void *pckt )
   SVCCTL_EvtAckStatus_t event_notification_status;
   SVCCTL_UserEvtFlowStatus_t return_status;
   uint8_t index;
+#if (BLE_CFG_SVC_MAX_NBR_CB > 0)
+  SVC_CTL_p_EvtHandler_t p_owner_handler;
+  uint16_t attr_handle;
+#endif
+#if (SVCCTL_EVT_INDEX != 0)
+  void *p_evt;
+  uint16_t sub_code;
+  uint8_t slot;
+#endif
+#if (BLE_CFG_EVT_PROFILE != 0)
+  uint32_t time_start;
+  uint32_t time_elapsed;
+
+  time_start = BLE_CFG_EVT_PROFILE_GET_TIME( );
+#endif
 
   event_pckt = (hci_event_pckt*) ((hci_uart_pckt *) pckt)->data;
   event_notification_status = SVCCTL_EvtNotAck;
 
+#if (SVCCTL_EVT_INDEX != 0)
+  /**
+   * The event is decoded once, the parameters are handed over to the subscribers as the *_event_rp0 structure
+   */
   switch (event_pckt->evt)
   {
+    case HCI_LE_META_EVT_CODE:
+      sub_code = ((evt_le_meta_event*) event_pckt->data)->subevent;
+      p_evt = ((evt_le_meta_event*) event_pckt->data)->data;
+      break;
+
     case HCI_VENDOR_SPECIFIC_DEBUG_EVT_CODE:
-    {
-      blecore_evt = (evt_blecore_aci*) event_pckt->data;
+      sub_code = ((evt_blecore_aci*) event_pckt->data)->ecode;
+      p_evt = ((evt_blecore_aci*) event_pckt->data)->data;
+      break;
+
+    default:
+      sub_code = 0;
+      p_evt = event_pckt->data;
+      break;
+  }
+  slot = SVCCTL_GetEvtSlot(event_pckt->evt, sub_code);
+#endif
+
+#if (BLE_CFG_EVT_MAX_NBR_SUBSCRIBER > 0)
+  /**
+   * An event acknowledged by a subscriber is not reported to the Services, Clients and application
+   */
+  if (slot != SVCCTL_EVT_NO_SLOT)
+  {
+    event_notification_status = SVCCTL_NotifySubscribers(slot, p_evt);
+  }
+#elif (SVCCTL_EVT_INDEX != 0)
+  (void)(p_evt);
+#endif
 
-      switch ((blecore_evt->ecode) & SVCCTL_EGID_EVT_MASK)
+  if (event_notification_status == SVCCTL_EvtNotAck)
+  {
+    switch (event_pckt->evt)
+    {
+      case HCI_VENDOR_SPECIFIC_DEBUG_EVT_CODE:
       {
-        case SVCCTL_GATT_EVT_TYPE:
+        blecore_evt = (evt_blecore_aci*) event_pckt->data;
+
+        switch ((blecore_evt->ecode) & SVCCTL_EGID_EVT_MASK)
+        {
+          case SVCCTL_GATT_EVT_TYPE:
 #if (BLE_CFG_SVC_MAX_NBR_CB > 0)
-          /* For Service event handler */
-          for (index = 0; index < SVCCTL_EvtHandler.NbreOfRegisteredHandler; index++)
-          {
-            event_notification_status = SVCCTL_EvtHandler.SVCCTL__SvcHandlerTab[index](pckt);
             /**
-             * When a GATT event has been acknowledged by a Service, there is no need to call the other registered handlers
-             * a GATT event is relevant for only one Service
+             * An event referring to an attribute in a registered handle range is routed to the owning Service only
              */
-            if (event_notification_status != SVCCTL_EvtNotAck)
+            p_owner_handler = NULL;
+            if (SVCCTL_GetAttrHandle(blecore_evt, &attr_handle) != 0)
             {
-              /**
-               *  The event has been managed. The Event processing should be stopped
-               */
-              break;
+              p_owner_handler = SVCCTL_FindHandleOwner(attr_handle);
+            }
+
+            if (p_owner_handler != NULL)
+            {
+              event_notification_status = p_owner_handler(pckt);
+            }
+            else
+            {
+              /* For Service event handler */
+              for (index = 0; index < SVCCTL_EvtHandler.NbreOfRegisteredHandler; index++)
+              {
+                event_notification_status = SVCCTL_EvtHandler.SVCCTL__SvcHandlerTab[index](pckt);
+                /**
+                 * When a GATT event has been acknowledged by a Service, there is no need to call the other registered handlers
+                 * a GATT event is relevant for only one Service
+                 */
+                if (event_notification_status != SVCCTL_EvtNotAck)
+                {
+                  /**
+                   *  The event has been managed. The Event processing should be stopped
+                   */
+                  break;
+                }
+              }
             }
-          }
 #endif
 #if (BLE_CFG_CLT_MAX_NBR_CB > 0)
-          /* For Client event handler */
-          event_notification_status = SVCCTL_EvtNotAck;
-          for(index = 0; index <SVCCTL_CltHandler.NbreOfRegisteredHandler; index++)
-          {
-            event_notification_status = SVCCTL_CltHandler.SVCCTL_CltHandlerTable[index](pckt);
-            /**
-             * When a GATT event has been acknowledged by a Client, there is no need to call the other registered handlers
-             * a GATT event is relevant for only one Client
-             */
-            if (event_notification_status != SVCCTL_EvtNotAck)
+            /* For Client event handler */
+            event_notification_status = SVCCTL_EvtNotAck;
+            for(index = 0; index <SVCCTL_CltHandler.NbreOfRegisteredHandler; index++)
             {
+              event_notification_status = SVCCTL_CltHandler.SVCCTL_CltHandlerTable[index](pckt);
               /**
-               *  The event has been managed. The Event processing should be stopped
+               * When a GATT event has been acknowledged by a Client, there is no need to call the other registered handlers
+               * a GATT event is relevant for only one Client
                */
-              break;
+              if (event_notification_status != SVCCTL_EvtNotAck)
+              {
+                /**
+                 *  The event has been managed. The Event processing should be stopped
+                 */
+                break;
+              }
             }
-          }
 #endif
-          break;
+            break;
 
-        default:
-          break;
+          default:
+            break;
+        }
       }
-    }
-      break; /* HCI_HCI_VENDOR_SPECIFIC_DEBUG_EVT_CODE_SPECIFIC */
+        break; /* HCI_HCI_VENDOR_SPECIFIC_DEBUG_EVT_CODE_SPECIFIC */
 
-    default:
-      break;
+      default:
+        break;
+    }
   }
 
   /**
@@ -324,6 +763,22 @@ __WEAK SVCCTL_UserEvtFlowStatus_t SVCCTL_UserEvtRx( void *pckt )
       break;
   }
 
+#if (BLE_CFG_EVT_PROFILE != 0)
+  /**
+   * The processing time covers the subscribers, the Services, the Clients and the application
+   */
+  if (slot != SVCCTL_EVT_NO_SLOT)
+  {
+    time_elapsed = BLE_CFG_EVT_PROFILE_GET_TIME( ) - time_start;
+    SVCCTL_EvtProfileTab[slot].Count++;
+    SVCCTL_EvtProfileTab[slot].TimeTotal += time_elapsed;
+    if (time_elapsed > SVCCTL_EvtProfileTab[slot].TimeMax)
+    {
+      SVCCTL_EvtProfileTab[slot].TimeMax = time_elapsed;
+    }
+  }
+#endif
+
   return (return_status);
 }
 
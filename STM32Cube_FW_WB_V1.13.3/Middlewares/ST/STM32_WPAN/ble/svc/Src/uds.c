@@ -240,6 +240,14 @@ void UDS_Init(void){
     BLE_DBG_UDS_MSG ("FAILED to add User Control Point Characteristic: Error: %02X !!\n\r",
                  hciCmdResult);
   }
+
+  /**
+   *  Route the events of the service attributes straight to the event handler
+   *  The last attribute is the client char configuration descriptor of the user control point
+   */
+  SVCCTL_RegisterHandleRange(UDS_Context.SvcHdle,
+                             UDS_Context.UserControlPointCharHdle + 2,
+                             UDS_Event_Handler);
 }
 
 /* Private functions ---------------------------------------------------------*/
@@ -307,17 +315,18 @@ static SVCCTL_EvtAckStatus_t UDS_Event_Handler(void *Event)
             	ucp_value[0] = UDS_UCP_OPCODE_RESPONSE_CODE;
             	ucp_value[1] = op_code;
             	ucp_value[2] = UDS_RESPONSE_VALUE_OP_CODE_NOT_SUPPORTED;
-    			aci_gatt_update_char_value(UDS_Context.SvcHdle,
+    			aci_gatt_update_char_value_async(UDS_Context.SvcHdle,
     						UDS_Context.UserControlPointCharHdle,
     						0, /* charValOffset */
     						3 , /* charValueLen */
-    						ucp_value);
+    						ucp_value, NULL, NULL);
     			return SVCCTL_EvtNotAck;
             }
 
             BLE_DBG_UDS_MSG("ACI_GATT_ATTRIBUTE_MODIFIED_VSEVT_CODE UDS_USER_CONTROL_POINT_EVT(op code=%d)\n\r", op_code);
 
             Notification.UDS_Evt_Opcode = UDS_USER_CONTROL_POINT_EVT;
+            Notification.ConnectionHandle = attribute_modified->Connection_Handle;
             Notification.DataTransfered.Length=attribute_modified->Attr_Data_Length;
             Notification.DataTransfered.pPayload=attribute_modified->Attr_Data;
 
@@ -333,6 +342,7 @@ static SVCCTL_EvtAckStatus_t UDS_Event_Handler(void *Event)
 
         	  BLE_DBG_UDS_MSG("ACI_GATT_ATTRIBUTE_MODIFIED_VSEVT_CODE UDS_INDICATION (%d)\n\r", Notification.UDS_Evt_Opcode);
 
+        	  Notification.ConnectionHandle = attribute_modified->Connection_Handle;
         	  Notification.DataTransfered.Length = 0;
         	  Notification.DataTransfered.pPayload = NULL;
 
@@ -346,14 +356,14 @@ static SVCCTL_EvtAckStatus_t UDS_Event_Handler(void *Event)
         case ACI_GATT_READ_PERMIT_REQ_VSEVT_CODE:
         	attribute_read = (aci_gatt_read_permit_req_event_rp0*)blue_evt->data;
         	if(attribute_read->Attribute_Handle == (UDS_Context.UDS_WeightCharHdle + 1)){
-        		if(UDS_App_AccessPermitted()){
+        		if(UDS_App_AccessPermitted(attribute_read->Connection_Handle)){
         			return_value = SVCCTL_EvtAckFlowEnable;
         			aci_gatt_allow_read(attribute_read->Connection_Handle);
         		} else {
         			aci_gatt_deny_read(attribute_read->Connection_Handle, UDS_ERROR_CODE_UserDataAccessNotPermitted);
         		}
         	} else if(attribute_read->Attribute_Handle == (UDS_Context.UDS_HeightCharHdle + 1)){
-        		if(UDS_App_AccessPermitted()){
+        		if(UDS_App_AccessPermitted(attribute_read->Connection_Handle)){
         			return_value = SVCCTL_EvtAckFlowEnable;
         			aci_gatt_allow_read(attribute_read->Connection_Handle);
         		} else {
@@ -367,7 +377,7 @@ static SVCCTL_EvtAckStatus_t UDS_Event_Handler(void *Event)
 
         	write_perm_req = (aci_gatt_write_permit_req_event_rp0*)blue_evt->data;
         	if(write_perm_req->Attribute_Handle == (UDS_Context.UDS_WeightCharHdle + 1)){
-				if(UDS_App_AccessPermitted()){
+				if(UDS_App_AccessPermitted(write_perm_req->Connection_Handle)){
 					return_value = SVCCTL_EvtAckFlowEnable;
 					aci_gatt_write_resp(write_perm_req->Connection_Handle,
 					                                        write_perm_req->Attribute_Handle,
@@ -384,7 +394,7 @@ static SVCCTL_EvtAckStatus_t UDS_Event_Handler(void *Event)
 					                                        (uint8_t *)&(write_perm_req->Data[0]));
 				}
 			} else if(write_perm_req->Attribute_Handle == (UDS_Context.UDS_HeightCharHdle + 1)){
-				if(UDS_App_AccessPermitted()){
+				if(UDS_App_AccessPermitted(write_perm_req->Connection_Handle)){
 					return_value = SVCCTL_EvtAckFlowEnable;
 					aci_gatt_write_resp(write_perm_req->Connection_Handle,
 					                                        write_perm_req->Attribute_Handle,
@@ -401,7 +411,7 @@ static SVCCTL_EvtAckStatus_t UDS_Event_Handler(void *Event)
 					                                        (uint8_t *)&(write_perm_req->Data[0]));
 				}
 			} else if(write_perm_req->Attribute_Handle == (UDS_Context.DatabaseChangeIncrementCharHdle + 1)){
-				if(UDS_App_AccessPermitted()){
+				if(UDS_App_AccessPermitted(write_perm_req->Connection_Handle)){
 					return_value = SVCCTL_EvtAckFlowEnable;
 					aci_gatt_write_resp(write_perm_req->Connection_Handle,
 					                                        write_perm_req->Attribute_Handle,
@@ -441,11 +451,11 @@ static void Populate_Char_User_Index(uint8_t user_index)
 
   value = user_index;
 
-  aci_gatt_update_char_value(UDS_Context.SvcHdle,
-                             UDS_Context.UserIndexCharHdle,
-                             0, /* charValOffset */
-                             1, /* charValueLen */
-                             &value);
+  aci_gatt_update_char_value_async(UDS_Context.SvcHdle,
+                                   UDS_Context.UserIndexCharHdle,
+                                   0, /* charValOffset */
+                                   1, /* charValueLen */
+                                   &value, NULL, NULL);
 }/* end Update_Char_Feature() */
 
 
@@ -455,11 +465,11 @@ static void Populate_Char_Height(uint16_t height)
 
   STORE_LE_16(value, height);
 
-  aci_gatt_update_char_value(UDS_Context.SvcHdle,
-                             UDS_Context.UDS_HeightCharHdle,
-                             0, /* charValOffset */
-                             2, /* charValueLen */
-                             value);
+  aci_gatt_update_char_value_async(UDS_Context.SvcHdle,
+                                   UDS_Context.UDS_HeightCharHdle,
+                                   0, /* charValOffset */
+                                   2, /* charValueLen */
+                                   value, NULL, NULL);
 }/* end Update_Char_Feature() */
 
 
@@ -469,11 +479,11 @@ static void Populate_Char_Weight(uint16_t weight)
 
   STORE_LE_16(value, weight);
 
-  aci_gatt_update_char_value(UDS_Context.SvcHdle,
-                             UDS_Context.UDS_WeightCharHdle,
-                             0, /* charValOffset */
-                             2, /* charValueLen */
-                             value);
+  aci_gatt_update_char_value_async(UDS_Context.SvcHdle,
+                                   UDS_Context.UDS_WeightCharHdle,
+                                   0, /* charValOffset */
+                                   2, /* charValueLen */
+                                   value, NULL, NULL);
 }/* end Update_Char_Feature() */
 
 
@@ -505,10 +515,10 @@ static void UDS_UserControlPoint_Message(UDC_ProcedureComplete_t *msg){
 	BLE_DBG_UDS_MSG("\n\r");
 #endif
 
-	aci_gatt_update_char_value(UDS_Context.SvcHdle,
+	aci_gatt_update_char_value_async(UDS_Context.SvcHdle,
 			UDS_Context.UserControlPointCharHdle,
 			0, /* charValOffset */
 			msg->ResponseParameterLength + 3 , /* charValueLen */
-			(uint8_t *)  &ucp_value[0]);
+			(uint8_t *)  &ucp_value[0], NULL, NULL);
 }
 
@@ -31,32 +31,95 @@
  * || GATT Characteristic and Object Type | 0x2A9E         | Weight Scale Feature  ||
  */
 
+/* Vendor specific 128-bit UUIDs */
+/*
+ * 5A3C0001-7B2E-4F1D-9C84-2D61E0B7A9F3: Weight History Data
+ * 5A3C0002-7B2E-4F1D-9C84-2D61E0B7A9F3: Weight History Control Point
+ */
+
 
 /* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  uint8_t Value[WSS_MEASUREMENT_MAX_LENGTH];  /**< Weight Measurement as sent over the air */
+  uint8_t Length;
+  uint8_t FieldOffset[WSS_FIELD_NBR];         /**< Position of each field, computed when the flags change */
+} WSS_MeasurementBuffer_t;
+
+typedef struct {
+  uint8_t Flag;                               /**< Flag telling the field is present, 0 when always present */
+  uint8_t Size;
+} WSS_FieldLayout_t;
+
 typedef struct {
   uint16_t SvcHdle;                     /**< Service handle, Weight Scale Service */
   /* Mandatory Service Characteristics */
   uint16_t FeatureCharHdle;             /**< Service Characteristic handle, Weight Scale Feature */
   uint16_t MeasurementCharHdle;         /**< Service Characteristic handle, Weight Measurement */
   /* No optional Service Characteristics */
+  uint16_t LinkConnHdle[BLE_CFG_WSS_MAX_NBR_LINK]; /**< Collectors with the Weight Measurement indication enabled, 0xFFFF when free */
+  uint8_t IndicationPending;            /**< Collectors (one bit per link) whose confirmation of the Weight Measurement is outstanding */
+  uint8_t IndicationConfirmed;          /**< The outstanding Weight Measurement has been confirmed by at least one collector */
+  WSS_MeasurementBuffer_t Measurement;  /**< Weight Measurement wire buffer */
+#if (BLE_CFG_WSS_HISTORY != 0)
+  uint16_t HistoryDataCharHdle;         /**< Vendor Characteristic handle, Weight History Data */
+  uint16_t HistoryControlPointCharHdle; /**< Vendor Characteristic handle, Weight History Control Point */
+  uint16_t HistoryLinkConnHdle[BLE_CFG_WSS_MAX_NBR_LINK]; /**< Clients with the Weight History Data notification enabled */
+#endif
 } WSS_Context_t;
 
 
 /* Private defines -----------------------------------------------------------*/
+#define WSS_FIELD_NOT_PRESENT    (0xFF)
+#define WSS_LINK_FREE            (0xFFFF)
 /* Private macros ------------------------------------------------------------*/
 /* Store Value into a buffer in Little Endian Format */
 #define STORE_LE_16(buf, val)    ( ((buf)[0] =  (uint8_t) (val)    ) , \
                                    ((buf)[1] =  (uint8_t) (val>>8) ) )
+#define STORE_LE_32(buf, val)    ( ((buf)[0] =  (uint8_t) (val)     ) , \
+                                   ((buf)[1] =  (uint8_t) (val>>8)  ) , \
+                                   ((buf)[2] =  (uint8_t) (val>>16) ) , \
+                                   ((buf)[3] =  (uint8_t) (val>>24) ) )
+#define LOAD_LE_16(buf)          ( (uint16_t)((buf)[0]) | ((uint16_t)((buf)[1]) << 8) )
+
+#define COPY_UUID_128(uuid_struct, uuid_15, uuid_14, uuid_13, uuid_12, uuid_11, uuid_10, uuid_9, uuid_8, uuid_7, uuid_6, uuid_5, uuid_4, uuid_3, uuid_2, uuid_1, uuid_0) \
+do {\
+    uuid_struct[0] = uuid_0; uuid_struct[1] = uuid_1; uuid_struct[2] = uuid_2; uuid_struct[3] = uuid_3; \
+        uuid_struct[4] = uuid_4; uuid_struct[5] = uuid_5; uuid_struct[6] = uuid_6; uuid_struct[7] = uuid_7; \
+            uuid_struct[8] = uuid_8; uuid_struct[9] = uuid_9; uuid_struct[10] = uuid_10; uuid_struct[11] = uuid_11; \
+                uuid_struct[12] = uuid_12; uuid_struct[13] = uuid_13; uuid_struct[14] = uuid_14; uuid_struct[15] = uuid_15; \
+}while(0)
+
+#define COPY_WSS_HISTORY_DATA_UUID(uuid_struct)           COPY_UUID_128(uuid_struct,0x5a,0x3c,0x00,0x01,0x7b,0x2e,0x4f,0x1d,0x9c,0x84,0x2d,0x61,0xe0,0xb7,0xa9,0xf3)
+#define COPY_WSS_HISTORY_CONTROL_POINT_UUID(uuid_struct)  COPY_UUID_128(uuid_struct,0x5a,0x3c,0x00,0x02,0x7b,0x2e,0x4f,0x1d,0x9c,0x84,0x2d,0x61,0xe0,0xb7,0xa9,0xf3)
 
 
 /* Private variables ---------------------------------------------------------*/
 static WSS_Context_t WSS_Context;
 
+/**
+ * Weight Measurement fields in the order they are sent, after the Flags octet
+ */
+static const WSS_FieldLayout_t WSS_FieldLayout[WSS_FIELD_NBR] =
+{
+  { 0,                                 2 },  /* Weight */
+  { WSS_FLAGS_TIME_STAMP_PRESENT,      7 },  /* Time Stamp */
+  { WSS_FLAGS_USER_ID_PRESENT,         1 },  /* User ID */
+  { WSS_FLAGS_BMI_AND_HEIGHT_PRESENT,  2 },  /* BMI */
+  { WSS_FLAGS_BMI_AND_HEIGHT_PRESENT,  2 }   /* Height */
+};
+
 
 /* Private function prototypes -----------------------------------------------*/
 static SVCCTL_EvtAckStatus_t WSS_Event_Handler(void *pckt);
-static void Update_Char_WeightScaleMeasurement(WSS_MeasurementValue_t *pMeasurement);
+static tBleStatus Update_Char_WeightScaleMeasurement(WSS_MeasurementValue_t *pMeasurement);
 static void Update_Char_Feature(WSS_FeatureValue_t *pFeatureValue);
+static uint8_t WSS_Link_Find(uint16_t ConnectionHandle);
+static void WSS_Link_Release(uint8_t Link);
+#if (BLE_CFG_WSS_HISTORY != 0)
+static void WSS_History_Init(void);
+static uint8_t WSS_History_Link_Find(uint16_t ConnectionHandle);
+static uint8_t WSS_History_ControlPoint(aci_gatt_write_permit_req_event_rp0 *pWritePermitReq, WSS_App_Notification_evt_t *pNotification);
+#endif
 
 /* Public functions ----------------------------------------------------------*/
 
@@ -68,12 +131,22 @@ static void Update_Char_Feature(WSS_FeatureValue_t *pFeatureValue);
 void WSS_Init(void){
   tBleStatus hciCmdResult = BLE_STATUS_FAILED;
   uint16_t uuid;
+  uint8_t index;
+  uint16_t last_handle;
 
   /**
    *  Register the event handler to the BLE controller
    */
   SVCCTL_RegisterSvcHandler(WSS_Event_Handler);
 
+  for(index = 0; index < BLE_CFG_WSS_MAX_NBR_LINK; index++)
+  {
+    WSS_Context.LinkConnHdle[index] = WSS_LINK_FREE;
+  }
+  WSS_Context.IndicationPending = 0;
+  WSS_Context.IndicationConfirmed = 0;
+  WSS_Measurement_SetFlags(WSS_NO_FLAGS);
+
   /**
    *  Add Weight Scale Service
    *
@@ -82,13 +155,19 @@ void WSS_Init(void){
    *                                2 for weight scale feature characteristic +
    *                                2 for weight scale measurement characteristic +
    *                                1 for client char configuration descriptor +
-   *                                
+   *                                2 for weight history data characteristic +
+   *                                1 for client char configuration descriptor +
+   *                                2 for weight history control point characteristic
    */
   uuid = WEIGHT_SCALE_SERVICE_UUID;
   hciCmdResult = aci_gatt_add_service(UUID_TYPE_16,
                     (Service_UUID_t *) &uuid,
                     PRIMARY_SERVICE,
+#if (BLE_CFG_WSS_HISTORY != 0)
+                    6 + 5,
+#else
                     6,
+#endif
                     &(WSS_Context.SvcHdle));
 
    if (hciCmdResult == BLE_STATUS_SUCCESS)
@@ -158,12 +237,28 @@ void WSS_Init(void){
     BLE_DBG_WSS_MSG ("FAILED to add Weight Scale Measurement Characteristic: Error: %02X !!\n\r",
                  hciCmdResult);
   }
+
+  /**
+   *  Route the events of the service attributes straight to the event handler
+   *  The last attribute is the client char configuration descriptor of the measurement,
+   *  or the value of the weight history control point
+   */
+  last_handle = WSS_Context.MeasurementCharHdle + 2;
+#if (BLE_CFG_WSS_HISTORY != 0)
+  WSS_History_Init();
+  last_handle = WSS_Context.HistoryControlPointCharHdle + 1;
+#endif
+  SVCCTL_RegisterHandleRange(WSS_Context.SvcHdle,
+                             last_handle,
+                             WSS_Event_Handler);
 }
 
-void WSS_Update_Char(uint16_t UUID, uint8_t *pPayload){
+tBleStatus WSS_Update_Char(uint16_t UUID, uint8_t *pPayload){
+  tBleStatus return_value = BLE_STATUS_SUCCESS;
+
   switch (UUID){
   case WEIGHT_SCALE_MEASUREMENT_CHAR_UUID:
-    Update_Char_WeightScaleMeasurement((WSS_MeasurementValue_t*)pPayload);
+    return_value = Update_Char_WeightScaleMeasurement((WSS_MeasurementValue_t*)pPayload);
     break;
   case WEIGHT_SCALE_FEATURE_CHAR_UUID:
     Update_Char_Feature((WSS_FeatureValue_t*)pPayload);
@@ -172,10 +267,343 @@ void WSS_Update_Char(uint16_t UUID, uint8_t *pPayload){
     /* do nothing */
     break;
   }
+
+  return return_value;
+}
+
+/**
+ * @brief  Lay out the Weight Measurement wire buffer for a set of flags
+ *         The fields absent with these flags are ignored by the setters
+ * @param  Flags: Weight Measurement flags
+ * @retval None
+ */
+void WSS_Measurement_SetFlags(uint8_t Flags){
+  WSS_MeasurementBuffer_t *p_measurement = &WSS_Context.Measurement;
+  uint8_t length = 1;
+  uint8_t field;
+
+  p_measurement->Value[0] = Flags;
+
+  for(field = 0; field < WSS_FIELD_NBR; field++){
+    if((WSS_FieldLayout[field].Flag == 0) || (Flags & WSS_FieldLayout[field].Flag)){
+      p_measurement->FieldOffset[field] = length;
+      length += WSS_FieldLayout[field].Size;
+    }
+    else{
+      p_measurement->FieldOffset[field] = WSS_FIELD_NOT_PRESENT;
+    }
+  }
+
+  p_measurement->Length = length;
+}
+
+/**
+ * @brief  Write a 2 octets field in the Weight Measurement wire buffer
+ * @param  Field: WSS_FIELD_WEIGHT, WSS_FIELD_BMI or WSS_FIELD_HEIGHT
+ * @param  Value: Field value
+ * @retval None
+ */
+void WSS_Measurement_SetField(WSS_MeasurementField_t Field, uint16_t Value){
+  uint8_t offset = WSS_Context.Measurement.FieldOffset[Field];
+
+  if((offset != WSS_FIELD_NOT_PRESENT) && (WSS_FieldLayout[Field].Size == 2)){
+    STORE_LE_16(WSS_Context.Measurement.Value + offset, Value);
+  }
+}
+
+void WSS_Measurement_SetUserID(uint8_t UserID){
+  uint8_t offset = WSS_Context.Measurement.FieldOffset[WSS_FIELD_USER_ID];
+
+  if(offset != WSS_FIELD_NOT_PRESENT){
+    WSS_Context.Measurement.Value[offset] = UserID;
+  }
 }
 
+void WSS_Measurement_SetTimeStamp(WSS_TimeStamp_t *pTimeStamp){
+  uint8_t offset = WSS_Context.Measurement.FieldOffset[WSS_FIELD_TIME_STAMP];
+  uint8_t *p_value;
+
+  if(offset != WSS_FIELD_NOT_PRESENT){
+    p_value = WSS_Context.Measurement.Value + offset;
+    STORE_LE_16(p_value, pTimeStamp->Year);
+    p_value[2] = pTimeStamp->Month;
+    p_value[3] = pTimeStamp->Day;
+    p_value[4] = pTimeStamp->Hours;
+    p_value[5] = pTimeStamp->Minutes;
+    p_value[6] = pTimeStamp->Seconds;
+  }
+}
+
+/**
+ * @brief  Indicate the Weight Measurement wire buffer as it is
+ * @param  None
+ * @retval BLE_STATUS_SUCCESS when the indication has been sent
+ */
+tBleStatus WSS_Measurement_Send(void){
+  tBleStatus return_value;
+  uint8_t *p_value;
+  uint8_t index;
+
+  /**
+   * The wire buffer is encoded straight into the command packet shared with the CPU2
+   */
+  p_value = aci_gatt_update_char_value_reserve(WSS_Context.SvcHdle,
+                                               WSS_Context.MeasurementCharHdle,
+                                               0,                                /* charValOffset */
+                                               WSS_Context.Measurement.Length);  /* charValLength */
+  Osal_MemCpy(p_value, WSS_Context.Measurement.Value, WSS_Context.Measurement.Length);
+  return_value = aci_gatt_update_char_value_commit();
+  if(return_value == BLE_STATUS_SUCCESS)
+  {
+    /**
+     * The indication is sent to every collector which has enabled it,
+     * each of them confirms it on its own link
+     */
+    WSS_Context.IndicationPending = 0;
+    WSS_Context.IndicationConfirmed = 0;
+    for(index = 0; index < BLE_CFG_WSS_MAX_NBR_LINK; index++)
+    {
+      if(WSS_Context.LinkConnHdle[index] != WSS_LINK_FREE)
+      {
+        WSS_Context.IndicationPending |= (1 << index);
+      }
+    }
+  }
+
+  return return_value;
+}
+
+/**
+ * @brief  Drop the state kept for a collector once its link is closed
+ * @param  ConnectionHandle: Handle of the closed connection
+ * @retval None
+ */
+void WSS_Disconnection(uint16_t ConnectionHandle){
+  uint8_t link;
+
+  link = WSS_Link_Find(ConnectionHandle);
+  if(link < BLE_CFG_WSS_MAX_NBR_LINK)
+  {
+    WSS_Link_Release(link);
+  }
+
+#if (BLE_CFG_WSS_HISTORY != 0)
+  link = WSS_History_Link_Find(ConnectionHandle);
+  if(link < BLE_CFG_WSS_MAX_NBR_LINK)
+  {
+    WSS_Context.HistoryLinkConnHdle[link] = WSS_LINK_FREE;
+  }
+#endif
+
+  return;
+}
+
+
+#if (BLE_CFG_WSS_HISTORY != 0)
+/**
+ * @brief  Encode a measurement as a Weight History record
+ * @param  pRecord: WSS_HISTORY_RECORD_LENGTH octets written
+ * @param  pMeasurement: Measurement, the User ID field holds the user of the measurement
+ * @param  Epoch: Time stamp of the measurement in seconds since 1970, 0 when unknown
+ * @retval None
+ */
+void WSS_History_SetRecord(uint8_t *pRecord, const WSS_MeasurementValue_t *pMeasurement, uint32_t Epoch){
+  uint8_t flags = pMeasurement->Flags;
+
+  pRecord[0] = pMeasurement->UserID;
+  pRecord[1] = flags;
+  STORE_LE_16(pRecord + 2, pMeasurement->Weight);
+  if((flags & WSS_FLAGS_TIME_STAMP_PRESENT) == 0)
+  {
+    Epoch = 0;
+  }
+  STORE_LE_32(pRecord + 4, Epoch);
+  if(flags & WSS_FLAGS_BMI_AND_HEIGHT_PRESENT)
+  {
+    STORE_LE_16(pRecord + 8, pMeasurement->BMI);
+    STORE_LE_16(pRecord + 10, pMeasurement->Height);
+  }
+  else
+  {
+    STORE_LE_16(pRecord + 8, 0);
+    STORE_LE_16(pRecord + 10, 0);
+  }
+}
+
+/**
+ * @brief  Prepare a Weight History Data notification to one client
+ *         The frame is written straight into the command packet shared with the CPU2,
+ *         no other command shall be sent before WSS_History_Send()
+ * @param  ConnectionHandle: Handle of the connection of the client
+ * @param  Length: Length of the frame, up to the ATT_MTU of the link less 3 octets
+ * @retval Address where the Length octets of the frame are written
+ */
+uint8_t* WSS_History_Reserve(uint16_t ConnectionHandle, uint8_t Length){
+  return aci_gatt_update_char_value_ext_reserve(ConnectionHandle,
+                                                WSS_Context.SvcHdle,
+                                                WSS_Context.HistoryDataCharHdle,
+                                                0x01,        /* Update_Type: notification */
+                                                Length,      /* Char_Length */
+                                                0,           /* Value_Offset */
+                                                Length);     /* Value_Length */
+}
+
+/**
+ * @brief  Send the notification prepared with WSS_History_Reserve()
+ * @param  None
+ * @retval BLE_STATUS_INSUFFICIENT_RESOURCES when the notification buffers are full,
+ *         the frame shall be sent again after the ACI_GATT_TX_POOL_AVAILABLE event
+ */
+tBleStatus WSS_History_Send(void){
+  return aci_gatt_update_char_value_ext_commit();
+}
+#endif /* BLE_CFG_WSS_HISTORY */
 
 /* Private functions ---------------------------------------------------------*/
+#if (BLE_CFG_WSS_HISTORY != 0)
+/**
+ * @brief  Add the vendor specific Weight History characteristics
+ * @param  None
+ * @retval None
+ */
+static void WSS_History_Init(void)
+{
+  tBleStatus hciCmdResult;
+  Char_UUID_t uuid128;
+  uint8_t index;
+
+  for(index = 0; index < BLE_CFG_WSS_MAX_NBR_LINK; index++)
+  {
+    WSS_Context.HistoryLinkConnHdle[index] = WSS_LINK_FREE;
+  }
+
+  /**
+   *  Add Weight History Data Characteristic
+   */
+  COPY_WSS_HISTORY_DATA_UUID(uuid128.Char_UUID_128);
+  hciCmdResult = aci_gatt_add_char(WSS_Context.SvcHdle,
+                    UUID_TYPE_128,
+                    &uuid128,
+                    BLE_CFG_WSS_HISTORY_DATA_MAX_LENGTH,
+                    CHAR_PROP_NOTIFY,
+                    ATTR_PERMISSION_NONE,
+                    GATT_DONT_NOTIFY_EVENTS, /* gattEvtMask */
+                    10, /* encryKeySize */
+                    1, /* isVariable: 1 */
+                    &(WSS_Context.HistoryDataCharHdle));
+
+  if (hciCmdResult == BLE_STATUS_SUCCESS)
+  {
+    BLE_DBG_WSS_MSG ("Weight History Data Characteristic Added Successfully %04X\n\r",
+                 WSS_Context.HistoryDataCharHdle);
+  }
+  else
+  {
+    BLE_DBG_WSS_MSG ("FAILED to add Weight History Data Characteristic: Error: %02X !!\n\r",
+                 hciCmdResult);
+  }
+
+  /**
+   *  Add Weight History Control Point Characteristic
+   */
+  COPY_WSS_HISTORY_CONTROL_POINT_UUID(uuid128.Char_UUID_128);
+  hciCmdResult = aci_gatt_add_char(WSS_Context.SvcHdle,
+                    UUID_TYPE_128,
+                    &uuid128,
+                    1                                         /** Op Code, 1 octet */
+                   +2,                                        /** Sequence number, 2 octets */
+                    CHAR_PROP_WRITE,
+                    ATTR_PERMISSION_NONE,
+                    GATT_NOTIFY_WRITE_REQ_AND_WAIT_FOR_APPL_RESP, /* gattEvtMask */
+                    10, /* encryKeySize */
+                    1, /* isVariable: 1 */
+                    &(WSS_Context.HistoryControlPointCharHdle));
+
+  if (hciCmdResult == BLE_STATUS_SUCCESS)
+  {
+    BLE_DBG_WSS_MSG ("Weight History Control Point Characteristic Added Successfully %04X\n\r",
+                 WSS_Context.HistoryControlPointCharHdle);
+  }
+  else
+  {
+    BLE_DBG_WSS_MSG ("FAILED to add Weight History Control Point Characteristic: Error: %02X !!\n\r",
+                 hciCmdResult);
+  }
+}
+
+/**
+ * @brief  Look for the slot of a client of the Weight History Data
+ * @param  ConnectionHandle: Handle of the connection, WSS_LINK_FREE to get a free slot
+ * @retval Slot index, BLE_CFG_WSS_MAX_NBR_LINK when not found
+ */
+static uint8_t WSS_History_Link_Find(uint16_t ConnectionHandle)
+{
+  uint8_t index;
+
+  for(index = 0; index < BLE_CFG_WSS_MAX_NBR_LINK; index++)
+  {
+    if(WSS_Context.HistoryLinkConnHdle[index] == ConnectionHandle)
+    {
+      break;
+    }
+  }
+
+  return index;
+}/* end WSS_History_Link_Find */
+
+/**
+ * @brief  Check a write of the Weight History Control Point
+ *         The requests are carried out by the application, which reports their outcome
+ *         in a status frame of the Weight History Data
+ * @param  pWritePermitReq: Write request
+ * @param  pNotification: Updated with the request
+ * @retval Error code of the write response, 0 when the request is accepted
+ */
+static uint8_t WSS_History_ControlPoint(aci_gatt_write_permit_req_event_rp0 *pWritePermitReq, WSS_App_Notification_evt_t *pNotification)
+{
+  uint8_t op_code;
+
+  if(WSS_History_Link_Find(pWritePermitReq->Connection_Handle) == BLE_CFG_WSS_MAX_NBR_LINK)
+  {
+    return WSS_ERR_CODE_CCCD_IMPROPERLY_CONFIGURED;
+  }
+
+  if(pWritePermitReq->Data_Length == 0)
+  {
+    return WSS_ERR_CODE_OPCODE_NOT_SUPPORTED;
+  }
+
+  op_code = pWritePermitReq->Data[0];
+  switch(op_code)
+  {
+    case WSS_HISTORY_OPCODE_START:
+    case WSS_HISTORY_OPCODE_ABORT:
+      if(pWritePermitReq->Data_Length != 1)
+      {
+        return WSS_ERR_CODE_OPCODE_NOT_SUPPORTED;
+      }
+      pNotification->HistorySequence = 0;
+      break;
+
+    case WSS_HISTORY_OPCODE_RESUME:
+    case WSS_HISTORY_OPCODE_ACK:
+      if(pWritePermitReq->Data_Length != 3)
+      {
+        return WSS_ERR_CODE_OPCODE_NOT_SUPPORTED;
+      }
+      pNotification->HistorySequence = LOAD_LE_16(pWritePermitReq->Data + 1);
+      break;
+
+    default:
+      return WSS_ERR_CODE_OPCODE_NOT_SUPPORTED;
+  }
+
+  pNotification->HistoryOpCode = op_code;
+
+  return 0;
+}/* end WSS_History_ControlPoint */
+#endif /* BLE_CFG_WSS_HISTORY */
+
 /**
  * @brief  Event handler
  * @param  Event: Address of the buffer holding the Event
@@ -187,7 +615,13 @@ static SVCCTL_EvtAckStatus_t WSS_Event_Handler(void *Event)
   hci_event_pckt *event_pckt;
   evt_blue_aci *blue_evt;
   aci_gatt_attribute_modified_event_rp0    * attribute_modified;
+  aci_gatt_server_confirmation_event_rp0   * server_confirmation;
+#if (BLE_CFG_WSS_HISTORY != 0)
+  aci_gatt_write_permit_req_event_rp0      * write_permit_req;
+  uint8_t error_code;
+#endif
   WSS_App_Notification_evt_t Notification;
+  uint8_t link;
 
   return_value = SVCCTL_EvtNotAck;
   event_pckt = (hci_event_pckt *)(((hci_uart_pckt*)Event)->data);
@@ -205,11 +639,21 @@ static SVCCTL_EvtAckStatus_t WSS_Event_Handler(void *Event)
           if(attribute_modified->Attr_Handle == (WSS_Context.MeasurementCharHdle + 2))
           {
             return_value = SVCCTL_EvtAckFlowEnable;
+            Notification.ConnectionHandle = attribute_modified->Connection_Handle;
+            link = WSS_Link_Find(attribute_modified->Connection_Handle);
             /**
              * Notify to application to start measurement
              */
             if(attribute_modified->Attr_Data[0] & COMSVC_Indication)
             {
+              if(link == BLE_CFG_WSS_MAX_NBR_LINK)
+              {
+                link = WSS_Link_Find(WSS_LINK_FREE);
+                if(link < BLE_CFG_WSS_MAX_NBR_LINK)
+                {
+                  WSS_Context.LinkConnHdle[link] = attribute_modified->Connection_Handle;
+                }
+              }
               Notification.WSS_Evt_Opcode = WSS_MEASUREMENT_IND_ENABLED_EVT;
               WSS_App_Notification(&Notification);
             }
@@ -217,6 +661,89 @@ static SVCCTL_EvtAckStatus_t WSS_Event_Handler(void *Event)
             {
               Notification.WSS_Evt_Opcode = WSS_MEASUREMENT_IND_DISABLED_EVT;
               WSS_App_Notification(&Notification);
+              if(link < BLE_CFG_WSS_MAX_NBR_LINK)
+              {
+                WSS_Link_Release(link);
+              }
+            }
+          }
+#if (BLE_CFG_WSS_HISTORY != 0)
+          else if(attribute_modified->Attr_Handle == (WSS_Context.HistoryDataCharHdle + 2))
+          {
+            return_value = SVCCTL_EvtAckFlowEnable;
+            Notification.ConnectionHandle = attribute_modified->Connection_Handle;
+            link = WSS_History_Link_Find(attribute_modified->Connection_Handle);
+            if(attribute_modified->Attr_Data[0] & COMSVC_Notification)
+            {
+              if(link == BLE_CFG_WSS_MAX_NBR_LINK)
+              {
+                link = WSS_History_Link_Find(WSS_LINK_FREE);
+                if(link < BLE_CFG_WSS_MAX_NBR_LINK)
+                {
+                  WSS_Context.HistoryLinkConnHdle[link] = attribute_modified->Connection_Handle;
+                }
+              }
+              Notification.WSS_Evt_Opcode = WSS_HISTORY_NOTIF_ENABLED_EVT;
+            }
+            else
+            {
+              if(link < BLE_CFG_WSS_MAX_NBR_LINK)
+              {
+                WSS_Context.HistoryLinkConnHdle[link] = WSS_LINK_FREE;
+              }
+              Notification.WSS_Evt_Opcode = WSS_HISTORY_NOTIF_DISABLED_EVT;
+            }
+            WSS_App_Notification(&Notification);
+          }
+#endif
+        }
+        break;
+
+#if (BLE_CFG_WSS_HISTORY != 0)
+        case ACI_GATT_WRITE_PERMIT_REQ_VSEVT_CODE:
+        {
+          write_permit_req = (aci_gatt_write_permit_req_event_rp0*)blue_evt->data;
+          if(write_permit_req->Attribute_Handle == (WSS_Context.HistoryControlPointCharHdle + 1))
+          {
+            return_value = SVCCTL_EvtAckFlowEnable;
+            error_code = WSS_History_ControlPoint(write_permit_req, &Notification);
+            aci_gatt_write_resp(write_permit_req->Connection_Handle,
+                                write_permit_req->Attribute_Handle,
+                                (error_code != 0), /* write_status */
+                                error_code,        /* err_code */
+                                write_permit_req->Data_Length,
+                                (uint8_t *)&(write_permit_req->Data[0]));
+            if(error_code == 0)
+            {
+              Notification.ConnectionHandle = write_permit_req->Connection_Handle;
+              Notification.WSS_Evt_Opcode = WSS_HISTORY_CONTROL_POINT_EVT;
+              WSS_App_Notification(&Notification);
+            }
+          }
+        }
+        break;
+#endif
+
+        case EVT_BLUE_GATT_SERVER_CONFIRMATION_EVENT:
+        {
+          /**
+           * Only one indication may be outstanding per link, the confirmation belongs to
+           * the Weight Measurement when this service is waiting for it on that link
+           * The application is notified once every collector has confirmed it
+           */
+          server_confirmation = (aci_gatt_server_confirmation_event_rp0*)blue_evt->data;
+          link = WSS_Link_Find(server_confirmation->Connection_Handle);
+          if((link < BLE_CFG_WSS_MAX_NBR_LINK) && (WSS_Context.IndicationPending & (1 << link)))
+          {
+            return_value = SVCCTL_EvtAckFlowEnable;
+            WSS_Context.IndicationPending &= ~(1 << link);
+            WSS_Context.IndicationConfirmed = 1;
+
+            if(WSS_Context.IndicationPending == 0)
+            {
+              Notification.ConnectionHandle = server_confirmation->Connection_Handle;
+              Notification.WSS_Evt_Opcode = WSS_MEASUREMENT_IND_CONFIRMED_EVT;
+              WSS_App_Notification(&Notification);
             }
           }
         }
@@ -235,70 +762,74 @@ static SVCCTL_EvtAckStatus_t WSS_Event_Handler(void *Event)
   return(return_value);
 }/* end WSS_Event_Handler */
 
+/**
+ * @brief  Look for the link slot of a collector
+ * @param  ConnectionHandle: Handle of the connection, WSS_LINK_FREE to get a free slot
+ * @retval Slot index, BLE_CFG_WSS_MAX_NBR_LINK when not found
+ */
+static uint8_t WSS_Link_Find(uint16_t ConnectionHandle)
+{
+  uint8_t index;
+
+  for(index = 0; index < BLE_CFG_WSS_MAX_NBR_LINK; index++)
+  {
+    if(WSS_Context.LinkConnHdle[index] == ConnectionHandle)
+    {
+      break;
+    }
+  }
+
+  return index;
+}/* end WSS_Link_Find */
+
+/**
+ * @brief  Free the slot of a collector which no longer receives the indication
+ *         Its confirmation is not waited for anymore, the application is notified
+ *         when it was the last one and another collector has already confirmed
+ * @param  Link: Slot index
+ * @retval None
+ */
+static void WSS_Link_Release(uint8_t Link)
+{
+  WSS_App_Notification_evt_t Notification;
+
+  Notification.ConnectionHandle = WSS_Context.LinkConnHdle[Link];
+  WSS_Context.LinkConnHdle[Link] = WSS_LINK_FREE;
+
+  if(WSS_Context.IndicationPending & (1 << Link))
+  {
+    WSS_Context.IndicationPending &= ~(1 << Link);
+    if((WSS_Context.IndicationPending == 0) && (WSS_Context.IndicationConfirmed != 0))
+    {
+      Notification.WSS_Evt_Opcode = WSS_MEASUREMENT_IND_CONFIRMED_EVT;
+      WSS_App_Notification(&Notification);
+    }
+  }
+
+  return;
+}/* end WSS_Link_Release */
+
 /**
  * @brief  Weight Scale Measurement Characteristic update
  * @param  Service_Instance: Instance of the service to which the characteristic belongs
  * @param  pMeasurement: The address of the new value to be written
- * @retval None
+ * @retval BLE_STATUS_SUCCESS when the indication has been sent
  */
-static void Update_Char_WeightScaleMeasurement(WSS_MeasurementValue_t *pMeasurement){
-  uint8_t wsm_value [
-                     1 +  /* Flags */
-                     2 +  /* Weight */
-                     7 +  /* Time Stamp */
-                     1 +  /* User ID */
-                     2 +  /* BMI */
-                     2 +  /* Height */
-                     0    /* The last one which means nothing */
-                    ];
-  uint8_t length = 0;
-  
-  /*
-   * Flags update
-   */
-  wsm_value[length++] = pMeasurement->Flags;
-  
-  /*
-   * Weight
-   */
-  STORE_LE_16(wsm_value + length, pMeasurement->Weight);
-  length += 2;
-  
-  /*
-   * Time Stamp
-   */
-  if (pMeasurement->Flags & WSS_FLAGS_TIME_STAMP_PRESENT){
-    STORE_LE_16(wsm_value + length, pMeasurement->TimeStamp.Year);
-    length += 2;
-    wsm_value[length++] = pMeasurement->TimeStamp.Month;
-    wsm_value[length++] = pMeasurement->TimeStamp.Day;
-    wsm_value[length++] = pMeasurement->TimeStamp.Hours;
-    wsm_value[length++] = pMeasurement->TimeStamp.Minutes;
-    wsm_value[length++] = pMeasurement->TimeStamp.Seconds;
-  }
-  
+static tBleStatus Update_Char_WeightScaleMeasurement(WSS_MeasurementValue_t *pMeasurement){
   /*
-   * User ID
+   * Flags update, the layout is only computed again when they change
    */
-  if (pMeasurement->Flags & WSS_FLAGS_USER_ID_PRESENT){
-    wsm_value[length++] = pMeasurement->UserID;
+  if(pMeasurement->Flags != WSS_Context.Measurement.Value[0]){
+    WSS_Measurement_SetFlags(pMeasurement->Flags);
   }
-  
-  /*
-   * BMI & Weight Pair
-   */
-  if (pMeasurement->Flags & WSS_FLAGS_BMI_AND_HEIGHT_PRESENT){
-    STORE_LE_16(wsm_value + length, pMeasurement->BMI);
-    length += 2;
-    STORE_LE_16(wsm_value + length, pMeasurement->Height);
-    length += 2;
-  }
-  
-  aci_gatt_update_char_value(WSS_Context.SvcHdle,
-                             WSS_Context.MeasurementCharHdle,
-                             0,               /* charValOffset */
-                             length,          /* charValLength */
-                             wsm_value);
+
+  WSS_Measurement_SetField(WSS_FIELD_WEIGHT, pMeasurement->Weight);
+  WSS_Measurement_SetTimeStamp(&pMeasurement->TimeStamp);
+  WSS_Measurement_SetUserID(pMeasurement->UserID);
+  WSS_Measurement_SetField(WSS_FIELD_BMI, pMeasurement->BMI);
+  WSS_Measurement_SetField(WSS_FIELD_HEIGHT, pMeasurement->Height);
+
+  return WSS_Measurement_Send();
 }
 
 /**
@@ -318,10 +849,10 @@ static void Update_Char_Feature(WSS_FeatureValue_t *pFeatureValue)
   wsf_value[2] = (uint8_t)(pFeatureValue->Value >> 16);
   wsf_value[3] = (uint8_t)(pFeatureValue->Value >> 24);
   
-  aci_gatt_update_char_value(WSS_Context.SvcHdle,
-                             WSS_Context.FeatureCharHdle,
-                             0, /* charValOffset */
-                             4, /* charValueLen */
-                             (uint8_t *)  &wsf_value[0]);
+  aci_gatt_update_char_value_async(WSS_Context.SvcHdle,
+                                   WSS_Context.FeatureCharHdle,
+                                   0, /* charValOffset */
+                                   4, /* charValueLen */
+                                   (uint8_t *)  &wsf_value[0], NULL, NULL);
 }/* end Update_Char_Feature() */
 
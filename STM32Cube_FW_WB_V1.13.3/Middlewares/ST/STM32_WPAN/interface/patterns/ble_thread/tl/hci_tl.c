@@ -25,6 +25,18 @@
 #include "tl.h"
 #include "hci_tl.h"
 
+/**
+ * Number of commands that may be queued with hci_send_req_async() and maximum parameter length of these commands.
+ * They may be overridden in ble_conf.h which is seen through ble_common.h
+ */
+#ifndef HCI_TL_ASYNC_CMD_NBR
+#define HCI_TL_ASYNC_CMD_NBR            (4)
+#endif
+
+#ifndef HCI_TL_ASYNC_CMD_MAX_PARAM_LEN
+#define HCI_TL_ASYNC_CMD_MAX_PARAM_LEN  (40)
+#endif
+
 /* Private typedef -----------------------------------------------------------*/
 typedef enum
 {
@@ -32,6 +44,22 @@ typedef enum
   HCI_TL_CMD_RESP_WAIT,
 } HCI_TL_CmdRespStatus_t;
 
+typedef enum
+{
+  HCI_TL_ASYNC_CMD_IDLE,      /**< No asynchronous command in flight */
+  HCI_TL_ASYNC_CMD_PENDING,   /**< The head of the queue has been sent, its response is waited */
+  HCI_TL_ASYNC_CMD_NO_CREDIT, /**< The response has been received with numcmd = 0 */
+} HCI_TL_AsyncCmdState_t;
+
+typedef struct
+{
+  hci_cmd_callback_t CallBack;
+  void *pContext;
+  uint16_t Opcode;
+  uint8_t Plen;
+  uint8_t Param[HCI_TL_ASYNC_CMD_MAX_PARAM_LEN];
+} HCI_TL_AsyncCmd_t;
+
 /* Private defines -----------------------------------------------------------*/
 
 /**
@@ -58,11 +86,25 @@ static tListNode HciCmdEventQueue;
 static void (* StatusNotCallBackFunction) (HCI_TL_CmdStatus_t status);
 static volatile HCI_TL_CmdRespStatus_t CmdRspStatusFlag;
 
+/**
+ * Asynchronous commands are queued in submission order, the head is the one in flight
+ * A single command is in flight: the mailbox has one command packet, and the CPU2 does not notify when it has taken
+ * the command out of it, so the next one is only written once the response of the previous one has been received
+ */
+static HCI_TL_AsyncCmd_t AsyncCmdQueue[HCI_TL_ASYNC_CMD_NBR];
+static uint8_t AsyncCmdHead;
+static uint8_t AsyncCmdCount;
+static volatile HCI_TL_AsyncCmdState_t AsyncCmdState;
+static volatile uint8_t AsyncCmdWaiting;
+
 /* Private function prototypes -----------------------------------------------*/
 static void NotifyCmdStatus(HCI_TL_CmdStatus_t hcicmdstatus);
 static void SendCmd(uint16_t opcode, uint8_t plen, void *param);
 static void TlEvtReceived(TL_EvtPacket_t *hcievt);
 static void TlInit( TL_CmdPacket_t * p_cmdbuffer );
+static void AsyncCmdSendNext(void);
+static void AsyncCmdProcess(void);
+static void AsyncCmdWait(void);
 
 /* Interface ------- ---------------------------------------------------------*/
 void hci_init(void(* UserEvtRx)(void* pData), void* pConf)
@@ -81,15 +123,24 @@ void hci_user_evt_proc(void)
 {
   TL_EvtPacket_t *phcievtbuffer;
   tHCI_UserEvtRxParam UserEvtRxParam;
+  uint32_t evt_nbr;
+
+  /**
+   * Report the response of the asynchronous command in flight and send the next one
+   */
+  AsyncCmdProcess();
+  AsyncCmdSendNext();
 
   /**
    * Up to release version v1.2.0, a while loop was implemented to read out events from the queue as long as
    * it is not empty. However, in a bare metal implementation, this leads to calling in a "blocking" mode
    * hci_user_evt_proc() as long as events are received without giving the opportunity to run other tasks
    * in the background.
-   * From now, the events are reported one by one. When it is checked there is still an event pending in the queue,
+   * From now, the events are reported by batches bounded by hci_user_evt_budget() (one event with the default
+   * implementation). When it is checked there is still an event pending in the queue,
    * a request to the user is made to call again hci_user_evt_proc().
-   * This gives the opportunity to the application to run other background tasks between each event.
+   * This gives the opportunity to the application to run other background tasks between each batch while
+   * saving a scheduler round per event during bursts.
    */
 
   /**
@@ -97,7 +148,9 @@ void hci_user_evt_proc(void)
    * in case the user overwrite the header where the next/prev pointers are located
    */
 
-  if((LST_is_empty(&HciAsynchEventQueue) == FALSE) && (UserEventFlow != HCI_TL_UserEventFlow_Disable))
+  evt_nbr = 0;
+  while((LST_is_empty(&HciAsynchEventQueue) == FALSE) && (UserEventFlow != HCI_TL_UserEventFlow_Disable) &&
+        (hci_user_evt_budget(evt_nbr) != 0))
   {
     LST_remove_head ( &HciAsynchEventQueue, (tListNode **)&phcievtbuffer );
 
@@ -124,6 +177,11 @@ void hci_user_evt_proc(void)
        */
       LST_insert_head ( &HciAsynchEventQueue, (tListNode *)phcievtbuffer );
     }
+
+    AsyncCmdProcess();
+    AsyncCmdSendNext();
+
+    evt_nbr++;
   }
 
   if((LST_is_empty(&HciAsynchEventQueue) == FALSE) && (UserEventFlow != HCI_TL_UserEventFlow_Disable))
@@ -160,6 +218,13 @@ int hci_send_req(struct hci_request *p_cmd, uint8_t async)
 
   NotifyCmdStatus(HCI_TL_CmdBusy);
   local_cmd_status = HCI_TL_CmdBusy;
+
+  /**
+   * The command packet is shared with the asynchronous commands
+   * Wait for the one in flight, the pending ones are sent afterwards
+   */
+  AsyncCmdWait();
+
   opcode = ((p_cmd->ocf) & 0x03ff) | ((p_cmd->ogf) << 10);
   SendCmd(opcode, p_cmd->clen, p_cmd->cparam);
 
@@ -208,9 +273,129 @@ int hci_send_req(struct hci_request *p_cmd, uint8_t async)
 
   NotifyCmdStatus(HCI_TL_CmdAvailable);
 
+  AsyncCmdSendNext();
+
   return 0;
 }
 
+int hci_send_req_async(struct hci_request *p_cmd, hci_cmd_callback_t callback, void *p_context)
+{
+  struct hci_request rq;
+  HCI_TL_AsyncCmd_t *p_async_cmd;
+  uint8_t status;
+
+  if(p_cmd->clen > HCI_TL_ASYNC_CMD_MAX_PARAM_LEN)
+  {
+    /**
+     * The command does not fit in a queue slot, it is sent in blocking mode
+     */
+    rq = *p_cmd;
+    status = 0;
+    rq.rparam = &status;
+    rq.rlen = 1;
+    if(hci_send_req(&rq, FALSE) < 0)
+    {
+      return -1;
+    }
+    if(callback != 0)
+    {
+      callback(((rq.ocf) & 0x03ff) | ((rq.ogf) << 10), status, p_context);
+    }
+
+    return 0;
+  }
+
+  if(AsyncCmdCount == HCI_TL_ASYNC_CMD_NBR)
+  {
+    /**
+     * The queue is full, the caller is held as in blocking mode until a slot is released
+     */
+    NotifyCmdStatus(HCI_TL_CmdBusy);
+    while(AsyncCmdCount == HCI_TL_ASYNC_CMD_NBR)
+    {
+      AsyncCmdSendNext();
+      AsyncCmdWait();
+    }
+    NotifyCmdStatus(HCI_TL_CmdAvailable);
+  }
+
+  p_async_cmd = &AsyncCmdQueue[(AsyncCmdHead + AsyncCmdCount) % HCI_TL_ASYNC_CMD_NBR];
+  p_async_cmd->CallBack = callback;
+  p_async_cmd->pContext = p_context;
+  p_async_cmd->Opcode = ((p_cmd->ocf) & 0x03ff) | ((p_cmd->ogf) << 10);
+  p_async_cmd->Plen = p_cmd->clen;
+  AsyncCmdCount++;
+
+  if(p_cmd->cparam == (void *)pCmdBuffer->cmdserial.cmd.payload)
+  {
+    /**
+     * Encoded in place by hci_cmd_reserve_async() in the command packet, which is free: it is sent as is
+     */
+    AsyncCmdState = HCI_TL_ASYNC_CMD_PENDING;
+    SendCmd(p_async_cmd->Opcode, p_async_cmd->Plen, p_cmd->cparam);
+
+    return 0;
+  }
+
+  if(p_cmd->cparam != (void *)p_async_cmd->Param)
+  {
+    memcpy(p_async_cmd->Param, p_cmd->cparam, p_cmd->clen);
+  }
+
+  AsyncCmdSendNext();
+
+  return 0;
+}
+
+void * hci_cmd_reserve_async(uint16_t plen)
+{
+  if(plen > HCI_TL_ASYNC_CMD_MAX_PARAM_LEN)
+  {
+    /**
+     * The command is sent in blocking mode by hci_send_req_async()
+     */
+    return hci_cmd_reserve();
+  }
+
+  if((AsyncCmdState == HCI_TL_ASYNC_CMD_IDLE) && (AsyncCmdCount == 0))
+  {
+    return (void *)pCmdBuffer->cmdserial.cmd.payload;
+  }
+
+  if(AsyncCmdCount == HCI_TL_ASYNC_CMD_NBR)
+  {
+    NotifyCmdStatus(HCI_TL_CmdBusy);
+    while(AsyncCmdCount == HCI_TL_ASYNC_CMD_NBR)
+    {
+      AsyncCmdSendNext();
+      AsyncCmdWait();
+    }
+    NotifyCmdStatus(HCI_TL_CmdAvailable);
+  }
+
+  if((AsyncCmdState == HCI_TL_ASYNC_CMD_IDLE) && (AsyncCmdCount == 0))
+  {
+    return (void *)pCmdBuffer->cmdserial.cmd.payload;
+  }
+
+  /**
+   * The command packet is in use, the command is encoded in the slot it is queued in
+   */
+  return (void *)AsyncCmdQueue[(AsyncCmdHead + AsyncCmdCount) % HCI_TL_ASYNC_CMD_NBR].Param;
+}
+
+void * hci_cmd_reserve(void)
+{
+  if(AsyncCmdState != HCI_TL_ASYNC_CMD_IDLE)
+  {
+    NotifyCmdStatus(HCI_TL_CmdBusy);
+    AsyncCmdWait();
+    NotifyCmdStatus(HCI_TL_CmdAvailable);
+  }
+
+  return (void *)pCmdBuffer->cmdserial.cmd.payload;
+}
+
 /* Private functions ---------------------------------------------------------*/
 static void TlInit( TL_CmdPacket_t * p_cmdbuffer )
 {
@@ -227,6 +412,11 @@ static void TlInit( TL_CmdPacket_t * p_cmdbuffer )
 
   UserEventFlow = HCI_TL_UserEventFlow_Enable;
 
+  AsyncCmdHead = 0;
+  AsyncCmdCount = 0;
+  AsyncCmdState = HCI_TL_ASYNC_CMD_IDLE;
+  AsyncCmdWaiting = 0;
+
   /* Initialize low level driver */
   if (hciContext.io.Init)
   {
@@ -243,13 +433,116 @@ static void SendCmd(uint16_t opcode, uint8_t plen, void *param)
 {
   pCmdBuffer->cmdserial.cmd.cmdcode = opcode;
   pCmdBuffer->cmdserial.cmd.plen = plen;
-  memcpy( pCmdBuffer->cmdserial.cmd.payload, param, plen );
+
+  /**
+   * The parameters have already been encoded in place when the buffer comes from hci_cmd_reserve()
+   */
+  if(param != (void *)pCmdBuffer->cmdserial.cmd.payload)
+  {
+    memcpy( pCmdBuffer->cmdserial.cmd.payload, param, plen );
+  }
 
   hciContext.io.Send(0,0);
 
   return;
 }
 
+static void AsyncCmdSendNext(void)
+{
+  HCI_TL_AsyncCmd_t *p_async_cmd;
+
+  if((AsyncCmdState == HCI_TL_ASYNC_CMD_IDLE) && (AsyncCmdCount != 0))
+  {
+    p_async_cmd = &AsyncCmdQueue[AsyncCmdHead];
+    AsyncCmdState = HCI_TL_ASYNC_CMD_PENDING;
+    SendCmd(p_async_cmd->Opcode, p_async_cmd->Plen, p_async_cmd->Param);
+  }
+
+  return;
+}
+
+static void AsyncCmdProcess(void)
+{
+  TL_EvtPacket_t *pevtpacket;
+  TL_CcEvt_t *pcommand_complete_event;
+  TL_CsEvt_t *pcommand_status_event;
+  HCI_TL_AsyncCmd_t *p_async_cmd;
+  hci_cmd_callback_t callback;
+  void *p_context;
+  uint16_t opcode;
+  uint8_t status;
+  uint8_t numcmd;
+
+  while((AsyncCmdState != HCI_TL_ASYNC_CMD_IDLE) && (LST_is_empty(&HciCmdEventQueue) == FALSE))
+  {
+    LST_remove_head (&HciCmdEventQueue, (tListNode **)&pevtpacket);
+
+    if(pevtpacket->evtserial.evt.evtcode == TL_BLEEVT_CS_OPCODE)
+    {
+      pcommand_status_event = (TL_CsEvt_t*)pevtpacket->evtserial.evt.payload;
+      opcode = pcommand_status_event->cmdcode;
+      status = pcommand_status_event->status;
+      numcmd = pcommand_status_event->numcmd;
+    }
+    else
+    {
+      pcommand_complete_event = (TL_CcEvt_t*)pevtpacket->evtserial.evt.payload;
+      opcode = pcommand_complete_event->cmdcode;
+      status = (pevtpacket->evtserial.evt.plen > TL_EVT_HDR_SIZE) ? pcommand_complete_event->payload[0] : 0;
+      numcmd = pcommand_complete_event->numcmd;
+    }
+
+    p_async_cmd = &AsyncCmdQueue[AsyncCmdHead];
+    if((AsyncCmdState == HCI_TL_ASYNC_CMD_PENDING) && (opcode == p_async_cmd->Opcode))
+    {
+      callback = p_async_cmd->CallBack;
+      p_context = p_async_cmd->pContext;
+      AsyncCmdHead = (AsyncCmdHead + 1) % HCI_TL_ASYNC_CMD_NBR;
+      AsyncCmdCount--;
+
+      /**
+       * The credit is taken into account before the callback, which may send a command
+       */
+      AsyncCmdState = (numcmd != 0) ? HCI_TL_ASYNC_CMD_IDLE : HCI_TL_ASYNC_CMD_NO_CREDIT;
+
+      if(callback != 0)
+      {
+        callback(opcode, status, p_context);
+      }
+    }
+    else if(numcmd != 0)
+    {
+      AsyncCmdState = HCI_TL_ASYNC_CMD_IDLE;
+    }
+  }
+
+  return;
+}
+
+static void AsyncCmdWait(void)
+{
+  uint8_t waiting;
+
+  /**
+   * From now on, the responses release hci_cmd_resp_wait() instead of being reported to hci_user_evt_proc()
+   * The ones received before are already in the queue
+   * The wait may be nested when a callback sends a blocking command, the outer one is restored on exit
+   */
+  waiting = AsyncCmdWaiting;
+  AsyncCmdWaiting = 1;
+
+  AsyncCmdProcess();
+  while(AsyncCmdState != HCI_TL_ASYNC_CMD_IDLE)
+  {
+    hci_cmd_resp_wait(HCI_TL_DEFAULT_TIMEOUT);
+    AsyncCmdProcess();
+  }
+
+  AsyncCmdWaiting = waiting;
+
+  return;
+}
+
 static void NotifyCmdStatus(HCI_TL_CmdStatus_t hcicmdstatus)
 {
   if(hcicmdstatus == HCI_TL_CmdBusy)
@@ -275,7 +568,14 @@ static void TlEvtReceived(TL_EvtPacket_t *hcievt)
   if ( ((hcievt->evtserial.evt.evtcode) == TL_BLEEVT_CS_OPCODE) || ((hcievt->evtserial.evt.evtcode) == TL_BLEEVT_CC_OPCODE ) )
   {
     LST_insert_tail(&HciCmdEventQueue, (tListNode *)hcievt);
-    hci_cmd_resp_release(0); /**< Notify the application a full Cmd Event has been received */
+    if((AsyncCmdState != HCI_TL_ASYNC_CMD_IDLE) && (AsyncCmdWaiting == 0))
+    {
+      hci_notify_asynch_evt((void*) &HciAsynchEventQueue); /**< The response of an asynchronous command is reported from hci_user_evt_proc() */
+    }
+    else
+    {
+      hci_cmd_resp_release(0); /**< Notify the application a full Cmd Event has been received */
+    }
   }
   else
   {
@@ -305,3 +605,8 @@ __WEAK void hci_cmd_resp_release(uint32_t flag)
 
   return;
 }
+
+__WEAK uint8_t hci_user_evt_budget(uint32_t evt_nbr)
+{
+  return (evt_nbr < HCI_TL_USER_EVT_BUDGET);
+}
@@ -29,6 +29,14 @@ extern "C" {
 #include "tl.h"
 
 /* Exported defines -----------------------------------------------------------*/
+/**
+ * Number of events reported per call of hci_user_evt_proc() by the weak implementation of hci_user_evt_budget().
+ * It may be overridden in ble_conf.h
+ */
+#ifndef HCI_TL_USER_EVT_BUDGET
+#define HCI_TL_USER_EVT_BUDGET          (1)
+#endif
+
 typedef enum
 {
   HCI_TL_UserEventFlow_Disable,
@@ -137,6 +145,18 @@ void hci_cmd_resp_wait(uint32_t timeout);
  */
 void hci_cmd_resp_release(uint32_t flag);
 
+/**
+ * @brief  This function is called by hci_user_evt_proc() before reporting each event to know whether the event
+ *         may be reported in the same call or whether the hand shall be given back to the scheduler.
+ *         A weak implementation is available in hci_tl.c allowing up to HCI_TL_USER_EVT_BUDGET events per call
+ *         The user may re-implement this function in the application to bound the time spent per call :
+ *         - The start time may be latched when evt_nbr is 0
+ *
+ * @param  evt_nbr: Number of events already reported in the current call
+ * @retval 1 when the event may be reported, 0 otherwise
+ */
+uint8_t hci_user_evt_budget(uint32_t evt_nbr);
+
 
 
 /**
@@ -153,6 +173,7 @@ void hci_cmd_resp_release(uint32_t flag);
 /**
  * @brief  This process shall be called by the scheduler each time it is requested with hci_notify_asynch_evt()
  *         This process may send an ACI/HCI command when the svc_ctl.c module is used
+ *         The number of events reported per call is bounded by hci_user_evt_budget()
  *
  * @param  None
  * @retval None
@@ -184,6 +205,28 @@ void hci_user_evt_proc(void);
  */
 void hci_init(void(* UserEvtRx)(void* pData), void* pConf);
 
+/**
+ * @brief  Reserve the command packet shared with the CPU2 so that the command parameters are encoded in place.
+ *         The command is committed by calling hci_send_req() with cparam set to the returned address, in which
+ *         case the parameters are not copied again.
+ *         The buffer is owned by the caller until the command is committed and shall not be reserved while a command
+ *         is pending (i.e. from a context that may preempt hci_send_req()). It waits for the asynchronous command in
+ *         flight, if any.
+ * @param  None
+ * @retval Address of the parameters of the command packet
+ */
+void * hci_cmd_reserve(void);
+
+/**
+ * @brief  Reserve the buffer in which the parameters of an asynchronous command are encoded in place.
+ *         This is the command packet when no asynchronous command is pending, otherwise the queue slot of the command.
+ *         The command is committed by calling hci_send_req_async() with cparam set to the returned address, in which
+ *         case the parameters are not copied again. It is held as hci_send_req_async() when the queue is full.
+ * @param  plen: Length of the parameters of the command
+ * @retval Address where the parameters of the command are encoded
+ */
+void * hci_cmd_reserve_async(uint16_t plen);
+
 /**
  * END OF SECTION - INTERFACES USED BY THE BLE DRIVER
  *********************************************************************************************************************
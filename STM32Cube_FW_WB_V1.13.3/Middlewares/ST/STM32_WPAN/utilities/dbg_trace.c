@@ -50,6 +50,13 @@ size_t __write(int handle, const unsigned char * buf, size_t bufSize);
 /** @defgroup TRACE Log private defines 
  * @{
  */
+#if (( CFG_DEBUG_TRACE_FULL != 0 ) || ( CFG_DEBUG_TRACE_LIGHT != 0 ))
+#if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
+#if ((DBG_TRACE_MSG_QUEUE_SIZE & (DBG_TRACE_MSG_QUEUE_SIZE - 1)) != 0)
+#error "DBG_TRACE_MSG_QUEUE_SIZE shall be a power of 2"
+#endif
+#endif
+#endif
 
 /**
  * @}
@@ -69,10 +76,11 @@ size_t __write(int handle, const unsigned char * buf, size_t bufSize);
  */
 #if (( CFG_DEBUG_TRACE_FULL != 0 ) || ( CFG_DEBUG_TRACE_LIGHT != 0 ))
 #if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
-static queue_t MsgDbgTraceQueue;
+static ring_queue_t MsgDbgTraceQueue;
 static uint8_t MsgDbgTraceQueueBuff[DBG_TRACE_MSG_QUEUE_SIZE];
+static uint32_t DbgTraceTxSize;
 #endif
-__IO ITStatus DbgTracePeripheralReady = SET;
+static __IO uint32_t DbgTracePeripheralReady = SET;
 #endif
 /**
  * @}
@@ -92,6 +100,9 @@ __IO ITStatus DbgTracePeripheralReady = SET;
  */
 #if (( CFG_DEBUG_TRACE_FULL != 0 ) || ( CFG_DEBUG_TRACE_LIGHT != 0 ))
 static void DbgTrace_TxCpltCallback(void);
+#if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
+static void DbgTrace_StartTx(void);
+#endif
 #endif
 
 
@@ -166,30 +177,13 @@ void DbgTraceBuffer(const void *pBuffer, uint32_t u32Length, const char *strForm
 static void DbgTrace_TxCpltCallback(void)
 {
 #if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
-  uint8_t* buf;
-  uint16_t bufSize;
+  /* Remove data just sent to UART */
+  RingQueue_Remove(&MsgDbgTraceQueue, DbgTraceTxSize);
 
-  BACKUP_PRIMASK();
-
-  DISABLE_IRQ();			/**< Disable all interrupts by setting PRIMASK bit on Cortex*/
-  /* Remove element just sent to UART */
-  CircularQueue_Remove(&MsgDbgTraceQueue,&bufSize);
+  DbgTracePeripheralReady = SET;
 
   /* Sense if new data to be sent */
-  buf=CircularQueue_Sense(&MsgDbgTraceQueue,&bufSize);
-
-
-  if ( buf != NULL) 
-  {
-    RESTORE_PRIMASK();
-    DbgOutputTraces((uint8_t*)buf, bufSize, DbgTrace_TxCpltCallback);
-  } 
-  else
-  {
-    DbgTracePeripheralReady = SET;
-    RESTORE_PRIMASK();
-  }
-
+  DbgTrace_StartTx();
 #else
   BACKUP_PRIMASK();
 
@@ -200,6 +194,47 @@ static void DbgTrace_TxCpltCallback(void)
   RESTORE_PRIMASK();
 #endif
 }
+
+#if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
+/**
+ * @brief  Start the transmission of the data of the queue if the DBG_TRACE USART is not busy
+ * @note   The context that takes the peripheral ready flag is the only consumer of the queue until the
+ *         end of the transmission. When the queue is seen empty, it is checked again once the flag is given
+ *         back as another context may have added data in between and not been able to take the flag.
+ * @retval None
+ */
+static void DbgTrace_StartTx(void)
+{
+  uint8_t* buf;
+  uint32_t bufSize;
+
+  do
+  {
+    /* Take the peripheral ready flag without masking the interrupts */
+    do
+    {
+      if (__LDREXW(&DbgTracePeripheralReady) != SET)
+      {
+        __CLREX();
+        return;
+      }
+    } while (__STREXW(RESET, &DbgTracePeripheralReady) != 0);
+
+    buf = RingQueue_Sense(&MsgDbgTraceQueue, &bufSize);
+
+    if (buf != NULL)
+    {
+      DbgTraceTxSize = MIN(bufSize, 0xFFFFU);
+      DbgOutputTraces(buf, (uint16_t)DbgTraceTxSize, DbgTrace_TxCpltCallback);
+      return;
+    }
+
+    DbgTracePeripheralReady = SET;
+  } while (RingQueue_Count(&MsgDbgTraceQueue) != 0);
+
+  return;
+}
+#endif
 #endif
 
 void DbgTraceInit( void )
@@ -207,7 +242,7 @@ void DbgTraceInit( void )
 #if (( CFG_DEBUG_TRACE_FULL != 0 ) || ( CFG_DEBUG_TRACE_LIGHT != 0 ))
   DbgOutputInit();
 #if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
-  CircularQueue_Init(&MsgDbgTraceQueue, MsgDbgTraceQueueBuff, DBG_TRACE_MSG_QUEUE_SIZE, 0, CIRCULAR_QUEUE_SPLIT_IF_WRAPPING_FLAG);
+  (void)RingQueue_Init(&MsgDbgTraceQueue, MsgDbgTraceQueueBuff, DBG_TRACE_MSG_QUEUE_SIZE);
 #endif 
 #endif
   return;
@@ -254,9 +289,9 @@ size_t __write(int handle, const unsigned char * buf, size_t bufSize)
 size_t DbgTraceWrite(int handle, const unsigned char * buf, size_t bufSize)
 {
   size_t chars_written = 0;
-  uint8_t* buffer;
-
+#if (DBG_TRACE_USE_CIRCULAR_QUEUE == 0)
   BACKUP_PRIMASK();
+#endif
 
   /* Ignore flushes */
   if ( handle == -1 )
@@ -276,17 +311,10 @@ size_t DbgTraceWrite(int handle, const unsigned char * buf, size_t bufSize)
     /* CS Start */
 
 #if (DBG_TRACE_USE_CIRCULAR_QUEUE != 0)
-    DISABLE_IRQ();      /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
-    buffer=CircularQueue_Add(&MsgDbgTraceQueue,(uint8_t*)buf, bufSize,1);
-    if (buffer && DbgTracePeripheralReady)
-    {
-      DbgTracePeripheralReady = RESET;
-      RESTORE_PRIMASK();
-      DbgOutputTraces((uint8_t*)buffer, bufSize, DbgTrace_TxCpltCallback);
-    }
-    else
+    /* The message is dropped when the queue is full */
+    if (RingQueue_Add(&MsgDbgTraceQueue, buf, bufSize) != 0)
     {
-      RESTORE_PRIMASK();
+      DbgTrace_StartTx();
     }
 #else
     DISABLE_IRQ();      /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
@@ -301,6 +329,54 @@ size_t DbgTraceWrite(int handle, const unsigned char * buf, size_t bufSize)
   return ( chars_written );
 }
 
+#if (CFG_DEBUG_TRACE_BINARY != 0)
+/**
+ * @brief Output a message without formatting it, it is decoded on the host from the ELF file of the application
+ * @param nbArgs number of arguments following the format string, up to DBG_TRACE_BINARY_MAX_ARGS
+ * @param strFormat format string in printf() style
+ * @param ... arguments of the format string
+ * @retval None
+ */
+void DbgTraceBinary( uint32_t nbArgs, const char *strFormat, ... )
+{
+  uint8_t record[1 + (4 * (1 + DBG_TRACE_BINARY_MAX_ARGS))];
+  uint32_t value;
+  uint32_t index;
+  uint32_t size;
+  va_list vaArgs;
+
+  if ( nbArgs > DBG_TRACE_BINARY_MAX_ARGS )
+  {
+    nbArgs = DBG_TRACE_BINARY_MAX_ARGS;
+  }
+
+  record[0] = (uint8_t)( DBG_TRACE_BINARY_TAG | nbArgs );
+  value = (uint32_t)strFormat;
+  size = 1;
+
+  va_start(vaArgs, strFormat);
+  for ( index = 0; index <= nbArgs; index++ )
+  {
+    if ( index != 0 )
+    {
+      value = va_arg(vaArgs, uint32_t);
+    }
+    record[size++] = (uint8_t)value;
+    record[size++] = (uint8_t)( value >> 8 );
+    record[size++] = (uint8_t)( value >> 16 );
+    record[size++] = (uint8_t)( value >> 24 );
+  }
+  va_end(vaArgs);
+
+  /**
+   * The record is added as a single element of the queue so that it is never split by another trace
+   */
+  (void)DbgTraceWrite(1U, record, size);
+
+  return;
+}
+#endif /* CFG_DEBUG_TRACE_BINARY */
+
 #if   defined ( __CC_ARM )     /* Keil */
 
 /**
@@ -28,11 +28,28 @@ extern "C"
 
 /* Exported types ------------------------------------------------------------*/
 /* External variables --------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/**
+ * A binary record is the tag byte ORed with the number of arguments, the address of the format string
+ * and the arguments, all on 32 bits in little endian
+ */
+#define DBG_TRACE_BINARY_TAG        (0xF8U)
+#define DBG_TRACE_BINARY_MAX_ARGS   (7U)
+
 /* Exported macros -----------------------------------------------------------*/
+/**
+ * Number of arguments following the format string, up to DBG_TRACE_BINARY_MAX_ARGS
+ */
+#define DBG_TRACE_BINARY_NARG(...)  DBG_TRACE_BINARY_ARG_N(__VA_ARGS__, 7, 6, 5, 4, 3, 2, 1, 0, 0)
+#define DBG_TRACE_BINARY_ARG_N(fmt, a1, a2, a3, a4, a5, a6, a7, n, ...)  n
+#define DBG_TRACE_BINARY(...)       DbgTraceBinary(DBG_TRACE_BINARY_NARG(__VA_ARGS__), __VA_ARGS__)
+
 #if ( ( CFG_DEBUG_TRACE_FULL != 0 ) || ( CFG_DEBUG_TRACE_LIGHT != 0 ) )
 #define PRINT_LOG_BUFF_DBG(...) DbgTraceBuffer(__VA_ARGS__)
 #if ( CFG_DEBUG_TRACE_FULL != 0 )
 #define PRINT_MESG_DBG(...)     do{printf("\r\n [%s][%s][%d] ", DbgTraceGetFileName(__FILE__),__FUNCTION__,__LINE__);printf(__VA_ARGS__);}while(0);
+#elif ( CFG_DEBUG_TRACE_BINARY != 0 )
+#define PRINT_MESG_DBG(...)     DBG_TRACE_BINARY(__VA_ARGS__)
 #else
 #define PRINT_MESG_DBG          printf
 #endif
@@ -94,6 +111,17 @@ const char *DbgTraceGetFileName( const char *fullpath );
  */
 size_t DbgTraceWrite(int handle, const unsigned char * buf, size_t bufSize);
 
+/**
+ * @brief Output a message without formatting it, it is decoded on the host from the ELF file of the application
+ * @note  Only integer arguments and addresses of constant strings are supported. Use DBG_TRACE_BINARY() so that
+ *        the number of arguments is computed.
+ * @param nbArgs number of arguments following the format string, up to DBG_TRACE_BINARY_MAX_ARGS
+ * @param strFormat format string in printf() style
+ * @param ... arguments of the format string
+ * @retval None
+ */
+void DbgTraceBinary( uint32_t nbArgs, const char *strFormat, ... );
+
 #ifdef __cplusplus
 }
 #endif
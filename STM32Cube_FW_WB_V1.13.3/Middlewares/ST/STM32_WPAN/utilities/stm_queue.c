@@ -32,7 +32,29 @@
 /* Global variables ----------------------------------------------------------*/
 /* Extern variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
+static uint32_t RingQueue_AtomicAdd(volatile uint32_t *x, uint32_t value);
+
 /* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief   Add a value to a variable shared with the interrupts without masking them
+  * @note    The exclusive store fails when an interrupt has been taken since the exclusive load
+  * @param  x: pointer on the variable
+  * @param  value: value to be added (modulo 2^32)
+  * @retval  new value of the variable
+  */
+static uint32_t RingQueue_AtomicAdd(volatile uint32_t *x, uint32_t value)
+{
+  uint32_t new_value;
+
+  do
+  {
+    new_value = __LDREXW(x) + value;
+  } while (__STREXW(new_value, x) != 0);
+
+  return new_value;
+}
+
 /* Public functions ----------------------------------------------------------*/
 
 /**
@@ -381,3 +403,126 @@ int CircularQueue_NbElement(queue_t *q)
 {
   return q->elementCount;
 }
+
+/**
+  * @brief   Initialize a ring queue.
+  * @note    The indexes are free running so that the whole buffer is usable.
+  * @param  q: pointer on ring queue structure to be initialised
+  * @param  queueBuffer: pointer on Queue Buffer
+  * @param  queueSize:  Size of Queue Buffer, a power of 2
+  * @retval   0 or -1 if the size is not a power of 2
+  */
+int RingQueue_Init(ring_queue_t *q, uint8_t* queueBuffer, uint32_t queueSize)
+{
+  if ((queueSize == 0) || ((queueSize & (queueSize - 1)) != 0))
+  {
+    return -1;
+  }
+
+  q->qBuff = queueBuffer;
+  q->mask = queueSize - 1;
+  q->reserved = 0;
+  q->committed = 0;
+  q->writers = 0;
+  q->read = 0;
+
+  return 0;
+}
+
+/**
+  * @brief   Add bytes to a ring queue.
+  * @note    The room is reserved with exclusive accesses and the bytes are copied with at most two memcpy.
+  *          The last producer to complete makes readable the bytes of all the producers it has preempted,
+  *          so that the consumer never reads a reserved room that is not yet filled.
+  * @param  q: pointer on ring queue structure to be handled
+  * @param  x: pointer on the bytes to be added
+  * @param  size: number of bytes to be added
+  * @retval  size, or 0 if the bytes do not fit in the queue (nothing is added)
+  */
+uint32_t RingQueue_Add(ring_queue_t *q, const uint8_t* x, uint32_t size)
+{
+  uint32_t start;
+  uint32_t offset;
+  uint32_t span;
+  uint32_t end;
+
+  (void)RingQueue_AtomicAdd(&q->writers, 1);
+
+  do
+  {
+    start = __LDREXW(&q->reserved);
+    if (((q->mask + 1) - (start - q->read)) < size)
+    {
+      __CLREX();
+      size = 0;
+      break;
+    }
+  } while (__STREXW(start + size, &q->reserved) != 0);
+
+  if (size != 0)
+  {
+    offset = start & q->mask;
+    span = MIN(size, (q->mask + 1) - offset);
+    memcpy(&q->qBuff[offset], x, span);
+    memcpy(&q->qBuff[0], &x[span], size - span);
+  }
+
+  /* The bytes shall be in the buffer before they are made readable */
+  __DMB();
+
+  if (RingQueue_AtomicAdd(&q->writers, (uint32_t)-1) == 0)
+  {
+    /* The reserved index is read again when a producer has been completed after it was read */
+    do
+    {
+      (void)__LDREXW(&q->committed);
+      end = q->reserved;
+    } while (__STREXW(end, &q->committed) != 0);
+  }
+
+  return size;
+}
+
+/**
+  * @brief   Get the first contiguous bytes readable in a ring queue.
+  * @note    The bytes stay in the queue until RingQueue_Remove() is called.
+  * @param  q: pointer on ring queue structure to be handled
+  * @param  size: number of contiguous bytes readable
+  * @retval  pointer on the first byte or NULL if the queue is empty
+  */
+uint8_t* RingQueue_Sense(ring_queue_t *q, uint32_t* size)
+{
+  uint32_t read = q->read;
+  uint32_t offset = read & q->mask;
+
+  *size = MIN(q->committed - read, (q->mask + 1) - offset);
+
+  /* The bytes shall not be read before the committed index */
+  __DMB();
+
+  return (*size != 0) ? &q->qBuff[offset] : NULL;
+}
+
+/**
+  * @brief   Remove bytes from a ring queue.
+  * @param  q: pointer on ring queue structure to be handled
+  * @param  size: number of bytes to be removed, at most the size returned by RingQueue_Sense()
+  * @retval  None
+  */
+void RingQueue_Remove(ring_queue_t *q, uint32_t size)
+{
+  /* The bytes shall be read before their room is released */
+  __DMB();
+
+  q->read += size;
+}
+
+/**
+  * @brief   Get the number of bytes readable in a ring queue.
+  * @param  q: pointer on ring queue structure to be handled
+  * @retval  number of bytes
+  */
+uint32_t RingQueue_Count(ring_queue_t *q)
+{
+  return q->committed - q->read;
+}
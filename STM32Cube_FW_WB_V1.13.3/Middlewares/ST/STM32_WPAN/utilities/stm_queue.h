@@ -42,6 +42,16 @@ typedef struct {
    uint8_t  optionFlags;     /* option to enable specific features */
 } queue_t;
 
+/* Byte ring without interrupt masking: one consumer, producers may preempt each other on the same core */
+typedef struct {
+   uint8_t* qBuff;               /* ring buffer, provided by init fct */
+   uint32_t mask;                /* size of the ring minus 1, the size is a power of 2 */
+   volatile uint32_t reserved;   /* free running index of the end of the data reserved by the producers */
+   volatile uint32_t committed;  /* free running index of the end of the data readable by the consumer */
+   volatile uint32_t writers;    /* number of producers in progress */
+   volatile uint32_t read;       /* free running index of the first byte to be read, only written by the consumer */
+} ring_queue_t;
+
 /* Exported constants --------------------------------------------------------*/
 
 /* Exported macro ------------------------------------------------------------*/
@@ -55,5 +65,11 @@ int CircularQueue_NbElement(queue_t *q);
 uint8_t* CircularQueue_Remove_Copy(queue_t *q, uint16_t* elementSize, uint8_t* buffer);
 uint8_t* CircularQueue_Sense_Copy(queue_t *q, uint16_t* elementSize, uint8_t* buffer);
 
+int RingQueue_Init(ring_queue_t *q, uint8_t* queueBuffer, uint32_t queueSize);
+uint32_t RingQueue_Add(ring_queue_t *q, const uint8_t* x, uint32_t size);
+uint8_t* RingQueue_Sense(ring_queue_t *q, uint32_t* size);
+void RingQueue_Remove(ring_queue_t *q, uint32_t size);
+uint32_t RingQueue_Count(ring_queue_t *q);
+
 
 #endif /* __STM_QUEUE_H */
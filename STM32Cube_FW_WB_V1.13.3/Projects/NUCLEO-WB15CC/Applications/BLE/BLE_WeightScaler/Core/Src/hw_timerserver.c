@@ -46,12 +46,21 @@ typedef struct
 {
   HW_TS_pTimerCb_t  pTimerCallBack;
   uint32_t        CounterInit;
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+  uint32_t        Expiry;         /**< Absolute time of the timeout in wakeup timer ticks */
+  uint32_t        Slack;          /**< Number of ticks the timeout may be delayed to share a wakeup */
+#else
   uint32_t        CountLeft;
+#endif
   TimerIDStatus_t     TimerIDStatus;
   HW_TS_Mode_t   TimerMode;
   uint32_t        TimerProcessID;
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+  uint8_t         HeapIndex;      /**< Position of the running timer in aTimerHeap[] */
+#else
   uint8_t         PreviousID;
   uint8_t         NextID;
+#endif
 }TimerContext_t;
 
 /* Private defines -----------------------------------------------------------*/
@@ -59,6 +68,48 @@ typedef struct
 #define TIMER_LIST_EMPTY      0xFFFF
 
 /* Private macros ------------------------------------------------------------*/
+/**
+ * Access to the RTC wakeup timer, the EXTI line and the NVIC
+ * When CFG_HW_TS_PORT_HEADER is defined, they are taken from that file instead so that the timer server may be
+ * run against another implementation, for instance a simulated RTC on a host
+ */
+#ifdef CFG_HW_TS_PORT_HEADER
+#include CFG_HW_TS_PORT_HEADER
+#else
+#define HW_TS_RTC_READ_SSR()                  READ_BIT(RTC->SSR, RTC_SSR_SS)
+#define HW_TS_RTC_READ_WUT()                  READ_BIT(RTC->WUTR, RTC_WUTR_WUT)
+#define HW_TS_RTC_WRITE_WUT(value)            MODIFY_REG(RTC->WUTR, RTC_WUTR_WUT, (value))
+#define HW_TS_RTC_READ_WUTE()                 READ_BIT(RTC->CR, RTC_CR_WUTE)
+#define HW_TS_RTC_READ_WUCKSEL()              READ_BIT(RTC->CR, RTC_CR_WUCKSEL)
+#define HW_TS_RTC_READ_PREDIV_A()             (READ_BIT(RTC->PRER, RTC_PRER_PREDIV_A) >> (uint32_t)POSITION_VAL(RTC_PRER_PREDIV_A))
+#define HW_TS_RTC_READ_PREDIV_S()             READ_BIT(RTC->PRER, RTC_PRER_PREDIV_S)
+#define HW_TS_RTC_BYPASS_SHADOW()             SET_BIT(RTC->CR, RTC_CR_BYPSHAD)
+#define HW_TS_RTC_GET_FLAG_WUTWF()            __HAL_RTC_WAKEUPTIMER_GET_FLAG(phrtc, RTC_FLAG_WUTWF)
+#define HW_TS_RTC_GET_FLAG_WUTF()             __HAL_RTC_WAKEUPTIMER_GET_FLAG(phrtc, RTC_FLAG_WUTF)
+#define HW_TS_RTC_CLEAR_FLAG_WUTF()           __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(phrtc, RTC_FLAG_WUTF)
+#define HW_TS_RTC_EXTI_CLEAR_FLAG()           __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG()
+#define HW_TS_RTC_WAKEUPTIMER_ENABLE()        __HAL_RTC_WAKEUPTIMER_ENABLE(phrtc)
+#define HW_TS_RTC_WAKEUPTIMER_DISABLE()       __HAL_RTC_WAKEUPTIMER_DISABLE(phrtc)
+#define HW_TS_RTC_WAKEUPTIMER_ENABLE_IT()     __HAL_RTC_WAKEUPTIMER_ENABLE_IT(phrtc, RTC_IT_WUT)
+#define HW_TS_RTC_WRITEPROTECTION_ENABLE()    __HAL_RTC_WRITEPROTECTION_ENABLE(phrtc)
+#define HW_TS_RTC_WRITEPROTECTION_DISABLE()   __HAL_RTC_WRITEPROTECTION_DISABLE(phrtc)
+#define HW_TS_EXTI_ENABLE_RISING_TRIG()       LL_EXTI_EnableRisingTrig_0_31(RTC_EXTI_LINE_WAKEUPTIMER_EVENT)
+#define HW_TS_EXTI_ENABLE_IT()                LL_EXTI_EnableIT_0_31(RTC_EXTI_LINE_WAKEUPTIMER_EVENT)
+#define HW_TS_NVIC_ENABLE()                   HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID)
+#define HW_TS_NVIC_DISABLE()                  HAL_NVIC_DisableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID)
+#define HW_TS_NVIC_SET_PENDING()              HAL_NVIC_SetPendingIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID)
+#define HW_TS_NVIC_CLEAR_PENDING()            HAL_NVIC_ClearPendingIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID)
+#define HW_TS_NVIC_SET_PRIORITY()             HAL_NVIC_SetPriority(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID, CFG_HW_TS_NVIC_RTC_WAKEUP_IT_PREEMPTPRIO, CFG_HW_TS_NVIC_RTC_WAKEUP_IT_SUBPRIO)
+#endif
+
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+/**
+ * Compare two absolute times of the timer server
+ * The result is valid as long as they are less than 2^31 ticks apart
+ */
+#define TIME_BEFORE(a, b)     ((int32_t)((a) - (b)) < 0)
+#endif
+
 /* Private variables ---------------------------------------------------------*/
 
 /**
@@ -70,6 +121,17 @@ PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint8_t CurrentRunningTi
 PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint8_t PreviousRunningTimerID;
 PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint32_t SSRValueOnLastSetup;
 PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile WakeupTimerLimitation_Status_t  WakeupTimerLimitation;
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+/**
+ * Running timers ordered as a binary min heap on their expiry time, the first one is CurrentRunningTimerID
+ */
+PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint8_t aTimerHeap[CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER];
+PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint8_t TimerHeapSize;
+/**
+ * Absolute time of the last wakeup timer setup, the expiry times are given in the same time base
+ */
+PLACE_IN_SECTION("TIMERSERVER_CONTEXT") static volatile uint32_t TimeOrigin;
+#endif
 
 /**
  * END of Section TIMERSERVER_CONTEXT
@@ -87,9 +149,16 @@ static void RestartWakeupCounter(uint16_t Value);
 static uint16_t ReturnTimeElapsed(void);
 static void RescheduleTimerList(void);
 static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR);
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+static void HeapMoveUp(uint8_t HeapIndex, uint8_t TimerID);
+static void HeapMoveDown(uint8_t HeapIndex, uint8_t TimerID);
+static uint32_t CoalesceExpiry(uint32_t Earliest, uint32_t Latest);
+static void linkTimer(uint8_t TimerID);
+#else
 static void LinkTimerBefore(uint8_t TimerID, uint8_t RefTimerID);
 static void LinkTimerAfter(uint8_t TimerID, uint8_t RefTimerID);
 static uint16_t linkTimer(uint8_t TimerID);
+#endif
 static uint32_t ReadRtcSsrValue(void);
 
 __weak void HW_TS_RTC_CountUpdated_AppNot(void);
@@ -108,20 +177,235 @@ static uint32_t ReadRtcSsrValue(void)
   uint32_t first_read;
   uint32_t second_read;
 
-  first_read = (uint32_t)(READ_BIT(RTC->SSR, RTC_SSR_SS));
+  first_read = (uint32_t)(HW_TS_RTC_READ_SSR());
 
-  second_read = (uint32_t)(READ_BIT(RTC->SSR, RTC_SSR_SS));
+  second_read = (uint32_t)(HW_TS_RTC_READ_SSR());
 
   while(first_read != second_read)
   {
     first_read = second_read;
 
-    second_read = (uint32_t)(READ_BIT(RTC->SSR, RTC_SSR_SS));
+    second_read = (uint32_t)(HW_TS_RTC_READ_SSR());
   }
 
   return second_read;
 }
 
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+/**
+ * @brief  Move a Timer up in the heap from the position specified until its parent expires before it
+ * @param  HeapIndex: The position in the heap where the Timer is placed
+ * @param  TimerID:   The ID of the Timer
+ * @retval None
+ */
+static void HeapMoveUp(uint8_t HeapIndex, uint8_t TimerID)
+{
+  uint8_t parent_index;
+  uint8_t parent_id;
+
+  while(HeapIndex != 0)
+  {
+    parent_index = (HeapIndex - 1) >> 1;
+    parent_id = aTimerHeap[parent_index];
+
+    if(!TIME_BEFORE(aTimerContext[TimerID].Expiry, aTimerContext[parent_id].Expiry))
+    {
+      break;
+    }
+
+    aTimerHeap[HeapIndex] = parent_id;
+    aTimerContext[parent_id].HeapIndex = HeapIndex;
+    HeapIndex = parent_index;
+  }
+
+  aTimerHeap[HeapIndex] = TimerID;
+  aTimerContext[TimerID].HeapIndex = HeapIndex;
+
+  return;
+}
+
+/**
+ * @brief  Move a Timer down in the heap from the position specified until its children expire after it
+ * @param  HeapIndex: The position in the heap where the Timer is placed
+ * @param  TimerID:   The ID of the Timer
+ * @retval None
+ */
+static void HeapMoveDown(uint8_t HeapIndex, uint8_t TimerID)
+{
+  uint16_t child_index;
+  uint8_t child_id;
+
+  child_index = (2 * (uint16_t)HeapIndex) + 1;
+  while(child_index < TimerHeapSize)
+  {
+    child_id = aTimerHeap[child_index];
+
+    /**
+     * Select the child that expires first
+     */
+    if(((child_index + 1) < TimerHeapSize) &&
+       (TIME_BEFORE(aTimerContext[aTimerHeap[child_index + 1]].Expiry, aTimerContext[child_id].Expiry)))
+    {
+      child_index++;
+      child_id = aTimerHeap[child_index];
+    }
+
+    if(!TIME_BEFORE(aTimerContext[child_id].Expiry, aTimerContext[TimerID].Expiry))
+    {
+      break;
+    }
+
+    aTimerHeap[HeapIndex] = child_id;
+    aTimerContext[child_id].HeapIndex = HeapIndex;
+    HeapIndex = (uint8_t)child_index;
+    child_index = (2 * (uint16_t)HeapIndex) + 1;
+  }
+
+  aTimerHeap[HeapIndex] = TimerID;
+  aTimerContext[TimerID].HeapIndex = HeapIndex;
+
+  return;
+}
+
+/**
+ * @brief  Select the expiry time of a Timer in its slack window
+ * @note   The window is first matched against the Timer that expires first so that both are reported on the
+ *         same wakeup. Otherwise, the expiry is aligned on the largest power of 2 ticks of the window so that
+ *         independent Timers with a slack meet on the same boundaries
+ * @param  Earliest:  The expiry time without slack
+ * @param  Latest:    The expiry time with the full slack
+ * @retval The expiry time selected
+ */
+static uint32_t CoalesceExpiry(uint32_t Earliest, uint32_t Latest)
+{
+  uint32_t first_expiry;
+
+  if(TimerHeapSize != 0)
+  {
+    first_expiry = aTimerContext[aTimerHeap[0]].Expiry;
+
+    if((!TIME_BEFORE(first_expiry, Earliest)) && (!TIME_BEFORE(Latest, first_expiry)))
+    {
+      return first_expiry;
+    }
+  }
+
+  if(Latest == Earliest)
+  {
+    return Latest;
+  }
+
+  /**
+   * The bits of Latest below the highest bit that differs from Earliest may be cleared without
+   * leaving the window
+   */
+  return (Latest & ~((1UL << (31 - __CLZ(Latest ^ Earliest))) - 1));
+}
+
+/**
+ * @brief  Insert a Timer in the heap
+ * @note   The expiry time is computed from the time elapsed since the last wakeup timer setup so that the
+ *         other running timers do not need to be updated
+ * @param  TimerID:   The ID of the Timer
+ * @retval None
+ */
+static void linkTimer(uint8_t TimerID)
+{
+  uint16_t time_elapsed;
+
+  if(TimerHeapSize == 0)
+  {
+    /**
+     * No timer in the heap
+     */
+    SSRValueOnLastSetup = SSR_FORBIDDEN_VALUE;
+    time_elapsed = 0;
+  }
+  else
+  {
+    time_elapsed = ReturnTimeElapsed();
+  }
+
+  aTimerContext[TimerID].Expiry = TimeOrigin + time_elapsed + aTimerContext[TimerID].CounterInit;
+
+  if(aTimerContext[TimerID].Slack != 0)
+  {
+    aTimerContext[TimerID].Expiry = CoalesceExpiry(aTimerContext[TimerID].Expiry,
+                                                   aTimerContext[TimerID].Expiry + aTimerContext[TimerID].Slack);
+  }
+
+  TimerHeapSize++;
+  HeapMoveUp(TimerHeapSize - 1, TimerID);
+
+  /**
+   * As with the list, PreviousRunningTimerID is only updated when the first Timer changes so that a change made
+   * by UnlinkTimer() in the wakeup handler is still seen when the repeated Timer is started again
+   */
+  if(aTimerHeap[0] != CurrentRunningTimerID)
+  {
+    PreviousRunningTimerID = CurrentRunningTimerID;
+    CurrentRunningTimerID = aTimerHeap[0];
+  }
+
+  return;
+}
+
+/**
+ * @brief  Remove a Timer from the heap
+ * @param  TimerID:   The ID of the Timer
+ * @param  RequestReadSSR: Request to read the SSR register or not
+ * @retval None
+ */
+static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR)
+{
+  uint8_t heap_index;
+  uint8_t last_id;
+
+  heap_index = aTimerContext[TimerID].HeapIndex;
+
+  TimerHeapSize--;
+  if(heap_index != TimerHeapSize)
+  {
+    /**
+     * The last Timer of the heap takes the place of the removed one
+     */
+    last_id = aTimerHeap[TimerHeapSize];
+    if((heap_index != 0) && TIME_BEFORE(aTimerContext[last_id].Expiry, aTimerContext[aTimerHeap[(heap_index - 1) >> 1]].Expiry))
+    {
+      HeapMoveUp(heap_index, last_id);
+    }
+    else
+    {
+      HeapMoveDown(heap_index, last_id);
+    }
+  }
+
+  if(heap_index == 0)
+  {
+    PreviousRunningTimerID = CurrentRunningTimerID;
+    if(TimerHeapSize == 0)
+    {
+      CurrentRunningTimerID = CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER;
+    }
+    else
+    {
+      CurrentRunningTimerID = aTimerHeap[0];
+    }
+  }
+
+  /**
+   * Timer is out of the heap
+   */
+  aTimerContext[TimerID].TimerIDStatus = TimerID_Created;
+
+  if((CurrentRunningTimerID == CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER) && (RequestReadSSR == SSR_Read_Requested))
+  {
+    SSRValueOnLastSetup = SSR_FORBIDDEN_VALUE;
+  }
+
+  return;
+}
+#else
 /**
  * @brief  Insert a Timer in the list after the Timer ID specified
  * @param  TimerID:   The ID of the Timer
@@ -283,6 +567,8 @@ static void UnlinkTimer(uint8_t TimerID, RequestReadSSR_t RequestReadSSR)
   return;
 }
 
+#endif
+
 /**
  * @brief  Return the number of ticks counted by the wakeuptimer since it has been started
  * @note  The API is reading the SSR register to get how many ticks have been counted
@@ -337,7 +623,7 @@ static void RestartWakeupCounter(uint16_t Value)
   /**
    * The wakeuptimer has been disabled in the calling function to reduce the time to poll the WUTWF
    * FLAG when the new value will have to be written
-   *  __HAL_RTC_WAKEUPTIMER_DISABLE(phrtc);
+   *  HW_TS_RTC_WAKEUPTIMER_DISABLE();
    */
 
   if(Value == 0)
@@ -347,7 +633,7 @@ static void RestartWakeupCounter(uint16_t Value)
     /**
      * Simulate that the Timer expired
      */
-    HAL_NVIC_SetPendingIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);
+    HW_TS_NVIC_SET_PENDING();
   }
   else
   {
@@ -356,7 +642,7 @@ static void RestartWakeupCounter(uint16_t Value)
       Value -= 1;
     }
 
-    while(__HAL_RTC_WAKEUPTIMER_GET_FLAG(phrtc, RTC_FLAG_WUTWF) == RESET);
+    while(HW_TS_RTC_GET_FLAG_WUTWF() == RESET);
 
     /**
      * make sure to clear the flags after checking the WUTWF.
@@ -365,18 +651,18 @@ static void RestartWakeupCounter(uint16_t Value)
      * Otherwise, when the timer is periodic with 1 Tick, it may generate an extra interrupt in between
      * due to the autoreload feature
      */
-    __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(phrtc, RTC_FLAG_WUTF);   /**<  Clear flag in RTC module */
-    __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module */
-    HAL_NVIC_ClearPendingIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);   /**<  Clear pending bit in NVIC */
+    HW_TS_RTC_CLEAR_FLAG_WUTF();   /**<  Clear flag in RTC module */
+    HW_TS_RTC_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module */
+    HW_TS_NVIC_CLEAR_PENDING();   /**<  Clear pending bit in NVIC */
 
-    MODIFY_REG(RTC->WUTR, RTC_WUTR_WUT, Value);
+    HW_TS_RTC_WRITE_WUT(Value);
 
     /**
      * Update the value here after the WUTWF polling that may take some time
      */
     SSRValueOnLastSetup = ReadRtcSsrValue();
 
-    __HAL_RTC_WAKEUPTIMER_ENABLE(phrtc);    /**<  Enable the Wakeup Timer */
+    HW_TS_RTC_WAKEUPTIMER_ENABLE();    /**<  Enable the Wakeup Timer */
 
     HW_TS_RTC_CountUpdated_AppNot();
   }
@@ -402,17 +688,49 @@ static void RescheduleTimerList(void)
    * The wakeuptimer is disabled now to reduce the time to poll the WUTWF
    * FLAG when the new value will have to be written
    */
-  if((READ_BIT(RTC->CR, RTC_CR_WUTE) == (RTC_CR_WUTE)) == SET)
+  if((HW_TS_RTC_READ_WUTE() == (RTC_CR_WUTE)) == SET)
   {
     /**
      * Wait for the flag to be back to 0 when the wakeup timer is enabled
      */
-    while(__HAL_RTC_WAKEUPTIMER_GET_FLAG(phrtc, RTC_FLAG_WUTWF) == SET);
+    while(HW_TS_RTC_GET_FLAG_WUTWF() == SET);
   }
-  __HAL_RTC_WAKEUPTIMER_DISABLE(phrtc);   /**<  Disable the Wakeup Timer */
+  HW_TS_RTC_WAKEUPTIMER_DISABLE();   /**<  Disable the Wakeup Timer */
 
   localTimerID = CurrentRunningTimerID;
 
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+  /**
+   * Read how much has been counted and move the time origin to now
+   * The expiry times are absolute, there is no count to update in the running timers
+   */
+  time_elapsed = ReturnTimeElapsed();
+  TimeOrigin += time_elapsed;
+
+  if(TIME_BEFORE(TimeOrigin, aTimerContext[localTimerID].Expiry))
+  {
+    timecountleft = aTimerContext[localTimerID].Expiry - TimeOrigin;
+  }
+  else
+  {
+    timecountleft = 0;
+  }
+
+  if(timecountleft > MaxWakeupTimerSetup)
+  {
+    /**
+     * The number of tick left is greater than the Wakeuptimer maximum value
+     */
+    wakeup_timer_value = MaxWakeupTimerSetup;
+
+    WakeupTimerLimitation = WakeupTimerValue_Overpassed;
+  }
+  else
+  {
+    wakeup_timer_value = (uint16_t)timecountleft;
+    WakeupTimerLimitation = WakeupTimerValue_LargeEnough;
+  }
+#else
   /**
    * Calculate what will be the value to write in the wakeuptimer
    */
@@ -466,6 +784,8 @@ static void RescheduleTimerList(void)
     localTimerID = aTimerContext[localTimerID].NextID;
   }
 
+#endif
+
   /**
    * Write next count
    */
@@ -498,14 +818,14 @@ void HW_TS_RTC_Wakeup_Handler(void)
 #endif
 
 /* Disable the write protection for RTC registers */
-  __HAL_RTC_WRITEPROTECTION_DISABLE( phrtc );
+  HW_TS_RTC_WRITEPROTECTION_DISABLE();
 
   /**
    * Disable the Wakeup Timer
    * This may speed up a bit the processing to wait the timer to be disabled
    * The timer is still counting 2 RTCCLK
    */
-  __HAL_RTC_WAKEUPTIMER_DISABLE(phrtc);
+  HW_TS_RTC_WAKEUPTIMER_DISABLE();
 
   local_current_running_timer_id = CurrentRunningTimerID;
 
@@ -532,7 +852,7 @@ void HW_TS_RTC_Wakeup_Handler(void)
         HW_TS_Start(local_current_running_timer_id, aTimerContext[local_current_running_timer_id].CounterInit);
 
         /* Disable the write protection for RTC registers */
-        __HAL_RTC_WRITEPROTECTION_DISABLE( phrtc );
+        HW_TS_RTC_WRITEPROTECTION_DISABLE();
         }
       else
       {
@@ -542,7 +862,7 @@ void HW_TS_RTC_Wakeup_Handler(void)
         HW_TS_Stop(local_current_running_timer_id);
 
         /* Disable the write protection for RTC registers */
-        __HAL_RTC_WRITEPROTECTION_DISABLE( phrtc );
+        HW_TS_RTC_WRITEPROTECTION_DISABLE();
         }
 
       HW_TS_RTC_Int_AppNot(timer_process_id, local_current_running_timer_id, ptimer_callback);
@@ -562,7 +882,7 @@ void HW_TS_RTC_Wakeup_Handler(void)
      * However, if due to any bug in the timer server this is the case, the mistake may not impact the user.
      * We could just clean the interrupt flag and get out from this unexpected interrupt
      */
-    while(__HAL_RTC_WAKEUPTIMER_GET_FLAG(phrtc, RTC_FLAG_WUTWF) == RESET);
+    while(HW_TS_RTC_GET_FLAG_WUTWF() == RESET);
 
     /**
      * make sure to clear the flags after checking the WUTWF.
@@ -571,8 +891,8 @@ void HW_TS_RTC_Wakeup_Handler(void)
      * Otherwise, when the timer is periodic with 1 Tick, it may generate an extra interrupt in between
      * due to the autoreload feature
      */
-    __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(phrtc, RTC_FLAG_WUTF);   /**<  Clear flag in RTC module */
-    __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module */
+    HW_TS_RTC_CLEAR_FLAG_WUTF();   /**<  Clear flag in RTC module */
+    HW_TS_RTC_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module */
 
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
     __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
@@ -580,7 +900,7 @@ void HW_TS_RTC_Wakeup_Handler(void)
   }
 
   /* Enable the write protection for RTC registers */
-  __HAL_RTC_WRITEPROTECTION_ENABLE( phrtc );
+  HW_TS_RTC_WRITEPROTECTION_ENABLE();
 
   return;
 }
@@ -596,18 +916,18 @@ void HW_TS_Init(HW_TS_InitMode_t TimerInitMode, RTC_HandleTypeDef *hrtc)
   phrtc = hrtc;
 
  /* Disable the write protection for RTC registers */
-  __HAL_RTC_WRITEPROTECTION_DISABLE( phrtc );
+  HW_TS_RTC_WRITEPROTECTION_DISABLE();
 
-  SET_BIT(RTC->CR, RTC_CR_BYPSHAD);
+  HW_TS_RTC_BYPASS_SHADOW();
 
   /**
    * Readout the user config
    */
-  WakeupTimerDivider = (4 - ((uint32_t)(READ_BIT(RTC->CR, RTC_CR_WUCKSEL))));
+  WakeupTimerDivider = (4 - ((uint32_t)(HW_TS_RTC_READ_WUCKSEL())));
 
-  AsynchPrescalerUserConfig = (uint8_t)(READ_BIT(RTC->PRER, RTC_PRER_PREDIV_A) >> (uint32_t)POSITION_VAL(RTC_PRER_PREDIV_A)) + 1;
+  AsynchPrescalerUserConfig = (uint8_t)HW_TS_RTC_READ_PREDIV_A() + 1;
 
-  SynchPrescalerUserConfig = (uint16_t)(READ_BIT(RTC->PRER, RTC_PRER_PREDIV_S)) + 1;
+  SynchPrescalerUserConfig = (uint16_t)(HW_TS_RTC_READ_PREDIV_S()) + 1;
 
   /**
    *  Margin is taken to avoid wrong calculation when the wrap around is there and some
@@ -627,8 +947,8 @@ void HW_TS_Init(HW_TS_InitMode_t TimerInitMode, RTC_HandleTypeDef *hrtc)
   /**
    * Configure EXTI module
    */
-  LL_EXTI_EnableRisingTrig_0_31(RTC_EXTI_LINE_WAKEUPTIMER_EVENT);
-  LL_EXTI_EnableIT_0_31(RTC_EXTI_LINE_WAKEUPTIMER_EVENT);
+  HW_TS_EXTI_ENABLE_RISING_TRIG();
+  HW_TS_EXTI_ENABLE_IT();
 
   if(TimerInitMode == hw_ts_InitMode_Full)
   {
@@ -644,34 +964,42 @@ void HW_TS_Init(HW_TS_InitMode_t TimerInitMode, RTC_HandleTypeDef *hrtc)
     }
 
     CurrentRunningTimerID = CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER;   /**<  Set ID to non valid value */
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+    TimerHeapSize = 0;
+#endif
 
-    __HAL_RTC_WAKEUPTIMER_DISABLE(phrtc);                       /**<  Disable the Wakeup Timer */
-    __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(phrtc, RTC_FLAG_WUTF);     /**<  Clear flag in RTC module */
-    __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module  */
-    HAL_NVIC_ClearPendingIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);       /**<  Clear pending bit in NVIC  */
-    __HAL_RTC_WAKEUPTIMER_ENABLE_IT(phrtc, RTC_IT_WUT);         /**<  Enable interrupt in RTC module  */
+    HW_TS_RTC_WAKEUPTIMER_DISABLE();                       /**<  Disable the Wakeup Timer */
+    HW_TS_RTC_CLEAR_FLAG_WUTF();     /**<  Clear flag in RTC module */
+    HW_TS_RTC_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module  */
+    HW_TS_NVIC_CLEAR_PENDING();       /**<  Clear pending bit in NVIC  */
+    HW_TS_RTC_WAKEUPTIMER_ENABLE_IT();         /**<  Enable interrupt in RTC module  */
   }
   else
   {
-    if(__HAL_RTC_WAKEUPTIMER_GET_FLAG(phrtc, RTC_FLAG_WUTF) != RESET)
+    if(HW_TS_RTC_GET_FLAG_WUTF() != RESET)
     {
       /**
        * Simulate that the Timer expired
        */
-      HAL_NVIC_SetPendingIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);
+      HW_TS_NVIC_SET_PENDING();
     }
   }
 
   /* Enable the write protection for RTC registers */
-  __HAL_RTC_WRITEPROTECTION_ENABLE( phrtc );
+  HW_TS_RTC_WRITEPROTECTION_ENABLE();
 
-  HAL_NVIC_SetPriority(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID, CFG_HW_TS_NVIC_RTC_WAKEUP_IT_PREEMPTPRIO, CFG_HW_TS_NVIC_RTC_WAKEUP_IT_SUBPRIO);   /**<  Set NVIC priority */
-  HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID); /**<  Enable NVIC */
+  HW_TS_NVIC_SET_PRIORITY();   /**<  Set NVIC priority */
+  HW_TS_NVIC_ENABLE(); /**<  Enable NVIC */
 
   return;
 }
 
 HW_TS_ReturnStatus_t HW_TS_Create(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pftimeout_handler)
+{
+  return HW_TS_CreateWithSlack(TimerProcessID, pTimerId, TimerMode, pftimeout_handler, 0);
+}
+
+HW_TS_ReturnStatus_t HW_TS_CreateWithSlack(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pftimeout_handler, uint32_t SlackTicks)
 {
   HW_TS_ReturnStatus_t localreturnstatus;
   uint8_t loop = 0;
@@ -700,6 +1028,11 @@ HW_TS_ReturnStatus_t HW_TS_Create(uint32_t TimerProcessID, uint8_t *pTimerId, HW
     aTimerContext[loop].TimerProcessID = TimerProcessID;
     aTimerContext[loop].TimerMode = TimerMode;
     aTimerContext[loop].pTimerCallBack = pftimeout_handler;
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+    aTimerContext[loop].Slack = SlackTicks;
+#else
+    (void)SlackTicks;
+#endif
     *pTimerId = loop;
 
     localreturnstatus = hw_ts_Successful;
@@ -738,10 +1071,10 @@ void HW_TS_Stop(uint8_t timer_id)
   __disable_irq();          /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
 #endif
 
-  HAL_NVIC_DisableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);    /**<  Disable NVIC */
+  HW_TS_NVIC_DISABLE();    /**<  Disable NVIC */
 
   /* Disable the write protection for RTC registers */
-  __HAL_RTC_WRITEPROTECTION_DISABLE( phrtc );
+  HW_TS_RTC_WRITEPROTECTION_DISABLE();
 
   if(aTimerContext[timer_id].TimerIDStatus == TimerID_Running)
   {
@@ -757,16 +1090,16 @@ void HW_TS_Stop(uint8_t timer_id)
       /**
        * Disable the timer
        */
-      if((READ_BIT(RTC->CR, RTC_CR_WUTE) == (RTC_CR_WUTE)) == SET)
+      if((HW_TS_RTC_READ_WUTE() == (RTC_CR_WUTE)) == SET)
       {
         /**
          * Wait for the flag to be back to 0 when the wakeup timer is enabled
          */
-        while(__HAL_RTC_WAKEUPTIMER_GET_FLAG(phrtc, RTC_FLAG_WUTWF) == SET);
+        while(HW_TS_RTC_GET_FLAG_WUTWF() == SET);
       }
-      __HAL_RTC_WAKEUPTIMER_DISABLE(phrtc);   /**<  Disable the Wakeup Timer */
+      HW_TS_RTC_WAKEUPTIMER_DISABLE();   /**<  Disable the Wakeup Timer */
 
-      while(__HAL_RTC_WAKEUPTIMER_GET_FLAG(phrtc, RTC_FLAG_WUTWF) == RESET);
+      while(HW_TS_RTC_GET_FLAG_WUTWF() == RESET);
 
       /**
        * make sure to clear the flags after checking the WUTWF.
@@ -775,9 +1108,9 @@ void HW_TS_Stop(uint8_t timer_id)
        * Otherwise, when the timer is periodic with 1 Tick, it may generate an extra interrupt in between
        * due to the autoreload feature
        */
-      __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(phrtc, RTC_FLAG_WUTF);   /**<  Clear flag in RTC module */
-      __HAL_RTC_WAKEUPTIMER_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module */
-      HAL_NVIC_ClearPendingIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);   /**<  Clear pending bit in NVIC */
+      HW_TS_RTC_CLEAR_FLAG_WUTF();   /**<  Clear flag in RTC module */
+      HW_TS_RTC_EXTI_CLEAR_FLAG(); /**<  Clear flag in EXTI module */
+      HW_TS_NVIC_CLEAR_PENDING();   /**<  Clear pending bit in NVIC */
     }
     else if(PreviousRunningTimerID != localcurrentrunningtimerid)
     {
@@ -786,9 +1119,9 @@ void HW_TS_Stop(uint8_t timer_id)
   }
 
   /* Enable the write protection for RTC registers */
-  __HAL_RTC_WRITEPROTECTION_ENABLE( phrtc );
+  HW_TS_RTC_WRITEPROTECTION_ENABLE();
 
-  HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID); /**<  Enable NVIC */
+  HW_TS_NVIC_ENABLE(); /**<  Enable NVIC */
 
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
@@ -799,7 +1132,9 @@ void HW_TS_Stop(uint8_t timer_id)
 
 void HW_TS_Start(uint8_t timer_id, uint32_t timeout_ticks)
 {
+#if (CFG_HW_TS_USE_HEAP_ENGINE != 1)
   uint16_t time_elapsed;
+#endif
   uint8_t localcurrentrunningtimerid;
 
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
@@ -816,13 +1151,28 @@ void HW_TS_Start(uint8_t timer_id, uint32_t timeout_ticks)
   __disable_irq();          /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
 #endif
 
-  HAL_NVIC_DisableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID);    /**<  Disable NVIC */
+  HW_TS_NVIC_DISABLE();    /**<  Disable NVIC */
 
   /* Disable the write protection for RTC registers */
-  __HAL_RTC_WRITEPROTECTION_DISABLE( phrtc );
+  HW_TS_RTC_WRITEPROTECTION_DISABLE();
 
   aTimerContext[timer_id].TimerIDStatus = TimerID_Running;
 
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+  aTimerContext[timer_id].CounterInit = timeout_ticks;
+
+  linkTimer(timer_id);
+
+  localcurrentrunningtimerid = CurrentRunningTimerID;
+
+  /**
+   * The wakeup timer is only written again when the new timer is the first to expire
+   */
+  if(PreviousRunningTimerID != localcurrentrunningtimerid)
+  {
+    RescheduleTimerList();
+  }
+#else
   aTimerContext[timer_id].CountLeft = timeout_ticks;
   aTimerContext[timer_id].CounterInit = timeout_ticks;
 
@@ -838,11 +1188,12 @@ void HW_TS_Start(uint8_t timer_id, uint32_t timeout_ticks)
   {
     aTimerContext[timer_id].CountLeft -= time_elapsed;
   }
+#endif
 
   /* Enable the write protection for RTC registers */
-  __HAL_RTC_WRITEPROTECTION_ENABLE( phrtc );
+  HW_TS_RTC_WRITEPROTECTION_ENABLE();
 
-  HAL_NVIC_EnableIRQ(CFG_HW_TS_RTC_WAKEUP_HANDLER_ID); /**<  Enable NVIC */
+  HW_TS_NVIC_ENABLE(); /**<  Enable NVIC */
 
 #if (CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION == 1)
   __set_PRIMASK(primask_bit); /**< Restore PRIMASK bit*/
@@ -859,9 +1210,9 @@ uint16_t HW_TS_RTC_ReadLeftTicksToCount(void)
   primask_bit = __get_PRIMASK();  /**< backup PRIMASK bit */
   __disable_irq();                /**< Disable all interrupts by setting PRIMASK bit on Cortex*/
 
-  if((READ_BIT(RTC->CR, RTC_CR_WUTE) == (RTC_CR_WUTE)) == SET)
+  if((HW_TS_RTC_READ_WUTE() == (RTC_CR_WUTE)) == SET)
   {
-    auro_reload_value = (uint32_t)(READ_BIT(RTC->WUTR, RTC_WUTR_WUT));
+    auro_reload_value = (uint32_t)(HW_TS_RTC_READ_WUT());
 
     elapsed_time_value = ReturnTimeElapsed();
 
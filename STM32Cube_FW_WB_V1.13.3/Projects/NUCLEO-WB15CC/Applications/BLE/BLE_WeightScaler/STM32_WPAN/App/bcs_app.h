@@ -48,7 +48,7 @@ extern "C"
 /* USER CODE END EM */
 
 /* Exported functions prototypes ---------------------------------------------*/
-void BCSAPP_Reset(void);
+void BCSAPP_Reset(uint16_t ConnectionHandle);
 void BCSAPP_Init(void);
 
 void BCSAPP_RemoveFeature(uint16_t feature);
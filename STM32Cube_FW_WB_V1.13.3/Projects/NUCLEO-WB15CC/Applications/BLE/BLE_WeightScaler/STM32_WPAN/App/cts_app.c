@@ -19,6 +19,8 @@
 /* USER CODE END Header */
 
 /* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
 #include "app_common.h"
 
 #include "dbg_trace.h"
@@ -28,6 +30,7 @@
 #include "stm32_seq.h"
 #include "cts.h"
 #include "cts_app.h"
+#include "time_base.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
@@ -44,8 +47,7 @@
 typedef struct{
 	CTS_Ch_t cts_ch;
 
-	uint8_t notify_status;
-	uint32_t StartTick;
+	uint8_t notify_status[CFG_BLE_NUM_LINK]; /* per link, indexed by APP_BLE_Get_Link_Index() */
 } CTSAPP_Context_t;
 
 /* USER CODE BEGIN PTD */
@@ -53,14 +55,6 @@ typedef struct{
 /* USER CODE END PTD */
 
 /* Private macros -------------------------------------------------------------*/
-#define DEFAULT_CTS_DATE_TIME_YEAR                                         2022
-#define DEFAULT_CTS_DATE_TIME_MONTH                                           7
-#define DEFAULT_CTS_DATE_TIME_DAY                                            29
-#define DEFAULT_CTS_DATE_TIME_HOURS                                           0
-#define DEFAULT_CTS_DATE_TIME_MINUTES                                         0
-#define DEFAULT_CTS_DATE_TIME_SECONDS                                         0
-#define DEFAULT_CTS_DAY_OF_WEEK                                               5 /* Friday */
-#define DEFAULT_CTS_FRACTION256                                               0
 #define DEFAULT_ADJUST_REASON                        CTS_ADJUST_REASON_RESERVED
 
 /* USER CODE BEGIN PM */
@@ -76,6 +70,8 @@ static CTSAPP_Context_t CTSAPP_Context;
 
 /* Private function prototypes -----------------------------------------------*/
 static void cts_notify(void);
+static void cts_set_time(const CTS_Ch_t *pCurrentTime);
+static SVCCTL_EvtAckStatus_t CTSAPP_Disconnection(void *pEvt);
 
 /* USER CODE BEGIN PFP */
 
@@ -84,61 +80,102 @@ static void cts_notify(void);
 /* Functions Definition ------------------------------------------------------*/
 /* Static functions ----------------------------------------------------------*/
 static void cts_notify(void){
-	uint32_t seconds;
-	uint8_t minutes;
-	uint8_t hours;
+	TIMEBASE_DateTime_t date_time;
+	uint8_t link;
+
+	/* the notification is sent to every link which has enabled it */
+	for(link = 0; link < CFG_BLE_NUM_LINK; link++){
+		if(CTSAPP_Context.notify_status[link] != 0){
+			break;
+		}
+	}
 
-	APP_DBG_MSG("CTS Notify (Tick = %ld, enabled = %d)\n\r", HAL_GetTick(), CTSAPP_Context.notify_status );
+	APP_DBG_MSG("CTS Notify (Tick = %ld, enabled = %d)\n\r", HAL_GetTick(), (link < CFG_BLE_NUM_LINK) );
 
-	if(CTSAPP_Context.notify_status == 0){
+	if(link == CFG_BLE_NUM_LINK){
 		return;
 	}
 
-	/* day date time */
-	/*   we keep content of year, month, date, day of week in this application demo */
-	seconds = (HAL_GetTick() - CTSAPP_Context.StartTick) / 1000;
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Seconds = seconds % 60;
-	minutes = seconds / 60;
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Minutes = minutes % 60;
-	hours = minutes / 24;
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Minutes = hours % 24;
+	/* day date time, converted from the time base when the characteristic is updated */
+	TIMEBASE_ToDateTime(TIMEBASE_Get(&(CTSAPP_Context.cts_ch.exact_time_256.fractions256)), &date_time);
+	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Year = date_time.Year;
+	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Month = date_time.Month;
+	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Day = date_time.Day;
+	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Hours = date_time.Hours;
+	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Minutes = date_time.Minutes;
+	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Seconds = date_time.Seconds;
+	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.day_of_week = date_time.DayOfWeek;
+
+	/* the adjust reason is the one of the last time update */
+	CTS_Update_Char(CURRENT_TIME_CHAR_UUID, (uint8_t*)&(CTSAPP_Context.cts_ch));
+}
+
+static void cts_set_time(const CTS_Ch_t *pCurrentTime){
+	TIMEBASE_DateTime_t date_time;
+
+	date_time.Year = pCurrentTime->exact_time_256.day_date_time.date_time.Year;
+	date_time.Month = pCurrentTime->exact_time_256.day_date_time.date_time.Month;
+	date_time.Day = pCurrentTime->exact_time_256.day_date_time.date_time.Day;
+	date_time.Hours = pCurrentTime->exact_time_256.day_date_time.date_time.Hours;
+	date_time.Minutes = pCurrentTime->exact_time_256.day_date_time.date_time.Minutes;
+	date_time.Seconds = pCurrentTime->exact_time_256.day_date_time.date_time.Seconds;
 
-	/* adjust reason */
+	APP_DBG_MSG("CTS Set Time %d-%02d-%02d %02d:%02d:%02d\n\r", date_time.Year, date_time.Month, date_time.Day,
+			date_time.Hours, date_time.Minutes, date_time.Seconds);
+
+	if((date_time.Year < TIMEBASE_YEAR_MIN) || (date_time.Year > TIMEBASE_YEAR_MAX)){
+		return;
+	}
+
+	TIMEBASE_Set(TIMEBASE_FromDateTime(&date_time), pCurrentTime->exact_time_256.fractions256);
 	CTSAPP_Context.cts_ch.adjust_reason = CTS_ADJUST_MANUAL_TIME_UPDATE;
 
-	CTS_Update_Char(CURRENT_TIME_CHAR_UUID, (uint8_t*)&(CTSAPP_Context.cts_ch));
+	/* the clients are told about the new time */
+	UTIL_SEQ_SetTask(1 << CFG_TASK_CTS_NOTIFY_ID, CFG_SCH_PRIO_0);
 }
 
 /* Public functions ----------------------------------------------------------*/
 
-void CTSAPP_Reset(void){
-	APP_DBG_MSG("CTSAPP_Reset\n\r");
+void CTSAPP_Reset(uint16_t ConnectionHandle){
+	uint8_t link;
+
+	APP_DBG_MSG("CTSAPP_Reset 0x%x\n\r", ConnectionHandle);
 
-	/* Reset Context */
-	CTSAPP_Context.notify_status = 0; /* disable */
+	/* Reset Context of the link */
+	link = APP_BLE_Get_Link_Index(ConnectionHandle);
+	if(link < CFG_BLE_NUM_LINK){
+		CTSAPP_Context.notify_status[link] = 0; /* disable */
+	}
 }
 
-void CTSAPP_Init(void)
+static SVCCTL_EvtAckStatus_t CTSAPP_Disconnection(void *pEvt)
 {
-	APP_DBG_MSG("CTSAPP_Init\n\r");
+	CTSAPP_Reset(((hci_disconnection_complete_event_rp0 *)pEvt)->Connection_Handle);
 
-	/* initialize Context */
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Year = DEFAULT_CTS_DATE_TIME_YEAR;
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Month = DEFAULT_CTS_DATE_TIME_MONTH;
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Day = DEFAULT_CTS_DATE_TIME_DAY;
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Hours = DEFAULT_CTS_DATE_TIME_HOURS;
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Minutes = DEFAULT_CTS_DATE_TIME_MINUTES;
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.date_time.Seconds = DEFAULT_CTS_DATE_TIME_SECONDS;
+	return SVCCTL_EvtNotAck;
+}
 
-	CTSAPP_Context.cts_ch.exact_time_256.day_date_time.day_of_week = DEFAULT_CTS_DAY_OF_WEEK;
+void CTSAPP_Init(void)
+{
+	uint8_t link;
 
-	CTSAPP_Context.cts_ch.exact_time_256.fractions256 = DEFAULT_CTS_FRACTION256; /* The number of 1/256 fractions of a second. Valid range 0–255 */
+	APP_DBG_MSG("CTSAPP_Init\n\r");
 
-	CTSAPP_Context.cts_ch.adjust_reason = DEFAULT_ADJUST_REASON;
+	/*
+	 * The context of a link is reset on its disconnection
+	 */
+	if (SVCCTL_SubscribeEvt(HCI_DISCONNECTION_COMPLETE_EVT_CODE, 0, CTSAPP_Disconnection) != BLE_STATUS_SUCCESS)
+	{
+		/* BLE_CFG_EVT_MAX_NBR_SUBSCRIBER is too small */
+		Error_Handler();
+	}
 
-	CTSAPP_Context.notify_status = 0; /* disable */
+	/* initialize Context, the time itself is kept by the time base */
+	CTSAPP_Context.cts_ch.adjust_reason = DEFAULT_ADJUST_REASON;
 
-	CTSAPP_Context.StartTick = HAL_GetTick();
+	for(link = 0; link < CFG_BLE_NUM_LINK; link++){
+		CTSAPP_Context.notify_status[link] = 0; /* disable */
+	}
 
 	/*
 	* Register task for Current Time Notify
@@ -147,12 +184,22 @@ void CTSAPP_Init(void)
 }
 
 void CTS_App_Notification(CTS_App_Notification_evt_t * pNotification){
+	uint8_t link;
+
+	link = APP_BLE_Get_Link_Index(pNotification->ConnectionHandle);
+	if(link == CFG_BLE_NUM_LINK){
+		return;
+	}
+
 	switch(pNotification->CTS_Evt_Opcode){
 	case CTS_NOTIFY_DISABLED_EVT:
-		CTSAPP_Context.notify_status = 0; /* disable */
+		CTSAPP_Context.notify_status[link] = 0; /* disable */
 		break;
 	case CTS_NOTIFY_ENABLED_EVT:
-		CTSAPP_Context.notify_status = 1; /* enable */
+		CTSAPP_Context.notify_status[link] = 1; /* enable */
+		break;
+	case CTS_CURRENT_TIME_WRITE_EVT:
+		cts_set_time(&(pNotification->CurrentTime));
 		break;
 	default:
 		/* do nothing */
@@ -0,0 +1,316 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    time_base.c
+  * @author  MCD Application Team
+  * @brief   Wall clock shared by WSS, BCS and CTS, kept by the RTC
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+
+#include "dbg_trace.h"
+#include "time_base.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * The time is kept as a single count of RTC ticks since 1970-01-01 00:00:00,
+ * the offset to add to the RTC reading. The RTC is never written: the Timer
+ * Server measures the elapsed time with the sub-second register.
+ * The offset is saved in the RTC backup registers so that the time survives
+ * a reset as long as the backup domain is kept.
+ */
+typedef struct{
+  uint64_t Offset;
+} TIMEBASE_Context_t;
+
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private defines ------------------------------------------------------------*/
+/**
+ * Rate of the RTC sub-second counter
+ */
+#define TIMEBASE_TICK_FREQ                 (LSE_VALUE / (CFG_RTC_ASYNCH_PRESCALER + 1))
+
+/**
+ * Ticks of the RTC sub-second counter per RTC calendar second
+ * The calendar counts real seconds only when CFG_RTC_SYNCH_PRESCALER + 1 is TIMEBASE_TICK_FREQ
+ */
+#define TIMEBASE_TICK_PER_RTC_SECOND       ((uint32_t)CFG_RTC_SYNCH_PRESCALER + 1)
+
+#define TIMEBASE_SECONDS_PER_DAY           (86400UL)
+
+/**
+ * Backup registers holding the offset
+ */
+#define TIMEBASE_BKP_OFFSET_LOW            LL_RTC_BKP_DR0
+#define TIMEBASE_BKP_OFFSET_HIGH           LL_RTC_BKP_DR1
+#define TIMEBASE_BKP_MAGIC                 LL_RTC_BKP_DR2
+#define TIMEBASE_MAGIC                     (0x54494D45UL)
+
+/**
+ * Time used until a collector sets it
+ */
+#define TIMEBASE_DEFAULT_YEAR                                               2022
+#define TIMEBASE_DEFAULT_MONTH                                                 7
+#define TIMEBASE_DEFAULT_DAY                                                  29
+#define TIMEBASE_DEFAULT_HOURS                                                 0
+#define TIMEBASE_DEFAULT_MINUTES                                               0
+#define TIMEBASE_DEFAULT_SECONDS                                               0
+
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macros -------------------------------------------------------------*/
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+static TIMEBASE_Context_t TIMEBASE_Context;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t TimeBase_DaysFromCivil(uint32_t year, uint32_t month, uint32_t day);
+static uint64_t TimeBase_RtcTicks(void);
+static void TimeBase_Save(void);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Functions Definition ------------------------------------------------------*/
+/**
+ * @brief  Number of days from 1970-01-01 to a date of the proleptic Gregorian calendar
+ *         The year is counted from March so that the leap day ends it
+ * @param  year: year, from 1970
+ * @param  month: month, from 1 to 12
+ * @param  day: day of the month, from 1
+ * @retval Number of days
+ */
+static uint32_t TimeBase_DaysFromCivil(uint32_t year, uint32_t month, uint32_t day)
+{
+  uint32_t era;
+  uint32_t year_of_era;
+  uint32_t day_of_year;
+  uint32_t day_of_era;
+
+  if(month <= 2)
+  {
+    year--;
+  }
+  era = year / 400;
+  year_of_era = year - (era * 400);
+  day_of_year = (((153 * ((month > 2) ? (month - 3) : (month + 9))) + 2) / 5) + day - 1;
+  day_of_era = (year_of_era * 365) + (year_of_era / 4) - (year_of_era / 100) + day_of_year;
+
+  return (era * 146097) + day_of_era - 719468;
+}
+
+/**
+ * @brief  Read the RTC as a count of sub-second ticks
+ *         The calendar registers are read until they hold together with the sub-second register
+ * @param  None
+ * @retval RTC ticks since 1970-01-01 00:00:00 of the RTC calendar
+ */
+static uint64_t TimeBase_RtcTicks(void)
+{
+  uint32_t ssr;
+  uint32_t tr;
+  uint32_t dr;
+  uint32_t seconds;
+
+  do
+  {
+    ssr = LL_RTC_TIME_GetSubSecond(RTC);
+    tr = LL_RTC_TIME_Get(RTC);
+    dr = LL_RTC_DATE_Get(RTC);
+  } while((ssr != LL_RTC_TIME_GetSubSecond(RTC)) || (tr != LL_RTC_TIME_Get(RTC)) || (dr != LL_RTC_DATE_Get(RTC)));
+
+  seconds = TimeBase_DaysFromCivil(2000 + __LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_YEAR(dr)),
+                                   __LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_MONTH(dr)),
+                                   __LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_DAY(dr))) * TIMEBASE_SECONDS_PER_DAY;
+  seconds += (__LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_HOUR(tr)) * 3600) +
+             (__LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_MINUTE(tr)) * 60) +
+             __LL_RTC_CONVERT_BCD2BIN(__LL_RTC_GET_SECOND(tr));
+
+  return ((uint64_t)seconds * TIMEBASE_TICK_PER_RTC_SECOND) + (CFG_RTC_SYNCH_PRESCALER - ssr);
+}
+
+static void TimeBase_Save(void)
+{
+  LL_RTC_BAK_SetRegister(RTC, TIMEBASE_BKP_MAGIC, 0);
+  LL_RTC_BAK_SetRegister(RTC, TIMEBASE_BKP_OFFSET_LOW, (uint32_t)TIMEBASE_Context.Offset);
+  LL_RTC_BAK_SetRegister(RTC, TIMEBASE_BKP_OFFSET_HIGH, (uint32_t)(TIMEBASE_Context.Offset >> 32));
+  LL_RTC_BAK_SetRegister(RTC, TIMEBASE_BKP_MAGIC, TIMEBASE_MAGIC);
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Restore the time kept across the reset, or start from the default time
+ * @param  None
+ * @retval None
+ */
+void TIMEBASE_Init(void)
+{
+  TIMEBASE_DateTime_t date_time;
+
+  if(LL_RTC_BAK_GetRegister(RTC, TIMEBASE_BKP_MAGIC) == TIMEBASE_MAGIC)
+  {
+    TIMEBASE_Context.Offset = ((uint64_t)LL_RTC_BAK_GetRegister(RTC, TIMEBASE_BKP_OFFSET_HIGH) << 32) |
+                              LL_RTC_BAK_GetRegister(RTC, TIMEBASE_BKP_OFFSET_LOW);
+    APP_DBG_MSG("TIMEBASE_Init: time restored, epoch = %ld\n\r", TIMEBASE_Get(NULL));
+  }
+  else
+  {
+    date_time.Year    = TIMEBASE_DEFAULT_YEAR;
+    date_time.Month   = TIMEBASE_DEFAULT_MONTH;
+    date_time.Day     = TIMEBASE_DEFAULT_DAY;
+    date_time.Hours   = TIMEBASE_DEFAULT_HOURS;
+    date_time.Minutes = TIMEBASE_DEFAULT_MINUTES;
+    date_time.Seconds = TIMEBASE_DEFAULT_SECONDS;
+    TIMEBASE_Set(TIMEBASE_FromDateTime(&date_time), 0);
+    APP_DBG_MSG("TIMEBASE_Init: default time, epoch = %ld\n\r", TIMEBASE_Get(NULL));
+  }
+}
+
+/**
+ * @brief  Current time
+ * @param  pFractions256: updated with the 1/256 fractions of the second, may be NULL
+ * @retval Seconds since 1970-01-01 00:00:00
+ */
+uint32_t TIMEBASE_Get(uint8_t *pFractions256)
+{
+  uint64_t ticks = TimeBase_RtcTicks() + TIMEBASE_Context.Offset;
+
+  if(pFractions256 != NULL)
+  {
+    *pFractions256 = (uint8_t)(((ticks % TIMEBASE_TICK_FREQ) * 256) / TIMEBASE_TICK_FREQ);
+  }
+
+  return (uint32_t)(ticks / TIMEBASE_TICK_FREQ);
+}
+
+/**
+ * @brief  Set the current time
+ * @param  Epoch: seconds since 1970-01-01 00:00:00
+ * @param  Fractions256: 1/256 fractions of the second
+ * @retval None
+ */
+void TIMEBASE_Set(uint32_t Epoch, uint8_t Fractions256)
+{
+  uint64_t ticks = ((uint64_t)Epoch * TIMEBASE_TICK_FREQ) + (((uint32_t)Fractions256 * TIMEBASE_TICK_FREQ) / 256);
+
+  /* The offset wraps around when the RTC calendar is ahead of the time */
+  TIMEBASE_Context.Offset = ticks - TimeBase_RtcTicks();
+  TimeBase_Save();
+}
+
+/**
+ * @brief  Free running count of the RTC, it goes on in the Stop modes and is not changed by TIMEBASE_Set()
+ *         It wraps around, two counts are compared by their difference
+ * @param  None
+ * @retval Ticks of TIMEBASE_TICK_FREQ
+ */
+uint32_t TIMEBASE_GetTicks(void)
+{
+  return (uint32_t)TimeBase_RtcTicks();
+}
+
+/**
+ * @brief  Convert a duration to ticks of TIMEBASE_GetTicks(), rounded up
+ * @param  Ms: duration in ms
+ * @retval Ticks of TIMEBASE_TICK_FREQ
+ */
+uint32_t TIMEBASE_MsToTicks(uint32_t Ms)
+{
+  return (uint32_t)((((uint64_t)Ms * TIMEBASE_TICK_FREQ) + 999) / 1000);
+}
+
+/**
+ * @brief  Convert ticks of TIMEBASE_GetTicks() to a duration, rounded up
+ * @param  Ticks: ticks of TIMEBASE_TICK_FREQ
+ * @retval Duration in ms
+ */
+uint32_t TIMEBASE_TicksToMs(uint32_t Ticks)
+{
+  return (uint32_t)((((uint64_t)Ticks * 1000) + TIMEBASE_TICK_FREQ - 1) / TIMEBASE_TICK_FREQ);
+}
+
+/**
+ * @brief  Convert a time to its calendar form
+ * @param  Epoch: seconds since 1970-01-01 00:00:00
+ * @param  pDateTime: updated with the date and time
+ * @retval None
+ */
+void TIMEBASE_ToDateTime(uint32_t Epoch, TIMEBASE_DateTime_t *pDateTime)
+{
+  uint32_t days = Epoch / TIMEBASE_SECONDS_PER_DAY;
+  uint32_t seconds = Epoch % TIMEBASE_SECONDS_PER_DAY;
+  uint32_t era;
+  uint32_t day_of_era;
+  uint32_t year_of_era;
+  uint32_t day_of_year;
+  uint32_t month_from_march;
+
+  pDateTime->Hours   = (uint8_t)(seconds / 3600);
+  pDateTime->Minutes = (uint8_t)((seconds / 60) % 60);
+  pDateTime->Seconds = (uint8_t)(seconds % 60);
+
+  /* 1970-01-01 is a Thursday */
+  pDateTime->DayOfWeek = (uint8_t)(((days + 3) % 7) + 1);
+
+  /**
+   * Inverse of TimeBase_DaysFromCivil(), the year is counted from March
+   */
+  days += 719468;
+  era = days / 146097;
+  day_of_era = days - (era * 146097);
+  year_of_era = (day_of_era - (day_of_era / 1460) + (day_of_era / 36524) - (day_of_era / 146096)) / 365;
+  day_of_year = day_of_era - ((365 * year_of_era) + (year_of_era / 4) - (year_of_era / 100));
+  month_from_march = ((5 * day_of_year) + 2) / 153;
+
+  pDateTime->Day   = (uint8_t)(day_of_year - (((153 * month_from_march) + 2) / 5) + 1);
+  pDateTime->Month = (uint8_t)((month_from_march < 10) ? (month_from_march + 3) : (month_from_march - 9));
+  pDateTime->Year  = (uint16_t)(year_of_era + (era * 400) + ((pDateTime->Month <= 2) ? 1 : 0));
+}
+
+/**
+ * @brief  Convert a date and time to seconds since 1970-01-01 00:00:00
+ *         The day of week is ignored
+ * @param  pDateTime: date and time, from TIMEBASE_YEAR_MIN to TIMEBASE_YEAR_MAX
+ * @retval Seconds since 1970-01-01 00:00:00
+ */
+uint32_t TIMEBASE_FromDateTime(const TIMEBASE_DateTime_t *pDateTime)
+{
+  return (TimeBase_DaysFromCivil(pDateTime->Year, pDateTime->Month, pDateTime->Day) * TIMEBASE_SECONDS_PER_DAY) +
+         ((uint32_t)pDateTime->Hours * 3600) + ((uint32_t)pDateTime->Minutes * 60) + pDateTime->Seconds;
+}
+
+/* USER CODE BEGIN FD */
+
+/* USER CODE END FD */
@@ -0,0 +1,95 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    time_base.h
+  * @author  MCD Application Team
+  * @brief   Header for time_base.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TIME_BASE_H
+#define __TIME_BASE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+/* Exported types ------------------------------------------------------------*/
+/**
+ * Calendar form of the time, in the field order of the Date Time characteristic
+ * Day of week is 1 for Monday up to 7 for Sunday
+ */
+typedef struct{
+  uint16_t  Year;
+  uint8_t   Month;
+  uint8_t   Day;
+  uint8_t   Hours;
+  uint8_t   Minutes;
+  uint8_t   Seconds;
+  uint8_t   DayOfWeek;
+} TIMEBASE_DateTime_t;
+
+/* USER CODE BEGIN ET */
+
+/* USER CODE END ET */
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Range of the years the time base may be set to
+ */
+#define TIMEBASE_YEAR_MIN                  (1970)
+#define TIMEBASE_YEAR_MAX                  (2105)
+
+/* USER CODE BEGIN EC */
+
+/* USER CODE END EC */
+
+/* Exported macro ------------------------------------------------------------*/
+/* USER CODE BEGIN EM */
+
+/* USER CODE END EM */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void TIMEBASE_Init(void);
+uint32_t TIMEBASE_Get(uint8_t *pFractions256);
+void TIMEBASE_Set(uint32_t Epoch, uint8_t Fractions256);
+void TIMEBASE_ToDateTime(uint32_t Epoch, TIMEBASE_DateTime_t *pDateTime);
+uint32_t TIMEBASE_FromDateTime(const TIMEBASE_DateTime_t *pDateTime);
+uint32_t TIMEBASE_GetTicks(void);
+uint32_t TIMEBASE_MsToTicks(uint32_t Ms);
+uint32_t TIMEBASE_TicksToMs(uint32_t Ticks);
+/* USER CODE BEGIN EFP */
+
+/* USER CODE END EFP */
+
+/* Private defines -----------------------------------------------------------*/
+/* USER CODE BEGIN Private defines */
+
+/* USER CODE END Private defines */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__TIME_BASE_H */
+
+/* USER CODE END */
@@ -19,6 +19,8 @@
 /* USER CODE END Header */
 
 /* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
 #include "app_common.h"
 
 #include "dbg_trace.h"
@@ -28,6 +30,7 @@
 #include "stm32_seq.h"
 #include "uds.h"
 #include "uds_app.h"
+#include "uds_store.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
@@ -35,7 +38,7 @@
 /* USER CODE END Includes */
 
 /* Private defines ------------------------------------------------------------*/
-#define MAX_SIZE_USER_DATA             0x10  /* 0xFE */ /* decrease database size for limited RAM size on STM32WB15CC */
+#define MAX_SIZE_USER_DATA             CFG_UDS_MAX_NBR_USER
 #define MAX_CONSENT_CODE               0x270F /*9999*/
 
 #define INTERVAL_REGISTER_NEW_USER     (1000000/CFG_TS_TICK_VAL)  /**< 1s */
@@ -44,18 +47,26 @@
 
 #define MAXIMUM_CONSENT_TRIES          3
 
+/* bit (User Index - 1) of the map is set when the User Index is registered */
+#define USER_MAP_SIZE                  ((MAX_SIZE_USER_DATA + 31) / 32)
+
+#define UDS_USER_INDEX_ALL             0xFF  /* Delete User(s) parameter, all the users */
+
+#if ((MAX_SIZE_USER_DATA < 1) || (MAX_SIZE_USER_DATA > 0xFE))
+#error "CFG_UDS_MAX_NBR_USER shall be in the User Index range, 1 to 254"
+#endif
 
 /* USER CODE BEGIN PD */
 
 /* USER CODE END PD */
 
 /* Private typedef -----------------------------------------------------------*/
+/* one array per field, the table is 6 bytes per user without padding */
 typedef struct {
-	uint8_t user_index;
-	uint16_t consent_code;
-	uint16_t height;
-	uint16_t weight;
-} UDSAPP_UserData_t;
+	uint16_t consent_code[MAX_SIZE_USER_DATA];
+	uint16_t height[MAX_SIZE_USER_DATA];
+	uint16_t weight[MAX_SIZE_USER_DATA];
+} UDSAPP_UserTable_t;
 
 typedef struct {
 	uint32_t tick;
@@ -69,22 +80,38 @@ typedef struct {
 	uint8_t tries;
 } UCP_Buffer_Consent_t;
 
+typedef struct {
+	uint32_t tick;
+	uint8_t op_code;      /* Delete User Data or Delete User(s) */
+	uint8_t user_index;   /* Delete User(s) parameter */
+} UCP_Buffer_DeleteUser_t;
+
+typedef struct {
+	UCP_Buffer_Consent_t buf_consent;
+	uint8_t user_data_access_permitted;
+	uint16_t indicationStatusUerControlPoint;
+} UDSAPP_Link_t;
+
 typedef struct{
-  UDSAPP_UserData_t user_data[MAX_SIZE_USER_DATA];
-  uint8_t user_data_size;
+  /* users, indexed by User Index - 1 */
+  UDSAPP_UserTable_t user_data;
+  uint32_t user_map[USER_MAP_SIZE];
+  uint8_t user_nbr;
 
   /* buffer for User Control Point */
   UCP_Buffer_RegisterNewUser_t buf_register_new_user;
-  UCP_Buffer_Consent_t buf_consent;
+  UCP_Buffer_DeleteUser_t buf_delete_user;
+
+  /* consent and indication of each link, indexed by APP_BLE_Get_Link_Index() */
+  UDSAPP_Link_t link[CFG_BLE_NUM_LINK];
+  uint8_t ucp_link;     /* link of the User Control Point procedure in progress */
+  uint8_t active_link;  /* link of the latest consent, its user is the one measured */
 
   uint16_t UDS_Char_Height;
   uint16_t UDS_Char_Weight;
 
-  uint8_t user_data_access_permitted;
-
   UDC_ProcedureComplete_t UDC_ErrorMessage;
 
-  uint16_t indicationStatusUerControlPoint;
   uint32_t StartTick;
 } UDSAPP_Context_t;
 
@@ -93,6 +120,9 @@ typedef struct{
 /* USER CODE END PTD */
 
 /* Private macros -------------------------------------------------------------*/
+#define USER_CONSENT_CODE(index)       (UDSAPP_Context.user_data.consent_code[(index) - 1])
+#define USER_HEIGHT(index)             (UDSAPP_Context.user_data.height[(index) - 1])
+#define USER_WEIGHT(index)             (UDSAPP_Context.user_data.weight[(index) - 1])
 
 /* USER CODE BEGIN PM */
 
@@ -107,15 +137,23 @@ static UDSAPP_Context_t UDSAPP_Context;
 
 /* Private function prototypes -----------------------------------------------*/
 static void UDSAPP_UserControlPoint_Error_Message(void);
-static void UDS_App_Notif_Height(uint16_t height);
-static void UDS_App_Notif_Weight(uint16_t weight);
-static void UDS_App_Notif_UserControlPoint(UDS_App_Notification_UCP_t *data);
+static void UDS_App_Notif_Height(uint8_t link, uint16_t height);
+static void UDS_App_Notif_Weight(uint8_t link, uint16_t weight);
+static void UDS_App_Notif_UserControlPoint(uint8_t link, UDS_App_Notification_UCP_t *data);
 
 static void procedure_complete_error(uint8_t request_op_code, uint8_t error_code);
 static void register_new_user(void);
 static void consent(void);
 static void delete_user_data(void);
-static void mark_invalid_data(uint8_t index);
+static void delete_users(void);
+static uint8_t user_registered(uint8_t index);
+static uint8_t user_alloc(void);
+static void user_add(uint8_t index, uint16_t consent_code, uint16_t height, uint16_t weight);
+static void user_remove(uint8_t index);
+static void user_save(uint8_t index);
+static uint8_t link_user(uint8_t link);
+static void reset_link(uint8_t link);
+static SVCCTL_EvtAckStatus_t UDSAPP_Disconnection(void *pEvt);
 
 
 /* USER CODE BEGIN PFP */
@@ -136,6 +174,98 @@ static void procedure_complete_error(uint8_t request_op_code, uint8_t error_code
 	UTIL_SEQ_SetTask( 1<<CFG_TASK_UDS_CRL_MSG_ID, CFG_SCH_PRIO_0);
 }
 
+static uint8_t user_registered(uint8_t index){
+	if ((index == 0) || (index > MAX_SIZE_USER_DATA)){
+		return 0;
+	}
+
+	return (UDSAPP_Context.user_map[(index - 1) / 32] & (1UL << ((index - 1) % 32))) != 0;
+}
+
+/* lowest free User Index, UDS_USER_INDEX_UNKNOW when the database is full */
+static uint8_t user_alloc(void){
+	uint32_t free_map;
+	uint16_t index;
+	uint8_t word;
+
+	for(word = 0; word < USER_MAP_SIZE; word++){
+		free_map = ~UDSAPP_Context.user_map[word];
+		if(free_map != 0){
+			index = (word * 32) + __CLZ(__RBIT(free_map)) + 1;
+
+			return (index <= MAX_SIZE_USER_DATA) ? (uint8_t)index : UDS_USER_INDEX_UNKNOW;
+		}
+	}
+
+	return UDS_USER_INDEX_UNKNOW;
+}
+
+static void user_add(uint8_t index, uint16_t consent_code, uint16_t height, uint16_t weight){
+	if (user_registered(index) == 0){
+		UDSAPP_Context.user_map[(index - 1) / 32] |= (1UL << ((index - 1) % 32));
+		UDSAPP_Context.user_nbr += 1;
+	}
+
+	USER_CONSENT_CODE(index) = consent_code;
+	USER_HEIGHT(index) = height;
+	USER_WEIGHT(index) = weight;
+}
+
+static void user_remove(uint8_t index){
+	uint8_t link;
+
+	UDSAPP_Context.user_map[(index - 1) / 32] &= ~(1UL << ((index - 1) % 32));
+	UDSAPP_Context.user_nbr -= 1;
+
+	USER_CONSENT_CODE(index) = (MAX_CONSENT_CODE + 1);
+	USER_HEIGHT(index) = 0;
+	USER_WEIGHT(index) = 0;
+
+	/* the consent given to the deleted user is withdrawn on every link */
+	for(link = 0; link < CFG_BLE_NUM_LINK; link++){
+		if(UDSAPP_Context.link[link].buf_consent.user_index == index){
+			UDSAPP_Context.link[link].user_data_access_permitted = 0; /* disable */
+			UDSAPP_Context.link[link].buf_consent.user_index = UDS_USER_INDEX_UNKNOW;
+		}
+	}
+
+#ifdef APP_ENABLE_UDS_STORE
+	if (UDSSTORE_Delete(index) != UDSSTORE_OK){
+		APP_DBG_MSG("User %d deletion not stored\n\r", index);
+	}
+#endif /* APP_ENABLE_UDS_STORE */
+}
+
+static void user_save(uint8_t index){
+#ifdef APP_ENABLE_UDS_STORE
+	if (UDSSTORE_Write(index, USER_CONSENT_CODE(index), USER_HEIGHT(index), USER_WEIGHT(index)) != UDSSTORE_OK){
+		APP_DBG_MSG("User %d not stored\n\r", index);
+	}
+#else
+	UNUSED(index);
+#endif /* APP_ENABLE_UDS_STORE */
+}
+
+/* User Index the link has the consent of, UDS_USER_INDEX_UNKNOW when none */
+static uint8_t link_user(uint8_t link){
+	if (UDSAPP_Context.link[link].user_data_access_permitted == 0){
+		return UDS_USER_INDEX_UNKNOW;
+	}
+
+	return UDSAPP_Context.link[link].buf_consent.user_index;
+}
+
+#ifdef APP_ENABLE_UDS_STORE
+static void user_load(uint8_t user_index, uint16_t consent_code, uint16_t height, uint16_t weight){
+	if ((user_index == 0) || (user_index > MAX_SIZE_USER_DATA)){
+		/* stored with a larger database */
+		return;
+	}
+
+	user_add(user_index, consent_code, height, weight);
+}
+#endif /* APP_ENABLE_UDS_STORE */
+
 static void register_new_user(void){
 	uint16_t consent_code = UDSAPP_Context.buf_register_new_user.consent_code;
 	uint8_t index;
@@ -153,38 +283,27 @@ static void register_new_user(void){
 	}
 
 #ifdef SUPPORT_MULTI_USERS
-	index = UDSAPP_Context.user_data_size + 1;
+	index = user_alloc();
 #else
 	/* only one user */
-	index = 1;
+	index = (user_registered(1) == 0) ? 1 : UDS_USER_INDEX_UNKNOW;
 #endif /* SUPPORT_MULTI_USERS */
 
-	if ((UDSAPP_Context.user_data[index].user_index != UDS_USER_INDEX_UNKNOW) &&
-			(UDSAPP_Context.user_data[index].consent_code <= MAX_CONSENT_CODE)){
-		/* already registered by other user -- only single user is allowed */
-		procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_OPERATION_FAILED);
-
-		return;
-	}
-
-	if (index >= 0xFF){
-		/* arrive the range of User Index */
+	if (index == UDS_USER_INDEX_UNKNOW){
+		/* already registered by other user, or the range of User Index is reached */
 		procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_OPERATION_FAILED);
 
 		return;
 	}
 
 	/* procedure */
-	UDSAPP_Context.user_data_size = index;
-	UDSAPP_Context.user_data[index].user_index = index;
-	UDSAPP_Context.user_data[index].consent_code = consent_code;
-	UDSAPP_Context.user_data[index].height = 0;  /* invalid value */
-	UDSAPP_Context.user_data[index].weight = 0;  /* invalid value */
+	user_add(index, consent_code, 0, 0);  /* invalid height and weight */
+	user_save(index);
 
 	/* reset the counter for consent tries */
-	UDSAPP_Context.buf_consent.tries = 0;
+	UDSAPP_Context.link[UDSAPP_Context.ucp_link].buf_consent.tries = 0;
 
-	UDSAPP_Context.user_data_access_permitted = 0; /* disable */
+	UDSAPP_Context.link[UDSAPP_Context.ucp_link].user_data_access_permitted = 0; /* disable */
 
 	/* procedure complete message */
 	response.ResponseValue = UDS_RESPONSE_VALUE_SUCCESS;
@@ -192,22 +311,16 @@ static void register_new_user(void){
 	response.ResponseParameterLength = 1;
 
 	UDS_Update_Char(USER_CONTROL_POINT_CHAR_UUID, (uint8_t*)&response);
-
-#ifdef SUPPORT_MULTI_USERS
-	/* prepare the next record */
-	if(index < 0xFF){
-		mark_invalid_data(index + 1);
-	}
-#endif /* SUPPORT_MULTI_USERS */
 }
 
 static void consent(void){
-	uint16_t consent_code = UDSAPP_Context.buf_consent.consent_code;
-	uint8_t user_index = UDSAPP_Context.buf_consent.user_index; /* User Index starts from 1 */
+	UDSAPP_Link_t *p_link = &UDSAPP_Context.link[UDSAPP_Context.ucp_link];
+	uint16_t consent_code = p_link->buf_consent.consent_code;
+	uint8_t user_index = p_link->buf_consent.user_index; /* User Index starts from 1 */
 	UDC_ProcedureComplete_t response;
 	uint16_t value;
 
-	APP_DBG_MSG("Consent procedure [tick = %ld]", UDSAPP_Context.buf_consent.tick);
+	APP_DBG_MSG("Consent procedure [tick = %ld, link = %d]", p_link->buf_consent.tick, UDSAPP_Context.ucp_link);
 
 	response.ResponseCodeOpCode = UDS_UCP_OPCODE_RESPONSE_CODE;
 	response.RequestOpCode      = UDS_UCP_OPCODE_CONSENT;
@@ -218,20 +331,20 @@ static void consent(void){
 		return;
 	}
 
-	if ((user_index == 0) || (user_index > UDSAPP_Context.user_data_size) || (user_index >= 0xFF)){
+	if (user_registered(user_index) == 0){
 		procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_INVALID_PARAMETER);
 
 		return;
 	}
 
-	if (UDSAPP_Context.user_data[user_index].consent_code != consent_code){
-		if(UDSAPP_Context.buf_consent.tries < MAXIMUM_CONSENT_TRIES){
+	if (USER_CONSENT_CODE(user_index) != consent_code){
+		if(p_link->buf_consent.tries < MAXIMUM_CONSENT_TRIES){
 			procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_USER_NOT_AUTHORIZED);
 		} else {
 			procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_OPERATION_FAILED);
 		}
 
-		UDSAPP_Context.buf_consent.tries += 1;
+		p_link->buf_consent.tries += 1;
 
 		return;
 	}
@@ -246,100 +359,134 @@ static void consent(void){
 	UDS_Update_Char(USER_INDEX_CHAR_UUID, (uint8_t*)&user_index);
 
 	/* populate current User Data */
-	if(UDSAPP_Context.user_data[user_index].height > 0){
-		value = UDSAPP_Context.user_data[user_index].height;
+	if(USER_HEIGHT(user_index) > 0){
+		value = USER_HEIGHT(user_index);
 		UDS_Update_Char(HEIGHT_CHAR_UUID, (uint8_t*)(&value));
 	}
-	if(UDSAPP_Context.user_data[user_index].weight > 0){
-		value = UDSAPP_Context.user_data[user_index].weight;
+	if(USER_WEIGHT(user_index) > 0){
+		value = USER_WEIGHT(user_index);
 		UDS_Update_Char(WEIGHT_CHAR_UUID, (uint8_t*)(&value));
 	}
 
-	UDSAPP_Context.user_data_access_permitted = 1; /* enable */
+	p_link->user_data_access_permitted = 1; /* enable */
+	UDSAPP_Context.active_link = UDSAPP_Context.ucp_link;
 }
 
 static void delete_user_data(void){
 	uint8_t index;
 	UDC_ProcedureComplete_t response;
 
-	APP_DBG_MSG("Delete User Data procedure [tick = %ld]", UDSAPP_Context.buf_consent.tick);
+	if (UDSAPP_Context.buf_delete_user.op_code == UDS_UCP_OPCODE_DELETE_USER){
+		delete_users();
+
+		return;
+	}
+
+	APP_DBG_MSG("Delete User Data procedure [tick = %ld]", UDSAPP_Context.buf_delete_user.tick);
 
 	response.ResponseCodeOpCode = UDS_UCP_OPCODE_RESPONSE_CODE;
 	response.RequestOpCode      = UDS_UCP_OPCODE_DELETE_USER_DATA;
 
-	index = UDSAPP_Context.user_data_size;
+	/* the user of the link consent is deleted */
+	index = link_user(UDSAPP_Context.ucp_link);
 
-	if ( (UDSAPP_Context.user_data_size == 0) || (index < 1) || (UDSAPP_Context.user_data[index].user_index == UDS_USER_INDEX_UNKNOW)){
+	if (user_registered(index) == 0){
 		procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_USER_NOT_AUTHORIZED);
 
 		return;
 	}
 
-	if (index >= 0xFF){
-		/* arrive the range of User Index */
-		procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_OPERATION_FAILED);
+	user_remove(index);
+
+	/* procedure complete message */
+	response.ResponseValue = UDS_RESPONSE_VALUE_SUCCESS;
+	response.ResponseParameterLength = 0;
+
+	UDS_Update_Char(USER_CONTROL_POINT_CHAR_UUID, (uint8_t*)&response);
+}
+
+static void delete_users(void){
+	uint8_t index = UDSAPP_Context.buf_delete_user.user_index;
+	uint32_t user_map;
+	uint8_t word;
+	UDC_ProcedureComplete_t response;
+
+	APP_DBG_MSG("Delete User(s) procedure [tick = %ld, index = %d]", UDSAPP_Context.buf_delete_user.tick, index);
+
+	response.ResponseCodeOpCode = UDS_UCP_OPCODE_RESPONSE_CODE;
+	response.RequestOpCode      = UDS_UCP_OPCODE_DELETE_USER;
+
+	/* the database is only changed by a collector having the consent of a user */
+	if (link_user(UDSAPP_Context.ucp_link) == UDS_USER_INDEX_UNKNOW){
+		procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_USER_NOT_AUTHORIZED);
 
 		return;
 	}
 
-	/* mark current data as invalid */
-	mark_invalid_data(index);
-
-	UDSAPP_Context.user_data_size -= 1;
+	if (index == UDS_USER_INDEX_ALL){
+		for(word = 0; word < USER_MAP_SIZE; word++){
+			user_map = UDSAPP_Context.user_map[word];
+			while(user_map != 0){
+				user_remove((word * 32) + __CLZ(__RBIT(user_map)) + 1);
+				user_map &= user_map - 1;
+			}
+		}
+	} else if (user_registered(index) != 0){
+		user_remove(index);
+	} else {
+		procedure_complete_error(response.RequestOpCode, UDS_RESPONSE_VALUE_INVALID_PARAMETER);
 
-	UDSAPP_Context.user_data_access_permitted = 0; /* disable */
+		return;
+	}
 
 	/* procedure complete message */
 	response.ResponseValue = UDS_RESPONSE_VALUE_SUCCESS;
-	response.ResponseParameterLength = 0;
+	response.ResponseParameter[0] = index;
+	response.ResponseParameterLength = 1;
 
 	UDS_Update_Char(USER_CONTROL_POINT_CHAR_UUID, (uint8_t*)&response);
 }
 
-static void mark_invalid_data(uint8_t index){
-	/* mark current data as invalid */
-	UDSAPP_Context.user_data[index].user_index = UDS_USER_INDEX_UNKNOW;
-	UDSAPP_Context.user_data[index].consent_code = (MAX_CONSENT_CODE + 1);
-	UDSAPP_Context.user_data[index].height = 0;
-	UDSAPP_Context.user_data[index].weight = 0;
-}
-
-static void UDS_App_Notif_Height(uint16_t height){
-	uint8_t index;
+static void UDS_App_Notif_Height(uint8_t link, uint16_t height){
+	uint8_t index = link_user(link);
 
-	if ((UDSAPP_Context.user_data_size == 0) || (UDSAPP_Context.user_data_size >= 0xFF) || (UDSAPP_Context.user_data[UDSAPP_Context.user_data_size].user_index == UDS_USER_INDEX_UNKNOW)){
+	if (user_registered(index) == 0){
 		/* invalid current user index */
 		return;
 	}
 
-	index = UDSAPP_Context.user_data_size;
-
-	UDSAPP_Context.user_data[index].height = height;
+	USER_HEIGHT(index) = height;
+	user_save(index);
 }
 
-static void UDS_App_Notif_Weight(uint16_t weight){
-	uint8_t index;
+static void UDS_App_Notif_Weight(uint8_t link, uint16_t weight){
+	uint8_t index = link_user(link);
 
-	if ((UDSAPP_Context.user_data_size == 0) || (UDSAPP_Context.user_data_size >= 0xFF) || (UDSAPP_Context.user_data[UDSAPP_Context.user_data_size].user_index == UDS_USER_INDEX_UNKNOW)){
+	if (user_registered(index) == 0){
 		/* invalid current user index */
 		return;
 	}
 
-	index = UDSAPP_Context.user_data_size;
-
-	UDSAPP_Context.user_data[index].height = weight;
+	USER_WEIGHT(index) = weight;
+	user_save(index);
 }
 
-static void UDS_App_Notif_UserControlPoint(UDS_App_Notification_UCP_t *data)
+static void UDS_App_Notif_UserControlPoint(uint8_t link, UDS_App_Notification_UCP_t *data)
 {
   uint32_t tick = HAL_GetTick();
-  APP_DBG_MSG("[enabled = %d] UDS_App_Notif_UserControlPoint, code = %d (tick = %ld)\n\r",
-		  UDSAPP_Context.indicationStatusUerControlPoint, data->op_code, tick);
+  APP_DBG_MSG("[enabled = %d] UDS_App_Notif_UserControlPoint, link = %d, code = %d (tick = %ld)\n\r",
+		  UDSAPP_Context.link[link].indicationStatusUerControlPoint, link, data->op_code, tick);
 
-  if(UDSAPP_Context.indicationStatusUerControlPoint == 0){
+  if(UDSAPP_Context.link[link].indicationStatusUerControlPoint == 0){
 	  return;
   }
-  
+
+  /* the procedure tasks run on behalf of this link */
+  UDSAPP_Context.ucp_link = link;
+
+  /* the collector reads or writes the user data right after the procedure */
+  APP_BLE_Conn_Activity(link);
+
   switch(data->op_code)
   {
   case 0:
@@ -354,14 +501,16 @@ static void UDS_App_Notif_UserControlPoint(UDS_App_Notification_UCP_t *data)
 	  break;
   case UDS_UCP_OPCODE_CONSENT:
 	  /* Consent */
-	  UDSAPP_Context.buf_consent.tick = tick;
-	  UDSAPP_Context.buf_consent.user_index = data->parameter[0];
-	  UDSAPP_Context.buf_consent.consent_code = *((uint16_t*)(data->parameter + 1));
+	  UDSAPP_Context.link[link].buf_consent.tick = tick;
+	  UDSAPP_Context.link[link].buf_consent.user_index = data->parameter[0];
+	  UDSAPP_Context.link[link].buf_consent.consent_code = *((uint16_t*)(data->parameter + 1));
 
 	  UTIL_SEQ_SetTask( 1<<CFG_TASK_UDS_CONSENT_ID, CFG_SCH_PRIO_0);
 	  break;
   case UDS_UCP_OPCODE_DELETE_USER_DATA:
 	  /* Delete User Data */
+	  UDSAPP_Context.buf_delete_user.tick = tick;
+	  UDSAPP_Context.buf_delete_user.op_code = UDS_UCP_OPCODE_DELETE_USER_DATA;
 	  UTIL_SEQ_SetTask( 1<<CFG_TASK_UDS_DEL_USER_ID, CFG_SCH_PRIO_0);
 	  break;
   case UDS_UCP_OPCODE_LIST_ALL_USERS:
@@ -370,7 +519,14 @@ static void UDS_App_Notif_UserControlPoint(UDS_App_Notification_UCP_t *data)
 	  break;
   case UDS_UCP_OPCODE_DELETE_USER:
 	  /* Delete User(s) */
-	  procedure_complete_error(UDS_UCP_OPCODE_DELETE_USER, UDS_RESPONSE_VALUE_OP_CODE_NOT_SUPPORTED);
+	  if(data->parameter_length < 1){
+		  procedure_complete_error(UDS_UCP_OPCODE_DELETE_USER, UDS_RESPONSE_VALUE_INVALID_PARAMETER);
+		  break;
+	  }
+	  UDSAPP_Context.buf_delete_user.tick = tick;
+	  UDSAPP_Context.buf_delete_user.op_code = UDS_UCP_OPCODE_DELETE_USER;
+	  UDSAPP_Context.buf_delete_user.user_index = data->parameter[0];
+	  UTIL_SEQ_SetTask( 1<<CFG_TASK_UDS_DEL_USER_ID, CFG_SCH_PRIO_0);
 	  break;
   default:
 	  /* 0x06−0x1F, Reserved for future use */
@@ -384,17 +540,33 @@ static void UDS_App_Notif_UserControlPoint(UDS_App_Notification_UCP_t *data)
 }
 
 /* Public functions ----------------------------------------------------------*/
-uint8_t UDS_App_AccessPermitted(void){
-	return UDSAPP_Context.user_data_access_permitted != 0;
+uint8_t UDS_App_AccessPermitted(uint16_t ConnectionHandle){
+	uint8_t link = APP_BLE_Get_Link_Index(ConnectionHandle);
+
+	if(link == CFG_BLE_NUM_LINK){
+		return 0;
+	}
+
+	return UDSAPP_Context.link[link].user_data_access_permitted != 0;
+}
+
+uint8_t UDSAPP_UserIndex(void){
+	return link_user(UDSAPP_Context.active_link);
 }
 
 void UDS_App_Notification(UDS_App_Notification_evt_t *pNotification){
+	uint8_t link = APP_BLE_Get_Link_Index(pNotification->ConnectionHandle);
+
+	if(link == CFG_BLE_NUM_LINK){
+		return;
+	}
+
 	switch(pNotification->UDS_Evt_Opcode){
 	case UDS_INDICATION_ENABLED:
-		UDSAPP_Context.indicationStatusUerControlPoint = 1;
+		UDSAPP_Context.link[link].indicationStatusUerControlPoint = 1;
 		break;
 	case UDS_INDICATION_DISABLED:
-		UDSAPP_Context.indicationStatusUerControlPoint = 0;
+		UDSAPP_Context.link[link].indicationStatusUerControlPoint = 0;
 		break;
 	case UDS_USER_CONTROL_POINT_EVT:{
 		UDS_App_Notification_UCP_t noti;
@@ -404,14 +576,16 @@ void UDS_App_Notification(UDS_App_Notification_evt_t *pNotification){
 			Osal_MemCpy(noti.parameter, pNotification->DataTransfered.pPayload + 1, noti.parameter_length);
 		}
 
-		UDS_App_Notif_UserControlPoint(&noti);
+		UDS_App_Notif_UserControlPoint(link, &noti);
 	}
 		break;
 	case UDS_NOTIFY_HEIGHT:
-		UDS_App_Notif_Height(*(uint16_t*)(pNotification->DataTransfered.pPayload));
+		APP_BLE_Conn_Activity(link);
+		UDS_App_Notif_Height(link, *(uint16_t*)(pNotification->DataTransfered.pPayload));
 		break;
 	case UDS_NOTIFY_WEIGHT:
-		UDS_App_Notif_Weight(*(uint16_t*)(pNotification->DataTransfered.pPayload));
+		APP_BLE_Conn_Activity(link);
+		UDS_App_Notif_Weight(link, *(uint16_t*)(pNotification->DataTransfered.pPayload));
 		break;
 	default:
 		/* do nothing */
@@ -419,37 +593,82 @@ void UDS_App_Notification(UDS_App_Notification_evt_t *pNotification){
 	}
 }
 
-void UDSAPP_Reset(void){
-	APP_DBG_MSG("UDSAPP_Reset\n\r");
+static void reset_link(uint8_t link){
+	UDSAPP_Context.link[link].indicationStatusUerControlPoint = 0;  /* disable */
+	UDSAPP_Context.link[link].user_data_access_permitted = 0; /* disable */
+	UDSAPP_Context.link[link].buf_consent.user_index = UDS_USER_INDEX_UNKNOW;
+	UDSAPP_Context.link[link].buf_consent.tries = 0;
+}
+
+void UDSAPP_Reset(uint16_t ConnectionHandle){
+	uint8_t link;
+
+	APP_DBG_MSG("UDSAPP_Reset 0x%x\n\r", ConnectionHandle);
 
 #ifndef UDS_SINGLE_TRUSTED_COLLECTOR
 	/*
-	* Reset Application Context
+	* Reset Application Context of the link, the registered users are kept
 	*/
-	UDSAPP_Context.indicationStatusUerControlPoint = 0;  /* disable */
-	UDSAPP_Context.user_data_access_permitted = 0; /* disable */
-	UDSAPP_Context.UDS_Char_Height = 0;
-	UDSAPP_Context.UDS_Char_Weight = 0;
-	UDSAPP_Context.user_data_size = 0;
-	UDSAPP_Context.StartTick = HAL_GetTick();
+	link = APP_BLE_Get_Link_Index(ConnectionHandle);
+	if(link < CFG_BLE_NUM_LINK){
+		reset_link(link);
+	}
+
+	if(APP_BLE_Get_Link_Nbr() <= 1){
+		UDSAPP_Context.UDS_Char_Height = 0;
+		UDSAPP_Context.UDS_Char_Weight = 0;
+		UDSAPP_Context.StartTick = HAL_GetTick();
+	}
+#else
+	UNUSED(link);
 #endif /* ! UDS_SINGLE_TRUSTED_COLLECTOR */
 }
 
+static SVCCTL_EvtAckStatus_t UDSAPP_Disconnection(void *pEvt)
+{
+  UDSAPP_Reset(((hci_disconnection_complete_event_rp0 *)pEvt)->Connection_Handle);
+
+  return SVCCTL_EvtNotAck;
+}
+
 void UDSAPP_Init(void)
 {
+  uint8_t link;
+
   APP_DBG_MSG("UDSAPP_Init\n\r");
-  
+
+  /*
+   * The context of a link is reset on its disconnection
+   */
+  if (SVCCTL_SubscribeEvt(HCI_DISCONNECTION_COMPLETE_EVT_CODE, 0, UDSAPP_Disconnection) != BLE_STATUS_SUCCESS)
+  {
+    /* BLE_CFG_EVT_MAX_NBR_SUBSCRIBER is too small */
+    Error_Handler();
+  }
+
   /*
    * Initialize Application Context
    */
-  UDSAPP_Context.indicationStatusUerControlPoint = 0;  /* disable */
-  UDSAPP_Context.user_data_access_permitted = 0; /* disable */
+  for(link = 0; link < CFG_BLE_NUM_LINK; link++){
+    reset_link(link);
+  }
+  UDSAPP_Context.ucp_link = 0;
+  UDSAPP_Context.active_link = 0;
   UDSAPP_Context.UDS_Char_Height = 0;
   UDSAPP_Context.UDS_Char_Weight = 0;
-  UDSAPP_Context.user_data_size = 0;
   UDSAPP_Context.StartTick = HAL_GetTick();
-  
-  mark_invalid_data(1);
+
+  memset(UDSAPP_Context.user_map, 0, sizeof(UDSAPP_Context.user_map));
+  UDSAPP_Context.user_nbr = 0;
+
+#ifdef APP_ENABLE_UDS_STORE
+  /**
+   * Restore the users registered before the reset
+   */
+  UDSSTORE_Init();
+  UDSSTORE_Load(user_load);
+  APP_DBG_MSG("%d user(s) restored\n\r", UDSAPP_Context.user_nbr);
+#endif /* APP_ENABLE_UDS_STORE */
 
   /**
    * Initialize User Data Characteristics
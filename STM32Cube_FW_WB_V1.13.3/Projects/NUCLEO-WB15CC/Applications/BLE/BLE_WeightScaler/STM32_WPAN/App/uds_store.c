@@ -0,0 +1,395 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    uds_store.c
+  * @author  MCD Application Team
+  * @brief   User Data Service users kept in flash
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+
+#include "dbg_trace.h"
+#include "shci.h"
+#include "uds_store.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * The store is a log of user records over two flash pages used in turn.
+ * Each change of a user is appended to the active page, so that a given flash
+ * word is written once per page cycle whatever the user being updated.
+ * When the active page is full, the latest record of every user still
+ * registered is copied to the other page, which then becomes the active one
+ * once its header is written, and the full page is erased.
+ */
+typedef struct{
+  uint32_t ActivePage;  /**< address of the page holding the log */
+  uint32_t Sequence;    /**< sequence number of the active page, the highest one wins after a reset */
+  uint16_t WriteIdx;    /**< next erased record of the active page */
+} UDSSTORE_Context_t;
+
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private defines ------------------------------------------------------------*/
+#define UDSSTORE_PAGE_NBR                  (CFG_UDS_STORE_SIZE / FLASH_PAGE_SIZE)
+#define UDSSTORE_RECORD_PER_PAGE           (FLASH_PAGE_SIZE / UDSSTORE_RECORD_SIZE)
+
+#define UDSSTORE_MARKER_VALID              (0xA5)
+#define UDSSTORE_PAGE_MAGIC                (0x55445331UL)    /**< "UDS1" */
+#define UDSSTORE_USER_INDEX_NBR            (256)
+
+/**
+ * Record layout, the first record of a page is the page header (magic, sequence)
+ */
+#define UDSSTORE_SHIFT_MARKER              (0)
+#define UDSSTORE_SHIFT_USER_INDEX          (8)
+#define UDSSTORE_SHIFT_CONSENT             (16)
+#define UDSSTORE_SHIFT_HEIGHT              (32)
+#define UDSSTORE_SHIFT_WEIGHT              (48)
+
+#if (UDSSTORE_PAGE_NBR != 2)
+#error "CFG_UDS_STORE_SIZE shall cover 2 flash pages"
+#endif
+
+#if ((UDSSTORE_RECORD_PER_PAGE - 1) < (UDSSTORE_USER_INDEX_NBR - 2))
+#error "A flash page shall hold one record for every User Index"
+#endif
+
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macros -------------------------------------------------------------*/
+#define UDSSTORE_RECORD_ADDRESS(page, idx) ((page) + ((uint32_t)(idx) * UDSSTORE_RECORD_SIZE))
+#define UDSSTORE_FIELD(record, shift)      ((uint16_t)((record) >> (shift)))
+
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+static UDSSTORE_Context_t UDSSTORE_Context;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t UdsStore_Read(uint32_t page, uint16_t idx);
+static uint8_t UdsStore_RecordValid(uint64_t record);
+static uint8_t UdsStore_PageValid(uint32_t page, uint32_t *pSequence);
+static uint8_t UdsStore_PageErased(uint32_t page);
+static UDSSTORE_Status_t UdsStore_Append(uint64_t record);
+static UDSSTORE_Status_t UdsStore_Compact(void);
+static HAL_StatusTypeDef UdsStore_FlashProgram(uint32_t address, uint64_t data);
+static HAL_StatusTypeDef UdsStore_FlashErase(uint32_t address);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Functions Definition ------------------------------------------------------*/
+static uint64_t UdsStore_Read(uint32_t page, uint16_t idx)
+{
+  return *(__IO uint64_t *)UDSSTORE_RECORD_ADDRESS(page, idx);
+}
+
+static uint8_t UdsStore_RecordValid(uint64_t record)
+{
+  return ((record != UINT64_MAX) && ((uint8_t)(record >> UDSSTORE_SHIFT_MARKER) == UDSSTORE_MARKER_VALID));
+}
+
+static uint8_t UdsStore_PageValid(uint32_t page, uint32_t *pSequence)
+{
+  uint64_t header = UdsStore_Read(page, 0);
+
+  *pSequence = (uint32_t)(header >> 32);
+
+  return ((uint32_t)header == UDSSTORE_PAGE_MAGIC);
+}
+
+static uint8_t UdsStore_PageErased(uint32_t page)
+{
+  uint16_t idx;
+
+  for(idx = 0; idx < UDSSTORE_RECORD_PER_PAGE; idx++)
+  {
+    if(UdsStore_Read(page, idx) != UINT64_MAX)
+    {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static UDSSTORE_Status_t UdsStore_Append(uint64_t record)
+{
+  if(UDSSTORE_Context.WriteIdx >= UDSSTORE_RECORD_PER_PAGE)
+  {
+    if(UdsStore_Compact() != UDSSTORE_OK)
+    {
+      return UDSSTORE_ERROR;
+    }
+  }
+
+  if(UdsStore_FlashProgram(UDSSTORE_RECORD_ADDRESS(UDSSTORE_Context.ActivePage, UDSSTORE_Context.WriteIdx), record) != HAL_OK)
+  {
+    return UDSSTORE_ERROR;
+  }
+  UDSSTORE_Context.WriteIdx++;
+
+  return UDSSTORE_OK;
+}
+
+/**
+ * Copy the latest record of every registered user to the other page
+ * The header of the new page is written last, a reset in between keeps the full page active
+ */
+static UDSSTORE_Status_t UdsStore_Compact(void)
+{
+  uint32_t seen[UDSSTORE_USER_INDEX_NBR / 32];
+  uint32_t other;
+  uint64_t record;
+  uint16_t idx;
+  uint16_t dst;
+  uint8_t user_index;
+
+  other = (UDSSTORE_Context.ActivePage == CFG_UDS_STORE_ADDRESS) ? (CFG_UDS_STORE_ADDRESS + FLASH_PAGE_SIZE) : CFG_UDS_STORE_ADDRESS;
+
+  if((UdsStore_PageErased(other) == 0) && (UdsStore_FlashErase(other) != HAL_OK))
+  {
+    return UDSSTORE_ERROR;
+  }
+
+  memset(seen, 0, sizeof(seen));
+  dst = 1;
+  for(idx = UDSSTORE_Context.WriteIdx - 1; idx > 0; idx--)
+  {
+    record = UdsStore_Read(UDSSTORE_Context.ActivePage, idx);
+    if(UdsStore_RecordValid(record) == 0)
+    {
+      continue;
+    }
+
+    user_index = (uint8_t)(record >> UDSSTORE_SHIFT_USER_INDEX);
+    if(seen[user_index / 32] & (1UL << (user_index % 32)))
+    {
+      continue;
+    }
+    seen[user_index / 32] |= (1UL << (user_index % 32));
+
+    if(UDSSTORE_FIELD(record, UDSSTORE_SHIFT_CONSENT) == UDSSTORE_CONSENT_DELETED)
+    {
+      continue;
+    }
+
+    if(UdsStore_FlashProgram(UDSSTORE_RECORD_ADDRESS(other, dst), record) != HAL_OK)
+    {
+      return UDSSTORE_ERROR;
+    }
+    dst++;
+  }
+
+  if(UdsStore_FlashProgram(other, ((uint64_t)(UDSSTORE_Context.Sequence + 1) << 32) | UDSSTORE_PAGE_MAGIC) != HAL_OK)
+  {
+    return UDSSTORE_ERROR;
+  }
+
+  UdsStore_FlashErase(UDSSTORE_Context.ActivePage);
+
+  UDSSTORE_Context.ActivePage = other;
+  UDSSTORE_Context.Sequence++;
+  UDSSTORE_Context.WriteIdx = dst;
+
+  APP_DBG_MSG("UDSSTORE compacted, %d user(s) kept\n\r", dst - 1);
+
+  return UDSSTORE_OK;
+}
+
+/**
+ * Same flash access sequence as the Weight Scale Measurements history
+ */
+static HAL_StatusTypeDef UdsStore_FlashProgram(uint32_t address, uint64_t data)
+{
+  HAL_StatusTypeDef status;
+
+  while(LL_HSEM_1StepLock(HSEM, CFG_HW_FLASH_SEMID));
+  HAL_FLASH_Unlock();
+
+  while(LL_HSEM_1StepLock(HSEM, CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID));
+  status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address, data);
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID, 0);
+
+  HAL_FLASH_Lock();
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_FLASH_SEMID, 0);
+
+  return status;
+}
+
+static HAL_StatusTypeDef UdsStore_FlashErase(uint32_t address)
+{
+  FLASH_EraseInitTypeDef erase_init;
+  uint32_t page_error;
+  HAL_StatusTypeDef status;
+
+  erase_init.TypeErase = FLASH_TYPEERASE_PAGES;
+  erase_init.Page = (address - FLASH_BASE) / FLASH_PAGE_SIZE;
+  erase_init.NbPages = 1;
+
+  SHCI_C2_FLASH_EraseActivity(ERASE_ACTIVITY_ON);
+
+  while(LL_HSEM_1StepLock(HSEM, CFG_HW_FLASH_SEMID));
+  HAL_FLASH_Unlock();
+
+  while(LL_HSEM_1StepLock(HSEM, CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID));
+  status = HAL_FLASHEx_Erase(&erase_init, &page_error);
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID, 0);
+
+  HAL_FLASH_Lock();
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_FLASH_SEMID, 0);
+
+  SHCI_C2_FLASH_EraseActivity(ERASE_ACTIVITY_OFF);
+
+  return status;
+}
+
+/* Public functions ----------------------------------------------------------*/
+void UDSSTORE_Init(void)
+{
+  uint32_t page[2] = { CFG_UDS_STORE_ADDRESS, CFG_UDS_STORE_ADDRESS + FLASH_PAGE_SIZE };
+  uint32_t sequence[2];
+  uint8_t valid[2];
+  uint8_t active;
+
+  valid[0] = UdsStore_PageValid(page[0], &sequence[0]);
+  valid[1] = UdsStore_PageValid(page[1], &sequence[1]);
+
+  if((valid[0] == 0) && (valid[1] == 0))
+  {
+    /* First start, the log begins in the first page */
+    if(UdsStore_PageErased(page[0]) == 0)
+    {
+      UdsStore_FlashErase(page[0]);
+    }
+    UdsStore_FlashProgram(page[0], ((uint64_t)1 << 32) | UDSSTORE_PAGE_MAGIC);
+    valid[0] = 1;
+    sequence[0] = 1;
+  }
+
+  /* Both pages are valid when the erase following a compaction has been interrupted */
+  if(valid[0] && valid[1])
+  {
+    active = (sequence[1] > sequence[0]) ? 1 : 0;
+  }
+  else
+  {
+    active = valid[1] ? 1 : 0;
+  }
+
+  UDSSTORE_Context.ActivePage = page[active];
+  UDSSTORE_Context.Sequence = sequence[active];
+
+  /* The records are written in sequence, the log ends at the first erased one */
+  UDSSTORE_Context.WriteIdx = 1;
+  while((UDSSTORE_Context.WriteIdx < UDSSTORE_RECORD_PER_PAGE) &&
+        (UdsStore_Read(UDSSTORE_Context.ActivePage, UDSSTORE_Context.WriteIdx) != UINT64_MAX))
+  {
+    UDSSTORE_Context.WriteIdx++;
+  }
+
+  APP_DBG_MSG("UDSSTORE_Init: page 0x%08lX, %d record(s)\n\r", UDSSTORE_Context.ActivePage, UDSSTORE_Context.WriteIdx - 1);
+}
+
+/**
+ * @brief  Report the users kept in flash, the latest record of each user is the valid one
+ * @param  pfLoad: called once for every registered user
+ * @retval None
+ */
+void UDSSTORE_Load(UDSSTORE_LoadCb_t pfLoad)
+{
+  uint32_t seen[UDSSTORE_USER_INDEX_NBR / 32];
+  uint64_t record;
+  uint16_t idx;
+  uint8_t user_index;
+
+  memset(seen, 0, sizeof(seen));
+  for(idx = UDSSTORE_Context.WriteIdx - 1; idx > 0; idx--)
+  {
+    record = UdsStore_Read(UDSSTORE_Context.ActivePage, idx);
+    if(UdsStore_RecordValid(record) == 0)
+    {
+      continue;
+    }
+
+    user_index = (uint8_t)(record >> UDSSTORE_SHIFT_USER_INDEX);
+    if(seen[user_index / 32] & (1UL << (user_index % 32)))
+    {
+      continue;
+    }
+    seen[user_index / 32] |= (1UL << (user_index % 32));
+
+    if(UDSSTORE_FIELD(record, UDSSTORE_SHIFT_CONSENT) != UDSSTORE_CONSENT_DELETED)
+    {
+      pfLoad(user_index,
+             UDSSTORE_FIELD(record, UDSSTORE_SHIFT_CONSENT),
+             UDSSTORE_FIELD(record, UDSSTORE_SHIFT_HEIGHT),
+             UDSSTORE_FIELD(record, UDSSTORE_SHIFT_WEIGHT));
+    }
+  }
+}
+
+/**
+ * @brief  Append the current data of a user
+ * @param  user_index: UDS User Index
+ * @param  consent_code: consent code of the user
+ * @param  height: height of the user, 0 when unknown
+ * @param  weight: weight of the user, 0 when unknown
+ * @retval UDSSTORE_OK when the record has been written
+ */
+UDSSTORE_Status_t UDSSTORE_Write(uint8_t user_index, uint16_t consent_code, uint16_t height, uint16_t weight)
+{
+  uint64_t record;
+
+  record = ((uint64_t)UDSSTORE_MARKER_VALID << UDSSTORE_SHIFT_MARKER) |
+           ((uint64_t)user_index << UDSSTORE_SHIFT_USER_INDEX) |
+           ((uint64_t)consent_code << UDSSTORE_SHIFT_CONSENT) |
+           ((uint64_t)height << UDSSTORE_SHIFT_HEIGHT) |
+           ((uint64_t)weight << UDSSTORE_SHIFT_WEIGHT);
+
+  return UdsStore_Append(record);
+}
+
+/**
+ * @brief  Record the deletion of a user
+ * @param  user_index: UDS User Index
+ * @retval UDSSTORE_OK when the record has been written
+ */
+UDSSTORE_Status_t UDSSTORE_Delete(uint8_t user_index)
+{
+  return UDSSTORE_Write(user_index, UDSSTORE_CONSENT_DELETED, 0, 0);
+}
+
+/* USER CODE BEGIN FD */
+
+/* USER CODE END FD */
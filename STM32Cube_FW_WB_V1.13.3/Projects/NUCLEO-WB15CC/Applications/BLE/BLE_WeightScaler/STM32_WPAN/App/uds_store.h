@@ -0,0 +1,89 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    uds_store.h
+  * @author  MCD Application Team
+  * @brief   Header for uds_store.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UDS_STORE_H
+#define __UDS_STORE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  UDSSTORE_OK = 0,
+  UDSSTORE_ERROR
+} UDSSTORE_Status_t;
+
+/**
+ * Called by UDSSTORE_Load() for every user found in flash
+ */
+typedef void (*UDSSTORE_LoadCb_t)(uint8_t user_index, uint16_t consent_code, uint16_t height, uint16_t weight);
+
+/* USER CODE BEGIN ET */
+
+/* USER CODE END ET */
+/* Exported constants --------------------------------------------------------*/
+/**
+ * A record is one double word: marker, user index, consent code, height and weight
+ * A deleted user is written with UDSSTORE_CONSENT_DELETED as consent code
+ */
+#define UDSSTORE_RECORD_SIZE               (8)
+#define UDSSTORE_CONSENT_DELETED           (0xFFFF)
+
+/* USER CODE BEGIN EC */
+
+/* USER CODE END EC */
+
+/* Exported macro ------------------------------------------------------------*/
+/* USER CODE BEGIN EM */
+
+/* USER CODE END EM */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void UDSSTORE_Init(void);
+void UDSSTORE_Load(UDSSTORE_LoadCb_t pfLoad);
+UDSSTORE_Status_t UDSSTORE_Write(uint8_t user_index, uint16_t consent_code, uint16_t height, uint16_t weight);
+UDSSTORE_Status_t UDSSTORE_Delete(uint8_t user_index);
+/* USER CODE BEGIN EFP */
+
+/* USER CODE END EFP */
+
+/* Private defines -----------------------------------------------------------*/
+/* USER CODE BEGIN Private defines */
+
+/* USER CODE END Private defines */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__UDS_STORE_H */
+
+/* USER CODE END */
@@ -19,6 +19,8 @@
 /* USER CODE END Header */
 
 /* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
 #include "app_common.h"
 
 #include "dbg_trace.h"
@@ -28,6 +30,19 @@
 #include "stm32_seq.h"
 #include "wss.h"
 #include "wss_app.h"
+#include "meas_conv.h"
+#include "time_base.h"
+#ifdef APP_ENABLE_WSS_STORE
+#include "wss_store.h"
+#endif /* APP_ENABLE_WSS_STORE */
+#ifdef APP_ENABLE_UDS
+#include "uds.h"
+#include "uds_app.h"
+#endif /* APP_ENABLE_UDS */
+
+#if defined(APP_ENABLE_WSS_HISTORY) && !defined(APP_ENABLE_WSS_STORE)
+#error "APP_ENABLE_WSS_HISTORY transfers the measurements of APP_ENABLE_WSS_STORE"
+#endif
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
@@ -39,39 +54,47 @@ typedef struct{
   WSS_MeasurementValue_t MeasurementChar;
   WSS_FeatureValue_t FeatureChar;
   
-  uint8_t Indication_Status;
+  uint8_t Indication_Status[CFG_BLE_NUM_LINK];   /* per link, indexed by APP_BLE_Get_Link_Index() */
   uint8_t TimerMeasurement_Id;
-  uint32_t StartTick;
+  uint32_t DeadlineMiss;          /* last count of the sequencer deadline misses reported */
+#ifdef APP_ENABLE_WSS_STORE
+  uint8_t Replay_InFlight;        /* a stored measurement is waiting for the confirmation */
+  uint8_t Replay_Stored;          /* the last indication sent is a stored measurement, not a live one */
+  uint8_t TimerReplay_Id;
+#endif /* APP_ENABLE_WSS_STORE */
+#ifdef APP_ENABLE_WSS_HISTORY
+  uint16_t History_ConnHdle;      /* collector of the bulk transfer, WSSAPP_HISTORY_NONE when idle */
+  uint16_t History_AckSeq;        /* sequence number of the oldest stored measurement */
+  uint16_t History_NextSeq;       /* sequence number of the next measurement to send */
+  uint16_t History_StatusConnHdle;
+  uint8_t History_Status;         /* status frame waiting to be sent, 0 when none */
+  uint8_t History_StatusOpCode;
+  uint8_t History_OpCode;         /* request the end of the transfer is reported to */
+  uint8_t History_EndSent;
+  uint8_t History_TxPoolWait;     /* the notification buffers are full */
+#endif /* APP_ENABLE_WSS_HISTORY */
+#ifdef APP_ENABLE_WSS_BROADCAST
+  uint8_t Broadcast_Sequence;     /* incremented with each broadcast measurement */
+#endif /* APP_ENABLE_WSS_BROADCAST */
 } WSSAPP_Context_t;
 
-typedef enum {
-  MeasurementUnits_SI = 0,   /* Weight and Mass in units of kilogram (kg) and Height in units of meter */
-  MeasurementUnits_Imperial  /* Weight and Mass in units of pound (lb) and Height in units of inch (in) */
-} Measurement_Unit_t;
-
 /* USER CODE BEGIN PTD */
 
 /* USER CODE END PTD */
 
 /* Private defines ------------------------------------------------------------*/
 #define DEFAULT_WEIGHT_IN_KG                                                  70
-#define DEFAULT_HEIGHT_IN_METERS                                             1.7f
-#define DEFAULT_WSS_TIME_STAMP_YEAR                                         2022
-#define DEFAULT_WSS_TIME_STAMP_MONTH                                           7
-#define DEFAULT_WSS_TIME_STAMP_DAY                                             5
-#define DEFAULT_WSS_TIME_STAMP_HOURS                                           0
-#define DEFAULT_WSS_TIME_STAMP_MINUTES                                         0
-#define DEFAULT_WSS_TIME_STAMP_SECONDS                                         0
+#define DEFAULT_HEIGHT_IN_MILLIMETERS                                      1700
 /* USER CODE BEGIN PD */
 
 /* USER CODE END PD */
 
 /* Private macros -------------------------------------------------------------*/
 #define WSS_MEASUREMENT_INTERVAL   (1000000/CFG_TS_TICK_VAL)  /**< 1s */
-
-/* Field Weight of Weight Scale Measurement */
-#define POUNDS_TO_KILOGRAMS        0.4536
-#define INCHES_TO_METERS           0.3048
+#define WSS_REPLAY_RETRY_INTERVAL  (100000/CFG_TS_TICK_VAL)   /**< 100ms */
+/* Flags, Weight, Time Stamp, User ID and Sequence Number */
+#define WSS_BROADCAST_MAX_LENGTH   (1 + 2 + 7 + 1 + 1)
+#define WSSAPP_HISTORY_NONE        (0xFFFF)
 
 /* USER CODE BEGIN PM */
 
@@ -85,20 +108,25 @@ static WSSAPP_Context_t WSSAPP_Context;
 
 /* Private function prototypes -----------------------------------------------*/
 static void WsMeas( void );
-/* Weight */
-static uint8_t WsFeatureField_WMR(void);
-static Measurement_Unit_t WsMeasurementUnits_Weight(void);
-static float WsMeasurementResolution_Weight(uint8_t feature, Measurement_Unit_t unit);
-static uint16_t WsConvert_Weight(Measurement_Unit_t unit_from, Measurement_Unit_t unit_to, float weight);
-/* Height */
-static uint8_t WsFeatureField_HMR(void);
-static Measurement_Unit_t WsMeasurementUnits_Height(void);
-static float WsMeasurementResolution_Height(uint8_t feature, Measurement_Unit_t unit);
-static uint16_t WsConvert_Height(Measurement_Unit_t unit_from, Measurement_Unit_t unit_to, float height);
-/* BMI */
-static uint16_t WsCalculate_BMI(float weight, float height);
-/* Measurement */
 static void WSSAPP_Measurement(void);
+static uint8_t WSSAPP_Indication_Enabled(void);
+static void WSSAPP_SetTimeStamp(WSS_MeasurementValue_t *pMeasurement, uint32_t Time);
+static SVCCTL_EvtAckStatus_t WSSAPP_Disconnection(void *pEvt);
+#ifdef APP_ENABLE_WSS_STORE
+static void WsReplay( void );
+static void WSSAPP_Replay(void);
+static void WSSAPP_Replay_Work(uint8_t Pending);
+#endif /* APP_ENABLE_WSS_STORE */
+#ifdef APP_ENABLE_WSS_BROADCAST
+static void WSSAPP_Broadcast(WSS_MeasurementValue_t *pMeasurement, uint32_t Time);
+#endif /* APP_ENABLE_WSS_BROADCAST */
+#ifdef APP_ENABLE_WSS_HISTORY
+static void WSSAPP_History(void);
+static void WSSAPP_History_Request(WSS_App_Notification_evt_t *pNotification);
+static void WSSAPP_History_Status(uint16_t ConnectionHandle, uint8_t OpCode, uint8_t Status);
+static void WSSAPP_History_End(void);
+static SVCCTL_EvtAckStatus_t WSSAPP_TxPoolAvailable(void *pEvt);
+#endif /* APP_ENABLE_WSS_HISTORY */
 
 /* USER CODE BEGIN PFP */
 
@@ -112,280 +140,534 @@ static void WsMeas( void )
    * The background is the only place where the application can make sure a new aci command
    * is not sent if there is a pending one
    */
-  UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_MEAS_REQ_ID, CFG_SCH_PRIO_0);
+  UTIL_SEQ_SetTaskDeadline( 1<<CFG_TASK_WSS_MEAS_REQ_ID, TIMEBASE_GetTicks() + TIMEBASE_MsToTicks(CFG_WSS_MEAS_DEADLINE_MS));
 
   return;
 }
 
-/*
- * Get Weight Measurement Resolution from Weight Scale Feature field
- */
-static uint8_t WsFeatureField_WMR(void){
-  //APP_DBG_MSG("Feature in WsFeatureField_WMR = %X\n\r", WSSAPP_Context.FeatureChar.Value);
-  return ((WSSAPP_Context.FeatureChar.Value >> 3) & 0x0F);
-}
-
-/*
- * Get Measurement Units from Flags of Weight Scale Measurement
- */
-static Measurement_Unit_t WsMeasurementUnits_Weight(void){
-  //APP_DBG_MSG("Flags in WsMeasurementUnits_Weight = %X\n\r", WSSAPP_Context.MeasurementChar.Flags);
-  return (Measurement_Unit_t)(WSSAPP_Context.MeasurementChar.Flags & 1);
-}
-
-/*
- * Weight Measurement Resolution from Weight Scale Feature field
- * Return value is the resolution for kilograms (kg) or resolution for pounds
- */
-static float WsMeasurementResolution_Weight(uint8_t feature, Measurement_Unit_t unit){
-  float resolution = 1.0f; /* the default is Not specified */
+static void WSSAPP_Measurement(void)
+{
+  /*Weight, BMI,  Height Initialization*/
   
-  switch (feature){
-  case 1:
-    /* Resolution of 0.5 kg or 1 lb */
-    resolution = (unit == MeasurementUnits_SI) ? 0.5f : 1.0f;
-    break;
-  case 2:
-    /* Resolution of 0.2 kg or 0.5 lb */
-    resolution = (unit == MeasurementUnits_SI) ? 0.2f : 0.5f;
-    break;
-  case 3:
-    /* Resolution of 0.1 kg or 0.2 lb */
-    resolution = (unit == MeasurementUnits_SI) ? 0.1f : 0.2f;
-    break;
-  case 4:
-    /* Resolution of 0.05 kg or 0.1 lb */
-    resolution = (unit == MeasurementUnits_SI) ? 0.05f : 0.1f;
-    break;
-  case 5:
-    /* Resolution of 0.02 kg or 0.05 lb */
-    resolution = (unit == MeasurementUnits_SI) ? 0.02f : 0.05f;
-    break;
-  case 6:
-    /* Resolution of 0.01 kg or 0.02 lb */
-    resolution = (unit == MeasurementUnits_SI) ? 0.01f : 0.02f;
-    break;
-  case 7:
-    /* Resolution of 0.005 kg or 0.01 lb */
-    resolution = (unit == MeasurementUnits_SI) ? 0.005f : 0.01f;
-    break;
-  default:
-    /* do nothing */
-    break;
+  /* E.g. weight = 0x36B0 for 70kg with resolution = 0.0005 */
+  Measurement_Unit_t unit = ((WSSAPP_Context.MeasurementChar.Flags & WSS_FLAGS_VALUE_UNIT_IMPERIAL) ? MeasurementUnits_Imperial : MeasurementUnits_SI);
+  uint32_t weight_g = (DEFAULT_WEIGHT_IN_KG + (rand() % 10)) * 1000;
+  uint16_t weight = MEASCONV_Weight(weight_g,
+                                    MEASCONV_WEIGHT_RES(WSSAPP_Context.FeatureChar.Value, MEASCONV_WSS_WEIGHT_RES_POS),
+                                    unit);
+  uint32_t height_mm = DEFAULT_HEIGHT_IN_MILLIMETERS + (rand() % 10) * 1000;
+  uint16_t height = MEASCONV_Height(height_mm,
+                                    MEASCONV_HEIGHT_RES(WSSAPP_Context.FeatureChar.Value, MEASCONV_WSS_HEIGHT_RES_POS),
+                                    unit);
+  uint16_t BMI = MEASCONV_BMI(weight_g, height_mm);
+  uint32_t time = TIMEBASE_Get(NULL);
+#ifdef APP_ENABLE_WSS_HISTORY
+  uint16_t count;
+#endif /* APP_ENABLE_WSS_HISTORY */
+  
+  //APP_DBG_MSG("weight_g = %ld -> weight = %02X, height_mm = %ld -> height = %02X\n\r", weight_g, weight, height_mm, height);
+  
+  APP_DBG_MSG("WSSAPP_Measurement ticks = %ld\n\r", HAL_GetTick());
+  if(UTIL_SEQ_GetDeadlineMiss() != WSSAPP_Context.DeadlineMiss){
+    WSSAPP_Context.DeadlineMiss = UTIL_SEQ_GetDeadlineMiss();
+    APP_DBG_MSG("WSSAPP_Measurement deadline misses = %ld\n\r", WSSAPP_Context.DeadlineMiss);
   }
   
-  //APP_DBG_MSG("Get Weight resolution = %f with feature = %X and unit = %d\n\r", resolution, feature, unit);
-  
-  return resolution;
-}
+#if !defined(APP_ENABLE_WSS_STORE) && !defined(APP_ENABLE_WSS_BROADCAST)
+  if(WSSAPP_Indication_Enabled() == 0){
+    APP_DBG_MSG("Stop WSS Measurement\n\r");
+    HW_TS_Stop(WSSAPP_Context.TimerMeasurement_Id);
+    return;
+  }
+#endif /* ! APP_ENABLE_WSS_STORE && ! APP_ENABLE_WSS_BROADCAST */
 
-/*
- * This function will transfer weight value with appoint unit
- * The formular: 1 pound = 0.4536 kilogram
- */
-static uint16_t WsConvert_Weight(Measurement_Unit_t unit_from, Measurement_Unit_t unit_to, float weight){
-  uint32_t v;
-  float resolution = WsMeasurementResolution_Weight(WsFeatureField_WMR(), WsMeasurementUnits_Weight());
+  /* update Weight */
+  WSSAPP_Context.MeasurementChar.Weight = weight;
   
-  //APP_DBG_MSG("Convert Weight %f with resolution = %f, unit %d -> %d\n\r", weight, resolution, unit_from, unit_to);
+  /* update Height */
+  WSSAPP_Context.MeasurementChar.Height = height;
+  
+  /* update BMI */
+  WSSAPP_Context.MeasurementChar.BMI    = BMI;
   
-  if((unit_from == MeasurementUnits_SI) && (unit_to == MeasurementUnits_Imperial)){
-    /* kilograms (kg) -> pounds */
-    weight /= POUNDS_TO_KILOGRAMS;
-  } else if ((unit_from == MeasurementUnits_Imperial) && (unit_to == MeasurementUnits_SI)){
-    /* pounds -> kilograms (kg) */
-    weight *= POUNDS_TO_KILOGRAMS;
+  /* update User ID */
+  WSSAPP_Context.MeasurementChar.UserID = 0x01;
+#ifdef APP_ENABLE_UDS
+  if(UDSAPP_UserIndex() != UDS_USER_INDEX_UNKNOW){
+    WSSAPP_Context.MeasurementChar.UserID = UDSAPP_UserIndex();
   }
+#endif /* APP_ENABLE_UDS */
   
-  weight /= resolution;
-  /* floor value */
-  v = (uint32_t)(weight * 10);
-  return (uint16_t)((v + 5) / 10);
-}
+  /**
+   * The Time Stamp is kept in the time base, it is only converted to the date and time
+   * when the measurement is sent
+   */
 
+#ifdef APP_ENABLE_WSS_BROADCAST
+  /* the gateways get the measurement without connecting */
+  WSSAPP_Broadcast(&WSSAPP_Context.MeasurementChar, time);
+#endif /* APP_ENABLE_WSS_BROADCAST */
 
-/*
- * Get Weight Measurement Resolution from Height Scale Feature field
- */
-static uint8_t WsFeatureField_HMR(void){
-  //APP_DBG_MSG("Feature in WsFeatureField_HMR = %X\n\r", WSSAPP_Context.FeatureChar.Value);
-  return ((WSSAPP_Context.FeatureChar.Value >> 7) & 0x07);
+#ifdef APP_ENABLE_WSS_STORE
+  /**
+   * Every measurement goes through the store, it is removed once the collector
+   * has confirmed the indication so that nothing is lost while it is away
+   */
+#ifdef APP_ENABLE_WSS_HISTORY
+  count = WSSSTORE_Count();
+#endif /* APP_ENABLE_WSS_HISTORY */
+  if(WSSSTORE_Push(WSSAPP_Context.MeasurementChar.UserID, time, &WSSAPP_Context.MeasurementChar) == WSSSTORE_OK){
+    APP_DBG_MSG("WSS Measurement stored, %d pending\n\r", WSSSTORE_Count());
+#ifdef APP_ENABLE_WSS_HISTORY
+    if(WSSAPP_Context.History_ConnHdle != WSSAPP_HISTORY_NONE){
+      if(WSSSTORE_Count() != (uint16_t)(count + 1)){
+        /* a page of the store has been erased, the sequence numbers are not valid anymore */
+        WSSAPP_History_Status(WSSAPP_Context.History_ConnHdle, WSSAPP_Context.History_OpCode, WSS_HISTORY_STATUS_RECORDS_LOST);
+        WSSAPP_History_End();
+      }
+      else{
+        WSSAPP_Context.History_EndSent = 0;
+        APP_BLE_Conn_Work(APP_BLE_Get_Link_Index(WSSAPP_Context.History_ConnHdle), APP_BLE_CONN_WORK_WSS_HISTORY, 1);
+        UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_HISTORY_ID, CFG_SCH_PRIO_0);
+      }
+    }
+#endif /* APP_ENABLE_WSS_HISTORY */
+    WSSAPP_Replay();
+    return;
+  }
+  APP_DBG_MSG("WSS Measurement not stored\n\r");
+#endif /* APP_ENABLE_WSS_STORE */
+
+  if(WSSAPP_Indication_Enabled()){
+    WSSAPP_SetTimeStamp(&WSSAPP_Context.MeasurementChar, time);
+#ifdef APP_ENABLE_WSS_STORE
+    /* its confirmation shall not remove a stored measurement */
+    if(WSS_Update_Char(WEIGHT_SCALE_MEASUREMENT_CHAR_UUID, (uint8_t *)&WSSAPP_Context.MeasurementChar) == BLE_STATUS_SUCCESS){
+      WSSAPP_Context.Replay_Stored = 0;
+    }
+#else
+    WSS_Update_Char(WEIGHT_SCALE_MEASUREMENT_CHAR_UUID, (uint8_t *)&WSSAPP_Context.MeasurementChar);
+#endif /* APP_ENABLE_WSS_STORE */
+  }
 }
 
+/**
+ * The measurement is indicated to every link which has enabled it
+ */
+static uint8_t WSSAPP_Indication_Enabled(void)
+{
+  uint8_t link;
+
+  for(link = 0; link < CFG_BLE_NUM_LINK; link++)
+  {
+    if(WSSAPP_Context.Indication_Status[link] != 0)
+    {
+      return 1;
+    }
+  }
 
-/*
- * Get Measurement Units from Flags of Weight Scale Measurement
+  return 0;
+}
+
+/**
+ * Set the Time Stamp of a measurement from its time in the time base
  */
-static Measurement_Unit_t WsMeasurementUnits_Height(void){
-  //APP_DBG_MSG("Flags in WsMeasurementUnits_Height = %X\n\r", WSSAPP_Context.MeasurementChar.Flags);
-  return (Measurement_Unit_t)(WSSAPP_Context.MeasurementChar.Flags & 1);
+static void WSSAPP_SetTimeStamp(WSS_MeasurementValue_t *pMeasurement, uint32_t Time)
+{
+  TIMEBASE_DateTime_t date_time;
+
+  TIMEBASE_ToDateTime(Time, &date_time);
+  pMeasurement->TimeStamp.Year    = date_time.Year;
+  pMeasurement->TimeStamp.Month   = date_time.Month;
+  pMeasurement->TimeStamp.Day     = date_time.Day;
+  pMeasurement->TimeStamp.Hours   = date_time.Hours;
+  pMeasurement->TimeStamp.Minutes = date_time.Minutes;
+  pMeasurement->TimeStamp.Seconds = date_time.Seconds;
 }
 
+#ifdef APP_ENABLE_WSS_STORE
+static void WsReplay( void )
+{
+  /**
+   * The code shall be executed in the background as aci command may be sent
+   * The background is the only place where the application can make sure a new aci command
+   * is not sent if there is a pending one
+   */
+  UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_REPLAY_ID, CFG_SCH_PRIO_0);
 
-/*
- * Height Measurement Resolution from Weight Scale Feature field
- * Return value is the resolution for meters or resolution for inches
+  return;
+}
+
+/**
+ * Send the oldest stored measurement
+ * Only one indication may be outstanding, the next one is sent straight from
+ * the confirmation so that the backlog is drained at the connection event rate
+ * The confirmation is reported once every subscribed link has confirmed it
  */
-static float WsMeasurementResolution_Height(uint8_t feature, Measurement_Unit_t unit){
-  float resolution = 1.0f; /* the default is Not specified */
-  
-  switch (feature){
-  case 1:
-    /* Resolution of 0.01 meter or 1 inch */
-    resolution = (unit == MeasurementUnits_SI) ? 0.01f : 1.0f;
-    break;
-  case 2:
-    /* Resolution of 0.005 meter or 0.5 inch */
-    resolution = (unit == MeasurementUnits_SI) ? 0.005f : 0.5f;
-    break;
-  case 3:
-    /* Resolution of 0.001 meter or 0.1 inch */
-    resolution = (unit == MeasurementUnits_SI) ? 0.001f : 0.1f;
-    break;
-  default:
-    /* do nothing */
-    break;
+static void WSSAPP_Replay(void)
+{
+  WSS_MeasurementValue_t measurement;
+  uint32_t time;
+  tBleStatus status;
+
+  if((WSSAPP_Indication_Enabled() == 0) || (WSSAPP_Context.Replay_InFlight != 0)){
+    return;
   }
-  
-  //APP_DBG_MSG("Get Height resolution = %f with feature = %X and unit = %d\n\r", resolution, feature, unit);
-  
-  return resolution;
-}
 
+#ifdef APP_ENABLE_WSS_HISTORY
+  /* the bulk transfer owns the store, the replay goes on once it is over */
+  if(WSSAPP_Context.History_ConnHdle != WSSAPP_HISTORY_NONE){
+    WSSAPP_Replay_Work(0);
+    return;
+  }
+#endif /* APP_ENABLE_WSS_HISTORY */
 
-/*
- * This function will transfer weight value with appoint unit
- * The formular: 1 pound = 0.4536 kilogram
- */
-static uint16_t WsConvert_Height(Measurement_Unit_t unit_from, Measurement_Unit_t unit_to, float height){
-  uint32_t v;
-  float resolution = WsMeasurementResolution_Height(WsFeatureField_HMR(), WsMeasurementUnits_Height());
-  
-  //APP_DBG_MSG("Convert Height %f with resolution = %f, unit %d -> %d\n\r", height, resolution, unit_from, unit_to);
-  
-  if((unit_from == MeasurementUnits_SI) && (unit_to == MeasurementUnits_Imperial)){
-    /* meters -> inches */
-    height /= INCHES_TO_METERS;
-  } else if ((unit_from == MeasurementUnits_Imperial) && (unit_to == MeasurementUnits_SI)){
-    /* inches -> meters */
-    height *= INCHES_TO_METERS;
+  if(WSSSTORE_Peek(&time, &measurement) != WSSSTORE_OK){
+    WSSAPP_Replay_Work(0);
+    return;
   }
-  
-  height /= resolution;
-  /* floor value */
-  v = (uint32_t)(height * 10);
-  return (uint16_t)((v + 5) / 10);
-}
 
+  /* the last stored measurement goes with the current connection parameters */
+  WSSAPP_Replay_Work(WSSSTORE_Count() > 1);
 
-/*
- * Calcular: BMI = Weight / (Height ^ 2) with Unit is 0.1 kg/m2
- */
-static uint16_t WsCalculate_BMI(float weight, float height){
-  float resolution = 0.1f;
-  float value = weight / (height * height);
-  uint32_t v;
-  
-  value /= resolution;
-  v = (uint32_t)(value * 10);
-  return (uint16_t)((v + 5) / 10);
+  WSSAPP_SetTimeStamp(&measurement, time);
+  status = WSS_Update_Char(WEIGHT_SCALE_MEASUREMENT_CHAR_UUID, (uint8_t *)&measurement);
+  if(status == BLE_STATUS_SUCCESS){
+    WSSAPP_Context.Replay_InFlight = 1;
+    WSSAPP_Context.Replay_Stored = 1;
+  }
+  else if(APP_BLE_Get_Server_Connection_Status() == APP_BLE_CONNECTED_SERVER){
+    /* another indication is outstanding or no buffer is available */
+    APP_DBG_MSG("WSS replay postponed, status = 0x%02X\n\r", status);
+    HW_TS_Start(WSSAPP_Context.TimerReplay_Id, WSS_REPLAY_RETRY_INTERVAL);
+  }
 }
 
+/**
+ * The subscribed links get the burst connection parameters while a backlog is replayed
+ */
+static void WSSAPP_Replay_Work(uint8_t Pending)
+{
+  uint8_t link;
 
-static void WSSAPP_Measurement(void)
+  for(link = 0; link < CFG_BLE_NUM_LINK; link++)
+  {
+    if(WSSAPP_Context.Indication_Status[link] != 0)
+    {
+      APP_BLE_Conn_Work(link, APP_BLE_CONN_WORK_WSS_REPLAY, Pending);
+    }
+  }
+}
+#endif /* APP_ENABLE_WSS_STORE */
+
+#ifdef APP_ENABLE_WSS_HISTORY
+/**
+ * Send the next Weight History Data frame
+ * A frame holds as many records as the ATT_MTU of the link allows, one frame is
+ * sent per run and the task is posted again until the buffers of the stack are full,
+ * it is then resumed by the ACI_GATT_TX_POOL_AVAILABLE event
+ */
+static void WSSAPP_History(void)
 {
-  /*Weight, BMI,  Height Initialization*/
-  
-  /* E.g. weight = 0x36B0 for 70kg with resolution = 0.0005 */
-  float weight_si = (float)(DEFAULT_WEIGHT_IN_KG + (rand() % 10));
-  uint16_t weight = WsConvert_Weight(MeasurementUnits_SI,
-                                    ((WSSAPP_Context.MeasurementChar.Flags & WSS_FLAGS_VALUE_UNIT_IMPERIAL) ? MeasurementUnits_Imperial : MeasurementUnits_SI),
-                                    weight_si);
-  float height_si = (float)(DEFAULT_HEIGHT_IN_METERS + (rand() % 10));
-  uint16_t height = WsConvert_Height(MeasurementUnits_SI,
-                                    ((WSSAPP_Context.MeasurementChar.Flags & WSS_FLAGS_VALUE_UNIT_IMPERIAL) ? MeasurementUnits_Imperial : MeasurementUnits_SI),
-                                    height_si);
-  uint16_t BMI = WsCalculate_BMI(weight_si, height_si);
-  uint32_t ticks = (HAL_GetTick() - WSSAPP_Context.StartTick) / 1000;
-  
-  //APP_DBG_MSG("weight_si = %f -> weight = %02X, height_si = %f -> height = %02X\n\r", weight_si, weight, height_si, height);
-  
-  APP_DBG_MSG("WSSAPP_Measurement ticks = %ld (delta = %ld)\n\r", HAL_GetTick(), ticks);
-  
-  if(WSSAPP_Context.Indication_Status == 0){
-    APP_DBG_MSG("Stop WSS Measurement\n\r");
-    HW_TS_Stop(WSSAPP_Context.TimerMeasurement_Id);
+  WSS_MeasurementValue_t measurement;
+  uint32_t time;
+  uint8_t *p_frame;
+  uint16_t pending;
+  uint16_t nb_records;
+  uint16_t index;
+  tBleStatus status;
+
+  if(WSSAPP_Context.History_TxPoolWait != 0){
     return;
   }
 
-  /* update Weight */
-  WSSAPP_Context.MeasurementChar.Weight = weight;
-  
-  /* update Height */
-  WSSAPP_Context.MeasurementChar.Height = height;
-  
-  /* update BMI */
-  WSSAPP_Context.MeasurementChar.BMI    = BMI;
-  
-  /* update User ID */
-  WSSAPP_Context.MeasurementChar.UserID = 0x01;
-  
-  /* update Time Stamp */
-  WSSAPP_Context.MeasurementChar.TimeStamp.Seconds = ticks % 60;
-  if(ticks >= 60){
-    WSSAPP_Context.MeasurementChar.TimeStamp.Minutes += ticks / 60;
+  if(WSSAPP_Context.History_Status != 0){
+    p_frame = WSS_History_Reserve(WSSAPP_Context.History_StatusConnHdle, WSS_HISTORY_STATUS_LENGTH);
+    p_frame[0] = WSS_HISTORY_FRAME_STATUS;
+    p_frame[1] = (uint8_t)(WSSAPP_Context.History_NextSeq & 0xFF);
+    p_frame[2] = (uint8_t)(WSSAPP_Context.History_NextSeq >> 8);
+    p_frame[3] = WSSAPP_Context.History_StatusOpCode;
+    p_frame[4] = WSSAPP_Context.History_Status;
+    status = WSS_History_Send();
+    if(status == BLE_STATUS_INSUFFICIENT_RESOURCES){
+      WSSAPP_Context.History_TxPoolWait = 1;
+      return;
+    }
+    APP_DBG_MSG("WSS History status 0x%02X, status = 0x%02X\n\r", WSSAPP_Context.History_Status, status);
+    WSSAPP_Context.History_Status = 0;
   }
 
-  if(WSSAPP_Context.MeasurementChar.TimeStamp.Minutes >= 60){
-    WSSAPP_Context.MeasurementChar.TimeStamp.Minutes = (WSSAPP_Context.MeasurementChar.TimeStamp.Minutes % 60);
-    
-    WSSAPP_Context.MeasurementChar.TimeStamp.Hours += (WSSAPP_Context.MeasurementChar.TimeStamp.Minutes / 60);
+  if(WSSAPP_Context.History_ConnHdle == WSSAPP_HISTORY_NONE){
+    return;
   }
-  
-  if(WSSAPP_Context.MeasurementChar.TimeStamp.Hours >= 24){
-    WSSAPP_Context.MeasurementChar.TimeStamp.Hours = (WSSAPP_Context.MeasurementChar.TimeStamp.Hours % 24);
-    
-    WSSAPP_Context.MeasurementChar.TimeStamp.Day += (WSSAPP_Context.MeasurementChar.TimeStamp.Hours / 24);
+
+  pending = WSSSTORE_Count() - (uint16_t)(WSSAPP_Context.History_NextSeq - WSSAPP_Context.History_AckSeq);
+  if(pending == 0){
+    if(WSSAPP_Context.History_EndSent == 0){
+      /* the collector acknowledges the last records and keeps the connection for the live measurements */
+      WSSAPP_Context.History_EndSent = 1;
+      APP_BLE_Conn_Work(APP_BLE_Get_Link_Index(WSSAPP_Context.History_ConnHdle), APP_BLE_CONN_WORK_WSS_HISTORY, 0);
+      WSSAPP_History_Status(WSSAPP_Context.History_ConnHdle, WSSAPP_Context.History_OpCode, WSS_HISTORY_STATUS_SUCCESS);
+    }
+    return;
   }
-  
-  /* let's handle date simply without permanment calendar */
-  if(WSSAPP_Context.MeasurementChar.TimeStamp.Day >= 30){
-    WSSAPP_Context.MeasurementChar.TimeStamp.Day = ((WSSAPP_Context.MeasurementChar.TimeStamp.Day - 1) % 30) + 1;
-    
-    WSSAPP_Context.MeasurementChar.TimeStamp.Month += (WSSAPP_Context.MeasurementChar.TimeStamp.Day / 30);
+
+  nb_records = (APP_BLE_Get_Att_Mtu(APP_BLE_Get_Link_Index(WSSAPP_Context.History_ConnHdle)) - 3 - WSS_HISTORY_HEADER_LENGTH) / WSS_HISTORY_RECORD_LENGTH;
+  if(nb_records > ((BLE_CFG_WSS_HISTORY_DATA_MAX_LENGTH - WSS_HISTORY_HEADER_LENGTH) / WSS_HISTORY_RECORD_LENGTH)){
+    nb_records = (BLE_CFG_WSS_HISTORY_DATA_MAX_LENGTH - WSS_HISTORY_HEADER_LENGTH) / WSS_HISTORY_RECORD_LENGTH;
   }
-  
-  if(WSSAPP_Context.MeasurementChar.TimeStamp.Month >= 12){
-    WSSAPP_Context.MeasurementChar.TimeStamp.Month = ((WSSAPP_Context.MeasurementChar.TimeStamp.Month - 1) % 12) + 1;
-    
-    WSSAPP_Context.MeasurementChar.TimeStamp.Year += (WSSAPP_Context.MeasurementChar.TimeStamp.Month / 12);
+  if(nb_records > pending){
+    nb_records = pending;
   }
 
-  if(WSSAPP_Context.Indication_Status){
-    WSS_Update_Char(WEIGHT_SCALE_MEASUREMENT_CHAR_UUID, (uint8_t *)&WSSAPP_Context.MeasurementChar);
+  p_frame = WSS_History_Reserve(WSSAPP_Context.History_ConnHdle,
+                                WSS_HISTORY_HEADER_LENGTH + nb_records * WSS_HISTORY_RECORD_LENGTH);
+  p_frame[0] = WSS_HISTORY_FRAME_RECORDS;
+  p_frame[1] = (uint8_t)(WSSAPP_Context.History_NextSeq & 0xFF);
+  p_frame[2] = (uint8_t)(WSSAPP_Context.History_NextSeq >> 8);
+  p_frame += WSS_HISTORY_HEADER_LENGTH;
+  for(index = 0; index < nb_records; index++){
+    /**
+     * The store is read in order from its cursor, no page is searched for each record
+     * The records hold the time base, as the history, there is no calendar conversion
+     */
+    WSSSTORE_Read((uint16_t)(WSSAPP_Context.History_NextSeq - WSSAPP_Context.History_AckSeq) + index, &time, &measurement);
+    WSS_History_SetRecord(p_frame, &measurement, time);
+    p_frame += WSS_HISTORY_RECORD_LENGTH;
+  }
+
+  status = WSS_History_Send();
+  if(status == BLE_STATUS_SUCCESS){
+    WSSAPP_Context.History_NextSeq += nb_records;
+    UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_HISTORY_ID, CFG_SCH_PRIO_0);
+  }
+  else if(status == BLE_STATUS_INSUFFICIENT_RESOURCES){
+    WSSAPP_Context.History_TxPoolWait = 1;
+  }
+  else{
+    APP_DBG_MSG("WSS History frame not sent, status = 0x%02X\n\r", status);
+  }
+}
+
+/**
+ * Weight History Control Point request of a collector
+ * The sequence numbers of RESUME and ACK shall be between the last acknowledged
+ * one and the next one to send
+ */
+static void WSSAPP_History_Request(WSS_App_Notification_evt_t *pNotification)
+{
+  uint16_t sequence = pNotification->HistorySequence;
+  uint16_t handle = pNotification->ConnectionHandle;
+
+  APP_DBG_MSG("WSS History request 0x%02X, sequence = %d\n\r", pNotification->HistoryOpCode, sequence);
+
+  if((WSSAPP_Context.History_ConnHdle != WSSAPP_HISTORY_NONE) && (WSSAPP_Context.History_ConnHdle != handle)){
+    WSSAPP_History_Status(handle, pNotification->HistoryOpCode, WSS_HISTORY_STATUS_BUSY);
+    return;
+  }
+
+  switch(pNotification->HistoryOpCode)
+  {
+    case WSS_HISTORY_OPCODE_START:
+      if((WSSAPP_Context.History_ConnHdle == WSSAPP_HISTORY_NONE) && (WSSAPP_Context.Replay_InFlight != 0)){
+        /* the stored measurement being indicated would be sent twice */
+        WSSAPP_History_Status(handle, WSS_HISTORY_OPCODE_START, WSS_HISTORY_STATUS_BUSY);
+        return;
+      }
+      WSSAPP_Context.History_ConnHdle = handle;
+      WSSAPP_Context.History_OpCode   = WSS_HISTORY_OPCODE_START;
+      WSSAPP_Context.History_AckSeq   = 0;
+      WSSAPP_Context.History_NextSeq  = 0;
+      WSSAPP_Context.History_EndSent  = 0;
+      HW_TS_Stop(WSSAPP_Context.TimerReplay_Id);
+      WSSAPP_Replay_Work(0);
+      APP_BLE_Conn_Work(APP_BLE_Get_Link_Index(handle), APP_BLE_CONN_WORK_WSS_HISTORY, 1);
+      break;
+
+    case WSS_HISTORY_OPCODE_RESUME:
+    case WSS_HISTORY_OPCODE_ACK:
+      if((WSSAPP_Context.History_ConnHdle == WSSAPP_HISTORY_NONE) ||
+         ((uint16_t)(sequence - WSSAPP_Context.History_AckSeq) > (uint16_t)(WSSAPP_Context.History_NextSeq - WSSAPP_Context.History_AckSeq))){
+        WSSAPP_History_Status(handle, pNotification->HistoryOpCode, WSS_HISTORY_STATUS_INVALID_SEQUENCE);
+        return;
+      }
+      if(pNotification->HistoryOpCode == WSS_HISTORY_OPCODE_RESUME){
+        WSSAPP_Context.History_OpCode  = WSS_HISTORY_OPCODE_RESUME;
+        WSSAPP_Context.History_NextSeq = sequence;
+        WSSAPP_Context.History_EndSent = 0;
+        APP_BLE_Conn_Work(APP_BLE_Get_Link_Index(handle), APP_BLE_CONN_WORK_WSS_HISTORY, 1);
+      }
+      else{
+        /* the acknowledged records are the oldest ones of the store */
+        while(WSSAPP_Context.History_AckSeq != sequence){
+          WSSSTORE_Pop();
+          WSSAPP_Context.History_AckSeq++;
+        }
+        APP_DBG_MSG("WSS History acknowledged up to %d, %d stored\n\r", sequence, WSSSTORE_Count());
+      }
+      break;
+
+    case WSS_HISTORY_OPCODE_ABORT:
+      WSSAPP_History_End();
+      break;
+
+    default:
+      break;
+  }
+
+  UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_HISTORY_ID, CFG_SCH_PRIO_0);
+}
+
+/**
+ * The status frame is sent by the history task, before any records frame
+ */
+static void WSSAPP_History_Status(uint16_t ConnectionHandle, uint8_t OpCode, uint8_t Status)
+{
+  WSSAPP_Context.History_StatusConnHdle = ConnectionHandle;
+  WSSAPP_Context.History_StatusOpCode   = OpCode;
+  WSSAPP_Context.History_Status         = Status;
+  UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_HISTORY_ID, CFG_SCH_PRIO_0);
+}
+
+/**
+ * End of the bulk transfer, the records not acknowledged are kept in the store
+ * and the indications of the stored measurements go on
+ */
+static void WSSAPP_History_End(void)
+{
+  if(WSSAPP_Context.History_ConnHdle == WSSAPP_HISTORY_NONE){
+    return;
+  }
+
+  APP_DBG_MSG("WSS History end, %d stored\n\r", WSSSTORE_Count());
+
+  APP_BLE_Conn_Work(APP_BLE_Get_Link_Index(WSSAPP_Context.History_ConnHdle), APP_BLE_CONN_WORK_WSS_HISTORY, 0);
+  WSSAPP_Context.History_ConnHdle = WSSAPP_HISTORY_NONE;
+
+  if((WSSAPP_Indication_Enabled() != 0) && (WSSSTORE_Count() > 0)){
+    UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_REPLAY_ID, CFG_SCH_PRIO_0);
+  }
+}
+
+static SVCCTL_EvtAckStatus_t WSSAPP_TxPoolAvailable(void *pEvt)
+{
+  if(WSSAPP_Context.History_TxPoolWait != 0){
+    WSSAPP_Context.History_TxPoolWait = 0;
+    UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_HISTORY_ID, CFG_SCH_PRIO_0);
+  }
+
+  return SVCCTL_EvtNotAck;
+}
+#endif /* APP_ENABLE_WSS_HISTORY */
+
+#ifdef APP_ENABLE_WSS_BROADCAST
+/**
+ * Broadcast a measurement in the service data of the Weight Scale Service
+ * The fields are laid out as in the Weight Measurement characteristic, without the
+ * BMI and Height to fit in the advertising data, and are followed by a sequence number
+ * so that a listener drops the advertisements of a measurement it already has
+ */
+static void WSSAPP_Broadcast(WSS_MeasurementValue_t *pMeasurement, uint32_t Time)
+{
+  TIMEBASE_DateTime_t date_time;
+  uint8_t data[WSS_BROADCAST_MAX_LENGTH];
+  uint8_t length = 0;
+  uint8_t flags;
+
+  flags = (pMeasurement->Flags & (WSS_FLAGS_VALUE_UNIT_IMPERIAL | WSS_FLAGS_TIME_STAMP_PRESENT)) | WSS_FLAGS_USER_ID_PRESENT;
+
+  data[length++] = flags;
+  data[length++] = (uint8_t)(pMeasurement->Weight & 0xFF);
+  data[length++] = (uint8_t)(pMeasurement->Weight >> 8);
+  if(flags & WSS_FLAGS_TIME_STAMP_PRESENT){
+    TIMEBASE_ToDateTime(Time, &date_time);
+    data[length++] = (uint8_t)(date_time.Year & 0xFF);
+    data[length++] = (uint8_t)(date_time.Year >> 8);
+    data[length++] = date_time.Month;
+    data[length++] = date_time.Day;
+    data[length++] = date_time.Hours;
+    data[length++] = date_time.Minutes;
+    data[length++] = date_time.Seconds;
   }
+  data[length++] = pMeasurement->UserID;
+  data[length++] = ++WSSAPP_Context.Broadcast_Sequence;
+
+  APP_DBG_MSG("WSS Broadcast, sequence = %d\n\r", WSSAPP_Context.Broadcast_Sequence);
+
+  APP_BLE_Broadcast(WEIGHT_SCALE_SERVICE_UUID, data, length);
 }
+#endif /* APP_ENABLE_WSS_BROADCAST */
 
 /* Public functions ----------------------------------------------------------*/
 void WSS_App_Notification(WSS_App_Notification_evt_t *pNotification)
 {
-  APP_DBG_MSG("WSS_App_Notification, code = %d (tick = %ld)\n\r", pNotification->WSS_Evt_Opcode, HAL_GetTick());
+  uint8_t link;
+
+  APP_DBG_MSG("WSS_App_Notification, code = %d, connection = 0x%x (tick = %ld)\n\r", pNotification->WSS_Evt_Opcode, pNotification->ConnectionHandle, HAL_GetTick());
   
+  link = APP_BLE_Get_Link_Index(pNotification->ConnectionHandle);
+
   switch(pNotification->WSS_Evt_Opcode)
   {
     case WSS_MEASUREMENT_IND_ENABLED_EVT:
-      WSSAPP_Context.Indication_Status = 1;
+      if(link < CFG_BLE_NUM_LINK){
+        WSSAPP_Context.Indication_Status[link] = 1;
+      }
+#ifdef APP_ENABLE_WSS_STORE
+      /* the outstanding indication did not reach the new link, it is sent again */
+      WSSAPP_Context.Replay_InFlight = 0;
+      if(WSSSTORE_Count() > 0){
+        APP_DBG_MSG("WSS replay of %d stored measurement(s)\n\r", WSSSTORE_Count());
+        UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_REPLAY_ID, CFG_SCH_PRIO_0);
+      }
+#endif /* APP_ENABLE_WSS_STORE */
       
 //      HW_TS_Stop(WSSAPP_Context.TimerMeasurement_Id);
 //      HW_TS_Start(WSSAPP_Context.TimerMeasurement_Id, WSS_MEASUREMENT_INTERVAL);
       break;
 
     case WSS_MEASUREMENT_IND_DISABLED_EVT:
-      WSSAPP_Context.Indication_Status = 0;
+      if(link < CFG_BLE_NUM_LINK){
+        WSSAPP_Context.Indication_Status[link] = 0;
+      }
+#ifdef APP_ENABLE_WSS_STORE
+      APP_BLE_Conn_Work(link, APP_BLE_CONN_WORK_WSS_REPLAY, 0);
+      if(WSSAPP_Indication_Enabled() == 0){
+        WSSAPP_Context.Replay_InFlight = 0;
+        HW_TS_Stop(WSSAPP_Context.TimerReplay_Id);
+      }
+#endif /* APP_ENABLE_WSS_STORE */
       
 //      HW_TS_Stop(WSSAPP_Context.TimerMeasurement_Id);
       break;
 
+#ifdef APP_ENABLE_WSS_STORE
+    case WSS_MEASUREMENT_IND_CONFIRMED_EVT:
+      WSSAPP_Context.Replay_InFlight = 0;
+      /* the measurement sent when the store failed is not in the store */
+      if(WSSAPP_Context.Replay_Stored != 0){
+        WSSAPP_Context.Replay_Stored = 0;
+        WSSSTORE_Pop();
+      }
+      WSSAPP_Replay();
+      break;
+#endif /* APP_ENABLE_WSS_STORE */
+
+#ifdef APP_ENABLE_WSS_HISTORY
+    case WSS_HISTORY_NOTIF_ENABLED_EVT:
+      break;
+
+    case WSS_HISTORY_NOTIF_DISABLED_EVT:
+      if(WSSAPP_Context.History_ConnHdle == pNotification->ConnectionHandle){
+        WSSAPP_History_End();
+      }
+      break;
+
+    case WSS_HISTORY_CONTROL_POINT_EVT:
+      WSSAPP_History_Request(pNotification);
+      break;
+#endif /* APP_ENABLE_WSS_HISTORY */
+
     default:
       break;
   }
@@ -393,19 +675,74 @@ void WSS_App_Notification(WSS_App_Notification_evt_t *pNotification)
   return;
 }
 
+void WSSAPP_Reset(uint16_t ConnectionHandle)
+{
+  uint8_t link;
+
+  APP_DBG_MSG("WSSAPP_Reset 0x%x\n\r", ConnectionHandle);
+
+  link = APP_BLE_Get_Link_Index(ConnectionHandle);
+  if(link < CFG_BLE_NUM_LINK){
+    WSSAPP_Context.Indication_Status[link]         = 0;
+  }
+
+  /*
+   * The confirmation of the closed link is not waited for anymore
+   */
+  WSS_Disconnection(ConnectionHandle);
+
+#ifdef APP_ENABLE_WSS_STORE
+  /*
+   * The pending indication is lost with the last connection, the stored
+   * measurement is kept and sent again with the next replay
+   */
+  if(WSSAPP_Indication_Enabled() == 0){
+    WSSAPP_Context.Replay_InFlight                 = 0;
+    HW_TS_Stop(WSSAPP_Context.TimerReplay_Id);
+  }
+#endif /* APP_ENABLE_WSS_STORE */
+
+#ifdef APP_ENABLE_WSS_HISTORY
+  /*
+   * The bulk transfer of the closed link ends, its status frame is dropped
+   */
+  if(WSSAPP_Context.History_StatusConnHdle == ConnectionHandle){
+    WSSAPP_Context.History_Status                  = 0;
+  }
+  if(WSSAPP_Context.History_ConnHdle == ConnectionHandle){
+    WSSAPP_History_End();
+  }
+#endif /* APP_ENABLE_WSS_HISTORY */
+}
+
+static SVCCTL_EvtAckStatus_t WSSAPP_Disconnection(void *pEvt)
+{
+  WSSAPP_Reset(((hci_disconnection_complete_event_rp0 *)pEvt)->Connection_Handle);
+
+  return SVCCTL_EvtNotAck;
+}
+
 void WSSAPP_Init(void)
 {
+  uint8_t link;
+
   APP_DBG_MSG("WSSAPP_Init\n\r");
-  
+
   /*
-   * No Indication by default
+   * The context of a link is reset on its disconnection
    */
-  WSSAPP_Context.Indication_Status                 = 0;
+  if (SVCCTL_SubscribeEvt(HCI_DISCONNECTION_COMPLETE_EVT_CODE, 0, WSSAPP_Disconnection) != BLE_STATUS_SUCCESS)
+  {
+    /* BLE_CFG_EVT_MAX_NBR_SUBSCRIBER is too small */
+    Error_Handler();
+  }
   
   /*
-   * Ticks
+   * No Indication by default
    */
-  WSSAPP_Context.StartTick                         = HAL_GetTick();
+  for(link = 0; link < CFG_BLE_NUM_LINK; link++){
+    WSSAPP_Context.Indication_Status[link]         = 0;
+  }
   
   /**
    * Initialize Weight Scale Features
@@ -426,15 +763,10 @@ void WSSAPP_Init(void)
   
   /* Weight */
   WSSAPP_Context.MeasurementChar.Weight            = 0;
+  WSSAPP_Context.DeadlineMiss                      = 0;
   
   /* Add support for Time Stamp */
   WSSAPP_Context.MeasurementChar.Flags            |= WSS_FLAGS_TIME_STAMP_PRESENT;
-  WSSAPP_Context.MeasurementChar.TimeStamp.Year    = DEFAULT_WSS_TIME_STAMP_YEAR;
-  WSSAPP_Context.MeasurementChar.TimeStamp.Month   = DEFAULT_WSS_TIME_STAMP_MONTH;
-  WSSAPP_Context.MeasurementChar.TimeStamp.Day     = DEFAULT_WSS_TIME_STAMP_DAY;
-  WSSAPP_Context.MeasurementChar.TimeStamp.Hours   = DEFAULT_WSS_TIME_STAMP_HOURS;
-  WSSAPP_Context.MeasurementChar.TimeStamp.Minutes = DEFAULT_WSS_TIME_STAMP_MINUTES;
-  WSSAPP_Context.MeasurementChar.TimeStamp.Seconds = DEFAULT_WSS_TIME_STAMP_SECONDS;
   
 #ifdef SUPPORT_MULTI_USERS
   /* Add support for User ID */
@@ -450,12 +782,44 @@ void WSSAPP_Init(void)
   /*
    * Create timer for Weight Scale Measurement
    */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR, &(WSSAPP_Context.TimerMeasurement_Id), hw_ts_Repeated, WsMeas);
+  HW_TS_CreateWithSlack(CFG_TIM_PROC_ID_ISR, &(WSSAPP_Context.TimerMeasurement_Id), hw_ts_Repeated, WsMeas, CFG_TS_SLACK_PERIODIC);
   
   /*
    * Register task for Weight Scale Measurment
    */
   UTIL_SEQ_RegTask( 1<< CFG_TASK_WSS_MEAS_REQ_ID, UTIL_SEQ_RFU, WSSAPP_Measurement );
+
+#ifdef APP_ENABLE_WSS_STORE
+  /*
+   * Measurements history kept in flash
+   */
+  WSSAPP_Context.Replay_InFlight                   = 0;
+  WSSAPP_Context.Replay_Stored                     = 0;
+  WSSSTORE_Init();
+
+  HW_TS_CreateWithSlack(CFG_TIM_PROC_ID_ISR, &(WSSAPP_Context.TimerReplay_Id), hw_ts_SingleShot, WsReplay, CFG_TS_SLACK_RETRY);
+  UTIL_SEQ_RegTask( 1<< CFG_TASK_WSS_REPLAY_ID, UTIL_SEQ_RFU, WSSAPP_Replay );
+#endif /* APP_ENABLE_WSS_STORE */
+
+#ifdef APP_ENABLE_WSS_HISTORY
+  /*
+   * Bulk transfer of the stored measurements, resumed when a notification buffer is free
+   */
+  WSSAPP_Context.History_ConnHdle                  = WSSAPP_HISTORY_NONE;
+  WSSAPP_Context.History_StatusConnHdle            = WSSAPP_HISTORY_NONE;
+  WSSAPP_Context.History_Status                    = 0;
+  WSSAPP_Context.History_TxPoolWait                = 0;
+  UTIL_SEQ_RegTask( 1<< CFG_TASK_WSS_HISTORY_ID, UTIL_SEQ_RFU, WSSAPP_History );
+  if (SVCCTL_SubscribeEvt(HCI_VENDOR_SPECIFIC_DEBUG_EVT_CODE, ACI_GATT_TX_POOL_AVAILABLE_VSEVT_CODE, WSSAPP_TxPoolAvailable) != BLE_STATUS_SUCCESS)
+  {
+    /* BLE_CFG_EVT_MAX_NBR_SUBSCRIBER is too small */
+    Error_Handler();
+  }
+#endif /* APP_ENABLE_WSS_HISTORY */
+
+#ifdef APP_ENABLE_WSS_BROADCAST
+  WSSAPP_Context.Broadcast_Sequence                = 0;
+#endif /* APP_ENABLE_WSS_BROADCAST */
 }
 
 /* USER CODE BEGIN FD */
@@ -48,6 +48,7 @@ extern "C"
 /* USER CODE END EM */
 
 /* Exported functions prototypes ---------------------------------------------*/
+void WSSAPP_Reset(uint16_t ConnectionHandle);
 void WSSAPP_Init(void);
 /* USER CODE BEGIN EFP */
 
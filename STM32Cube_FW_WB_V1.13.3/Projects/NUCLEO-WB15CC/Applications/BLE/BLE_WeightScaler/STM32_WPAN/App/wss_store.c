@@ -0,0 +1,450 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    wss_store.c
+  * @author  MCD Application Team
+  * @brief   Weight Scale Measurement history kept in flash
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "app_common.h"
+
+#include "dbg_trace.h"
+#include "ble.h"
+#include "shci.h"
+#include "wss_store.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * The store is a ring of records over the CFG_WSS_STORE_SIZE flash area.
+ * Records are written in sequence, the page following the one being filled
+ * is always erased before its last record is written so that at least one
+ * erased record exists and gives the position of the ring head after a reset.
+ * When the ring is full, the oldest page is lost.
+ */
+typedef struct{
+  uint16_t WriteIdx;  /**< next erased record */
+  uint16_t ReadIdx;   /**< oldest record not yet delivered */
+  uint16_t Count;     /**< number of records not yet delivered */
+  uint16_t CursorIdx;     /**< record of the last WSSSTORE_Read() */
+  uint16_t CursorOffset;  /**< its offset from the oldest pending record, WSSSTORE_CURSOR_NONE when unknown */
+} WSSSTORE_Context_t;
+
+typedef enum
+{
+  WSSSTORE_RECORD_ERASED,
+  WSSSTORE_RECORD_PENDING,
+  WSSSTORE_RECORD_DELIVERED
+} WSSSTORE_RecordState_t;
+
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private defines ------------------------------------------------------------*/
+#define WSSSTORE_PAGE_NBR                  (CFG_WSS_STORE_SIZE / FLASH_PAGE_SIZE)
+#define WSSSTORE_RECORD_PER_PAGE           (FLASH_PAGE_SIZE / WSSSTORE_RECORD_SIZE)
+
+/**
+ * The records of the previous layout, with the date and time, have another marker and are skipped
+ */
+#define WSSSTORE_MARKER_VALID              (0xA6)
+#define WSSSTORE_CURSOR_NONE               (0xFFFF)
+
+/**
+ * Record layout
+ */
+#define WSSSTORE_OFFSET_MARKER             (0)
+#define WSSSTORE_OFFSET_USER_INDEX         (1)
+#define WSSSTORE_OFFSET_FLAGS              (2)
+#define WSSSTORE_OFFSET_WEIGHT             (3)
+#define WSSSTORE_OFFSET_TIME               (5)    /**< seconds of the time base */
+#define WSSSTORE_OFFSET_UNUSED             (9)
+#define WSSSTORE_OFFSET_BMI                (12)
+#define WSSSTORE_OFFSET_HEIGHT             (14)
+
+#if (WSSSTORE_PAGE_NBR < 2)
+#error "CFG_WSS_STORE_SIZE shall cover at least 2 flash pages"
+#endif
+
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macros -------------------------------------------------------------*/
+#define STORE_LE_16(buf, val)    ( ((buf)[0] =  (uint8_t) (val)    ) , \
+                                   ((buf)[1] =  (uint8_t) (val>>8) ) )
+#define LOAD_LE_16(buf)          ( (uint16_t)((buf)[0]) | ((uint16_t)((buf)[1]) << 8) )
+#define STORE_LE_32(buf, val)    ( ((buf)[0] =  (uint8_t) (val)     ) , \
+                                   ((buf)[1] =  (uint8_t) (val>>8)  ) , \
+                                   ((buf)[2] =  (uint8_t) (val>>16) ) , \
+                                   ((buf)[3] =  (uint8_t) (val>>24) ) )
+#define LOAD_LE_32(buf)          ( (uint32_t)((buf)[0]) | ((uint32_t)((buf)[1]) << 8) | \
+                                   ((uint32_t)((buf)[2]) << 16) | ((uint32_t)((buf)[3]) << 24) )
+
+#define WSSSTORE_RECORD_ADDRESS(idx)       (CFG_WSS_STORE_ADDRESS + ((uint32_t)(idx) * WSSSTORE_RECORD_SIZE))
+#define WSSSTORE_NEXT(idx)                 (((idx) + 1) % WSSSTORE_RECORD_NBR)
+
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+static WSSSTORE_Context_t WSSSTORE_Context;
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+static WSSSTORE_RecordState_t WssStore_RecordState(uint16_t idx);
+static void WssStore_Scan(void);
+static void WssStore_Decode(uint16_t idx, uint32_t *pTime, WSS_MeasurementValue_t *pMeasurement);
+static HAL_StatusTypeDef WssStore_FlashProgram(uint32_t address, uint64_t data);
+static HAL_StatusTypeDef WssStore_FlashErase(uint32_t address);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Functions Definition ------------------------------------------------------*/
+static WSSSTORE_RecordState_t WssStore_RecordState(uint16_t idx)
+{
+  uint64_t header = *(__IO uint64_t *)WSSSTORE_RECORD_ADDRESS(idx);
+
+  if(header == UINT64_MAX)
+  {
+    return WSSSTORE_RECORD_ERASED;
+  }
+
+  if((header & 0xFF) == WSSSTORE_MARKER_VALID)
+  {
+    return WSSSTORE_RECORD_PENDING;
+  }
+
+  /* programmed to 0 once delivered, any other value comes from an interrupted write */
+  return WSSSTORE_RECORD_DELIVERED;
+}
+
+/**
+ * Locate the oldest pending record from the ring head and count the pending records
+ */
+static void WssStore_Scan(void)
+{
+  uint16_t idx = WSSSTORE_Context.WriteIdx;
+  uint16_t loop;
+
+  WSSSTORE_Context.ReadIdx = WSSSTORE_Context.WriteIdx;
+  WSSSTORE_Context.Count = 0;
+  WSSSTORE_Context.CursorOffset = WSSSTORE_CURSOR_NONE;
+
+  for(loop = 0; loop < WSSSTORE_RECORD_NBR; loop++)
+  {
+    if(WssStore_RecordState(idx) == WSSSTORE_RECORD_PENDING)
+    {
+      if(WSSSTORE_Context.Count == 0)
+      {
+        WSSSTORE_Context.ReadIdx = idx;
+      }
+      WSSSTORE_Context.Count++;
+    }
+    idx = WSSSTORE_NEXT(idx);
+  }
+}
+
+/**
+ * The time stamp of the measurement is left as is, the time is returned in the time base
+ */
+static void WssStore_Decode(uint16_t idx, uint32_t *pTime, WSS_MeasurementValue_t *pMeasurement)
+{
+  uint8_t record[WSSSTORE_RECORD_SIZE];
+
+  memcpy(record, (const void *)WSSSTORE_RECORD_ADDRESS(idx), WSSSTORE_RECORD_SIZE);
+
+  pMeasurement->Flags             = record[WSSSTORE_OFFSET_FLAGS];
+  pMeasurement->UserID            = record[WSSSTORE_OFFSET_USER_INDEX];
+  pMeasurement->Weight            = LOAD_LE_16(record + WSSSTORE_OFFSET_WEIGHT);
+  *pTime                          = LOAD_LE_32(record + WSSSTORE_OFFSET_TIME);
+  pMeasurement->BMI               = LOAD_LE_16(record + WSSSTORE_OFFSET_BMI);
+  pMeasurement->Height            = LOAD_LE_16(record + WSSSTORE_OFFSET_HEIGHT);
+}
+
+/**
+ * The CPU1 shall not write in flash while the CPU2 holds CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID,
+ * the semaphore is released just after writing the double word
+ */
+static HAL_StatusTypeDef WssStore_FlashProgram(uint32_t address, uint64_t data)
+{
+  HAL_StatusTypeDef status;
+
+  while(LL_HSEM_1StepLock(HSEM, CFG_HW_FLASH_SEMID));
+  HAL_FLASH_Unlock();
+
+  while(LL_HSEM_1StepLock(HSEM, CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID));
+  status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address, data);
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID, 0);
+
+  HAL_FLASH_Lock();
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_FLASH_SEMID, 0);
+
+  return status;
+}
+
+/**
+ * The CPU2 is notified of the erase activity so that it is scheduled
+ * when the BLE RF is idle
+ */
+static HAL_StatusTypeDef WssStore_FlashErase(uint32_t address)
+{
+  FLASH_EraseInitTypeDef erase_init;
+  uint32_t page_error;
+  HAL_StatusTypeDef status;
+
+  erase_init.TypeErase = FLASH_TYPEERASE_PAGES;
+  erase_init.Page = (address - FLASH_BASE) / FLASH_PAGE_SIZE;
+  erase_init.NbPages = 1;
+
+  SHCI_C2_FLASH_EraseActivity(ERASE_ACTIVITY_ON);
+
+  while(LL_HSEM_1StepLock(HSEM, CFG_HW_FLASH_SEMID));
+  HAL_FLASH_Unlock();
+
+  while(LL_HSEM_1StepLock(HSEM, CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID));
+  status = HAL_FLASHEx_Erase(&erase_init, &page_error);
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_BLOCK_FLASH_REQ_BY_CPU2_SEMID, 0);
+
+  HAL_FLASH_Lock();
+  LL_HSEM_ReleaseLock(HSEM, CFG_HW_FLASH_SEMID, 0);
+
+  SHCI_C2_FLASH_EraseActivity(ERASE_ACTIVITY_OFF);
+
+  return status;
+}
+
+/* Public functions ----------------------------------------------------------*/
+void WSSSTORE_Init(void)
+{
+  uint16_t idx;
+  uint16_t prev;
+
+  /**
+   * The ring head is the erased record following a written one
+   */
+  WSSSTORE_Context.WriteIdx = 0;
+  prev = WSSSTORE_RECORD_NBR - 1;
+  for(idx = 0; idx < WSSSTORE_RECORD_NBR; idx++)
+  {
+    if((WssStore_RecordState(idx) == WSSSTORE_RECORD_ERASED) &&
+       (WssStore_RecordState(prev) != WSSSTORE_RECORD_ERASED))
+    {
+      WSSSTORE_Context.WriteIdx = idx;
+      break;
+    }
+    prev = idx;
+  }
+
+  if((idx == WSSSTORE_RECORD_NBR) && (WssStore_RecordState(0) != WSSSTORE_RECORD_ERASED))
+  {
+    /* No erased record, the erase of the next page has been interrupted */
+    WssStore_FlashErase(WSSSTORE_RECORD_ADDRESS(0));
+  }
+
+  WssStore_Scan();
+
+  APP_DBG_MSG("WSSSTORE_Init: %d record(s) pending, head = %d\n\r", WSSSTORE_Context.Count, WSSSTORE_Context.WriteIdx);
+}
+
+/**
+ * @brief  Append a measurement to the store
+ * @param  user_index: UDS User Index the measurement belongs to
+ * @param  time: time of the measurement in the time base, its time stamp is not stored
+ * @param  pMeasurement: measurement to store
+ * @retval WSSSTORE_OK when the record has been written
+ */
+WSSSTORE_Status_t WSSSTORE_Push(uint8_t user_index, uint32_t time, WSS_MeasurementValue_t *pMeasurement)
+{
+  uint8_t record[WSSSTORE_RECORD_SIZE];
+  uint64_t dword[WSSSTORE_RECORD_SIZE / sizeof(uint64_t)];
+  uint32_t address = WSSSTORE_RECORD_ADDRESS(WSSSTORE_Context.WriteIdx);
+  uint16_t next = WSSSTORE_NEXT(WSSSTORE_Context.WriteIdx);
+
+  record[WSSSTORE_OFFSET_MARKER]     = WSSSTORE_MARKER_VALID;
+  record[WSSSTORE_OFFSET_USER_INDEX] = user_index;
+  record[WSSSTORE_OFFSET_FLAGS]      = pMeasurement->Flags;
+  STORE_LE_16(record + WSSSTORE_OFFSET_WEIGHT, pMeasurement->Weight);
+  STORE_LE_32(record + WSSSTORE_OFFSET_TIME, time);
+  memset(record + WSSSTORE_OFFSET_UNUSED, 0xFF, WSSSTORE_OFFSET_BMI - WSSSTORE_OFFSET_UNUSED);
+  STORE_LE_16(record + WSSSTORE_OFFSET_BMI, pMeasurement->BMI);
+  STORE_LE_16(record + WSSSTORE_OFFSET_HEIGHT, pMeasurement->Height);
+  memcpy(dword, record, sizeof(dword));
+
+  if((next % WSSSTORE_RECORD_PER_PAGE) == 0)
+  {
+    /**
+     * Last record of the page, free the next page first so that the ring head
+     * can still be found if the write is interrupted
+     */
+    if(WssStore_FlashErase(WSSSTORE_RECORD_ADDRESS(next)) != HAL_OK)
+    {
+      return WSSSTORE_ERROR;
+    }
+  }
+
+  /* The header double word holding the marker is written last */
+  if((WssStore_FlashProgram(address + sizeof(uint64_t), dword[1]) != HAL_OK) ||
+     (WssStore_FlashProgram(address, dword[0]) != HAL_OK))
+  {
+    return WSSSTORE_ERROR;
+  }
+
+  WSSSTORE_Context.WriteIdx = next;
+
+  if((next % WSSSTORE_RECORD_PER_PAGE) == 0)
+  {
+    /* The records of the erased page are lost when the store is full */
+    WssStore_Scan();
+  }
+  else
+  {
+    if(WSSSTORE_Context.Count == 0)
+    {
+      WSSSTORE_Context.ReadIdx = (uint16_t)((address - CFG_WSS_STORE_ADDRESS) / WSSSTORE_RECORD_SIZE);
+    }
+    WSSSTORE_Context.Count++;
+  }
+
+  return WSSSTORE_OK;
+}
+
+/**
+ * @brief  Read the oldest record not yet delivered
+ * @param  pTime: updated with the time of the measurement in the time base
+ * @param  pMeasurement: updated with the stored measurement, except its time stamp
+ * @retval WSSSTORE_EMPTY when no record is pending
+ */
+WSSSTORE_Status_t WSSSTORE_Peek(uint32_t *pTime, WSS_MeasurementValue_t *pMeasurement)
+{
+  if(WSSSTORE_Context.Count == 0)
+  {
+    return WSSSTORE_EMPTY;
+  }
+
+  WssStore_Decode(WSSSTORE_Context.ReadIdx, pTime, pMeasurement);
+
+  return WSSSTORE_OK;
+}
+
+/**
+ * @brief  Read a record not yet delivered without changing the store
+ *         The walk starts from the record of the previous read when the offset is not below it,
+ *         so that reading the records in sequence does not scan the ring again for each of them
+ * @param  offset: position of the record from the oldest one not yet delivered
+ * @param  pTime: updated with the time of the measurement in the time base
+ * @param  pMeasurement: updated with the stored measurement, except its time stamp
+ * @retval WSSSTORE_EMPTY when fewer records are pending
+ */
+WSSSTORE_Status_t WSSSTORE_Read(uint16_t offset, uint32_t *pTime, WSS_MeasurementValue_t *pMeasurement)
+{
+  uint16_t idx;
+  uint16_t idx_offset;
+
+  if(offset >= WSSSTORE_Context.Count)
+  {
+    return WSSSTORE_EMPTY;
+  }
+
+  if((WSSSTORE_Context.CursorOffset != WSSSTORE_CURSOR_NONE) && (WSSSTORE_Context.CursorOffset <= offset))
+  {
+    idx = WSSSTORE_Context.CursorIdx;
+    idx_offset = WSSSTORE_Context.CursorOffset;
+  }
+  else
+  {
+    idx = WSSSTORE_Context.ReadIdx;
+    idx_offset = 0;
+  }
+
+  while(idx_offset < offset)
+  {
+    idx = WSSSTORE_NEXT(idx);
+    if(WssStore_RecordState(idx) == WSSSTORE_RECORD_PENDING)
+    {
+      idx_offset++;
+    }
+  }
+
+  WSSSTORE_Context.CursorIdx = idx;
+  WSSSTORE_Context.CursorOffset = offset;
+
+  WssStore_Decode(idx, pTime, pMeasurement);
+
+  return WSSSTORE_OK;
+}
+
+/**
+ * @brief  Mark the oldest record as delivered
+ * @param  None
+ * @retval WSSSTORE_EMPTY when no record is pending
+ */
+WSSSTORE_Status_t WSSSTORE_Pop(void)
+{
+  uint16_t idx;
+
+  if(WSSSTORE_Context.Count == 0)
+  {
+    return WSSSTORE_EMPTY;
+  }
+
+  if(WssStore_FlashProgram(WSSSTORE_RECORD_ADDRESS(WSSSTORE_Context.ReadIdx), 0) != HAL_OK)
+  {
+    return WSSSTORE_ERROR;
+  }
+
+  WSSSTORE_Context.Count--;
+
+  /* the records behind the cursor get one position closer to the oldest one */
+  if((WSSSTORE_Context.CursorOffset == 0) || (WSSSTORE_Context.CursorOffset == WSSSTORE_CURSOR_NONE))
+  {
+    WSSSTORE_Context.CursorOffset = WSSSTORE_CURSOR_NONE;
+  }
+  else
+  {
+    WSSSTORE_Context.CursorOffset--;
+  }
+
+  idx = WSSSTORE_NEXT(WSSSTORE_Context.ReadIdx);
+  while((WSSSTORE_Context.Count > 0) && (WssStore_RecordState(idx) != WSSSTORE_RECORD_PENDING))
+  {
+    idx = WSSSTORE_NEXT(idx);
+  }
+  WSSSTORE_Context.ReadIdx = idx;
+
+  return WSSSTORE_OK;
+}
+
+uint16_t WSSSTORE_Count(void)
+{
+  return WSSSTORE_Context.Count;
+}
+
+/* USER CODE BEGIN FD */
+
+/* USER CODE END FD */
@@ -48,6 +48,23 @@
 #define CFG_FAST_CONN_ADV_INTERVAL_MAX    (0xa0)  /**< 100ms */
 #define CFG_LP_CONN_ADV_INTERVAL_MIN      (0x640) /**< 1s */
 #define CFG_LP_CONN_ADV_INTERVAL_MAX      (0xfa0) /**< 2.5s */
+#define CFG_BROADCAST_ADV_INTERVAL_MIN    (0x20)  /**< 20ms */
+#define CFG_BROADCAST_ADV_INTERVAL_MAX    (0x30)  /**< 30ms */
+
+/**
+ * Define the connection parameters requested by the connection policy
+ * Burst: the services have pending work on the link (history replay, user data procedure)
+ * Idle: no pending work for a while, the slave latency lets the device skip most connection events
+ * Interval in units of 1.25ms, supervision timeout in units of 10ms
+ */
+#define CFG_CONN_BURST_INTERVAL_MIN       (0x0c)  /**< 15ms */
+#define CFG_CONN_BURST_INTERVAL_MAX       (0x18)  /**< 30ms */
+#define CFG_CONN_BURST_LATENCY            (0)
+#define CFG_CONN_BURST_TIMEOUT            (0xc8)  /**< 2s */
+#define CFG_CONN_IDLE_INTERVAL_MIN        (0x60)  /**< 120ms */
+#define CFG_CONN_IDLE_INTERVAL_MAX        (0x78)  /**< 150ms */
+#define CFG_CONN_IDLE_LATENCY             (10)    /**< 1.65s between two connection events at most */
+#define CFG_CONN_IDLE_TIMEOUT             (0x258) /**< 6s */
 
 /**
  * Define IO Authentication
@@ -167,7 +184,7 @@
  * Note that certain characteristics and relative descriptors are added automatically during device initialization
  * so this parameters should be 9 plus the number of user Attributes
  */
-#define CFG_BLE_NUM_GATT_ATTRIBUTES 68
+#define CFG_BLE_NUM_GATT_ATTRIBUTES 73
 
 /**
  * Maximum supported ATT_MTU size
@@ -186,7 +203,7 @@
  *  The total amount of memory needed is the sum of the above quantities for each attribute.
  * This parameter is ignored by the CPU2 when CFG_BLE_OPTIONS is set to 1"
  */
-#define CFG_BLE_ATT_VALUE_ARRAY_SIZE    (1344)
+#define CFG_BLE_ATT_VALUE_ARRAY_SIZE    (1544)
 
 /**
  * Prepare Write List size in terms of number of packet
@@ -447,6 +464,14 @@
 #define CFG_TS_TICK_VAL           DIVR( (CFG_RTCCLK_DIV * 1000000), LSE_VALUE )
 #define CFG_TS_TICK_VAL_PS        DIVR( ((uint64_t)CFG_RTCCLK_DIV * 1e12), (uint64_t)LSE_VALUE )
 
+/**
+ * Slack given to the application timers created with HW_TS_CreateWithSlack()
+ * Their timeout may be delayed by up to this value to share the RTC wakeup of another timer
+ */
+#define CFG_TS_SLACK_PERIODIC     (100000/CFG_TS_TICK_VAL)  /**< 100ms, measurement, level and trace timers */
+#define CFG_TS_SLACK_RETRY        (10000/CFG_TS_TICK_VAL)   /**< 10ms, retry timers */
+#define CFG_TS_SLACK_ADV          (500000/CFG_TS_TICK_VAL)  /**< 500ms, advertising and connection managers */
+
 typedef enum
 {
   CFG_TIM_PROC_ID_ISR,
@@ -510,6 +535,13 @@ typedef enum
 #define CFG_DEBUG_TRACE_LIGHT     1
 #define CFG_DEBUG_TRACE_FULL      0
 
+/**
+ * When CFG_DEBUG_TRACE_BINARY is set to 1 with CFG_DEBUG_TRACE_LIGHT, the debug messages are not formatted on CPU1
+ * The address of the format string and the arguments are output as a binary record which is decoded on the host
+ * from the ELF file of the application with Utilities/PC_Software/DbgTraceDecoder/dbg_trace_decode.py
+ */
+#define CFG_DEBUG_TRACE_BINARY    0
+
 #if (( CFG_DEBUG_TRACE != 0 ) && ( CFG_DEBUG_TRACE_LIGHT == 0 ) && (CFG_DEBUG_TRACE_FULL == 0))
 #undef CFG_DEBUG_TRACE_FULL
 #undef CFG_DEBUG_TRACE_LIGHT
@@ -559,6 +591,61 @@ typedef enum
 
 #define SUPPORT_MULTI_USERS
 //#define UDS_SINGLE_TRUSTED_COLLECTOR
+
+/**
+ * Number of users of the UDS database, they are given the User Indexes 1 to CFG_UDS_MAX_NBR_USER
+ * The database takes 6 bytes of RAM per user, up to 254 users
+ */
+#ifdef SUPPORT_MULTI_USERS
+#define CFG_UDS_MAX_NBR_USER      (16)
+#else
+#define CFG_UDS_MAX_NBR_USER      (1)
+#endif
+
+/* Keep the Weight Scale Measurements in flash until a collector confirms them */
+#define APP_ENABLE_WSS_STORE
+/**
+ * Flash area of the Weight Scale Measurements history, at the end of the CPU1 flash
+ * It is removed from the application flash region in the linker files
+ */
+#define CFG_WSS_STORE_ADDRESS     (0x0807E000)
+#define CFG_WSS_STORE_SIZE        (0x2000)      /**< 2 pages of 4 KBytes */
+
+/**
+ * Broadcast each Weight Scale Measurement in the advertising service data,
+ * the gateways listening passively get it without a connection
+ */
+//#define APP_ENABLE_WSS_BROADCAST
+
+/**
+ * Bulk transfer of the Weight Scale Measurements history on the vendor specific Weight History
+ * characteristics, as many records as the ATT_MTU allows are packed in each notification
+ * It requires APP_ENABLE_WSS_STORE
+ */
+#define APP_ENABLE_WSS_HISTORY
+
+/* Keep the User Data Service users in flash */
+#define APP_ENABLE_UDS_STORE
+/**
+ * Flash area of the UDS users, just below the Weight Scale Measurements history
+ * It is removed from the application flash region in the linker files
+ */
+#define CFG_UDS_STORE_ADDRESS     (0x0807C000)
+#define CFG_UDS_STORE_SIZE        (0x2000)      /**< 2 pages of 4 KBytes */
+
+/**
+ * hci_user_evt_proc() reports the events by batches bounded by a number of events and a CPU time,
+ * the task is posted again when the budget is spent so that the other tasks are still scheduled
+ */
+#define CFG_HCI_USER_EVT_BUDGET_NBR       (16)
+#define CFG_HCI_USER_EVT_BUDGET_US        (500)
+
+/**
+ * A Weight Measurement request is set in the deadline class of the sequencer, so that it is sent ahead of
+ * the UDS control point and CTS tasks pending at the same time. The deadline is given in ms, it is converted
+ * to the RTC count of the sequencer time base with TIMEBASE_MsToTicks()
+ */
+#define CFG_WSS_MEAS_DEADLINE_MS          (30)
 /* USER CODE END Defines */
 
 /******************************************************************************
@@ -567,7 +654,8 @@ typedef enum
 
 /**
  * These are the lists of task id registered to the scheduler
- * Each task id shall be in the range [0:31]
+ * The task ids of the first list shall be in the range [0:31] as they are paused with a bit mapping
+ * The other task ids shall be below UTIL_SEQ_CONF_TASK_NBR, from 32 they are handled with the UTIL_SEQ_xxxTaskId() API
  * This mechanism allows to implement a generic code in the API TL_BLE_HCI_StatusNot() to comply with
  * the requirement that a HCI/ACI command shall never be sent if there is already one pending
  */
@@ -576,8 +664,11 @@ typedef enum
 typedef enum
 {
     CFG_TASK_ADV_UPDATE_ID,
+    CFG_TASK_CONN_UPDATE_ID,
 	/* WSS Measurement */
     CFG_TASK_WSS_MEAS_REQ_ID,
+    CFG_TASK_WSS_REPLAY_ID,
+    CFG_TASK_WSS_HISTORY_ID,
 	/* BCS Measurement */
     CFG_TASK_BCS_MEAS_REQ_ID,
 	/* UDS User Control Point */
@@ -605,6 +696,8 @@ typedef enum
     CFG_FIRST_TASK_ID_WITH_NO_HCICMD = CFG_LAST_TASK_ID_WITH_HCICMD - 1,        /**< Shall be FIRST in the list */
     CFG_TASK_SYSTEM_HCI_ASYNCH_EVT_ID,
     /* USER CODE BEGIN CFG_Task_Id_With_NO_HCI_Cmd_t */
+    CFG_TASK_SEQ_PROFILE_DUMP_ID,
+    CFG_TASK_LPM_ENERGY_DUMP_ID,
 
     /* USER CODE END CFG_Task_Id_With_NO_HCI_Cmd_t */
     CFG_LAST_TASK_ID_WITHO_NO_HCICMD                                            /**< Shall be LAST in the list */
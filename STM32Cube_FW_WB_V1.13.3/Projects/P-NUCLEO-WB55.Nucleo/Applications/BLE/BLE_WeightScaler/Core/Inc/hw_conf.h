@@ -106,6 +106,15 @@
  */
 #define CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER  6
 
+/**
+ * The user may select how the running timers are ordered
+ *  0: Sorted linked list. The count left of each running timer is updated on every wakeup timer setup and
+ *     the insertion walks the list
+ *  1: Binary min heap on the absolute expiry time. Nothing is updated on a wakeup timer setup and the insertion
+ *     and removal cost grows with the logarithm of the number of running timers
+ */
+#define CFG_HW_TS_USE_HEAP_ENGINE  1
+
 /**
  * The user may define the priority in the NVIC of the RTC_WKUP interrupt handler that is used to manage the
  * wakeup timer.
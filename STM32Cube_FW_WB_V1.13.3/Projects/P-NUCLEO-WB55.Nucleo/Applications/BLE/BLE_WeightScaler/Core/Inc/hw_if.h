@@ -150,6 +150,23 @@ extern "C" {
    */
   HW_TS_ReturnStatus_t HW_TS_Create(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pTimerCallBack);
 
+  /**
+   * @brief  Interface to create a virtual timer which timeout may be delayed
+   *         Same as HW_TS_Create() with a slack window. The timer server may delay the timeout by up to SlackTicks
+   *         so that it is reported on the same RTC wakeup as another timer. Timers with overlapping windows
+   *         are then batched in a single wakeup from low power mode.
+   *
+   * @param  TimerProcessID:  This is an identifier provided by the user and returned in the callback to allow
+   *                          identification of the requester
+   * @param  pTimerId: Timer Id returned to the user to request operation (start, stop, delete)
+   * @param  TimerMode: Mode of the virtual timer (Single shot or repeated)
+   * @param  pTimerCallBack: Callback when the virtual timer expires
+   * @param  SlackTicks: Maximum number of ticks the timeout may be delayed. It is ignored when
+   *                     CFG_HW_TS_USE_HEAP_ENGINE is not set
+   * @retval HW_TS_ReturnStatus_t: Return whether the creation is successful or not
+   */
+  HW_TS_ReturnStatus_t HW_TS_CreateWithSlack(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pTimerCallBack, uint32_t SlackTicks);
+
   /**
    * @brief  Stop a virtual timer
    *         This API may be used to stop a running timer. A timer which is stopped is move to the pending state.
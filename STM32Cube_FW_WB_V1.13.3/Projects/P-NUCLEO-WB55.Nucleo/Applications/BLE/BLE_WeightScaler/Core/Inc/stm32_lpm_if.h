@@ -27,6 +27,7 @@ extern "C" {
 #endif
 
 /* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
 
 /**
   * @brief Enters Low Power Off Mode
@@ -72,6 +73,21 @@ void PWR_EnterSleepMode( void );
   */
 void PWR_ExitSleepMode( void );
 
+/**
+  * @brief Returns the time counted by the RTC in all low power modes
+  * @note  The unit is the tick of the Timer Server
+  * @param none
+  * @retval the time
+  */
+uint32_t PWR_GetTime( void );
+
+/**
+  * @brief Returns the time left to the next Timer Server expiry
+  * @param none
+  * @retval the time in the unit of PWR_GetTime() or UTIL_LPM_IDLE_TIME_UNKNOWN when no timer is running
+  */
+uint32_t PWR_GetIdleTime( void );
+
 #ifdef __cplusplus
 }
 #endif
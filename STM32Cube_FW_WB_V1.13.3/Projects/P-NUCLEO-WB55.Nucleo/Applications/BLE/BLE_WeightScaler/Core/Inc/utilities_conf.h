@@ -47,6 +47,24 @@ extern "C" {
 #define UTIL_LPM_ENTER_CRITICAL_SECTION( )      UTILS_ENTER_CRITICAL_SECTION( )
 #define UTIL_LPM_EXIT_CRITICAL_SECTION( )       UTILS_EXIT_CRITICAL_SECTION( )
 
+/**
+ * Low power mode governor, Stop and Off modes are only entered when the next timer expiry is far enough
+ * The time base is the RTC counted in Timer Server ticks, the consumption are approximate values of CPU1 in uA
+ */
+#define UTIL_LPM_CONF_GOVERNOR                  (1)
+
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+#include "stm32_lpm_if.h"
+#define UTIL_LPM_GOVERNOR_GET_TIME( )           PWR_GetTime( )
+#define UTIL_LPM_GOVERNOR_GET_IDLE_TIME( )      PWR_GetIdleTime( )
+#define UTIL_LPM_GOVERNOR_POWER_RUN             (3000UL)
+#define UTIL_LPM_GOVERNOR_POWER_SLEEP           (1000UL)
+#define UTIL_LPM_GOVERNOR_POWER_STOP            (2UL)
+#define UTIL_LPM_GOVERNOR_POWER_OFF             (1UL)
+#define UTIL_LPM_GOVERNOR_COST_STOP             (1UL)
+#define UTIL_LPM_GOVERNOR_COST_OFF              (20UL)
+#endif /* UTIL_LPM_CONF_GOVERNOR */
+
 /******************************************************************************
  * sequencer
  * (any macro that does not need to be modified can be removed)
@@ -58,6 +76,31 @@ extern "C" {
 #define UTIL_SEQ_CONF_PRIO_NBR                  (2)
 #define UTIL_SEQ_MEMSET8( dest, value, size )   UTILS_MEMSET8( dest, value, size )
 
+/**
+ * Per task statistics of the sequencer, printed on the trace UART by UTIL_SEQ_ProfileDump()
+ * The time base is the DWT cycle counter of CPU1
+ */
+#define UTIL_SEQ_CONF_PROFILE                   (0)
+
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+#include "stm32wbxx.h"
+#define UTIL_SEQ_PROFILE_INIT( )                do{ CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; \
+                                                    DWT->CYCCNT = 0U; \
+                                                    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk; }while(0)
+#define UTIL_SEQ_PROFILE_GET_TIME( )            (DWT->CYCCNT)
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
+/**
+ * Deadline class of the sequencer, used by the requests that shall be served before the other pending tasks
+ * The time base is the free running RTC count, the HAL tick is stopped in the Stop modes entered by the low power manager
+ */
+#define UTIL_SEQ_CONF_EDF                       (1)
+
+#if (UTIL_SEQ_CONF_EDF != 0)
+#include "time_base.h"
+#define UTIL_SEQ_EDF_GET_TIME( )                TIMEBASE_GetTicks( )
+#endif /* UTIL_SEQ_CONF_EDF */
+
 #ifdef __cplusplus
 }
 #endif
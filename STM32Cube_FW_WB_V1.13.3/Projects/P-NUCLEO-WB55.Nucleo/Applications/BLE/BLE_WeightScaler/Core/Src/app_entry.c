@@ -35,6 +35,7 @@
 
 /* Private includes -----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "utilities_conf.h"
 
 /* USER CODE END Includes */
 
@@ -48,6 +49,8 @@ extern RTC_HandleTypeDef hrtc;
 #define POOL_SIZE (CFG_TLBLE_EVT_QUEUE_LENGTH*4U*DIVC(( sizeof(TL_PacketHeader_t) + TL_BLE_EVENT_FRAME_SIZE ), 4U))
 
 /* USER CODE BEGIN PD */
+#define SEQ_PROFILE_DUMP_PERIOD   (10*1000*1000/CFG_TS_TICK_VAL)  /**< 10s */
+#define LPM_ENERGY_DUMP_PERIOD    (60*1000*1000/CFG_TS_TICK_VAL)  /**< 60s */
 
 /* USER CODE END PD */
 
@@ -63,6 +66,12 @@ PLACE_IN_SECTION("MB_MEM2") ALIGN(4) static uint8_t SystemSpareEvtBuffer[sizeof(
 PLACE_IN_SECTION("MB_MEM2") ALIGN(4) static uint8_t BleSpareEvtBuffer[sizeof(TL_PacketHeader_t) + TL_EVT_HDR_SIZE + 255];
 
 /* USER CODE BEGIN PV */
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+static uint8_t SeqProfile_Timer_Id;
+#endif /* UTIL_SEQ_CONF_PROFILE */
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+static uint8_t LpmEnergy_Timer_Id;
+#endif /* UTIL_LPM_CONF_GOVERNOR */
 
 /* USER CODE END PV */
 
@@ -85,6 +94,15 @@ static void Init_Rtc( void );
 /* USER CODE BEGIN PFP */
 static void Led_Init( void );
 static void Button_Init( void );
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+static void Seq_Profile_Init( void );
+static void Seq_Profile_Timer_Cb( void );
+#endif /* UTIL_SEQ_CONF_PROFILE */
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+static void Lpm_Energy_Init( void );
+static void Lpm_Energy_Timer_Cb( void );
+static void Lpm_Energy_Dump( void );
+#endif /* UTIL_LPM_CONF_GOVERNOR */
 /* USER CODE END PFP */
 
 /* Functions Definition ------------------------------------------------------*/
@@ -137,6 +155,12 @@ void MX_APPE_Init( void )
    * This system event is received with APPE_SysUserEvtRx()
    */
 /* USER CODE BEGIN APPE_Init_2 */
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+  Seq_Profile_Init();
+#endif /* UTIL_SEQ_CONF_PROFILE */
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+  Lpm_Energy_Init();
+#endif /* UTIL_LPM_CONF_GOVERNOR */
 
 /* USER CODE END APPE_Init_2 */
    return;
@@ -507,6 +531,99 @@ static void APPE_SysEvtReadyProcessing( void * pPayload )
 }
 
 /* USER CODE BEGIN FD_LOCAL_FUNCTIONS */
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+static void Seq_Profile_Init( void )
+{
+  /**
+   * UTIL_SEQ_Init() is not called by the application, the time base is started here
+   */
+  UTIL_SEQ_PROFILE_INIT( );
+
+  /**
+   * The statistics are printed periodically on the trace UART
+   */
+  UTIL_SEQ_RegTask( 1<< CFG_TASK_SEQ_PROFILE_DUMP_ID, UTIL_SEQ_RFU, UTIL_SEQ_ProfileDump );
+  HW_TS_CreateWithSlack(CFG_TIM_PROC_ID_ISR, &SeqProfile_Timer_Id, hw_ts_Repeated, Seq_Profile_Timer_Cb, CFG_TS_SLACK_PERIODIC);
+  HW_TS_Start(SeqProfile_Timer_Id, SEQ_PROFILE_DUMP_PERIOD);
+
+  return;
+}
+
+static void Seq_Profile_Timer_Cb( void )
+{
+  UTIL_SEQ_SetTask( 1<< CFG_TASK_SEQ_PROFILE_DUMP_ID, CFG_SCH_PRIO_0);
+
+  return;
+}
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+static void Lpm_Energy_Init( void )
+{
+  /**
+   * The residency is accumulated from the boot and printed periodically on the trace UART
+   */
+  UTIL_SEQ_RegTask( 1<< CFG_TASK_LPM_ENERGY_DUMP_ID, UTIL_SEQ_RFU, Lpm_Energy_Dump );
+  HW_TS_CreateWithSlack(CFG_TIM_PROC_ID_ISR, &LpmEnergy_Timer_Id, hw_ts_Repeated, Lpm_Energy_Timer_Cb, CFG_TS_SLACK_PERIODIC);
+  HW_TS_Start(LpmEnergy_Timer_Id, LPM_ENERGY_DUMP_PERIOD);
+
+  return;
+}
+
+static void Lpm_Energy_Timer_Cb( void )
+{
+  UTIL_SEQ_SetTask( 1<< CFG_TASK_LPM_ENERGY_DUMP_ID, CFG_SCH_PRIO_0);
+
+  return;
+}
+
+/**
+ * @brief  Print the residency of CPU1 in each mode with the charge estimated from the current model
+ *         of the low power manager
+ * @note   The current model is given in uA and the time in Timer Server ticks so that the charge in nAh
+ *         is the energy multiplied by CFG_TS_TICK_VAL in us and divided by 3600000
+ * @param  None
+ * @retval None
+ */
+static void Lpm_Energy_Dump( void )
+{
+  static const char * const mode_name[] = { "run", "sleep", "stop", "off" };
+  UTIL_LPM_Residency_t residency;
+  uint64_t time_total = 0;
+  uint64_t energy_total = 0;
+  uint32_t mode;
+
+  APP_DBG_MSG("mode      count  time(ms)    charge(nAh)\r\n");
+
+  for(mode = 0; mode < 4; mode++)
+  {
+    if(mode == 0)
+    {
+      UTIL_LPM_ResidencyGetRun(&residency);
+    }
+    else
+    {
+      UTIL_LPM_ResidencyGet((UTIL_LPM_Mode_t)(mode - 1), &residency);
+    }
+    time_total += residency.TimeTotal;
+    energy_total += residency.Energy;
+
+    APP_DBG_MSG("%-5s %10lu %10lu %10lu\r\n",
+                mode_name[mode],
+                (uint32_t)residency.EntryCount,
+                (uint32_t)((residency.TimeTotal * CFG_TS_TICK_VAL) / 1000),
+                (uint32_t)((residency.Energy * CFG_TS_TICK_VAL) / 3600000));
+  }
+
+  if(time_total != 0)
+  {
+    APP_DBG_MSG("average current %lu uA\r\n", (uint32_t)(energy_total / time_total));
+  }
+
+  return;
+}
+#endif /* UTIL_LPM_CONF_GOVERNOR */
+
 static void Led_Init( void )
 {
 #if (CFG_LED_SUPPORTED == 1)
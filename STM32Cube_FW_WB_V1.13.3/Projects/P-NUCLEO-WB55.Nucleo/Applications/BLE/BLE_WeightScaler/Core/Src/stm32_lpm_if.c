@@ -52,6 +52,12 @@ static void ExitLowPower( void );
 /* USER CODE END Private_Typedef */
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN Private_Define */
+/**
+ * Period of the time read from the minutes, seconds and subseconds of the RTC: one calendar hour
+ * A calendar second lasts (CFG_RTC_ASYNCH_PRESCALER + 1) * (CFG_RTC_SYNCH_PRESCALER + 1) / LSE_VALUE seconds,
+ * 16s with CFG_RTCCLK_DIVIDER_CONF 0 so that the period is 16 hours, 1s with the other settings
+ */
+#define PWR_TIME_PERIOD   (3600UL * (CFG_RTC_SYNCH_PRESCALER + 1UL))
 
 /* USER CODE END Private_Define */
 /* Private macro -------------------------------------------------------------*/
@@ -60,6 +66,9 @@ static void ExitLowPower( void );
 /* USER CODE END Private_Macro */
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Private_Variables */
+static uint32_t TimeLastRead;
+static uint32_t TimeNow;
+static uint8_t TimeStarted;
 
 /* USER CODE END Private_Variables */
 
@@ -252,6 +261,76 @@ void PWR_ExitSleepMode( void )
   return;
 }
 
+/**
+  * @brief Returns the time counted by the RTC in all low power modes
+  * @note  The subsecond counter runs at the Timer Server tick as the asynchronous prescaler matches
+  *        the wakeup timer divider. It is extended with the minutes and seconds of the calendar and then
+  *        to 32 bits so that this API shall be called at least once per PWR_TIME_PERIOD, one calendar hour,
+  *        which is 16 hours with the default RTC prescalers.
+  *        The time starts at 0 on the first call.
+  *        The shadow registers are bypassed by the Timer Server.
+  *        This function is called from CRITICAL SECTION
+  * @param none
+  * @retval the time
+  */
+uint32_t PWR_GetTime( void )
+{
+  uint32_t ssr;
+  uint32_t tr;
+  uint32_t time_read;
+
+  /**
+   * Read again when a second boundary has been crossed between the two registers
+   */
+  do
+  {
+    ssr = LL_RTC_TIME_GetSubSecond( RTC );
+    tr = LL_RTC_TIME_Get( RTC );
+  } while( (ssr != LL_RTC_TIME_GetSubSecond( RTC )) || (tr != LL_RTC_TIME_Get( RTC )) );
+
+  time_read = ( ( ( __LL_RTC_CONVERT_BCD2BIN( __LL_RTC_GET_MINUTE( tr ) ) * 60UL ) +
+                  __LL_RTC_CONVERT_BCD2BIN( __LL_RTC_GET_SECOND( tr ) ) ) * ( CFG_RTC_SYNCH_PRESCALER + 1UL ) ) +
+              ( CFG_RTC_SYNCH_PRESCALER - ssr );
+
+  if( TimeStarted == 0U )
+  {
+    TimeStarted = 1U;
+  }
+  else if( time_read >= TimeLastRead )
+  {
+    TimeNow += time_read - TimeLastRead;
+  }
+  else
+  {
+    TimeNow += ( time_read + PWR_TIME_PERIOD ) - TimeLastRead;
+  }
+  TimeLastRead = time_read;
+
+  return TimeNow;
+}
+
+/**
+  * @brief Returns the time left to the next Timer Server expiry
+  * @param none
+  * @retval the time in the unit of PWR_GetTime() or UTIL_LPM_IDLE_TIME_UNKNOWN when no timer is running
+  */
+uint32_t PWR_GetIdleTime( void )
+{
+  uint16_t ticks_left;
+
+  ticks_left = HW_TS_RTC_ReadLeftTicksToCount( );
+
+  /**
+   * The Timer Server returns 0xFFFF when the wakeup timer is disabled
+   */
+  if( ticks_left == 0xFFFFU )
+  {
+    return UTIL_LPM_IDLE_TIME_UNKNOWN;
+  }
+
+  return ticks_left;
+}
+
 /*************************************************************
  *
  * LOCAL FUNCTIONS
@@ -34,6 +34,7 @@
 #include "shci.h"
 #include "stm32_lpm.h"
 #include "otp.h"
+#include "time_base.h"
 #ifdef APP_ENABLE_DIS
 #include "dis.h"
 #include "dis_app.h"
@@ -155,11 +156,23 @@ typedef struct _tBLEProfileGlobalContext
   uint16_t appearanceCharHandle;
 
   /**
-   * connection handle of the current active connection
+   * connection handle of the latest connection
+   * Used by the procedures whose event does not tell the connection (bond lost)
    * When not in connection, the handle is set to 0xFFFF
    */
   uint16_t connectionHandle;
 
+  /**
+   * connection handles of the active connections, one slot per link
+   * A free slot is set to 0xFFFF
+   */
+  uint16_t linkConnectionHandle[CFG_BLE_NUM_LINK];
+
+  /**
+   * number of active connections
+   */
+  uint8_t linkNbr;
+
   /**
    * length of the UUID list to be used while advertising
    */
@@ -172,6 +185,49 @@ typedef struct _tBLEProfileGlobalContext
 
 }BleGlobalContext_t;
 
+/**
+ * Connection parameters requested on a link by the connection policy
+ */
+typedef enum
+{
+  CONN_PROFILE_NONE,  /**< parameters chosen by the central */
+  CONN_PROFILE_BURST,
+  CONN_PROFILE_IDLE
+} ConnProfile_t;
+
+typedef struct
+{
+  /**
+   * pending work of the services, APP_BLE_ConnWork_t bits
+   */
+  uint8_t Work;
+
+  /**
+   * the link waits for the end of the idle hold time before the idle profile is requested
+   */
+  uint8_t Idle_Hold;
+
+  /**
+   * TIMEBASE_GetTicks() at which the idle hold time of the link elapses
+   */
+  uint32_t Idle_Hold_End;
+
+  /**
+   * a connection parameter update is in progress
+   */
+  uint8_t Update_Pending;
+
+  /**
+   * the 2M PHY and the data length extension have been requested
+   */
+  uint8_t Phy_Dle_Set;
+
+  /**
+   * profile requested last
+   */
+  ConnProfile_t Profile;
+} ConnPolicy_t;
+
 typedef struct
 {
   BleGlobalContext_t BleApplicationContext_legacy;
@@ -181,6 +237,26 @@ typedef struct
    * ID of the Advertising Timeout
    */
   uint8_t Advertising_mgr_timer_Id;
+
+  /**
+   * state the advertising goes back to at the end of the broadcast burst
+   */
+  APP_BLE_ConnStatus_t Broadcast_Fallback_Status;
+
+  /**
+   * connection policy of each link, same index as linkConnectionHandle
+   */
+  ConnPolicy_t Conn_Policy[CFG_BLE_NUM_LINK];
+
+  /**
+   * ID of the timer which runs the connection policy at the end of the earliest idle hold time
+   */
+  uint8_t Conn_Policy_timer_Id;
+
+  /**
+   * ATT_MTU agreed on each link, same index as linkConnectionHandle
+   */
+  uint16_t Att_Mtu[CFG_BLE_NUM_LINK];
   
 }BleApplicationContext_t;
 /* USER CODE BEGIN PTD */
@@ -191,8 +267,22 @@ typedef struct
 #define APPBLE_GAP_DEVICE_NAME_LENGTH 7
 #define FAST_ADV_TIMEOUT               (30*1000*1000/CFG_TS_TICK_VAL) /**< 30s */
 #define INITIAL_ADV_TIMEOUT            (60*1000*1000/CFG_TS_TICK_VAL) /**< 60s */
+#define BROADCAST_BURST_TIMEOUT        (3*1000*1000/CFG_TS_TICK_VAL)  /**< 3s */
+/**
+ * The service data shares the 31 octets of the advertising data with the flags (3),
+ * the local name (local_name[] and the length octet added by the stack), the service
+ * UUID list (4) and its own AD header (4)
+ */
+#define BROADCAST_DATA_MAX_LENGTH      (31 - 3 - (sizeof(local_name) + 1) - 4 - 4)
 
 #define BONDING_TIMEOUT                (10*1000*1000/CFG_TS_TICK_VAL) /**< 10s */
+#define CONN_IDLE_HOLD_TIME_MS         (5*1000)                       /**< 5s */
+
+/**
+ * Data length requested with the burst profile, the largest link layer payload on the 1M PHY
+ */
+#define CONN_DATA_LENGTH_TX_OCTETS     (251)
+#define CONN_DATA_LENGTH_TX_TIME       (2120)
 
 #define BD_ADDR_SIZE_LOCAL    6
 
@@ -253,6 +343,10 @@ uint8_t  manuf_data[14] = {
 };
 
 /* USER CODE BEGIN PV */
+/**
+ * DWT cycle count when hci_user_evt_proc() has reported its first event of the batch
+ */
+static uint32_t HciUserEvtBatchStart;
 
 /* USER CODE END PV */
 
@@ -266,6 +360,11 @@ static void Adv_Request( APP_BLE_ConnStatus_t New_Status );
 static void Add_Advertisment_Service_UUID( uint16_t servUUID );
 static void Adv_Mgr( void );
 static void Adv_Update( void );
+static void Adv_Broadcast_Stop( void );
+static void Conn_Mgr( void );
+static void Conn_Update( void );
+static void Conn_Request( uint8_t link, ConnProfile_t profile );
+static void Conn_Idle_Hold( uint8_t link );
 
 /* USER CODE BEGIN PFP */
 
@@ -281,6 +380,11 @@ static void Adv_Update( void );
 void APP_BLE_Init( void )
 {
 /* USER CODE BEGIN APP_BLE_Init_1 */
+  /**
+   * The cycle counter bounds the time spent per batch of events in hci_user_evt_budget()
+   */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
 /* USER CODE END APP_BLE_Init_1 */
   SHCI_C2_Ble_Init_Cmd_Packet_t ble_init_cmd_packet =
@@ -309,6 +413,7 @@ void APP_BLE_Init( void )
      CFG_BLE_MAX_TX_POWER,
      CFG_BLE_RX_MODEL_CONFIG}
   };
+  uint8_t index;
 
   /**
    * Initialize Ble Transport Layer
@@ -349,11 +454,22 @@ void APP_BLE_Init( void )
    */
   BleApplicationContext.Device_Connection_Status = APP_BLE_IDLE;
   BleApplicationContext.BleApplicationContext_legacy.connectionHandle = 0xFFFF;
+  for (index = 0; index < CFG_BLE_NUM_LINK; index++)
+  {
+    BleApplicationContext.BleApplicationContext_legacy.linkConnectionHandle[index] = 0xFFFF;
+  }
+  BleApplicationContext.BleApplicationContext_legacy.linkNbr = 0;
   
   /**
    * From here, all initialization are BLE application specific
    */
   UTIL_SEQ_RegTask( 1<<CFG_TASK_ADV_UPDATE_ID, UTIL_SEQ_RFU, Adv_Update);
+  UTIL_SEQ_RegTask( 1<<CFG_TASK_CONN_UPDATE_ID, UTIL_SEQ_RFU, Conn_Update);
+
+  /**
+   * Initialize the time shared by the time stamps of the services
+   */
+  TIMEBASE_Init();
 
 #ifdef APP_ENABLE_DIS
   /**
@@ -406,7 +522,12 @@ void APP_BLE_Init( void )
    * Create timer to handle the connection state machine
    */
 
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR, &(BleApplicationContext.Advertising_mgr_timer_Id), hw_ts_SingleShot, Adv_Mgr);
+  HW_TS_CreateWithSlack(CFG_TIM_PROC_ID_ISR, &(BleApplicationContext.Advertising_mgr_timer_Id), hw_ts_SingleShot, Adv_Mgr, CFG_TS_SLACK_ADV);
+
+  /**
+   * Create timer to handle the connection policy
+   */
+  HW_TS_CreateWithSlack(CFG_TIM_PROC_ID_ISR, &(BleApplicationContext.Conn_Policy_timer_Id), hw_ts_SingleShot, Conn_Mgr, CFG_TS_SLACK_ADV);
   
   APP_DBG_MSG("Complete Bonding, make device discoverable\n\r");
   
@@ -451,31 +572,50 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
     case HCI_DISCONNECTION_COMPLETE_EVT_CODE:
     {
       hci_disconnection_complete_event_rp0 *disconnection_complete_event;
+      uint8_t link;
       disconnection_complete_event = (hci_disconnection_complete_event_rp0 *) event_pckt->data;
 
-      if (disconnection_complete_event->Connection_Handle == BleApplicationContext.BleApplicationContext_legacy.connectionHandle)
+      link = APP_BLE_Get_Link_Index(disconnection_complete_event->Connection_Handle);
+      if (link < CFG_BLE_NUM_LINK)
       {
-        BleApplicationContext.BleApplicationContext_legacy.connectionHandle = 0;
-        BleApplicationContext.Device_Connection_Status = APP_BLE_IDLE;
-
-        APP_DBG_MSG("\r\n\r** DISCONNECTION EVENT WITH CLIENT \n\r");
+        APP_DBG_MSG("\r\n\r** DISCONNECTION EVENT WITH CLIENT 0x%x\n\r", disconnection_complete_event->Connection_Handle);
       }
 
-      /* restart advertising */
-      Adv_Request(APP_BLE_FAST_ADV);
-
       /* USER CODE BEGIN EVT_DISCONN_COMPLETE */
-#ifdef APP_ENABLE_BCS
-      BCSAPP_Reset();
-#endif /* APP_ENABLE_BCS */
-#ifdef APP_ENABLE_UDS
-      UDSAPP_Reset();
-#endif /* APP_ENABLE_UDS */
-#ifdef APP_ENABLE_CTS
-      CTSAPP_Reset();
-#endif /* APP_ENABLE_CTS */
 
       /* USER CODE END EVT_DISCONN_COMPLETE */
+
+      /**
+       * The link slot is released once the services have dropped the state they keep for it,
+       * they subscribe to the disconnection and are notified before this handler
+       */
+      if (link < CFG_BLE_NUM_LINK)
+      {
+        BleApplicationContext.BleApplicationContext_legacy.linkConnectionHandle[link] = 0xFFFF;
+        BleApplicationContext.BleApplicationContext_legacy.linkNbr--;
+        memset(&BleApplicationContext.Conn_Policy[link], 0, sizeof(ConnPolicy_t));
+        if (BleApplicationContext.BleApplicationContext_legacy.connectionHandle == disconnection_complete_event->Connection_Handle)
+        {
+          BleApplicationContext.BleApplicationContext_legacy.connectionHandle = 0xFFFF;
+        }
+        if ((BleApplicationContext.Device_Connection_Status == APP_BLE_CONNECTED_SERVER)
+            || (BleApplicationContext.Device_Connection_Status == APP_BLE_CONNECTED_CLIENT))
+        {
+          BleApplicationContext.Device_Connection_Status = APP_BLE_IDLE;
+        }
+      }
+
+      /* restart advertising, unless it is still running for the free links */
+      if (BleApplicationContext.Device_Connection_Status == APP_BLE_BROADCAST_ADV)
+      {
+        /* the broadcast burst goes on, the free link is advertised once it is over */
+        BleApplicationContext.Broadcast_Fallback_Status = APP_BLE_FAST_ADV;
+      }
+      else if ((BleApplicationContext.Device_Connection_Status != APP_BLE_FAST_ADV)
+               && (BleApplicationContext.Device_Connection_Status != APP_BLE_LP_ADV))
+      {
+        Adv_Request(APP_BLE_FAST_ADV);
+      }
     }
 
       break; /* HCI_DISCONNECTION_COMPLETE_EVT_CODE */
@@ -489,12 +629,32 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
       switch (meta_evt->subevent)
       {
         case HCI_LE_CONNECTION_UPDATE_COMPLETE_SUBEVT_CODE:
+        {
+          hci_le_connection_update_complete_event_rp0 *connection_update_event;
+          uint8_t link;
+
+          connection_update_event = (hci_le_connection_update_complete_event_rp0 *) meta_evt->data;
           APP_DBG_MSG("** CONNECTION UPDATE EVENT WITH CLIENT \n\r");
-          APP_DBG_MSG("\n\r");
+          APP_DBG_MSG("status 0x%x, interval %d, latency %d, timeout %d\n\r",
+                      connection_update_event->Status,
+                      connection_update_event->Conn_Interval,
+                      connection_update_event->Conn_Latency,
+                      connection_update_event->Supervision_Timeout);
+
+          /**
+           * The update may come from the central as well, the policy checks again the profile of the link
+           */
+          link = APP_BLE_Get_Link_Index(connection_update_event->Connection_Handle);
+          if (link < CFG_BLE_NUM_LINK)
+          {
+            BleApplicationContext.Conn_Policy[link].Update_Pending = 0;
+            UTIL_SEQ_SetTask(1 << CFG_TASK_CONN_UPDATE_ID, CFG_SCH_PRIO_0);
+          }
 
           /* USER CODE BEGIN EVT_LE_CONN_UPDATE_COMPLETE */
 
           /* USER CODE END EVT_LE_CONN_UPDATE_COMPLETE */
+        }
           break;
         case HCI_LE_PHY_UPDATE_COMPLETE_SUBEVT_CODE:
           APP_DBG_MSG("EVT_UPDATE_PHY_COMPLETE \n\r");
@@ -508,7 +668,7 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
             APP_DBG_MSG("EVT_UPDATE_PHY_COMPLETE, status nok \n\r");
           }
 
-          ret = hci_le_read_phy(BleApplicationContext.BleApplicationContext_legacy.connectionHandle,&TX_PHY,&RX_PHY);
+          ret = hci_le_read_phy(evt_le_phy_update_complete->Connection_Handle,&TX_PHY,&RX_PHY);
           if (ret == BLE_STATUS_SUCCESS)
           {
             APP_DBG_MSG("Read_PHY success \n\r");
@@ -533,6 +693,7 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
         case HCI_LE_CONNECTION_COMPLETE_SUBEVT_CODE:
         {
           hci_le_connection_complete_event_rp0 *connection_complete_event;
+          uint8_t link;
 
           /**
            * The connection is done, there is no need anymore to schedule the LP ADV
@@ -555,6 +716,31 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
           }
           BleApplicationContext.BleApplicationContext_legacy.connectionHandle = connection_complete_event->Connection_Handle;
 
+          link = APP_BLE_Get_Link_Index(0xFFFF);
+          if (link < CFG_BLE_NUM_LINK)
+          {
+            BleApplicationContext.BleApplicationContext_legacy.linkConnectionHandle[link] = connection_complete_event->Connection_Handle;
+            BleApplicationContext.BleApplicationContext_legacy.linkNbr++;
+
+            /**
+             * The parameters of the central are kept while the collector discovers the services,
+             * the link goes to the idle profile when nothing is pending at the end of the hold time
+             */
+            memset(&BleApplicationContext.Conn_Policy[link], 0, sizeof(ConnPolicy_t));
+            Conn_Idle_Hold(link);
+
+            BleApplicationContext.Att_Mtu[link] = BLE_DEFAULT_ATT_MTU;
+          }
+
+          /**
+           * Keep on advertising while a link is left so that another collector may connect
+           */
+          if ((BleApplicationContext.Device_Connection_Status == APP_BLE_CONNECTED_SERVER)
+              && (BleApplicationContext.BleApplicationContext_legacy.linkNbr < CFG_BLE_NUM_LINK))
+          {
+            Adv_Request(APP_BLE_FAST_ADV);
+          }
+
           /* USER CODE BEGIN HCI_EVT_LE_CONN_COMPLETE */
 
           /* USER CODE END HCI_EVT_LE_CONN_COMPLETE */
@@ -591,7 +777,7 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
       case ACI_GAP_PASS_KEY_REQ_VSEVT_CODE:  
         APP_DBG_MSG("\r\n\r** ACI_GAP_PASS_KEY_REQ_VSEVT_CODE \n");
 
-        aci_gap_pass_key_resp(BleApplicationContext.BleApplicationContext_legacy.connectionHandle,123456);
+        aci_gap_pass_key_resp(((aci_gap_pass_key_req_event_rp0 *)(blecore_evt->data))->Connection_Handle, 123456);
 
         APP_DBG_MSG("\r\n\r** aci_gap_pass_key_resp \n");
           break; /* ACI_GAP_PASS_KEY_REQ_VSEVT_CODE */
@@ -623,7 +809,7 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
                       ((aci_gap_numeric_comparison_value_event_rp0 *)(blecore_evt->data))->Numeric_Value);
           APP_DBG_MSG("Hex_value = %lx\n",
                       ((aci_gap_numeric_comparison_value_event_rp0 *)(blecore_evt->data))->Numeric_Value);
-          aci_gap_numeric_comparison_value_confirm_yesno(BleApplicationContext.BleApplicationContext_legacy.connectionHandle, YES); /* CONFIRM_YES = 1 */
+          aci_gap_numeric_comparison_value_confirm_yesno(((aci_gap_numeric_comparison_value_event_rp0 *)(blecore_evt->data))->Connection_Handle, YES); /* CONFIRM_YES = 1 */
           APP_DBG_MSG("\r\n\r** aci_gap_numeric_comparison_value_confirm_yesno-->YES \n");
           break;
 
@@ -651,6 +837,60 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
           /* USER CODE END EVT_BLUE_GAP_PROCEDURE_COMPLETE */
           break; /* ACI_GAP_PROC_COMPLETE_VSEVT_CODE */
 
+        case ACI_L2CAP_CONNECTION_UPDATE_RESP_VSEVT_CODE:
+        {
+          aci_l2cap_connection_update_resp_event_rp0 *l2cap_update_resp;
+          uint8_t link;
+
+          l2cap_update_resp = (aci_l2cap_connection_update_resp_event_rp0 *) blecore_evt->data;
+          APP_DBG_MSG("\r\n\r** ACI_L2CAP_CONNECTION_UPDATE_RESP_VSEVT_CODE, result %d \n\r", l2cap_update_resp->Result);
+
+          /**
+           * The request is over, a rejected profile is not asked for again until the link needs the other one
+           * The work may have changed while the request was pending
+           */
+          link = APP_BLE_Get_Link_Index(l2cap_update_resp->Connection_Handle);
+          if (link < CFG_BLE_NUM_LINK)
+          {
+            BleApplicationContext.Conn_Policy[link].Update_Pending = 0;
+            UTIL_SEQ_SetTask(1 << CFG_TASK_CONN_UPDATE_ID, CFG_SCH_PRIO_0);
+          }
+        }
+          break; /* ACI_L2CAP_CONNECTION_UPDATE_RESP_VSEVT_CODE */
+
+        case ACI_L2CAP_PROC_TIMEOUT_VSEVT_CODE:
+        {
+          aci_l2cap_proc_timeout_event_rp0 *l2cap_proc_timeout;
+          uint8_t link;
+
+          l2cap_proc_timeout = (aci_l2cap_proc_timeout_event_rp0 *) blecore_evt->data;
+          APP_DBG_MSG("\r\n\r** ACI_L2CAP_PROC_TIMEOUT_VSEVT_CODE \n\r");
+
+          link = APP_BLE_Get_Link_Index(l2cap_proc_timeout->Connection_Handle);
+          if (link < CFG_BLE_NUM_LINK)
+          {
+            BleApplicationContext.Conn_Policy[link].Update_Pending = 0;
+            UTIL_SEQ_SetTask(1 << CFG_TASK_CONN_UPDATE_ID, CFG_SCH_PRIO_0);
+          }
+        }
+          break; /* ACI_L2CAP_PROC_TIMEOUT_VSEVT_CODE */
+
+        case ACI_ATT_EXCHANGE_MTU_RESP_VSEVT_CODE:
+        {
+          aci_att_exchange_mtu_resp_event_rp0 *exchange_mtu_resp;
+          uint8_t link;
+
+          exchange_mtu_resp = (aci_att_exchange_mtu_resp_event_rp0 *) blecore_evt->data;
+          APP_DBG_MSG("\r\n\r** ACI_ATT_EXCHANGE_MTU_RESP_VSEVT_CODE, ATT_MTU = %d \n\r", exchange_mtu_resp->Server_RX_MTU);
+
+          link = APP_BLE_Get_Link_Index(exchange_mtu_resp->Connection_Handle);
+          if (link < CFG_BLE_NUM_LINK)
+          {
+            BleApplicationContext.Att_Mtu[link] = exchange_mtu_resp->Server_RX_MTU;
+          }
+        }
+          break; /* ACI_ATT_EXCHANGE_MTU_RESP_VSEVT_CODE */
+
       /* USER CODE BEGIN BLUE_EVT */
 
       /* USER CODE END BLUE_EVT */
@@ -673,13 +913,204 @@ SVCCTL_UserEvtFlowStatus_t SVCCTL_App_Notification( void *pckt )
 
 APP_BLE_ConnStatus_t APP_BLE_Get_Server_Connection_Status(void)
 {
+  /* advertising goes on while a link is left, the device is still connected */
+  if ((BleApplicationContext.BleApplicationContext_legacy.linkNbr != 0)
+      && ((BleApplicationContext.Device_Connection_Status == APP_BLE_FAST_ADV)
+          || (BleApplicationContext.Device_Connection_Status == APP_BLE_LP_ADV)
+          || (BleApplicationContext.Device_Connection_Status == APP_BLE_BROADCAST_ADV)))
+  {
+    return APP_BLE_CONNECTED_SERVER;
+  }
+
   return BleApplicationContext.Device_Connection_Status;
 }
 
+/**
+ * @brief  Look for the link slot of a connection
+ * @param  Connection_Handle: Handle of the connection, 0xFFFF to get a free slot
+ * @retval Slot index, CFG_BLE_NUM_LINK when not found
+ */
+uint8_t APP_BLE_Get_Link_Index(uint16_t Connection_Handle)
+{
+  uint8_t index;
+
+  for (index = 0; index < CFG_BLE_NUM_LINK; index++)
+  {
+    if (BleApplicationContext.BleApplicationContext_legacy.linkConnectionHandle[index] == Connection_Handle)
+    {
+      break;
+    }
+  }
+
+  return index;
+}
+
+uint8_t APP_BLE_Get_Link_Nbr(void)
+{
+  return BleApplicationContext.BleApplicationContext_legacy.linkNbr;
+}
+
+/**
+ * @brief  ATT_MTU of a link, the default one until the client has exchanged it
+ * @param  Link: Index of the link, see APP_BLE_Get_Link_Index()
+ * @retval ATT_MTU in octets
+ */
+uint16_t APP_BLE_Get_Att_Mtu(uint8_t Link)
+{
+  if (Link >= CFG_BLE_NUM_LINK)
+  {
+    return BLE_DEFAULT_ATT_MTU;
+  }
+
+  return BleApplicationContext.Att_Mtu[Link];
+}
+
+/**
+ * @brief  Advertise service data without connection for a burst, then go back to the previous advertising
+ *         The advertising is not connectable during the burst, it shall be called from a task which may
+ *         send an ACI command
+ * @param  ServiceUUID: 16 bits UUID of the service the data belongs to
+ * @param  pData: Service data
+ * @param  Length: Length of the service data, up to BROADCAST_DATA_MAX_LENGTH
+ * @retval None
+ */
+void APP_BLE_Broadcast(uint16_t ServiceUUID, const uint8_t *pData, uint8_t Length)
+{
+  tBleStatus ret;
+  uint8_t *p_adv_data;
+  APP_BLE_ConnStatus_t status = BleApplicationContext.Device_Connection_Status;
+
+  if (Length > BROADCAST_DATA_MAX_LENGTH)
+  {
+    APP_DBG_MSG("Broadcast data too long: %d \n\r", Length);
+    return;
+  }
+
+  HW_TS_Stop(BleApplicationContext.Advertising_mgr_timer_Id);
+
+  if ((status == APP_BLE_FAST_ADV) || (status == APP_BLE_LP_ADV) || (status == APP_BLE_BROADCAST_ADV))
+  {
+    ret = aci_gap_set_non_discoverable();
+    if (ret != BLE_STATUS_SUCCESS)
+    {
+      APP_DBG_MSG("Stop Advertising Failed , result: %d \n\r", ret);
+    }
+  }
+
+  /* a new measurement during the burst only restarts it */
+  if (status != APP_BLE_BROADCAST_ADV)
+  {
+    BleApplicationContext.Broadcast_Fallback_Status = status;
+  }
+  BleApplicationContext.Device_Connection_Status = APP_BLE_BROADCAST_ADV;
+
+  ret = aci_gap_set_discoverable(
+                                 ADV_NONCONN_IND,
+                                 CFG_BROADCAST_ADV_INTERVAL_MIN,
+                                 CFG_BROADCAST_ADV_INTERVAL_MAX,
+                                 CFG_BLE_ADDRESS_TYPE,
+                                 NO_WHITE_LIST_USE, /* use white list */
+                                 sizeof(local_name),
+                                 (uint8_t*) &local_name,
+                                 BleApplicationContext.BleApplicationContext_legacy.advtServUUIDlen,
+                                 BleApplicationContext.BleApplicationContext_legacy.advtServUUID,
+                                 0,
+                                 0);
+  if (ret != BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Fail   : aci_gap_set_discoverable command, result: 0x%x \n\r", ret);
+  }
+
+  /* The service data takes the place of the manufacturer data, encoded straight into the command packet */
+  p_adv_data = aci_gap_update_adv_data_reserve(Length + 4);
+  p_adv_data[0] = Length + 3;
+  p_adv_data[1] = AD_TYPE_SERVICE_DATA;
+  p_adv_data[2] = (uint8_t) (ServiceUUID & 0xFF);
+  p_adv_data[3] = (uint8_t) (ServiceUUID >> 8) & 0xFF;
+  memcpy(p_adv_data + 4, pData, Length);
+  ret = aci_gap_update_adv_data_commit();
+  if (ret == BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("  Success: Start Broadcast \n\r");
+  }
+  else
+  {
+    APP_DBG_MSG("Start Broadcast Failed , result: %d \n\r", ret);
+  }
+
+  /* Start Timer to STOP the burst - TIMEOUT */
+  HW_TS_Start(BleApplicationContext.Advertising_mgr_timer_Id, BROADCAST_BURST_TIMEOUT);
+
+  return;
+}
+
+/**
+ * @brief  Report the work of a service on a link to the connection policy
+ *         The link gets the burst connection parameters as soon as some work is pending,
+ *         and the idle ones when no work has been pending for the idle hold time
+ * @param  Link: Index of the link, see APP_BLE_Get_Link_Index()
+ * @param  Work: Work of the service
+ * @param  Pending: 1 when the work starts, 0 when it is over
+ * @retval None
+ */
+void APP_BLE_Conn_Work(uint8_t Link, APP_BLE_ConnWork_t Work, uint8_t Pending)
+{
+  ConnPolicy_t *p_policy;
+  uint8_t previous_work;
+
+  if (Link >= CFG_BLE_NUM_LINK)
+  {
+    return;
+  }
+
+  p_policy = &BleApplicationContext.Conn_Policy[Link];
+  previous_work = p_policy->Work;
+  if (Pending != 0)
+  {
+    p_policy->Work |= Work;
+  }
+  else
+  {
+    p_policy->Work &= ~Work;
+  }
+
+  if ((previous_work == 0) && (p_policy->Work != 0))
+  {
+    UTIL_SEQ_SetTask(1 << CFG_TASK_CONN_UPDATE_ID, CFG_SCH_PRIO_0);
+  }
+  else if ((previous_work != 0) && (p_policy->Work == 0))
+  {
+    Conn_Idle_Hold(Link);
+  }
+
+  return;
+}
+
+/**
+ * @brief  Report a short exchange on a link, the burst connection parameters are kept
+ *         for the idle hold time so that the requests which follow are served quickly
+ * @param  Link: Index of the link, see APP_BLE_Get_Link_Index()
+ * @retval None
+ */
+void APP_BLE_Conn_Activity(uint8_t Link)
+{
+  APP_BLE_Conn_Work(Link, APP_BLE_CONN_WORK_ACTIVITY, 1);
+
+  /**
+   * The activity stays pending until the idle hold time elapses, it is cleared by Conn_Update()
+   */
+  if (Link < CFG_BLE_NUM_LINK)
+  {
+    Conn_Idle_Hold(Link);
+  }
+
+  return;
+}
+
 /* USER CODE BEGIN FD*/
 void APP_BLE_Key_Button1_Action(void)
 {
-	UTIL_SEQ_SetTask( 1<<CFG_TASK_WSS_MEAS_REQ_ID, CFG_SCH_PRIO_0);
+	UTIL_SEQ_SetTaskDeadline( 1<<CFG_TASK_WSS_MEAS_REQ_ID, TIMEBASE_GetTicks() + TIMEBASE_MsToTicks(CFG_WSS_MEAS_DEADLINE_MS));
 }
 
 void APP_BLE_Key_Button2_Action(void)
@@ -1011,9 +1442,10 @@ static void Adv_Request(APP_BLE_ConnStatus_t New_Status)
 
     /*APP_DBG_MSG("\n\r");*/
 
-    if ((New_Status == APP_BLE_LP_ADV)
-        && ((BleApplicationContext.Device_Connection_Status == APP_BLE_FAST_ADV)
-            || (BleApplicationContext.Device_Connection_Status == APP_BLE_LP_ADV)))
+    if (((New_Status == APP_BLE_LP_ADV)
+         && ((BleApplicationContext.Device_Connection_Status == APP_BLE_FAST_ADV)
+             || (BleApplicationContext.Device_Connection_Status == APP_BLE_LP_ADV)))
+        || (BleApplicationContext.Device_Connection_Status == APP_BLE_BROADCAST_ADV))
     {
       /* Connection in ADVERTISE mode have to stop the current advertising */
       ret = aci_gap_set_non_discoverable();
@@ -1052,8 +1484,9 @@ static void Adv_Request(APP_BLE_ConnStatus_t New_Status)
       APP_DBG_MSG("  Success: aci_gap_set_discoverable command\n\r");
     }
 
-    /* Update Advertising data */
-    ret = aci_gap_update_adv_data(sizeof(manuf_data), (uint8_t*) manuf_data);
+    /* Update Advertising data, encoded straight into the command packet */
+    memcpy(aci_gap_update_adv_data_reserve(sizeof(manuf_data)), manuf_data, sizeof(manuf_data));
+    ret = aci_gap_update_adv_data_commit();
     if (ret == BLE_STATUS_SUCCESS)
     {
       if (New_Status == APP_BLE_FAST_ADV)
@@ -1166,7 +1599,198 @@ static void Adv_Mgr( void )
 
 static void Adv_Update( void )
 {
-  Adv_Request(APP_BLE_LP_ADV);
+  if (BleApplicationContext.Device_Connection_Status == APP_BLE_BROADCAST_ADV)
+  {
+    Adv_Broadcast_Stop();
+  }
+  else
+  {
+    Adv_Request(APP_BLE_LP_ADV);
+  }
+
+  return;
+}
+
+/**
+ * End of the broadcast burst, the advertising goes back to the state it had before
+ */
+static void Adv_Broadcast_Stop( void )
+{
+  tBleStatus ret;
+  APP_BLE_ConnStatus_t fallback_status = BleApplicationContext.Broadcast_Fallback_Status;
+
+  APP_DBG_MSG("Stop Broadcast, back to status %d\n\r", fallback_status);
+
+  if ((fallback_status == APP_BLE_FAST_ADV) || (fallback_status == APP_BLE_LP_ADV))
+  {
+    Adv_Request(fallback_status);
+  }
+  else
+  {
+    /* no link is left for a new connection */
+    ret = aci_gap_set_non_discoverable();
+    if (ret != BLE_STATUS_SUCCESS)
+    {
+      APP_DBG_MSG("Stop Broadcast Failed , result: %d \n\r", ret);
+    }
+    BleApplicationContext.Device_Connection_Status = fallback_status;
+  }
+
+  return;
+}
+
+static void Conn_Mgr( void )
+{
+  /**
+   * The connection parameters are requested in the background as an aci command is sent
+   */
+  UTIL_SEQ_SetTask(1 << CFG_TASK_CONN_UPDATE_ID, CFG_SCH_PRIO_0);
+
+  return;
+}
+
+/**
+ * Restart the idle hold time of a link, Conn_Update() starts the timer for the earliest one of the links
+ */
+static void Conn_Idle_Hold( uint8_t link )
+{
+  BleApplicationContext.Conn_Policy[link].Idle_Hold = 1;
+  BleApplicationContext.Conn_Policy[link].Idle_Hold_End = TIMEBASE_GetTicks() + TIMEBASE_MsToTicks(CONN_IDLE_HOLD_TIME_MS);
+
+  UTIL_SEQ_SetTask(1 << CFG_TASK_CONN_UPDATE_ID, CFG_SCH_PRIO_0);
+
+  return;
+}
+
+/**
+ * Request on each link the profile its pending work calls for
+ * A link with an update in progress is checked again at the end of the update
+ */
+static void Conn_Update( void )
+{
+  ConnPolicy_t *p_policy;
+  ConnProfile_t profile;
+  uint32_t now = TIMEBASE_GetTicks();
+  uint32_t hold_left;
+  uint32_t next_hold_left = 0;
+  uint8_t hold_running = 0;
+  uint8_t link;
+
+  for (link = 0; link < CFG_BLE_NUM_LINK; link++)
+  {
+    p_policy = &BleApplicationContext.Conn_Policy[link];
+    if ((BleApplicationContext.BleApplicationContext_legacy.linkConnectionHandle[link] == 0xFFFF)
+        || (p_policy->Update_Pending != 0))
+    {
+      continue;
+    }
+
+    if (p_policy->Idle_Hold != 0)
+    {
+      hold_left = p_policy->Idle_Hold_End - now;
+      if ((int32_t)hold_left <= 0)
+      {
+        /**
+         * The activity reported with APP_BLE_Conn_Activity() is over at the end of the hold time,
+         * it is cleared here rather than in the timer interrupt as the work is updated by the tasks
+         * The hold time is started again when the other work of the link is over
+         */
+        p_policy->Work &= ~APP_BLE_CONN_WORK_ACTIVITY;
+        p_policy->Idle_Hold = 0;
+      }
+      else if ((hold_running == 0) || (hold_left < next_hold_left))
+      {
+        next_hold_left = hold_left;
+        hold_running = 1;
+      }
+    }
+
+    if (p_policy->Work != 0)
+    {
+      profile = CONN_PROFILE_BURST;
+    }
+    else if (p_policy->Idle_Hold == 0)
+    {
+      profile = CONN_PROFILE_IDLE;
+    }
+    else
+    {
+      continue;
+    }
+
+    if (profile != p_policy->Profile)
+    {
+      Conn_Request(link, profile);
+    }
+  }
+
+  HW_TS_Stop(BleApplicationContext.Conn_Policy_timer_Id);
+  if (hold_running != 0)
+  {
+    HW_TS_Start(BleApplicationContext.Conn_Policy_timer_Id,
+                ((TIMEBASE_TicksToMs(next_hold_left) * 1000) + CFG_TS_TICK_VAL - 1) / CFG_TS_TICK_VAL);
+  }
+
+  return;
+}
+
+/**
+ * Send the connection parameter update request of a profile to the central
+ * The 2M PHY and the data length extension are requested along with the first burst and kept
+ * afterwards: they shorten the connection events of the idle profile as well, and switching them
+ * back would only add procedures on the link
+ */
+static void Conn_Request( uint8_t link, ConnProfile_t profile )
+{
+  ConnPolicy_t *p_policy = &BleApplicationContext.Conn_Policy[link];
+  uint16_t connection_handle = BleApplicationContext.BleApplicationContext_legacy.linkConnectionHandle[link];
+  tBleStatus ret;
+
+  if (profile == CONN_PROFILE_BURST)
+  {
+    if (p_policy->Phy_Dle_Set == 0)
+    {
+      ret = hci_le_set_phy(connection_handle, ALL_PHYS_PREFERENCE, TX_2M_PREFERRED, RX_2M_PREFERRED, 0);
+      if (ret != BLE_STATUS_SUCCESS)
+      {
+        APP_DBG_MSG("Set PHY Failed , result: %d \n\r", ret);
+      }
+      ret = hci_le_set_data_length(connection_handle, CONN_DATA_LENGTH_TX_OCTETS, CONN_DATA_LENGTH_TX_TIME);
+      if (ret != BLE_STATUS_SUCCESS)
+      {
+        APP_DBG_MSG("Set Data Length Failed , result: %d \n\r", ret);
+      }
+      p_policy->Phy_Dle_Set = 1;
+    }
+
+    ret = aci_l2cap_connection_parameter_update_req(connection_handle,
+                                                    CFG_CONN_BURST_INTERVAL_MIN,
+                                                    CFG_CONN_BURST_INTERVAL_MAX,
+                                                    CFG_CONN_BURST_LATENCY,
+                                                    CFG_CONN_BURST_TIMEOUT);
+  }
+  else
+  {
+    ret = aci_l2cap_connection_parameter_update_req(connection_handle,
+                                                    CFG_CONN_IDLE_INTERVAL_MIN,
+                                                    CFG_CONN_IDLE_INTERVAL_MAX,
+                                                    CFG_CONN_IDLE_LATENCY,
+                                                    CFG_CONN_IDLE_TIMEOUT);
+  }
+
+  /**
+   * On failure the profile is requested again on the next change of the links
+   */
+  if (ret == BLE_STATUS_SUCCESS)
+  {
+    APP_DBG_MSG("Connection 0x%x, request profile %d\n\r", connection_handle, profile);
+    p_policy->Profile = profile;
+    p_policy->Update_Pending = 1;
+  }
+  else
+  {
+    APP_DBG_MSG("Connection Update Request Failed , result: %d \n\r", ret);
+  }
 
   return;
 }
@@ -1281,5 +1905,16 @@ void SVCCTL_SvcInit(void){
 }
 
 /* USER CODE BEGIN FD_WRAP_FUNCTIONS */
+uint8_t hci_user_evt_budget(uint32_t evt_nbr)
+{
+  if(evt_nbr == 0)
+  {
+    HciUserEvtBatchStart = DWT->CYCCNT;
+    return 1;
+  }
+
+  return ((evt_nbr < CFG_HCI_USER_EVT_BUDGET_NBR) &&
+          ((DWT->CYCCNT - HciUserEvtBatchStart) < (CFG_HCI_USER_EVT_BUDGET_US * (SystemCoreClock / 1000000))));
+}
 
 /* USER CODE END FD_WRAP_FUNCTIONS */
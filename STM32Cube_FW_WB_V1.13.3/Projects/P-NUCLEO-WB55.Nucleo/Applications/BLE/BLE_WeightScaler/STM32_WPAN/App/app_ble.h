@@ -41,12 +41,23 @@ extern "C" {
       APP_BLE_IDLE,
       APP_BLE_FAST_ADV,
       APP_BLE_LP_ADV,
+      APP_BLE_BROADCAST_ADV,
       APP_BLE_SCAN,
       APP_BLE_LP_CONNECTING,
       APP_BLE_CONNECTED_SERVER,
       APP_BLE_CONNECTED_CLIENT
     } APP_BLE_ConnStatus_t;
 
+    /**
+     * Work of the services which keeps a link in the burst connection parameters while it is pending
+     */
+    typedef enum
+    {
+      APP_BLE_CONN_WORK_WSS_REPLAY  = (1 << 0),
+      APP_BLE_CONN_WORK_ACTIVITY    = (1 << 1),
+      APP_BLE_CONN_WORK_WSS_HISTORY = (1 << 2),
+    } APP_BLE_ConnWork_t;
+
 /* USER CODE BEGIN ET */
 
 /* USER CODE END ET */
@@ -70,6 +81,12 @@ extern "C" {
   void APP_BLE_Init( void );
 
   APP_BLE_ConnStatus_t APP_BLE_Get_Server_Connection_Status(void);
+  uint8_t APP_BLE_Get_Link_Index(uint16_t Connection_Handle);
+  uint8_t APP_BLE_Get_Link_Nbr(void);
+  uint16_t APP_BLE_Get_Att_Mtu(uint8_t Link);
+  void APP_BLE_Broadcast(uint16_t ServiceUUID, const uint8_t *pData, uint8_t Length);
+  void APP_BLE_Conn_Work(uint8_t Link, APP_BLE_ConnWork_t Work, uint8_t Pending);
+  void APP_BLE_Conn_Activity(uint8_t Link);
 
 /* USER CODE BEGIN EF */
   void APP_BLE_Key_Button1_Action(void);
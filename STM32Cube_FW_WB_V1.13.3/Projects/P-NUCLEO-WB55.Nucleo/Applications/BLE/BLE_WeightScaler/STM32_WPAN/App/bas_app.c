@@ -112,7 +112,7 @@ void BASAPP_Init(uint8_t index)
   /**
    * Create timer for Battery Level
    */
-  HW_TS_Create(CFG_TIM_PROC_ID_ISR, &(BASAPP_Context[index].TimerLevel_Id), hw_ts_Repeated, BASAPP_UpdateLevel);
+  HW_TS_CreateWithSlack(CFG_TIM_PROC_ID_ISR, &(BASAPP_Context[index].TimerLevel_Id), hw_ts_Repeated, BASAPP_UpdateLevel, CFG_TS_SLACK_PERIODIC);
 
   return;
 }
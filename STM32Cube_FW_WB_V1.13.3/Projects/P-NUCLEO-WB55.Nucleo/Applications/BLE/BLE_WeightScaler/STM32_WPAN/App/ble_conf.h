@@ -23,6 +23,7 @@
 #define BLE_CONF_H
 
 #include "app_conf.h"
+#include "time_base.h"
 
 /******************************************************************************
  *
@@ -92,6 +93,63 @@
  */
 /* TODO */
 
+/**
+ * Number of collectors the Weight Measurement is indicated to at the same time
+ * A confirmation is waited for from each of them
+ */
+#define BLE_CFG_WSS_MAX_NBR_LINK                    CFG_BLE_NUM_LINK
+
+/**
+ * Vendor specific Weight History characteristics, see APP_ENABLE_WSS_HISTORY
+ * A Weight History Data frame fills the largest ATT_MTU less the notification header
+ */
+#ifdef APP_ENABLE_WSS_HISTORY
+#define BLE_CFG_WSS_HISTORY                         1
+#else
+#define BLE_CFG_WSS_HISTORY                         0
+#endif
+#define BLE_CFG_WSS_HISTORY_DATA_MAX_LENGTH         (CFG_BLE_MAX_ATT_MTU - 3)
+
+/**
+ * Years a client may write in the Current Time, the time base cannot be set out of them
+ */
+#define BLE_CFG_CTS_YEAR_MIN                        TIMEBASE_YEAR_MIN
+#define BLE_CFG_CTS_YEAR_MAX                        TIMEBASE_YEAR_MAX
+
+/******************************************************************************
+ * HCI transport - asynchronous commands
+ ******************************************************************************/
+/**
+ * Characteristic updates queued with aci_gatt_update_char_value_async()
+ * The parameter length covers the 6 bytes header and the largest value sent in that mode
+ */
+#define HCI_TL_ASYNC_CMD_NBR                        (4)
+#define HCI_TL_ASYNC_CMD_MAX_PARAM_LEN              (6 + 20)
+
+/******************************************************************************
+ * BLE Controller - event subscribers
+ ******************************************************************************/
+/**
+ * Number of subscriptions to an event made with SVCCTL_SubscribeEvt()
+ * The WSS, BCS, UDS and CTS applications subscribe to the disconnection,
+ * the WSS application to the TX pool available event as well: 5 are used,
+ * the others are left for new subscribers
+ */
+#define BLE_CFG_EVT_MAX_NBR_SUBSCRIBER              (8)
+
+/**
+ * Per event processing time recorded by SVCCTL_UserEvtRx(), read with SVCCTL_EvtProfileGet()
+ * The time base is the DWT cycle counter of CPU1
+ */
+#define BLE_CFG_EVT_PROFILE                         (0)
+
+#if (BLE_CFG_EVT_PROFILE != 0)
+#include "stm32wbxx.h"
+#define BLE_CFG_EVT_PROFILE_INIT( )                 do{ CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; \
+                                                        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk; }while(0)
+#define BLE_CFG_EVT_PROFILE_GET_TIME( )             (DWT->CYCCNT)
+#endif /* BLE_CFG_EVT_PROFILE */
+
 /******************************************************************************
  * GAP Service - Appearance
  ******************************************************************************/
@@ -49,7 +49,7 @@ extern "C"
 
 /* Exported functions prototypes ---------------------------------------------*/
 void CTSAPP_Init(void);
-void CTSAPP_Reset(void);
+void CTSAPP_Reset(uint16_t ConnectionHandle);
 /* USER CODE BEGIN EFP */
 
 /* USER CODE END EFP */
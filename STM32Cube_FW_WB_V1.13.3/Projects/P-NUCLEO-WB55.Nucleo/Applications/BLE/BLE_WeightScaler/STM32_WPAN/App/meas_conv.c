@@ -0,0 +1,196 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    meas_conv.c
+  * @author  MCD Application Team
+  * @brief   Weight, Height and BMI fixed point conversion shared by WSS and BCS
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "meas_conv.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * A field value is computed as (input * Num + Den / 2) / Den
+ * which is the integer form of the floor(value / resolution + 0.5) rounding
+ */
+typedef struct{
+  uint32_t Num;
+  uint32_t Den;
+} MEASCONV_Ratio_t;
+
+/* USER CODE BEGIN PTD */
+
+/* USER CODE END PTD */
+
+/* Private defines ------------------------------------------------------------*/
+#define MEASCONV_WEIGHT_RES_NBR            (MEASCONV_WEIGHT_RES_MASK + 1)
+#define MEASCONV_HEIGHT_RES_NBR            (MEASCONV_HEIGHT_RES_MASK + 1)
+
+/* USER CODE BEGIN PD */
+
+/* USER CODE END PD */
+
+/* Private macros -------------------------------------------------------------*/
+/**
+ * Weight: input in grams
+ *   SI       : resolution given in grams
+ *   Imperial : 1 pound = 0.4536 kilogram, resolution given in 0.01 lb
+ *              g / (453.6 * res / 100) = (g * 1000) / (4536 * res) = (g * 125) / (567 * res)
+ */
+#define WEIGHT_KG(res_g)           { 1,   (res_g) }
+#define WEIGHT_LB(res_clb)         { 125, 567 * (res_clb) }
+
+/**
+ * Height: input in millimeters
+ *   SI       : resolution given in millimeters
+ *   Imperial : INCHES_TO_METERS factor of 0.3048 kept from the float implementation,
+ *              resolution given in 0.1 in
+ *              mm / (304.8 * res / 10) = (mm * 100) / (3048 * res) = (mm * 25) / (762 * res)
+ */
+#define HEIGHT_M(res_mm)           { 1,   (res_mm) }
+#define HEIGHT_IN(res_din)         { 25,  762 * (res_din) }
+
+/* USER CODE BEGIN PM */
+
+/* USER CODE END PM */
+
+/* Private variables ---------------------------------------------------------*/
+/**
+ * Weight Measurement Resolution, indexed by unit then by the feature field value
+ * 0 and reserved values are "Not specified" and use 1 kg or 1 lb
+ */
+static const MEASCONV_Ratio_t WeightRatioTab[2][MEASCONV_WEIGHT_RES_NBR] =
+{
+  /* MeasurementUnits_SI */
+  {
+    WEIGHT_KG(1000),  /* Not specified */
+    WEIGHT_KG(500),   /* 0.5 kg */
+    WEIGHT_KG(200),   /* 0.2 kg */
+    WEIGHT_KG(100),   /* 0.1 kg */
+    WEIGHT_KG(50),    /* 0.05 kg */
+    WEIGHT_KG(20),    /* 0.02 kg */
+    WEIGHT_KG(10),    /* 0.01 kg */
+    WEIGHT_KG(5),     /* 0.005 kg */
+    WEIGHT_KG(1000), WEIGHT_KG(1000), WEIGHT_KG(1000), WEIGHT_KG(1000),
+    WEIGHT_KG(1000), WEIGHT_KG(1000), WEIGHT_KG(1000), WEIGHT_KG(1000)
+  },
+  /* MeasurementUnits_Imperial */
+  {
+    WEIGHT_LB(100),   /* Not specified */
+    WEIGHT_LB(100),   /* 1 lb */
+    WEIGHT_LB(50),    /* 0.5 lb */
+    WEIGHT_LB(20),    /* 0.2 lb */
+    WEIGHT_LB(10),    /* 0.1 lb */
+    WEIGHT_LB(5),     /* 0.05 lb */
+    WEIGHT_LB(2),     /* 0.02 lb */
+    WEIGHT_LB(1),     /* 0.01 lb */
+    WEIGHT_LB(100), WEIGHT_LB(100), WEIGHT_LB(100), WEIGHT_LB(100),
+    WEIGHT_LB(100), WEIGHT_LB(100), WEIGHT_LB(100), WEIGHT_LB(100)
+  }
+};
+
+/**
+ * Height Measurement Resolution, indexed by unit then by the feature field value
+ * 0 and reserved values are "Not specified" and use 1 meter or 1 inch
+ */
+static const MEASCONV_Ratio_t HeightRatioTab[2][MEASCONV_HEIGHT_RES_NBR] =
+{
+  /* MeasurementUnits_SI */
+  {
+    HEIGHT_M(1000),   /* Not specified */
+    HEIGHT_M(10),     /* 0.01 meter */
+    HEIGHT_M(5),      /* 0.005 meter */
+    HEIGHT_M(1),      /* 0.001 meter */
+    HEIGHT_M(1000), HEIGHT_M(1000), HEIGHT_M(1000), HEIGHT_M(1000)
+  },
+  /* MeasurementUnits_Imperial */
+  {
+    HEIGHT_IN(10),    /* Not specified */
+    HEIGHT_IN(10),    /* 1 inch */
+    HEIGHT_IN(5),     /* 0.5 inch */
+    HEIGHT_IN(1),     /* 0.1 inch */
+    HEIGHT_IN(10), HEIGHT_IN(10), HEIGHT_IN(10), HEIGHT_IN(10)
+  }
+};
+
+/* USER CODE BEGIN PV */
+
+/* USER CODE END PV */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint16_t MeasConv_Apply(uint32_t value, const MEASCONV_Ratio_t *pRatio);
+
+/* USER CODE BEGIN PFP */
+
+/* USER CODE END PFP */
+
+/* Functions Definition ------------------------------------------------------*/
+static uint16_t MeasConv_Apply(uint32_t value, const MEASCONV_Ratio_t *pRatio)
+{
+  return (uint16_t)((value * pRatio->Num + (pRatio->Den / 2)) / pRatio->Den);
+}
+
+/* Public functions ----------------------------------------------------------*/
+/**
+ * @brief  Weight field value
+ * @param  weight_g: Weight in grams
+ * @param  resolution: Weight Measurement Resolution field of the Feature characteristic
+ * @param  unit: Unit of the Measurement characteristic
+ * @retval Weight in units of the resolution
+ */
+uint16_t MEASCONV_Weight(uint32_t weight_g, uint8_t resolution, Measurement_Unit_t unit)
+{
+  return MeasConv_Apply(weight_g, &WeightRatioTab[unit & 1][resolution & MEASCONV_WEIGHT_RES_MASK]);
+}
+
+/**
+ * @brief  Height field value
+ * @param  height_mm: Height in millimeters
+ * @param  resolution: Height Measurement Resolution field of the Feature characteristic
+ * @param  unit: Unit of the Measurement characteristic
+ * @retval Height in units of the resolution
+ */
+uint16_t MEASCONV_Height(uint32_t height_mm, uint8_t resolution, Measurement_Unit_t unit)
+{
+  return MeasConv_Apply(height_mm, &HeightRatioTab[unit & 1][resolution & MEASCONV_HEIGHT_RES_MASK]);
+}
+
+/**
+ * @brief  BMI field value: BMI = Weight / (Height ^ 2) with Unit is 0.1 kg/m2
+ * @param  weight_g: Weight in grams, up to MEASCONV_BMI_MAX_WEIGHT_G
+ * @param  height_mm: Height in millimeters
+ * @retval BMI in units of 0.1 kg/m2
+ */
+uint16_t MEASCONV_BMI(uint32_t weight_g, uint32_t height_mm)
+{
+  uint32_t height2 = height_mm * height_mm;
+
+  if(height2 == 0)
+  {
+    return 0;
+  }
+
+  return (uint16_t)((weight_g * 10000 + (height2 / 2)) / height2);
+}
+
+/* USER CODE BEGIN FD */
+
+/* USER CODE END FD */
@@ -0,0 +1,96 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    meas_conv.h
+  * @author  MCD Application Team
+  * @brief   Header for meas_conv.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MEAS_CONV_H
+#define __MEAS_CONV_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  MeasurementUnits_SI = 0,   /* Weight and Mass in units of kilogram (kg) and Height in units of meter */
+  MeasurementUnits_Imperial  /* Weight and Mass in units of pound (lb) and Height in units of inch (in) */
+} Measurement_Unit_t;
+
+/* USER CODE BEGIN ET */
+
+/* USER CODE END ET */
+/* Exported constants --------------------------------------------------------*/
+/**
+ * Weight and Height Measurement Resolution field positions
+ * The resolution indexes are the same for WSS and BCS, only the position
+ * of the fields inside the Feature characteristic differs
+ */
+#define MEASCONV_WSS_WEIGHT_RES_POS        (3)
+#define MEASCONV_WSS_HEIGHT_RES_POS        (7)
+#define MEASCONV_BCS_WEIGHT_RES_POS        (11)
+#define MEASCONV_BCS_HEIGHT_RES_POS        (15)
+
+#define MEASCONV_WEIGHT_RES_MASK           (0x0F)
+#define MEASCONV_HEIGHT_RES_MASK           (0x07)
+
+/**
+ * Largest weight (in grams) for which the BMI computation does not overflow
+ */
+#define MEASCONV_BMI_MAX_WEIGHT_G          (UINT32_MAX / 10000)
+
+/* USER CODE BEGIN EC */
+
+/* USER CODE END EC */
+
+/* Exported macro ------------------------------------------------------------*/
+#define MEASCONV_WEIGHT_RES(feature, pos)  ((uint8_t)(((feature) >> (pos)) & MEASCONV_WEIGHT_RES_MASK))
+#define MEASCONV_HEIGHT_RES(feature, pos)  ((uint8_t)(((feature) >> (pos)) & MEASCONV_HEIGHT_RES_MASK))
+
+/* USER CODE BEGIN EM */
+
+/* USER CODE END EM */
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint16_t MEASCONV_Weight(uint32_t weight_g, uint8_t resolution, Measurement_Unit_t unit);
+uint16_t MEASCONV_Height(uint32_t height_mm, uint8_t resolution, Measurement_Unit_t unit);
+uint16_t MEASCONV_BMI(uint32_t weight_g, uint32_t height_mm);
+/* USER CODE BEGIN EFP */
+
+/* USER CODE END EFP */
+
+/* Private defines -----------------------------------------------------------*/
+/* USER CODE BEGIN Private defines */
+
+/* USER CODE END Private defines */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__MEAS_CONV_H */
+
+/* USER CODE END */
@@ -49,7 +49,8 @@ extern "C"
 
 /* Exported functions prototypes ---------------------------------------------*/
 void UDSAPP_Init(void);
-void UDSAPP_Reset(void);
+void UDSAPP_Reset(uint16_t ConnectionHandle);
+uint8_t UDSAPP_UserIndex(void);
 /* USER CODE BEGIN EFP */
 
 /* USER CODE END EFP */
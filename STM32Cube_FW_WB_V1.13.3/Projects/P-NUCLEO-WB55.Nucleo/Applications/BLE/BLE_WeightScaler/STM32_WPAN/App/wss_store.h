@@ -0,0 +1,88 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    wss_store.h
+  * @author  MCD Application Team
+  * @brief   Header for wss_store.c module
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WSS_STORE_H
+#define __WSS_STORE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "wss.h"
+
+/* Private includes ----------------------------------------------------------*/
+/* USER CODE BEGIN Includes */
+
+/* USER CODE END Includes */
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  WSSSTORE_OK = 0,
+  WSSSTORE_EMPTY,
+  WSSSTORE_ERROR
+} WSSSTORE_Status_t;
+
+/* USER CODE BEGIN ET */
+
+/* USER CODE END ET */
+/* Exported constants --------------------------------------------------------*/
+/**
+ * A record is two double words, the first one is programmed to 0 once the
+ * record has been delivered to a collector
+ */
+#define WSSSTORE_RECORD_SIZE               (16)
+#define WSSSTORE_RECORD_NBR                (CFG_WSS_STORE_SIZE / WSSSTORE_RECORD_SIZE)
+
+/* USER CODE BEGIN EC */
+
+/* USER CODE END EC */
+
+/* Exported macro ------------------------------------------------------------*/
+/* USER CODE BEGIN EM */
+
+/* USER CODE END EM */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void WSSSTORE_Init(void);
+WSSSTORE_Status_t WSSSTORE_Push(uint8_t user_index, uint32_t time, WSS_MeasurementValue_t *pMeasurement);
+WSSSTORE_Status_t WSSSTORE_Peek(uint32_t *pTime, WSS_MeasurementValue_t *pMeasurement);
+WSSSTORE_Status_t WSSSTORE_Read(uint16_t offset, uint32_t *pTime, WSS_MeasurementValue_t *pMeasurement);
+WSSSTORE_Status_t WSSSTORE_Pop(void);
+uint16_t WSSSTORE_Count(void);
+/* USER CODE BEGIN EFP */
+
+/* USER CODE END EFP */
+
+/* Private defines -----------------------------------------------------------*/
+/* USER CODE BEGIN Private defines */
+
+/* USER CODE END Private defines */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__WSS_STORE_H */
+
+/* USER CODE END */
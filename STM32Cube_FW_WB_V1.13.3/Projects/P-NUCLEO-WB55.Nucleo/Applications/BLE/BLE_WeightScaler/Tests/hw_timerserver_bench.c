@@ -0,0 +1,174 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    hw_timerserver_bench.c
+  * @author  MCD Application Team
+  * @brief   Host benchmark of hw_timerserver.c on the simulated RTC
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include <time.h>
+#include "app_common.h"
+#include "hw_conf.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define NBR_START_STOP                (1000000)
+
+/**
+ * The running timers expire far after the probe timer so that nothing expires during the measurement
+ */
+#define BACKGROUND_TIMEOUT            (30000)
+#define PROBE_TIMEOUT_MAX             (BACKGROUND_TIMEOUT / 2)
+
+/**
+ * Periodic timers of the application, their periods and the slack given to them
+ */
+#define NBR_PERIODIC                  (8)
+#define PERIODIC_DURATION             (20 * 2048 * 60)
+#define PERIODIC_SLACK                (204)
+
+/* Private variables ---------------------------------------------------------*/
+static RTC_HandleTypeDef hrtc;
+static uint32_t RandomState = 0x2545F491;
+static uint32_t Expiries;
+static uint32_t Wakeups;
+static uint32_t LastExpiryTime;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(uint32_t Range)
+{
+  /* xorshift32 */
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+
+  return RandomState % Range;
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/**
+ * The timeouts reported on the same tick are reported on the same wakeup from low power mode
+ */
+static void Timeout(void)
+{
+  Expiries++;
+  if((Wakeups == 0) || (HW_TS_SIM.Time != LastExpiryTime))
+  {
+    Wakeups++;
+    LastExpiryTime = HW_TS_SIM.Time;
+  }
+
+  return;
+}
+
+static void Setup(void)
+{
+  /* prescalers of the application */
+  HW_TS_SIM_Init(0x0F, 0x7FFF, 0);
+  HW_TS_Init(hw_ts_InitMode_Full, &hrtc);
+
+  return;
+}
+
+/**
+ * Cost of HW_TS_Start() followed by HW_TS_Stop() with a number of other timers running
+ */
+static void BenchStartStop(uint8_t NbrRunning)
+{
+  uint8_t id;
+  uint8_t probe_id;
+  uint32_t loop;
+  double start;
+
+  Setup();
+
+  for(id = 0; id < NbrRunning; id++)
+  {
+    HW_TS_Create(0, &probe_id, hw_ts_SingleShot, Timeout);
+    HW_TS_Start(probe_id, BACKGROUND_TIMEOUT + Random(BACKGROUND_TIMEOUT));
+  }
+  HW_TS_Create(0, &probe_id, hw_ts_SingleShot, Timeout);
+
+  start = Now();
+  for(loop = 0; loop < NBR_START_STOP; loop++)
+  {
+    HW_TS_Start(probe_id, 1 + Random(PROBE_TIMEOUT_MAX));
+    HW_TS_Stop(probe_id);
+  }
+
+  printf("  start + stop, %2u timers running: %7.1f ns\n", NbrRunning, (Now() - start) / NBR_START_STOP);
+
+  return;
+}
+
+/**
+ * Number of wakeups taken by periodic timers which may share their wakeups within their slack
+ */
+static void BenchPeriodic(void)
+{
+  uint8_t id;
+  uint8_t timer_id;
+  double start;
+
+  Setup();
+  Expiries = 0;
+  Wakeups = 0;
+
+  for(id = 0; id < NBR_PERIODIC; id++)
+  {
+    HW_TS_CreateWithSlack(0, &timer_id, hw_ts_Repeated, Timeout, PERIODIC_SLACK);
+    HW_TS_Start(timer_id, 2048 + Random(4 * 2048));
+  }
+
+  start = Now();
+  HW_TS_SIM_Advance(PERIODIC_DURATION);
+
+  printf("  %u periodic timers over %u ticks: %u timeouts in %u wakeups, %.1f ms\n", NBR_PERIODIC,
+         PERIODIC_DURATION, Expiries, Wakeups, (Now() - start) / 1e6);
+
+  return;
+}
+
+/* Public functions ----------------------------------------------------------*/
+void HW_TS_RTC_CountUpdated_AppNot(void)
+{
+  return;
+}
+
+int main(void)
+{
+  uint8_t nbr_running;
+
+  printf("hw_timerserver (%s engine, %u timers)\n",
+         (CFG_HW_TS_USE_HEAP_ENGINE == 1) ? "heap" : "list", CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER);
+
+  for(nbr_running = 1; nbr_running < CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER; nbr_running *= 2)
+  {
+    BenchStartStop(nbr_running - 1);
+  }
+  BenchStartStop(CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER - 1);
+
+  BenchPeriodic();
+
+  return 0;
+}
@@ -0,0 +1,356 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    hw_timerserver_test.c
+  * @author  MCD Application Team
+  * @brief   Host test of hw_timerserver.c on the simulated RTC, random
+  *          start, stop and expiry sequences against a reference model
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "hw_conf.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint8_t       Id;
+  HW_TS_Mode_t  Mode;
+  uint32_t      Slack;
+  uint8_t       Running;
+  uint32_t      Ticks;
+  uint32_t      Earliest;     /**< The timeout shall not be reported before */
+  uint32_t      Latest;       /**< The timeout shall be reported at the latest */
+} ModelTimer_t;
+
+typedef struct
+{
+  uint32_t PredivA;
+  uint32_t PredivS;
+  uint32_t Wucksel;
+} SimConfig_t;
+
+/* Private defines -----------------------------------------------------------*/
+#define NBR_OPERATIONS                (200000)
+
+/**
+ * Longest time the interrupts are masked, within the CFG_HW_TS_RTC_HANDLER_MAX_DELAY margin
+ */
+#define MAX_MASKED_TICKS              (CFG_HW_TS_RTC_HANDLER_MAX_DELAY / 16)
+
+#define TIME_BEFORE(a, b)             ((int32_t)((a) - (b)) < 0)
+
+/* Private variables ---------------------------------------------------------*/
+/**
+ * The configuration of the application, then a short subsecond period so that the SSR wraps and the
+ * wakeup timer limitation are hit often
+ */
+static const SimConfig_t aSimConfig[] =
+{
+  { 0x0F, 0x7FFF, 0 },
+  { 0x0F, 0x03FF, 0 },
+  { 0x07, 0x00FF, 1 },
+};
+
+static const uint32_t aSlack[] = { 0, 0, 3, 50, 400, 3000 };
+
+static ModelTimer_t aModel[CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER];
+static RTC_HandleTypeDef hrtc;
+static uint32_t RandomState;
+static uint32_t MaskedTicks;
+static uint32_t Expiries;
+static uint32_t Failures;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(uint32_t Range)
+{
+  /* xorshift32 */
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+
+  return RandomState % Range;
+}
+
+static void Fail(const char *pReason, uint8_t TimerID)
+{
+  if(Failures < 20)
+  {
+    printf("t=%u timer %u: %s (earliest %u, latest %u)\n", HW_TS_SIM.Time, TimerID, pReason,
+           aModel[TimerID].Earliest, aModel[TimerID].Latest);
+  }
+  Failures++;
+
+  return;
+}
+
+static uint32_t RandomTimeout(void)
+{
+  switch(Random(4))
+  {
+    case 0:  return 1 + Random(16);
+    case 1:  return 1 + Random(2000);
+    case 2:  return 1 + Random(40000);
+    default: return 1 + Random(150000);
+  }
+}
+
+static void ModelStart(uint8_t TimerID, uint32_t Ticks)
+{
+  aModel[TimerID].Running = 1;
+  aModel[TimerID].Ticks = Ticks;
+  aModel[TimerID].Earliest = HW_TS_SIM.Time + Ticks;
+  aModel[TimerID].Latest = aModel[TimerID].Earliest + aModel[TimerID].Slack;
+
+  return;
+}
+
+static void Start(uint8_t TimerID, uint32_t Ticks)
+{
+  ModelStart(TimerID, Ticks);
+  HW_TS_Start(TimerID, Ticks);
+
+  return;
+}
+
+static void Stop(uint8_t TimerID)
+{
+  aModel[TimerID].Running = 0;
+  HW_TS_Stop(TimerID);
+
+  return;
+}
+
+static uint8_t AnyRunning(void)
+{
+  uint8_t id;
+
+  for(id = 0; id < CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER; id++)
+  {
+    if(aModel[id].Running != 0)
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * No running timer shall be past its latest expiry, and the wakeup timer shall be off only when no timer runs
+ */
+static void CheckState(void)
+{
+  uint8_t id;
+
+  for(id = 0; id < CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER; id++)
+  {
+    if((aModel[id].Running != 0) && TIME_BEFORE(aModel[id].Latest, HW_TS_SIM.Time))
+    {
+      Fail("timeout not reported", id);
+      aModel[id].Running = 0;
+    }
+  }
+
+  if((HW_TS_RTC_ReadLeftTicksToCount() == 0xFFFF) == (AnyRunning() != 0))
+  {
+    if(Failures < 20)
+    {
+      printf("t=%u: wakeup timer %s\n", HW_TS_SIM.Time, AnyRunning() ? "stopped with timers running" : "left running");
+    }
+    Failures++;
+  }
+
+  return;
+}
+
+static void RunConfig(const SimConfig_t *pConfig)
+{
+  uint32_t operation;
+  uint8_t id;
+
+  HW_TS_SIM_Init(pConfig->PredivA, pConfig->PredivS, pConfig->Wucksel);
+  HW_TS_Init(hw_ts_InitMode_Full, &hrtc);
+
+  for(id = 0; id < CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER; id++)
+  {
+    memset(&aModel[id], 0, sizeof(aModel[id]));
+    aModel[id].Mode = ((id & 1) != 0) ? hw_ts_Repeated : hw_ts_SingleShot;
+#if (CFG_HW_TS_USE_HEAP_ENGINE == 1)
+    aModel[id].Slack = aSlack[id % (sizeof(aSlack) / sizeof(aSlack[0]))];
+#endif
+    if((HW_TS_CreateWithSlack(0, &aModel[id].Id, aModel[id].Mode, NULL, aSlack[id % (sizeof(aSlack) / sizeof(aSlack[0]))]) != hw_ts_Successful) ||
+       (aModel[id].Id != id))
+    {
+      printf("timer %u not created\n", id);
+      Failures++;
+      return;
+    }
+  }
+
+  for(operation = 0; operation < NBR_OPERATIONS; operation++)
+  {
+    uint32_t choice = Random(100);
+
+    id = (uint8_t)Random(CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER);
+
+    if(choice < 30)
+    {
+      Start(id, RandomTimeout());
+    }
+    else if(choice < 45)
+    {
+      Stop(id);
+    }
+    else if(choice < 75)
+    {
+      HW_TS_SIM_Advance(Random(64));
+    }
+    else if(choice < 90)
+    {
+      HW_TS_SIM_Advance(Random(20000));
+    }
+    else if(choice < 97)
+    {
+      /**
+       * Interrupt latency, the timeouts raised meanwhile are reported late by the masked time
+       */
+      HW_TS_SIM_SetPrimask(1);
+      MaskedTicks = 1 + Random(MAX_MASKED_TICKS);
+      HW_TS_SIM_Advance(MaskedTicks);
+      HW_TS_SIM_SetPrimask(0);
+      MaskedTicks = 0;
+    }
+    else if(AnyRunning() == 0)
+    {
+      /**
+       * Spurious interrupt, nothing shall be reported
+       */
+      HW_TS_SIM_InjectIrq();
+    }
+
+    CheckState();
+  }
+
+  for(id = 0; id < CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER; id++)
+  {
+    HW_TS_Delete(id);
+    aModel[id].Running = 0;
+  }
+  CheckState();
+
+  if(HW_TS_SIM.AccessErrors != 0)
+  {
+    printf("%u write(s) to the locked or running wakeup timer\n", HW_TS_SIM.AccessErrors);
+    Failures++;
+  }
+
+  printf("prediv %u/%u wucksel %u: %u timeouts in %u wakeups over %u ticks\n",
+         pConfig->PredivA, pConfig->PredivS, pConfig->Wucksel, Expiries, HW_TS_SIM.IrqCount, HW_TS_SIM.Time);
+
+  return;
+}
+
+/* Public functions ----------------------------------------------------------*/
+/**
+ * Timeout reported by the timer server, in the wakeup interrupt context
+ */
+void HW_TS_RTC_Int_AppNot(uint32_t TimerProcessID, uint8_t TimerID, HW_TS_pTimerCb_t pTimerCallBack)
+{
+  uint32_t now = HW_TS_SIM.Time;
+  uint8_t other_id;
+
+  (void)TimerProcessID;
+  (void)pTimerCallBack;
+
+  Expiries++;
+
+  if(aModel[TimerID].Running == 0)
+  {
+    Fail("timeout of a stopped timer", TimerID);
+    return;
+  }
+
+  if(TIME_BEFORE(now, aModel[TimerID].Earliest))
+  {
+    Fail("timeout reported early", TimerID);
+  }
+  else if(TIME_BEFORE(aModel[TimerID].Latest + MaskedTicks, now))
+  {
+    Fail("timeout reported late", TimerID);
+  }
+
+  if(aModel[TimerID].Mode == hw_ts_Repeated)
+  {
+    ModelStart(TimerID, aModel[TimerID].Ticks);
+  }
+  else
+  {
+    aModel[TimerID].Running = 0;
+  }
+
+  /**
+   * The applications start and stop timers from the timeout callbacks as well
+   */
+  other_id = (uint8_t)Random(CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER);
+  switch(Random(8))
+  {
+    case 0:
+    case 1:
+      Start(other_id, RandomTimeout());
+      break;
+
+    case 2:
+      Stop(other_id);
+      break;
+
+    default:
+      break;
+  }
+
+  return;
+}
+
+/**
+ * The wakeup timer is read again before entering low power mode in the application, nothing to do here
+ */
+void HW_TS_RTC_CountUpdated_AppNot(void)
+{
+  return;
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t config;
+
+  RandomState = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 0x2545F491;
+  if(RandomState == 0)
+  {
+    RandomState = 1;
+  }
+
+  printf("hw_timerserver (%s engine, %u timers), seed 0x%08X\n",
+         (CFG_HW_TS_USE_HEAP_ENGINE == 1) ? "heap" : "list", CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER, RandomState);
+
+  for(config = 0; config < (sizeof(aSimConfig) / sizeof(aSimConfig[0])); config++)
+  {
+    Expiries = 0;
+    RunConfig(&aSimConfig[config]);
+  }
+
+  printf("hw_timerserver: %u failure(s)\n", Failures);
+
+  return (Failures == 0) ? 0 : 1;
+}
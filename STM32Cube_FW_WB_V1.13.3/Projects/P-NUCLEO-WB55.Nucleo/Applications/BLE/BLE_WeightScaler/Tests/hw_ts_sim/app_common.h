@@ -0,0 +1,99 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    app_common.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of app_common.h to build hw_timerserver.c
+  *          against the simulated RTC
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef APP_COMMON_H
+#define APP_COMMON_H
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hw_ts_sim.h"
+
+  /* -------------------------------- *
+   *  Compiler and CPU definitions    *
+   * -------------------------------- */
+#define PLACE_IN_SECTION( __x__ )
+#define __weak              __attribute__((weak))
+#define __CLZ(value)        ((uint8_t)__builtin_clz(value))
+
+/**
+ * The PRIMASK bit is the interrupt mask of the simulated CPU, a pending wakeup interrupt is taken when it is cleared
+ */
+#define __get_PRIMASK()     HW_TS_SIM_GetPrimask()
+#define __disable_irq()     HW_TS_SIM_SetPrimask(1)
+#define __set_PRIMASK(x)    HW_TS_SIM_SetPrimask(x)
+
+typedef enum
+{
+  RESET = 0,
+  SET = !RESET
+} FlagStatus;
+
+typedef struct
+{
+  uint32_t Instance;
+} RTC_HandleTypeDef;
+
+  /* -------------------------------- *
+   *  HW TimerServer, as in hw_if.h   *
+   * -------------------------------- */
+  typedef enum
+  {
+    hw_ts_InitMode_Full,
+    hw_ts_InitMode_Limited,
+  } HW_TS_InitMode_t;
+
+  typedef enum
+  {
+    hw_ts_SingleShot,
+    hw_ts_Repeated
+  } HW_TS_Mode_t;
+
+  typedef enum
+  {
+    hw_ts_Successful,
+    hw_ts_Failed,
+  }HW_TS_ReturnStatus_t;
+
+  typedef void (*HW_TS_pTimerCb_t)(void);
+
+  void HW_TS_Init(HW_TS_InitMode_t TimerInitMode, RTC_HandleTypeDef *hrtc);
+  HW_TS_ReturnStatus_t HW_TS_Create(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pTimerCallBack);
+  HW_TS_ReturnStatus_t HW_TS_CreateWithSlack(uint32_t TimerProcessID, uint8_t *pTimerId, HW_TS_Mode_t TimerMode, HW_TS_pTimerCb_t pTimerCallBack, uint32_t SlackTicks);
+  void HW_TS_Stop(uint8_t TimerID);
+  void HW_TS_Start(uint8_t TimerID, uint32_t timeout_ticks);
+  void HW_TS_Delete(uint8_t TimerID);
+  void HW_TS_RTC_Wakeup_Handler(void);
+  uint16_t HW_TS_RTC_ReadLeftTicksToCount(void);
+  void HW_TS_RTC_Int_AppNot(uint32_t TimerProcessID, uint8_t TimerID, HW_TS_pTimerCb_t pTimerCallBack);
+  void HW_TS_RTC_CountUpdated_AppNot(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*APP_COMMON_H */
@@ -0,0 +1,52 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    hw_conf.h
+  * @author  MCD Application Team
+  * @brief   Host replacement of hw_conf.h to build hw_timerserver.c
+  *          against the simulated RTC
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef HW_CONF_H
+#define HW_CONF_H
+
+/******************************************************************************
+ * HW TIMER SERVER
+ *****************************************************************************/
+/**
+ * The settings not given on the command line are the ones of the application
+ */
+#ifndef CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER
+#define CFG_HW_TS_MAX_NBR_CONCURRENT_TIMER  6
+#endif
+
+#ifndef CFG_HW_TS_USE_HEAP_ENGINE
+#define CFG_HW_TS_USE_HEAP_ENGINE  1
+#endif
+
+#define CFG_HW_TS_USE_PRIMASK_AS_CRITICAL_SECTION  1
+
+/**
+ * 10ms of LSI as in the application
+ */
+#define CFG_HW_TS_RTC_HANDLER_MAX_DELAY  ( 10 * (32000/1000) )
+
+/**
+ * The RTC wakeup timer, the EXTI line and the NVIC are the simulated ones
+ */
+#define CFG_HW_TS_PORT_HEADER  "hw_ts_sim_port.h"
+
+#endif /*HW_CONF_H */
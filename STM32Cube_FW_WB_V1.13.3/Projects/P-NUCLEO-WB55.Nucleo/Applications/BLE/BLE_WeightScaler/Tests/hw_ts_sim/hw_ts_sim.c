@@ -0,0 +1,196 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    hw_ts_sim.c
+  * @author  MCD Application Team
+  * @brief   Simulated RTC wakeup timer, EXTI line and NVIC of the timer server
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "app_common.h"
+#include "hw_ts_sim.h"
+
+/* Global variables ----------------------------------------------------------*/
+HW_TS_SIM_t HW_TS_SIM;
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  Take the wakeup interrupt while it is pending, enabled and not masked
+ *         The interrupt does not preempt itself, a new request is taken when the handler returns
+ * @param  None
+ * @retval None
+ */
+static void Dispatch(void)
+{
+  while((HW_TS_SIM.NvicPending != 0) && (HW_TS_SIM.NvicEnabled != 0) &&
+        (HW_TS_SIM.Primask == 0) && (HW_TS_SIM.InIrq == 0))
+  {
+    HW_TS_SIM.NvicPending = 0;
+    HW_TS_SIM.InIrq = 1;
+    HW_TS_SIM.IrqCount++;
+
+    HW_TS_RTC_Wakeup_Handler();
+
+    HW_TS_SIM.InIrq = 0;
+  }
+
+  return;
+}
+
+/* Public functions ----------------------------------------------------------*/
+void HW_TS_SIM_Init(uint32_t PredivA, uint32_t PredivS, uint32_t Wucksel)
+{
+  if((PredivA + 1) != (1UL << (4 - Wucksel)))
+  {
+    fprintf(stderr, "hw_ts_sim: the subsecond tick shall be the wakeup timer tick\n");
+    exit(2);
+  }
+
+  memset(&HW_TS_SIM, 0, sizeof(HW_TS_SIM));
+  HW_TS_SIM.PredivA = PredivA;
+  HW_TS_SIM.PredivS = PredivS;
+  HW_TS_SIM.Wucksel = Wucksel;
+  HW_TS_SIM.Ssr = PredivS;
+  HW_TS_SIM.Wutr = 0xFFFF;
+  HW_TS_SIM.WriteProtected = 1;
+
+  return;
+}
+
+void HW_TS_SIM_Advance(uint32_t Ticks)
+{
+  while(Ticks != 0)
+  {
+    Ticks--;
+    HW_TS_SIM.Time++;
+
+    if(HW_TS_SIM.Ssr == 0)
+    {
+      HW_TS_SIM.Ssr = HW_TS_SIM.PredivS;
+    }
+    else
+    {
+      HW_TS_SIM.Ssr--;
+    }
+
+    if(HW_TS_SIM.Wute != 0)
+    {
+      HW_TS_SIM.WutCount++;
+      if(HW_TS_SIM.WutCount > HW_TS_SIM.Wutr)
+      {
+        /**
+         * Auto reload, the flag is raised again every (Wutr + 1) ticks until the timer is disabled
+         */
+        HW_TS_SIM.WutCount = 0;
+        HW_TS_SIM.Wutf = 1;
+
+        if((HW_TS_SIM.Wutie != 0) && (HW_TS_SIM.ExtiRising != 0) && (HW_TS_SIM.ExtiIt != 0))
+        {
+          HW_TS_SIM.ExtiPending = 1;
+          HW_TS_SIM.NvicPending = 1;
+        }
+      }
+    }
+
+    Dispatch();
+  }
+
+  return;
+}
+
+void HW_TS_SIM_InjectIrq(void)
+{
+  HW_TS_SIM.NvicPending = 1;
+  Dispatch();
+
+  return;
+}
+
+uint32_t HW_TS_SIM_ReadSsr(void)
+{
+  return HW_TS_SIM.Ssr;
+}
+
+void HW_TS_SIM_WriteWut(uint32_t Value)
+{
+  /**
+   * WUTR is only writable when the wakeup timer is disabled and the registers unlocked
+   */
+  if((HW_TS_SIM.WriteProtected != 0) || (HW_TS_SIM.Wute != 0) || (Value > 0xFFFF))
+  {
+    HW_TS_SIM.AccessErrors++;
+    return;
+  }
+
+  HW_TS_SIM.Wutr = Value;
+
+  return;
+}
+
+void HW_TS_SIM_WakeupTimerEnable(uint8_t Enable)
+{
+  if(HW_TS_SIM.WriteProtected != 0)
+  {
+    HW_TS_SIM.AccessErrors++;
+    return;
+  }
+
+  if((Enable != 0) && (HW_TS_SIM.Wute == 0))
+  {
+    HW_TS_SIM.WutCount = 0;
+  }
+  HW_TS_SIM.Wute = Enable;
+
+  return;
+}
+
+void HW_TS_SIM_CheckWriteAccess(void)
+{
+  if(HW_TS_SIM.WriteProtected != 0)
+  {
+    HW_TS_SIM.AccessErrors++;
+  }
+
+  return;
+}
+
+void HW_TS_SIM_NvicEnable(uint8_t Enable)
+{
+  HW_TS_SIM.NvicEnabled = Enable;
+  Dispatch();
+
+  return;
+}
+
+void HW_TS_SIM_NvicSetPending(void)
+{
+  HW_TS_SIM.NvicPending = 1;
+  Dispatch();
+
+  return;
+}
+
+uint32_t HW_TS_SIM_GetPrimask(void)
+{
+  return HW_TS_SIM.Primask;
+}
+
+void HW_TS_SIM_SetPrimask(uint32_t Primask)
+{
+  HW_TS_SIM.Primask = (Primask != 0);
+  Dispatch();
+
+  return;
+}
@@ -0,0 +1,106 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    hw_ts_sim.h
+  * @author  MCD Application Team
+  * @brief   Simulated RTC wakeup timer, EXTI line and NVIC of the timer server
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef HW_TS_SIM_H
+#define HW_TS_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * Registers of the simulated RTC
+ * The time advances in ticks of the subsecond counter, which shall be the ticks of the wakeup timer as well:
+ * (PREDIV_A + 1) RTCCLK periods and RTCCLK divided by 2^(4 - WUCKSEL)
+ */
+typedef struct
+{
+  uint32_t Ssr;             /**< Subsecond down counter, reloaded with PredivS after 0 */
+  uint32_t PredivA;
+  uint32_t PredivS;
+  uint32_t Wucksel;
+  uint32_t Wutr;            /**< Wakeup timer reload value, WUTF is set every (Wutr + 1) ticks */
+  uint32_t WutCount;        /**< Ticks counted by the wakeup timer since it has been enabled or reloaded */
+  uint8_t  Wute;
+  uint8_t  Wutie;
+  uint8_t  Wutf;
+  uint8_t  WriteProtected;
+  uint8_t  ExtiRising;
+  uint8_t  ExtiIt;
+  uint8_t  ExtiPending;
+  uint8_t  NvicEnabled;
+  uint8_t  NvicPending;
+  uint8_t  Primask;
+  uint8_t  InIrq;
+  uint32_t Time;            /**< Ticks since HW_TS_SIM_Init() */
+  uint32_t IrqCount;        /**< Number of calls of HW_TS_RTC_Wakeup_Handler() */
+  uint32_t AccessErrors;    /**< Register writes the hardware would have ignored */
+} HW_TS_SIM_t;
+
+/* Exported variables --------------------------------------------------------*/
+extern HW_TS_SIM_t HW_TS_SIM;
+
+/* Exported functions ------------------------------------------------------- */
+/**
+ * @brief  Reset the simulated RTC with the prescalers the application writes in the RTC
+ * @param  PredivA: Asynchronous prescaler
+ * @param  PredivS: Synchronous prescaler
+ * @param  Wucksel: Wakeup timer clock selection, from 0 (RTCCLK/16) to 3 (RTCCLK/2)
+ * @retval None
+ */
+void HW_TS_SIM_Init(uint32_t PredivA, uint32_t PredivS, uint32_t Wucksel);
+
+/**
+ * @brief  Let the simulated time run
+ *         The wakeup interrupt is taken at the end of the tick where it is raised, unless it is masked
+ * @param  Ticks: Number of ticks to run
+ * @retval None
+ */
+void HW_TS_SIM_Advance(uint32_t Ticks);
+
+/**
+ * @brief  Set the wakeup interrupt pending in the NVIC without any wakeup timer event, as a spurious interrupt
+ * @param  None
+ * @retval None
+ */
+void HW_TS_SIM_InjectIrq(void);
+
+/**
+ * Accesses of the timer server to the simulated peripherals, see hw_ts_sim_port.h
+ */
+uint32_t HW_TS_SIM_ReadSsr(void);
+void HW_TS_SIM_WriteWut(uint32_t Value);
+void HW_TS_SIM_WakeupTimerEnable(uint8_t Enable);
+void HW_TS_SIM_CheckWriteAccess(void);
+void HW_TS_SIM_NvicEnable(uint8_t Enable);
+void HW_TS_SIM_NvicSetPending(void);
+uint32_t HW_TS_SIM_GetPrimask(void);
+void HW_TS_SIM_SetPrimask(uint32_t Primask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*HW_TS_SIM_H */
@@ -0,0 +1,58 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    hw_ts_sim_port.h
+  * @author  MCD Application Team
+  * @brief   Port of the timer server on the simulated RTC, selected with
+  *          CFG_HW_TS_PORT_HEADER
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef HW_TS_SIM_PORT_H
+#define HW_TS_SIM_PORT_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw_ts_sim.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define RTC_CR_WUTE                           (1UL << 10)
+
+/* Exported macros -----------------------------------------------------------*/
+#define HW_TS_RTC_READ_SSR()                  HW_TS_SIM_ReadSsr()
+#define HW_TS_RTC_READ_WUT()                  (HW_TS_SIM.Wutr)
+#define HW_TS_RTC_WRITE_WUT(value)            HW_TS_SIM_WriteWut(value)
+#define HW_TS_RTC_READ_WUTE()                 ((HW_TS_SIM.Wute != 0) ? RTC_CR_WUTE : 0)
+#define HW_TS_RTC_READ_WUCKSEL()              (HW_TS_SIM.Wucksel)
+#define HW_TS_RTC_READ_PREDIV_A()             (HW_TS_SIM.PredivA)
+#define HW_TS_RTC_READ_PREDIV_S()             (HW_TS_SIM.PredivS)
+#define HW_TS_RTC_BYPASS_SHADOW()             HW_TS_SIM_CheckWriteAccess()
+#define HW_TS_RTC_GET_FLAG_WUTWF()            ((HW_TS_SIM.Wute == 0) ? SET : RESET)
+#define HW_TS_RTC_GET_FLAG_WUTF()             ((HW_TS_SIM.Wutf != 0) ? SET : RESET)
+#define HW_TS_RTC_CLEAR_FLAG_WUTF()           (HW_TS_SIM.Wutf = 0)
+#define HW_TS_RTC_EXTI_CLEAR_FLAG()           (HW_TS_SIM.ExtiPending = 0)
+#define HW_TS_RTC_WAKEUPTIMER_ENABLE()        HW_TS_SIM_WakeupTimerEnable(1)
+#define HW_TS_RTC_WAKEUPTIMER_DISABLE()       HW_TS_SIM_WakeupTimerEnable(0)
+#define HW_TS_RTC_WAKEUPTIMER_ENABLE_IT()     (HW_TS_SIM.Wutie = 1)
+#define HW_TS_RTC_WRITEPROTECTION_ENABLE()    (HW_TS_SIM.WriteProtected = 1)
+#define HW_TS_RTC_WRITEPROTECTION_DISABLE()   (HW_TS_SIM.WriteProtected = 0)
+#define HW_TS_EXTI_ENABLE_RISING_TRIG()       (HW_TS_SIM.ExtiRising = 1)
+#define HW_TS_EXTI_ENABLE_IT()                (HW_TS_SIM.ExtiIt = 1)
+#define HW_TS_NVIC_ENABLE()                   HW_TS_SIM_NvicEnable(1)
+#define HW_TS_NVIC_DISABLE()                  HW_TS_SIM_NvicEnable(0)
+#define HW_TS_NVIC_SET_PENDING()              HW_TS_SIM_NvicSetPending()
+#define HW_TS_NVIC_CLEAR_PENDING()            (HW_TS_SIM.NvicPending = 0)
+#define HW_TS_NVIC_SET_PRIORITY()             ((void)0)
+
+#endif /*HW_TS_SIM_PORT_H */
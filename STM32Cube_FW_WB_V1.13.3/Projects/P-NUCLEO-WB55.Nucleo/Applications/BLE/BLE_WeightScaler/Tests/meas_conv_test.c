@@ -0,0 +1,239 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    meas_conv_test.c
+  * @author  MCD Application Team
+  * @brief   Host test of meas_conv.c against the float conversion it replaces
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <float.h>
+#include "meas_conv.h"
+
+/* Private defines -----------------------------------------------------------*/
+/**
+ * Sweep ranges, every gram and every millimeter is checked
+ * The weights cover the 16 bit field at the finest SI resolution (5 g)
+ */
+#define WEIGHT_G_MAX                  (330000)
+#define HEIGHT_MM_MAX                 (70000)
+#define BMI_WEIGHT_G_MAX              (300000)
+#define BMI_HEIGHT_MM_MIN             (500)
+#define BMI_HEIGHT_MM_MAX             (3000)
+
+/**
+ * The float path may only differ when the exact value is a rounding tie,
+ * where the float errors decide the result: a few ulp of the value for
+ * each of the float operations
+ */
+#define TIE_TOLERANCE(value)          ((value) * 8 * FLT_EPSILON + 1e-6)
+
+/* Taken from the float implementation of wss_app.c and bcs_app.c */
+#define POUNDS_TO_KILOGRAMS           0.4536
+#define INCHES_TO_METERS              0.3048
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Failures;
+static uint32_t Ties;
+
+/* Private functions ---------------------------------------------------------*/
+/*
+ * Float implementation removed from wss_app.c, with the feature field and
+ * the unit passed as parameters instead of being read from the context
+ */
+static float Float_Resolution_Weight(uint8_t feature, Measurement_Unit_t unit){
+  float resolution = 1.0f; /* the default is Not specified */
+
+  switch (feature){
+  case 1: resolution = (unit == MeasurementUnits_SI) ? 0.5f : 1.0f; break;
+  case 2: resolution = (unit == MeasurementUnits_SI) ? 0.2f : 0.5f; break;
+  case 3: resolution = (unit == MeasurementUnits_SI) ? 0.1f : 0.2f; break;
+  case 4: resolution = (unit == MeasurementUnits_SI) ? 0.05f : 0.1f; break;
+  case 5: resolution = (unit == MeasurementUnits_SI) ? 0.02f : 0.05f; break;
+  case 6: resolution = (unit == MeasurementUnits_SI) ? 0.01f : 0.02f; break;
+  case 7: resolution = (unit == MeasurementUnits_SI) ? 0.005f : 0.01f; break;
+  default: break;
+  }
+
+  return resolution;
+}
+
+static uint16_t Float_Convert_Weight(uint8_t feature, Measurement_Unit_t unit, float weight){
+  uint32_t v;
+  float resolution = Float_Resolution_Weight(feature, unit);
+
+  if(unit == MeasurementUnits_Imperial){
+    weight /= POUNDS_TO_KILOGRAMS;
+  }
+
+  weight /= resolution;
+  v = (uint32_t)(weight * 10);
+  return (uint16_t)((v + 5) / 10);
+}
+
+static float Float_Resolution_Height(uint8_t feature, Measurement_Unit_t unit){
+  float resolution = 1.0f; /* the default is Not specified */
+
+  switch (feature){
+  case 1: resolution = (unit == MeasurementUnits_SI) ? 0.01f : 1.0f; break;
+  case 2: resolution = (unit == MeasurementUnits_SI) ? 0.005f : 0.5f; break;
+  case 3: resolution = (unit == MeasurementUnits_SI) ? 0.001f : 0.1f; break;
+  default: break;
+  }
+
+  return resolution;
+}
+
+static uint16_t Float_Convert_Height(uint8_t feature, Measurement_Unit_t unit, float height){
+  uint32_t v;
+  float resolution = Float_Resolution_Height(feature, unit);
+
+  if(unit == MeasurementUnits_Imperial){
+    height /= INCHES_TO_METERS;
+  }
+
+  height /= resolution;
+  v = (uint32_t)(height * 10);
+  return (uint16_t)((v + 5) / 10);
+}
+
+static uint16_t Float_Calculate_BMI(float weight, float height){
+  float resolution = 0.1f;
+  float value = weight / (height * height);
+  uint32_t v;
+
+  value /= resolution;
+  v = (uint32_t)(value * 10);
+  return (uint16_t)((v + 5) / 10);
+}
+
+/*
+ * Exact value of a field from the definition of the resolutions,
+ * in double, far more precise than the float path, so that the ties are found
+ */
+static double Exact_Weight(uint32_t weight_g, uint8_t feature, Measurement_Unit_t unit){
+  static const double si_kg[8] = { 1.0, 0.5, 0.2, 0.1, 0.05, 0.02, 0.01, 0.005 };
+  static const double imperial_lb[8] = { 1.0, 1.0, 0.5, 0.2, 0.1, 0.05, 0.02, 0.01 };
+  double kg = (double)weight_g / 1000.0;
+
+  if(feature > 7){
+    feature = 0;
+  }
+  if(unit == MeasurementUnits_Imperial){
+    return kg / (0.4536 * imperial_lb[feature]);
+  }
+  return kg / si_kg[feature];
+}
+
+static double Exact_Height(uint32_t height_mm, uint8_t feature, Measurement_Unit_t unit){
+  static const double si_m[4] = { 1.0, 0.01, 0.005, 0.001 };
+  static const double imperial_in[4] = { 1.0, 1.0, 0.5, 0.1 };
+  double m = (double)height_mm / 1000.0;
+
+  if(feature > 3){
+    feature = 0;
+  }
+  if(unit == MeasurementUnits_Imperial){
+    return m / (0.3048 * imperial_in[feature]);
+  }
+  return m / si_m[feature];
+}
+
+/*
+ * The fixed point result shall be the exact rounding of the value, and be
+ * equal to the float result unless the value is a tie
+ * param is the resolution field, or the height for the BMI
+ */
+static void Check(const char *pName, uint32_t input, uint32_t param, uint8_t unit,
+                  uint16_t fixed, uint16_t flt, double exact)
+{
+  double half = exact - floor(exact) - 0.5;
+  uint16_t expected = (uint16_t)(uint32_t)floor(exact + 0.5);
+
+  if(fabs(half) < TIE_TOLERANCE(exact)){
+    /* both roundings are accepted at a tie */
+    if((fixed != flt) || (fixed != expected)){
+      Ties++;
+    }
+    return;
+  }
+
+  if((fixed != expected) || (fixed != flt)){
+    if(Failures < 20){
+      printf("%s(%u, %u, unit %u): fixed %u, float %u, exact %.6f\n",
+             pName, input, param, unit, fixed, flt, exact);
+    }
+    Failures++;
+  }
+}
+
+/* Public functions ----------------------------------------------------------*/
+int main(void)
+{
+  uint32_t weight_g;
+  uint32_t height_mm;
+  uint8_t feature;
+  uint8_t unit;
+
+  for(unit = MeasurementUnits_SI; unit <= MeasurementUnits_Imperial; unit++){
+    for(feature = 0; feature <= MEASCONV_WEIGHT_RES_MASK; feature++){
+      for(weight_g = 0; weight_g <= WEIGHT_G_MAX; weight_g++){
+        double exact = Exact_Weight(weight_g, feature, (Measurement_Unit_t)unit);
+
+        if(exact >= 65535.5){
+          break;
+        }
+        Check("Weight", weight_g, feature, unit,
+              MEASCONV_Weight(weight_g, feature, (Measurement_Unit_t)unit),
+              Float_Convert_Weight(feature, (Measurement_Unit_t)unit, (float)weight_g / 1000.0f),
+              exact);
+      }
+    }
+
+    for(feature = 0; feature <= MEASCONV_HEIGHT_RES_MASK; feature++){
+      for(height_mm = 0; height_mm <= HEIGHT_MM_MAX; height_mm++){
+        double exact = Exact_Height(height_mm, feature, (Measurement_Unit_t)unit);
+
+        if(exact >= 65535.5){
+          break;
+        }
+        Check("Height", height_mm, feature, unit,
+              MEASCONV_Height(height_mm, feature, (Measurement_Unit_t)unit),
+              Float_Convert_Height(feature, (Measurement_Unit_t)unit, (float)height_mm / 1000.0f),
+              exact);
+      }
+    }
+  }
+
+  for(height_mm = BMI_HEIGHT_MM_MIN; height_mm <= BMI_HEIGHT_MM_MAX; height_mm++){
+    for(weight_g = 0; weight_g <= BMI_WEIGHT_G_MAX; weight_g++){
+      uint32_t height2 = height_mm * height_mm;
+      double exact = (double)((weight_g * 10000) / height2) +
+                     (double)((weight_g * 10000) % height2) / (double)height2;
+
+      Check("BMI", weight_g, height_mm, MeasurementUnits_SI,
+            MEASCONV_BMI(weight_g, height_mm),
+            Float_Calculate_BMI((float)weight_g / 1000.0f, (float)height_mm / 1000.0f),
+            exact);
+    }
+  }
+
+  printf("meas_conv: %u mismatch(es), %u tie(s) rounded differently by the float path\n", Failures, Ties);
+
+  return (Failures == 0) ? 0 : 1;
+}
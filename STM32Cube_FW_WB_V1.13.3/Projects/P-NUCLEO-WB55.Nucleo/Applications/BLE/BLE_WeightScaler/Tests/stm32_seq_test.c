@@ -0,0 +1,411 @@
+/* USER CODE BEGIN Header */
+/**
+  ******************************************************************************
+  * @file    stm32_seq_test.c
+  * @author  MCD Application Team
+  * @brief   Host test of stm32_seq.c with more than 32 tasks: set, pause,
+  *          nested UTIL_SEQ_Run() and UTIL_SEQ_WaitEvt() across the words
+  *          of the task bit mappings
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2019-2022 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "stm32_seq.h"
+#include "utilities_conf.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef void (*Hook_t)(void);
+
+/* Private defines -----------------------------------------------------------*/
+#define TRACE_LEN                     (64)
+
+/**
+ * Calls of UTIL_SEQ_Idle() in a row after which a waited event is considered lost
+ */
+#define IDLE_MAX                      (1000)
+
+/**
+ * Marks written in the trace when a task resumes after a nested UTIL_SEQ_Run() or UTIL_SEQ_WaitEvt()
+ */
+#define MARK_NESTED_RUN               (100)
+#define MARK_RESUMED_0                (200)
+#define MARK_RESUMED_1                (201)
+
+#define COUNT_OF(array)               (sizeof(array) / sizeof((array)[0]))
+
+#define TASK(n)                       static void Task##n(void) { TaskEntry(n); }
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t aTrace[TRACE_LEN];
+static uint32_t TraceLen;
+static uint32_t IdleCount;
+static uint32_t Failures;
+static Hook_t aHook[UTIL_SEQ_CONF_TASK_NBR];
+
+/* Global variables ----------------------------------------------------------*/
+uint32_t SEQ_TEST_Time;
+
+/* Private functions ---------------------------------------------------------*/
+static void Trace(uint32_t Value)
+{
+  if(TraceLen < TRACE_LEN)
+  {
+    aTrace[TraceLen] = Value;
+  }
+  TraceLen++;
+
+  return;
+}
+
+/**
+ * A task runs its hook once, then only records it has run
+ */
+static void TaskEntry(uint32_t TaskId)
+{
+  Hook_t hook = aHook[TaskId];
+
+  Trace(TaskId);
+  aHook[TaskId] = 0;
+  if(hook != 0)
+  {
+    hook();
+  }
+
+  return;
+}
+
+TASK(0)  TASK(1)  TASK(2)  TASK(3)  TASK(4)  TASK(5)  TASK(6)  TASK(7)
+TASK(8)  TASK(9)  TASK(10) TASK(11) TASK(12) TASK(13) TASK(14) TASK(15)
+TASK(16) TASK(17) TASK(18) TASK(19) TASK(20) TASK(21) TASK(22) TASK(23)
+TASK(24) TASK(25) TASK(26) TASK(27) TASK(28) TASK(29) TASK(30) TASK(31)
+TASK(32) TASK(33) TASK(34) TASK(35) TASK(36) TASK(37) TASK(38) TASK(39)
+
+static void (* const aTask[UTIL_SEQ_CONF_TASK_NBR])(void) =
+{
+  Task0,  Task1,  Task2,  Task3,  Task4,  Task5,  Task6,  Task7,
+  Task8,  Task9,  Task10, Task11, Task12, Task13, Task14, Task15,
+  Task16, Task17, Task18, Task19, Task20, Task21, Task22, Task23,
+  Task24, Task25, Task26, Task27, Task28, Task29, Task30, Task31,
+  Task32, Task33, Task34, Task35, Task36, Task37, Task38, Task39,
+};
+
+static void Start(void)
+{
+  uint32_t task_id;
+
+  UTIL_SEQ_Init();
+  for(task_id = 0; task_id < UTIL_SEQ_CONF_TASK_NBR; task_id++)
+  {
+    UTIL_SEQ_RegTaskId(task_id, UTIL_SEQ_RFU, aTask[task_id]);
+    aHook[task_id] = 0;
+  }
+  TraceLen = 0;
+  IdleCount = 0;
+
+  return;
+}
+
+/**
+ * The tasks of a same priority are picked in round robin, their order is not checked
+ */
+static void SortTrace(uint32_t First, uint32_t Len)
+{
+  uint32_t i;
+  uint32_t j;
+  uint32_t value;
+
+  for(i = First + 1; (i < First + Len) && (i < TRACE_LEN); i++)
+  {
+    value = aTrace[i];
+    for(j = i; (j > First) && (aTrace[j - 1] > value); j--)
+    {
+      aTrace[j] = aTrace[j - 1];
+    }
+    aTrace[j] = value;
+  }
+
+  return;
+}
+
+static void Expect(const char *pName, const uint32_t *pExpected, uint32_t Len)
+{
+  uint32_t i;
+
+  if((TraceLen == Len) && (memcmp(aTrace, pExpected, Len * sizeof(uint32_t)) == 0))
+  {
+    return;
+  }
+
+  printf("%s: ran", pName);
+  for(i = 0; (i < TraceLen) && (i < TRACE_LEN); i++)
+  {
+    printf(" %u", aTrace[i]);
+  }
+  printf(", expected");
+  for(i = 0; i < Len; i++)
+  {
+    printf(" %u", pExpected[i]);
+  }
+  printf("\n");
+  Failures++;
+
+  return;
+}
+
+/* Set ---------------------------------------------------------------------- */
+static void TestSet(void)
+{
+  static const uint32_t expected[] = { 7, 39, 2, 33 };
+
+  Start();
+  UTIL_SEQ_SetTaskId(33, 1);
+  UTIL_SEQ_SetTaskId(2, 1);
+  UTIL_SEQ_SetTaskId(39, 0);
+  UTIL_SEQ_SetTaskId(7, 0);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  SortTrace(0, 2);
+  SortTrace(2, 2);
+  Expect("set", expected, COUNT_OF(expected));
+
+  return;
+}
+
+/* Pause -------------------------------------------------------------------- */
+static void TestPause(void)
+{
+  static const uint32_t expected_paused[] = { 5 };
+  static const uint32_t expected_resumed[] = { 5, 35 };
+
+  Start();
+  UTIL_SEQ_PauseTaskId(35);
+  UTIL_SEQ_SetTaskId(35, 0);
+  UTIL_SEQ_SetTaskId(5, 1);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  Expect("pause", expected_paused, COUNT_OF(expected_paused));
+
+  if((UTIL_SEQ_IsPauseTaskId(35) == 0) || (UTIL_SEQ_IsSchedulableTaskId(35) != 0))
+  {
+    printf("pause: task 35 not reported paused\n");
+    Failures++;
+  }
+
+  UTIL_SEQ_ResumeTaskId(35);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  Expect("resume", expected_resumed, COUNT_OF(expected_resumed));
+
+  return;
+}
+
+/* Nested UTIL_SEQ_Run() ---------------------------------------------------- */
+/**
+ * Only task 2 is allowed in the nested call, task 34 waits for the outer one
+ */
+static void NestedRunHook(void)
+{
+  UTIL_SEQ_SetTaskId(34, 0);
+  UTIL_SEQ_SetTaskId(2, 0);
+  UTIL_SEQ_Run(1U << 2);
+  Trace(MARK_NESTED_RUN);
+
+  return;
+}
+
+/**
+ * No task at all is allowed in the nested call
+ */
+static void NestedRunNoneHook(void)
+{
+  UTIL_SEQ_SetTaskId(36, 0);
+  UTIL_SEQ_SetTaskId(3, 0);
+  UTIL_SEQ_Run(0);
+  Trace(MARK_NESTED_RUN);
+
+  return;
+}
+
+static void TestNestedRun(void)
+{
+  static const uint32_t expected_mask[] = { 1, 2, MARK_NESTED_RUN, 34 };
+  static const uint32_t expected_none[] = { 38, MARK_NESTED_RUN, 3, 36 };
+
+  Start();
+  aHook[1] = NestedRunHook;
+  UTIL_SEQ_SetTaskId(1, 0);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  Expect("nested run", expected_mask, COUNT_OF(expected_mask));
+
+  Start();
+  aHook[38] = NestedRunNoneHook;
+  UTIL_SEQ_SetTaskId(38, 0);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  SortTrace(2, 2);
+  Expect("nested run none", expected_none, COUNT_OF(expected_none));
+
+  return;
+}
+
+/* UTIL_SEQ_WaitEvt() ------------------------------------------------------- */
+/**
+ * The waiting task is set again while it waits, it shall not run before the event
+ */
+static void WaitHighHook(void)
+{
+  UTIL_SEQ_SetTaskId(37, 0);
+  UTIL_SEQ_SetTaskId(36, 0);
+  UTIL_SEQ_WaitEvt(1U << 0);
+  Trace(MARK_RESUMED_0);
+
+  return;
+}
+
+static void SetEvt0Hook(void)
+{
+  UTIL_SEQ_SetEvt(1U << 0);
+
+  return;
+}
+
+/**
+ * A task from 0 to 31 waits, the tasks from 32 shall keep running meanwhile
+ */
+static void WaitLowHook(void)
+{
+  UTIL_SEQ_SetTaskId(39, 1);
+  UTIL_SEQ_SetTaskId(6, 0);
+  UTIL_SEQ_WaitEvt(1U << 1);
+  Trace(MARK_RESUMED_0);
+
+  return;
+}
+
+static void SetEvt1Hook(void)
+{
+  UTIL_SEQ_SetEvt(1U << 1);
+
+  return;
+}
+
+/**
+ * Task 3 waits for event 2, task 38 then waits for event 3 in the nested UTIL_SEQ_Run()
+ */
+static void WaitOuterHook(void)
+{
+  UTIL_SEQ_SetTaskId(38, 0);
+  UTIL_SEQ_WaitEvt(1U << 2);
+  Trace(MARK_RESUMED_1);
+
+  return;
+}
+
+static void WaitInnerHook(void)
+{
+  UTIL_SEQ_SetTaskId(4, 0);
+  UTIL_SEQ_WaitEvt(1U << 3);
+  Trace(MARK_RESUMED_0);
+  UTIL_SEQ_SetTaskId(5, 0);
+
+  return;
+}
+
+static void SetEvt2Hook(void)
+{
+  UTIL_SEQ_SetEvt(1U << 2);
+
+  return;
+}
+
+static void SetEvt3Hook(void)
+{
+  UTIL_SEQ_SetEvt(1U << 3);
+
+  return;
+}
+
+static void TestWaitEvt(void)
+{
+  static const uint32_t expected_high[] = { 36, 37, MARK_RESUMED_0, 36 };
+  static const uint32_t expected_low[] = { 6, 39, MARK_RESUMED_0, 6 };
+  static const uint32_t expected_nested[] = { 3, 38, 4, MARK_RESUMED_0, 5, MARK_RESUMED_1 };
+
+  Start();
+  aHook[36] = WaitHighHook;
+  aHook[37] = SetEvt0Hook;
+  UTIL_SEQ_SetTaskId(36, 0);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  Expect("wait from task 36", expected_high, COUNT_OF(expected_high));
+
+  Start();
+  aHook[6] = WaitLowHook;
+  aHook[39] = SetEvt1Hook;
+  UTIL_SEQ_SetTaskId(6, 0);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  Expect("wait from task 6", expected_low, COUNT_OF(expected_low));
+
+  Start();
+  aHook[3] = WaitOuterHook;
+  aHook[38] = WaitInnerHook;
+  aHook[4] = SetEvt3Hook;
+  aHook[5] = SetEvt2Hook;
+  UTIL_SEQ_SetTaskId(3, 0);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  Expect("nested wait", expected_nested, COUNT_OF(expected_nested));
+
+  return;
+}
+
+/* Deadline class ----------------------------------------------------------- */
+static void TestDeadline(void)
+{
+  static const uint32_t expected[] = { 1, 37, 0 };
+
+  Start();
+  SEQ_TEST_Time = 0xFFFFFFF0U;
+  UTIL_SEQ_SetTaskId(0, 0);
+  UTIL_SEQ_SetTaskIdDeadline(37, SEQ_TEST_Time + 30);
+  UTIL_SEQ_SetTaskIdDeadline(1, SEQ_TEST_Time + 20);
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
+  Expect("deadline", expected, COUNT_OF(expected));
+
+  return;
+}
+
+/* Public functions ----------------------------------------------------------*/
+/**
+ * Nothing else can set the waited event on the host, a wait that reaches the idle state would never end
+ */
+void UTIL_SEQ_Idle(void)
+{
+  if((UTIL_SEQ_IsEvtPend() == 0) && (++IdleCount > IDLE_MAX))
+  {
+    printf("waited event never set, trace length %u\n", TraceLen);
+    exit(1);
+  }
+
+  return;
+}
+
+int main(void)
+{
+  TestSet();
+  TestPause();
+  TestNestedRun();
+  TestWaitEvt();
+  TestDeadline();
+
+  printf("stm32_seq (%u tasks): %u failure(s)\n", UTIL_SEQ_CONF_TASK_NBR, Failures);
+
+  return (Failures == 0) ? 0 : 1;
+}
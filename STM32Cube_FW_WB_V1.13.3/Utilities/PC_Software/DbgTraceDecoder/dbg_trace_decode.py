@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+Decoder of the binary debug traces output when CFG_DEBUG_TRACE_BINARY is set.
+
+The trace UART carries the text traces unchanged and the binary records of
+DbgTraceBinary(): a tag byte (0xF8 ORed with the number of arguments), the
+address of the format string and the arguments, all on 32 bits in little
+endian. The format strings are read from the ELF file of the application.
+
+Usage:
+  dbg_trace_decode.py <application.elf> [<capture file>]
+
+The capture is read from the standard input when no file is given, e.g.
+  stty -F /dev/ttyACM0 115200 raw && dbg_trace_decode.py app.elf < /dev/ttyACM0
+
+Copyright (c) 2022 STMicroelectronics.
+All rights reserved.
+
+This software is licensed under terms that can be found in the LICENSE file
+in the root directory of this software component.
+If no LICENSE file comes with this software, it is provided AS-IS.
+"""
+
+import re
+import struct
+import sys
+
+TAG = 0xF8
+TAG_MASK = 0xF8
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+CONVERSION = re.compile(r'%([-+ 0#]*)(\d+)?(\.\d+)?(hh|h|ll|l|z|j|t)?([diouxXcsp%])')
+
+
+class Elf32Image:
+    """Loadable sections of a 32 bit little endian ELF file"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as elf:
+            data = elf.read()
+        if data[:4] != b'\x7fELF' or data[4] != 1 or data[5] != 1:
+            raise ValueError('%s is not a 32 bit little endian ELF file' % path)
+        shoff, = struct.unpack_from('<I', data, 0x20)
+        shentsize, shnum = struct.unpack_from('<HH', data, 0x2E)
+        self.data = data
+        self.sections = []
+        for index in range(shnum):
+            (_, sh_type, sh_flags, sh_addr, sh_offset, sh_size) = \
+                struct.unpack_from('<IIIIII', data, shoff + index * shentsize)
+            if (sh_flags & SHF_ALLOC) and sh_type != SHT_NOBITS and sh_size:
+                self.sections.append((sh_addr, sh_offset, sh_size))
+
+    def string(self, address):
+        """Return the NUL terminated string at an address of the target"""
+        for (sh_addr, sh_offset, sh_size) in self.sections:
+            if sh_addr <= address < sh_addr + sh_size:
+                start = sh_offset + address - sh_addr
+                end = self.data.find(b'\0', start, sh_offset + sh_size)
+                if end < 0:
+                    end = sh_offset + sh_size
+                return self.data[start:end].decode('latin-1')
+        return None
+
+
+def format_message(image, address, args):
+    """Apply the format string found at address to the arguments"""
+    fmt = image.string(address)
+    if fmt is None:
+        return '<unknown format 0x%08X %s>' % (address, ' '.join('0x%08X' % a for a in args))
+
+    remaining = list(args)
+
+    def convert(match):
+        flags, width, precision, _, conv = match.groups()
+        if conv == '%':
+            return '%'
+        value = remaining.pop(0) if remaining else 0
+        spec = '%' + flags + (width or '') + (precision or '')
+        if conv in 'di':
+            return (spec + 'd') % (value - (1 << 32) if value & 0x80000000 else value)
+        if conv == 'u':
+            return (spec + 'd') % value
+        if conv == 'c':
+            return (spec + 'c') % chr(value & 0xFF)
+        if conv == 's':
+            text = image.string(value)
+            return (spec + 's') % (text if text is not None else '<0x%08X>' % value)
+        if conv == 'p':
+            return '0x%08X' % value
+        return (spec + conv) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(image, stream, output):
+    """Decode the capture until the end of the stream"""
+    pending = b''
+    while True:
+        # read1() returns what is available, read() would wait for 256 bytes on a tty
+        chunk = stream.read1(256)
+        if not chunk:
+            break
+        pending += chunk
+        index = 0
+        while index < len(pending):
+            byte = pending[index]
+            if (byte & TAG_MASK) != TAG:
+                end = index
+                while end < len(pending) and (pending[end] & TAG_MASK) != TAG:
+                    end += 1
+                output.write(pending[index:end].decode('latin-1'))
+                index = end
+                continue
+            nb_args = byte & 0x07
+            size = 1 + 4 * (1 + nb_args)
+            if len(pending) - index < size:
+                break
+            words = struct.unpack_from('<%dI' % (1 + nb_args), pending, index + 1)
+            output.write(format_message(image, words[0], words[1:]))
+            index += size
+        pending = pending[index:]
+        output.flush()
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 1
+    image = Elf32Image(argv[1])
+    if len(argv) == 3:
+        with open(argv[2], 'rb') as capture:
+            decode(image, capture, sys.stdout)
+    else:
+        decode(image, sys.stdin.buffer, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
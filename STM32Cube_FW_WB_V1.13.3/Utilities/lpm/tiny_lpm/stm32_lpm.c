@@ -74,6 +74,70 @@
   #define UTIL_LPM_EXIT_CRITICAL_SECTION_ELP( )     UTIL_LPM_EXIT_CRITICAL_SECTION( )
 #endif
 
+/**
+ * @brief low power mode governor, disabled by default, can be enabled by redefining in utilities_conf.h
+ *        The mode allowed by the users is replaced by a lighter one when the time to the next expected
+ *        wakeup is too short to pay back its wakeup cost
+ */
+#ifndef UTIL_LPM_CONF_GOVERNOR
+  #define UTIL_LPM_CONF_GOVERNOR  (0)
+#endif
+
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+/**
+ * @brief time base of the governor, a free running 32 bit counter that keeps counting in all low power modes
+ */
+#ifndef UTIL_LPM_GOVERNOR_GET_TIME
+  #error "UTIL_LPM_GOVERNOR_GET_TIME shall be defined in utilities_conf.h"
+#endif
+
+/**
+ * @brief time left to the next expected wakeup, in the unit of UTIL_LPM_GOVERNOR_GET_TIME()
+ *        UTIL_LPM_IDLE_TIME_UNKNOWN is returned when no wakeup is expected
+ */
+#ifndef UTIL_LPM_GOVERNOR_GET_IDLE_TIME
+  #error "UTIL_LPM_GOVERNOR_GET_IDLE_TIME shall be defined in utilities_conf.h"
+#endif
+
+/**
+ * @brief consumption in each mode, in any unit as only the ratios are used
+ */
+#ifndef UTIL_LPM_GOVERNOR_POWER_RUN
+  #define UTIL_LPM_GOVERNOR_POWER_RUN     (1000UL)
+#endif
+#ifndef UTIL_LPM_GOVERNOR_POWER_SLEEP
+  #define UTIL_LPM_GOVERNOR_POWER_SLEEP   (300UL)
+#endif
+#ifndef UTIL_LPM_GOVERNOR_POWER_STOP
+  #define UTIL_LPM_GOVERNOR_POWER_STOP    (1UL)
+#endif
+#ifndef UTIL_LPM_GOVERNOR_POWER_OFF
+  #define UTIL_LPM_GOVERNOR_POWER_OFF     (0UL)
+#endif
+
+/**
+ * @brief wakeup cost of each mode before it is measured, in the unit of UTIL_LPM_GOVERNOR_GET_TIME()
+ *        It is the time spent running from the expected wakeup until the exit function of the mode returns
+ */
+#ifndef UTIL_LPM_GOVERNOR_COST_SLEEP
+  #define UTIL_LPM_GOVERNOR_COST_SLEEP    (0UL)
+#endif
+#ifndef UTIL_LPM_GOVERNOR_COST_STOP
+  #define UTIL_LPM_GOVERNOR_COST_STOP     (1UL)
+#endif
+#ifndef UTIL_LPM_GOVERNOR_COST_OFF
+  #define UTIL_LPM_GOVERNOR_COST_OFF      (10UL)
+#endif
+
+/**
+ * @brief longest wakeup cost that may be measured, a longer one is the wakeup by an unexpected event
+ *        after the expected wakeup has been cancelled
+ */
+#ifndef UTIL_LPM_GOVERNOR_COST_MAX
+  #define UTIL_LPM_GOVERNOR_COST_MAX      (64UL)
+#endif
+#endif /* UTIL_LPM_CONF_GOVERNOR */
+
 /**
  * @}
  */
@@ -90,6 +154,16 @@
  */
 #define UTIL_LPM_NO_BIT_SET   (0UL)
 
+/**
+ * @brief number of low power modes
+ */
+#define UTIL_LPM_MODE_NBR     (3U)
+
+/**
+ * @brief the wakeup costs are averaged over the last 2^UTIL_LPM_COST_SHIFT measures
+ */
+#define UTIL_LPM_COST_SHIFT   (3U)
+
 /**
  * @}
  */
@@ -109,11 +183,52 @@ static UTIL_LPM_bm_t StopModeDisable = UTIL_LPM_NO_BIT_SET;
  */
 static UTIL_LPM_bm_t OffModeDisable = UTIL_LPM_NO_BIT_SET;
 
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+/**
+ * @brief consumption in each mode, indexed by @ref UTIL_LPM_Mode_t
+ */
+static const uint32_t ModePower[UTIL_LPM_MODE_NBR] =
+{
+  UTIL_LPM_GOVERNOR_POWER_SLEEP,
+  UTIL_LPM_GOVERNOR_POWER_STOP,
+  UTIL_LPM_GOVERNOR_POWER_OFF,
+};
+
+/**
+ * @brief wakeup cost of each mode, scaled by 2^UTIL_LPM_COST_SHIFT
+ */
+static uint32_t ModeCost[UTIL_LPM_MODE_NBR] =
+{
+  UTIL_LPM_GOVERNOR_COST_SLEEP << UTIL_LPM_COST_SHIFT,
+  UTIL_LPM_GOVERNOR_COST_STOP << UTIL_LPM_COST_SHIFT,
+  UTIL_LPM_GOVERNOR_COST_OFF << UTIL_LPM_COST_SHIFT,
+};
+
+/**
+ * @brief residency in each mode
+ */
+static UTIL_LPM_Residency_t ModeResidency[UTIL_LPM_MODE_NBR];
+
+/**
+ * @brief time elapsed from the last reset of the residency to ResidencyLastTime
+ */
+static uint64_t ResidencyTime;
+
+/**
+ * @brief time of the last update of ResidencyTime
+ */
+static uint32_t ResidencyLastTime;
+#endif /* UTIL_LPM_CONF_GOVERNOR */
+
 /**
  * @}
  */
 /* Global variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+static UTIL_LPM_Mode_t LPM_GovernorSelect( UTIL_LPM_Mode_t mode_allowed, uint32_t idle_time );
+static void LPM_GovernorUpdate( UTIL_LPM_Mode_t mode, uint32_t idle_time, uint32_t time_start );
+#endif
 /* Functions Definition ------------------------------------------------------*/
 
 /** @addtogroup TINY_LPM_Exported_function
@@ -123,6 +238,12 @@ void UTIL_LPM_Init( void )
 {
   StopModeDisable = UTIL_LPM_NO_BIT_SET;
   OffModeDisable = UTIL_LPM_NO_BIT_SET;
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+  ModeCost[UTIL_LPM_SLEEPMODE] = UTIL_LPM_GOVERNOR_COST_SLEEP << UTIL_LPM_COST_SHIFT;
+  ModeCost[UTIL_LPM_STOPMODE] = UTIL_LPM_GOVERNOR_COST_STOP << UTIL_LPM_COST_SHIFT;
+  ModeCost[UTIL_LPM_OFFMODE] = UTIL_LPM_GOVERNOR_COST_OFF << UTIL_LPM_COST_SHIFT;
+  UTIL_LPM_ResidencyReset( );
+#endif
   UTIL_LPM_INIT_CRITICAL_SECTION( );
 }
 
@@ -215,6 +336,12 @@ UTIL_LPM_Mode_t UTIL_LPM_GetMode( void )
 
 void UTIL_LPM_EnterLowPower( void )
 {
+  UTIL_LPM_Mode_t mode_selected;
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+  uint32_t idle_time;
+  uint32_t time_start;
+#endif
+
   UTIL_LPM_ENTER_CRITICAL_SECTION_ELP( );
 
   if( StopModeDisable != UTIL_LPM_NO_BIT_SET )
@@ -223,8 +350,7 @@ void UTIL_LPM_EnterLowPower( void )
      * At least one user disallows Stop Mode
      * SLEEP mode is required
      */
-      UTIL_PowerDriver.EnterSleepMode( );
-      UTIL_PowerDriver.ExitSleepMode( );
+    mode_selected = UTIL_LPM_SLEEPMODE;
   }
   else
   { 
@@ -234,25 +360,202 @@ void UTIL_LPM_EnterLowPower( void )
        * At least one user disallows Off Mode
        * STOP mode is required
        */
-        UTIL_PowerDriver.EnterStopMode( );
-        UTIL_PowerDriver.ExitStopMode( );
+      mode_selected = UTIL_LPM_STOPMODE;
     }
     else
     {
       /**
        * OFF mode is required
        */
+      mode_selected = UTIL_LPM_OFFMODE;
+    }
+  }
+
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+  idle_time = UTIL_LPM_GOVERNOR_GET_IDLE_TIME( );
+  time_start = UTIL_LPM_GOVERNOR_GET_TIME( );
+  mode_selected = LPM_GovernorSelect( mode_selected, idle_time );
+#endif
+
+  switch( mode_selected )
+  {
+  case UTIL_LPM_SLEEPMODE:
+    {
+      UTIL_PowerDriver.EnterSleepMode( );
+      UTIL_PowerDriver.ExitSleepMode( );
+      break;
+    }
+  case UTIL_LPM_STOPMODE:
+    {
+      UTIL_PowerDriver.EnterStopMode( );
+      UTIL_PowerDriver.ExitStopMode( );
+      break;
+    }
+  default :
+    {
       UTIL_PowerDriver.EnterOffMode( );
       UTIL_PowerDriver.ExitOffMode( );
+      break;
     }
   }
-  
+
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+  LPM_GovernorUpdate( mode_selected, idle_time, time_start );
+#endif
+
   UTIL_LPM_EXIT_CRITICAL_SECTION_ELP( );
 }
 
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+void UTIL_LPM_ResidencyGet( UTIL_LPM_Mode_t mode, UTIL_LPM_Residency_t *pResidency )
+{
+  if( (uint32_t)mode < UTIL_LPM_MODE_NBR )
+  {
+    UTIL_LPM_ENTER_CRITICAL_SECTION( );
+
+    *pResidency = ModeResidency[mode];
+    pResidency->WakeupCost = ModeCost[mode] >> UTIL_LPM_COST_SHIFT;
+
+    UTIL_LPM_EXIT_CRITICAL_SECTION( );
+  }
+}
+
+void UTIL_LPM_ResidencyGetRun( UTIL_LPM_Residency_t *pResidency )
+{
+  uint64_t time_low_power = 0;
+  uint32_t entry_count = 0;
+  uint32_t mode;
+
+  UTIL_LPM_ENTER_CRITICAL_SECTION( );
+
+  for( mode = 0; mode < UTIL_LPM_MODE_NBR; mode++ )
+  {
+    entry_count += ModeResidency[mode].EntryCount;
+    time_low_power += ModeResidency[mode].TimeTotal;
+  }
+
+  /**
+   * Each exit from a low power mode starts a period in Run mode
+   */
+  pResidency->EntryCount = entry_count;
+  pResidency->DemoteCount = 0;
+  pResidency->TimeTotal = ( ResidencyTime + (uint32_t)( UTIL_LPM_GOVERNOR_GET_TIME( ) - ResidencyLastTime ) ) - time_low_power;
+  pResidency->Energy = pResidency->TimeTotal * UTIL_LPM_GOVERNOR_POWER_RUN;
+  pResidency->WakeupCost = 0;
+
+  UTIL_LPM_EXIT_CRITICAL_SECTION( );
+}
+
+void UTIL_LPM_ResidencyReset( void )
+{
+  uint32_t mode;
+
+  UTIL_LPM_ENTER_CRITICAL_SECTION( );
+
+  for( mode = 0; mode < UTIL_LPM_MODE_NBR; mode++ )
+  {
+    ModeResidency[mode].EntryCount = 0;
+    ModeResidency[mode].DemoteCount = 0;
+    ModeResidency[mode].TimeTotal = 0;
+    ModeResidency[mode].Energy = 0;
+    ModeResidency[mode].WakeupCost = 0;
+  }
+  ResidencyTime = 0;
+  ResidencyLastTime = UTIL_LPM_GOVERNOR_GET_TIME( );
+
+  UTIL_LPM_EXIT_CRITICAL_SECTION( );
+}
+#endif /* UTIL_LPM_CONF_GOVERNOR */
+
+/**
+ * @}
+ */
+
+#if (UTIL_LPM_CONF_GOVERNOR != 0)
+/** @defgroup TINY_LPM_Private_function TINY LPM private functions
+  * @{
+  */
+
+/**
+ * @brief  Select the mode with the lowest expected energy up to the next wakeup
+ * @note   The energy of a mode is its consumption over the idle time plus the extra consumption of the
+ *         CPU running during its wakeup cost
+ * @param  mode_allowed: deepest mode allowed by the users
+ * @param  idle_time: time to the next expected wakeup
+ * @retval the mode to enter
+ */
+static UTIL_LPM_Mode_t LPM_GovernorSelect( UTIL_LPM_Mode_t mode_allowed, uint32_t idle_time )
+{
+  UTIL_LPM_Mode_t mode_selected = mode_allowed;
+  uint64_t energy_selected = UINT64_MAX;
+  uint64_t energy;
+  uint32_t mode;
+
+  if( idle_time == UTIL_LPM_IDLE_TIME_UNKNOWN )
+  {
+    return mode_allowed;
+  }
+
+  for( mode = 0; mode <= (uint32_t)mode_allowed; mode++ )
+  {
+    energy = ((uint64_t)ModePower[mode] * idle_time) +
+             (((uint64_t)(UTIL_LPM_GOVERNOR_POWER_RUN - ModePower[mode]) * ModeCost[mode]) >> UTIL_LPM_COST_SHIFT);
+
+    /**
+     * On equal energy, the deepest mode is kept as the next wakeup may come later than expected
+     */
+    if( energy <= energy_selected )
+    {
+      energy_selected = energy;
+      mode_selected = (UTIL_LPM_Mode_t)mode;
+    }
+  }
+
+  if( mode_selected != mode_allowed )
+  {
+    ModeResidency[mode_allowed].DemoteCount++;
+  }
+
+  return mode_selected;
+}
+
+/**
+ * @brief  Update the residency and the wakeup cost of the mode that has been left
+ * @note   The wakeup cost is only measured when the wakeup happens after the expected one and within
+ *         UTIL_LPM_GOVERNOR_COST_MAX, otherwise the system has been woken up by an unexpected event
+ * @param  mode: mode that has been left
+ * @param  idle_time: time to the next expected wakeup when the mode was entered
+ * @param  time_start: time of the mode entry
+ * @retval None
+ */
+static void LPM_GovernorUpdate( UTIL_LPM_Mode_t mode, uint32_t idle_time, uint32_t time_start )
+{
+  uint32_t time_now = UTIL_LPM_GOVERNOR_GET_TIME( );
+  uint32_t time_elapsed = time_now - time_start;
+
+  ResidencyTime += (uint32_t)( time_now - ResidencyLastTime );
+  ResidencyLastTime = time_now;
+
+  ModeResidency[mode].EntryCount++;
+  ModeResidency[mode].TimeTotal += time_elapsed;
+
+  /**
+   * The CPU is considered running during the wakeup cost
+   */
+  ModeResidency[mode].Energy += ((uint64_t)ModePower[mode] * time_elapsed) +
+                                (((uint64_t)(UTIL_LPM_GOVERNOR_POWER_RUN - ModePower[mode]) * ModeCost[mode]) >> UTIL_LPM_COST_SHIFT);
+
+  if( (idle_time != UTIL_LPM_IDLE_TIME_UNKNOWN) && (time_elapsed >= idle_time) &&
+      ((time_elapsed - idle_time) <= UTIL_LPM_GOVERNOR_COST_MAX) )
+  {
+    ModeCost[mode] += (time_elapsed - idle_time) - (ModeCost[mode] >> UTIL_LPM_COST_SHIFT);
+  }
+}
+
 /**
  * @}
  */
+#endif /* UTIL_LPM_CONF_GOVERNOR */
 
 /**
  * @}
@@ -62,6 +62,20 @@ typedef enum
   UTIL_LPM_OFFMODE,
 } UTIL_LPM_Mode_t;
 
+/**
+ * @brief residency in a low power mode, recorded when UTIL_LPM_CONF_GOVERNOR is enabled.
+ *        The times are given in the unit of UTIL_LPM_GOVERNOR_GET_TIME()
+ */
+typedef struct
+{
+  uint32_t EntryCount;     /*!< number of entries in the mode                                          */
+  uint32_t DemoteCount;    /*!< number of times the mode was allowed but a lighter one has been entered */
+  uint64_t TimeTotal;      /*!< cumulated time from the mode entry to the exit function return         */
+  uint64_t Energy;         /*!< estimated consumption, in the unit of UTIL_LPM_GOVERNOR_POWER_x times
+                                the unit of the time                                                    */
+  uint32_t WakeupCost;     /*!< current estimate of the wakeup cost of the mode                         */
+} UTIL_LPM_Residency_t;
+
 /**
  * @}
  */
@@ -106,6 +120,20 @@ extern const struct UTIL_LPM_Driver_s UTIL_PowerDriver;
  */
 
 /* Exported macros -----------------------------------------------------------*/
+
+/** @defgroup TINY_LPM_Exported_macro TINY LPM exported macro
+  * @{
+  */
+
+/**
+ * @brief value returned by UTIL_LPM_GOVERNOR_GET_IDLE_TIME() when no wakeup is expected
+ */
+#define UTIL_LPM_IDLE_TIME_UNKNOWN  (0xFFFFFFFFUL)
+
+/**
+ * @}
+ */
+
 /* Exported functions ------------------------------------------------------- */
 
 /** @defgroup TINY_LPM_Exported_function TINY LPM exported functions
@@ -152,6 +180,27 @@ void UTIL_LPM_SetOffMode( UTIL_LPM_bm_t lpm_id_bm, UTIL_LPM_State_t state );
  */
 void UTIL_LPM_EnterLowPower( void );
 
+/**
+ * @brief  This API returns the residency in a low power mode since the last reset of the statistics
+ * @param  mode: the low power mode
+ * @param  pResidency: residency in the mode
+ * @note   Available when UTIL_LPM_CONF_GOVERNOR is enabled.
+ */
+void UTIL_LPM_ResidencyGet( UTIL_LPM_Mode_t mode, UTIL_LPM_Residency_t *pResidency );
+
+/**
+ * @brief  This API returns the residency in Run mode since the last reset of the statistics
+ * @param  pResidency: residency in Run mode, EntryCount is the number of wakeups
+ * @note   Available when UTIL_LPM_CONF_GOVERNOR is enabled.
+ */
+void UTIL_LPM_ResidencyGetRun( UTIL_LPM_Residency_t *pResidency );
+
+/**
+ * @brief  This API clears the residency of all low power modes, the wakeup costs are kept
+ * @note   Available when UTIL_LPM_CONF_GOVERNOR is enabled.
+ */
+void UTIL_LPM_ResidencyReset( void );
+
 /**
  *@}
  */
@@ -26,24 +26,6 @@
   * @{
   */
 
-/* Private typedef -----------------------------------------------------------*/
-/** @defgroup SEQUENCER_Private_type SEQUENCER private type
- *  @{
- */
-
-/**
- * @brief structure used to manage task scheduling
- */
-typedef struct
-{
-  uint32_t priority;    /*!<bit field of the enabled task.          */
-  uint32_t round_robin; /*!<mask on the allowed task to be running. */
-} UTIL_SEQ_Priority_t;
-
-/**
- * @}
- */
-
 /* Private defines -----------------------------------------------------------*/
 
 /** @defgroup SEQUENCER_Private_define SEQUENCER private defines
@@ -86,23 +68,33 @@ typedef struct
 #define UTIL_SEQ_ALL_BIT_SET    (~0U)
 
 /**
- * @brief default number of task is default 32 (maximum), can be reduced by redefining in utilities_conf.h
+ * @brief default number of task is default 32, can be changed by redefining in utilities_conf.h
+ *        Above 32, the tasks from 32 are handled with the UTIL_SEQ_xxxTaskId() API
  */
-#ifndef UTIL_SEQ_CONF_TASK_NBR 
+#ifndef UTIL_SEQ_CONF_TASK_NBR
 	#define UTIL_SEQ_CONF_TASK_NBR  (32)
-#endif 
+#endif
 
-#if UTIL_SEQ_CONF_TASK_NBR > 32
-#error "UTIL_SEQ_CONF_PRIO_NBR must be less of equal then 32"
+#if UTIL_SEQ_CONF_TASK_NBR > 1024
+#error "UTIL_SEQ_CONF_TASK_NBR must be less or equal than 1024"
 #endif
-  
+
+/**
+ * @brief number of 32 bit words of the task bit mappings, the word 0 holds the tasks 0 to 31
+ */
+#define UTIL_SEQ_TASK_WORD_NBR  ((UTIL_SEQ_CONF_TASK_NBR + 31U) / 32U)
+
 /**
  * @brief default value of priority number.
  */
-#ifndef UTIL_SEQ_CONF_PRIO_NBR 
+#ifndef UTIL_SEQ_CONF_PRIO_NBR
   #define UTIL_SEQ_CONF_PRIO_NBR  (2)
 #endif
 
+#if UTIL_SEQ_CONF_PRIO_NBR > 32
+#error "UTIL_SEQ_CONF_PRIO_NBR must be less or equal than 32"
+#endif
+
 /**
  * @brief default memset function.
  */
@@ -110,6 +102,96 @@ typedef struct
 #define UTIL_SEQ_MEMSET8( dest, value, size )   UTILS_MEMSET8( dest, value, size )
 #endif
 
+/**
+ * @brief word and bit of a task index inside the task bit mappings
+ */
+#define SEQ_TASK_WORD( idx )    ((idx) >> 5U)
+#define SEQ_TASK_BIT( idx )     (1U << ((idx) & 31U))
+
+/**
+ * @brief tasks of a word neither paused nor masked by UTIL_SEQ_Run()
+ */
+#define SEQ_TASK_ALLOWED( word ) (~(TaskPaused[(word)] | SuperMasked[(word)]))
+
+/**
+ * @brief per task statistics, disabled by default, can be enabled by redefining in utilities_conf.h
+ */
+#ifndef UTIL_SEQ_CONF_PROFILE
+  #define UTIL_SEQ_CONF_PROFILE  (0)
+#endif
+
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+/**
+ * @brief time base of the statistics, a free running 32 bit counter such as the DWT cycle counter
+ *        On a Linux host build, the monotonic clock is used in nanoseconds when not redefined
+ */
+#ifndef UTIL_SEQ_PROFILE_GET_TIME
+  #if defined(__linux__)
+    #include <time.h>
+    #define SEQ_PROFILE_HOST_TIME
+    #define UTIL_SEQ_PROFILE_GET_TIME( )   SEQ_ProfileHostTime( )
+  #else
+    #error "UTIL_SEQ_PROFILE_GET_TIME shall be defined in utilities_conf.h"
+  #endif
+#endif
+
+/**
+ * @brief start of the time base, called by UTIL_SEQ_Init()
+ */
+#ifndef UTIL_SEQ_PROFILE_INIT
+  #define UTIL_SEQ_PROFILE_INIT( )
+#endif
+
+/**
+ * @brief output of UTIL_SEQ_ProfileDump()
+ */
+#ifndef UTIL_SEQ_PROFILE_PRINTF
+  #include <stdio.h>
+  #define UTIL_SEQ_PROFILE_PRINTF( ... )  (void)printf( __VA_ARGS__ )
+#endif /* UTIL_SEQ_PROFILE_PRINTF */
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
+/**
+ * @brief deadline scheduling class, disabled by default, can be enabled by redefining in utilities_conf.h
+ *        The tasks set with a deadline are executed before the tasks set with a priority, earliest deadline first
+ */
+#ifndef UTIL_SEQ_CONF_EDF
+  #define UTIL_SEQ_CONF_EDF  (0)
+#endif
+
+#if (UTIL_SEQ_CONF_EDF != 0)
+/**
+ * @brief time base of the deadlines, a free running 32 bit counter such as a millisecond tick
+ */
+#ifndef UTIL_SEQ_EDF_GET_TIME
+  #error "UTIL_SEQ_EDF_GET_TIME shall be defined in utilities_conf.h"
+#endif
+
+/**
+ * @brief comparison of two times of the free running counter, valid when they are less than 2^31 apart
+ */
+#define SEQ_TIME_BEFORE( a, b )  ((int32_t)((a) - (b)) < 0)
+#endif /* UTIL_SEQ_CONF_EDF */
+
+/**
+ * @}
+ */
+
+/* Private typedef -----------------------------------------------------------*/
+/** @defgroup SEQUENCER_Private_type SEQUENCER private type
+ *  @{
+ */
+
+/**
+ * @brief structure used to manage task scheduling
+ */
+typedef struct
+{
+  uint32_t priority[UTIL_SEQ_TASK_WORD_NBR];    /*!<bit field of the enabled task.          */
+  uint32_t round_robin[UTIL_SEQ_TASK_WORD_NBR]; /*!<mask on the allowed task to be running. */
+  uint32_t word_set;                            /*!<bit field of the priority words not empty. */
+} UTIL_SEQ_Priority_t;
+
 /**
  * @}
  */
@@ -123,17 +205,17 @@ typedef struct
 /**
  * @brief task set.
  */
-static volatile UTIL_SEQ_bm_t TaskSet;
+static volatile UTIL_SEQ_bm_t TaskSet[UTIL_SEQ_TASK_WORD_NBR];
 
 /**
- * @brief task mask.
+ * @brief task paused, the inverse of the task mask so that all tasks are allowed without UTIL_SEQ_Init().
  */
-static volatile UTIL_SEQ_bm_t TaskMask = UTIL_SEQ_ALL_BIT_SET;
+static volatile UTIL_SEQ_bm_t TaskPaused[UTIL_SEQ_TASK_WORD_NBR];
 
 /**
- * @brief super mask.
+ * @brief task out of the super mask, the inverse of the super mask so that all tasks are allowed without UTIL_SEQ_Init().
  */
-static UTIL_SEQ_bm_t SuperMask = UTIL_SEQ_ALL_BIT_SET;
+static UTIL_SEQ_bm_t SuperMasked[UTIL_SEQ_TASK_WORD_NBR];
 
 /**
  * @brief evt set mask.
@@ -160,6 +242,46 @@ static void (*TaskCb[UTIL_SEQ_CONF_TASK_NBR])( void );
  */
 static UTIL_SEQ_Priority_t TaskPrio[UTIL_SEQ_CONF_PRIO_NBR];
 
+/**
+ * @brief bit field of the priorities having a task set.
+ */
+static volatile uint32_t PrioSet = UTIL_SEQ_NO_BIT_SET;
+
+/**
+ * @brief priority a set task is pending on.
+ *        A task set again with a higher priority is moved to that priority, it is executed once.
+ */
+static uint8_t TaskPrioIdx[UTIL_SEQ_CONF_TASK_NBR];
+
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+/**
+ * @brief statistics of each task.
+ */
+static UTIL_SEQ_Profile_t TaskProfile[UTIL_SEQ_CONF_TASK_NBR];
+
+/**
+ * @brief time a pending task has been set.
+ */
+static uint32_t TaskSetTime[UTIL_SEQ_CONF_TASK_NBR];
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
+#if (UTIL_SEQ_CONF_EDF != 0)
+/**
+ * @brief tasks pending in the deadline class.
+ */
+static UTIL_SEQ_bm_t TaskEdf[UTIL_SEQ_TASK_WORD_NBR];
+
+/**
+ * @brief deadline of a task pending in the deadline class.
+ */
+static uint32_t TaskDeadline[UTIL_SEQ_CONF_TASK_NBR];
+
+/**
+ * @brief number of deadline tasks that have returned after their deadline.
+ */
+static volatile uint32_t DeadlineMissCount = 0U;
+#endif /* UTIL_SEQ_CONF_EDF */
+
 /**
  * @}
  */
@@ -169,6 +291,21 @@ static UTIL_SEQ_Priority_t TaskPrio[UTIL_SEQ_CONF_PRIO_NBR];
  *  @{
  */
 uint8_t SEQ_BitPosition(uint32_t Value);
+static void SEQ_SetTaskIdx( uint32_t TaskIdx, uint32_t Task_Prio );
+static void SEQ_ClrTaskIdx( uint32_t TaskIdx );
+static void SEQ_ClrTaskPrio( uint32_t TaskIdx );
+static uint32_t SEQ_SelectTask( void );
+#if (UTIL_SEQ_CONF_EDF != 0)
+static void SEQ_SetTaskIdxDeadline( uint32_t TaskIdx, uint32_t Deadline );
+static uint32_t SEQ_SelectTaskDeadline( void );
+#endif /* UTIL_SEQ_CONF_EDF */
+static uint32_t SEQ_IsTaskSchedulable( void );
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+static void SEQ_ProfileRecord( uint32_t TaskIdx, uint32_t SetTime, uint32_t StartTime, uint32_t EndTime );
+#if defined(SEQ_PROFILE_HOST_TIME)
+static uint32_t SEQ_ProfileHostTime( void );
+#endif /* SEQ_PROFILE_HOST_TIME */
+#endif /* UTIL_SEQ_CONF_PROFILE */
 
 /**
  * @}
@@ -181,14 +318,24 @@ uint8_t SEQ_BitPosition(uint32_t Value);
  */
 void UTIL_SEQ_Init( void )
 {
-  TaskSet = UTIL_SEQ_NO_BIT_SET;
-  TaskMask = UTIL_SEQ_ALL_BIT_SET;
-  SuperMask = UTIL_SEQ_ALL_BIT_SET;
+  (void)UTIL_SEQ_MEMSET8((void *)TaskSet, 0, sizeof(TaskSet));
+  (void)UTIL_SEQ_MEMSET8((void *)TaskPaused, 0, sizeof(TaskPaused));
+  (void)UTIL_SEQ_MEMSET8(SuperMasked, 0, sizeof(SuperMasked));
   EvtSet = UTIL_SEQ_NO_BIT_SET;
   EvtWaited = UTIL_SEQ_NO_BIT_SET;
   CurrentTaskIdx = 0U;
+  PrioSet = UTIL_SEQ_NO_BIT_SET;
   (void)UTIL_SEQ_MEMSET8(TaskCb, 0, sizeof(TaskCb));
   (void)UTIL_SEQ_MEMSET8(TaskPrio, 0, sizeof(TaskPrio));
+  (void)UTIL_SEQ_MEMSET8(TaskPrioIdx, 0, sizeof(TaskPrioIdx));
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+  (void)UTIL_SEQ_MEMSET8(TaskProfile, 0, sizeof(TaskProfile));
+  UTIL_SEQ_PROFILE_INIT( );
+#endif /* UTIL_SEQ_CONF_PROFILE */
+#if (UTIL_SEQ_CONF_EDF != 0)
+  (void)UTIL_SEQ_MEMSET8(TaskEdf, 0, sizeof(TaskEdf));
+  DeadlineMissCount = 0U;
+#endif /* UTIL_SEQ_CONF_EDF */
   UTIL_SEQ_INIT_CRITICAL_SECTION( );
 }
 
@@ -203,107 +350,122 @@ void UTIL_SEQ_DeInit( void )
  */
 void UTIL_SEQ_Run( UTIL_SEQ_bm_t Mask_bm )
 {
-  uint32_t counter;
-  UTIL_SEQ_bm_t current_task_set;
-  UTIL_SEQ_bm_t super_mask_backup;
-  UTIL_SEQ_bm_t local_taskset;
+  UTIL_SEQ_bm_t super_mask_backup[UTIL_SEQ_TASK_WORD_NBR];
+  uint32_t task_idx;
+  uint32_t word;
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+  uint32_t set_time;
+  uint32_t start_time;
+#endif /* UTIL_SEQ_CONF_PROFILE */
+#if (UTIL_SEQ_CONF_EDF != 0)
+  UTIL_SEQ_bm_t deadline_set;
+  uint32_t deadline;
+#endif /* UTIL_SEQ_CONF_EDF */
 
   /**
    *  When this function is nested, the mask to be applied cannot be larger than the first call
    *  The mask is always getting smaller and smaller
    *  A copy is made of the mask set by UTIL_SEQ_Run() in case it is called again in the task
+   *  Mask_bm applies to the tasks 0 to 31, the tasks from 32 are masked as well unless it is UTIL_SEQ_DEFAULT
    */
-  super_mask_backup = SuperMask;
-  SuperMask &= Mask_bm;
+  for (word = 0U; word < UTIL_SEQ_TASK_WORD_NBR; word++)
+  {
+    super_mask_backup[word] = SuperMasked[word];
+    if ((word != 0U) && (Mask_bm != UTIL_SEQ_DEFAULT))
+    {
+      SuperMasked[word] = UTIL_SEQ_ALL_BIT_SET;
+    }
+  }
+  SuperMasked[0] |= ~Mask_bm;
 
   /**
    * There are two independent mask to check:
-   * TaskMask that comes from UTIL_SEQ_PauseTask() / UTIL_SEQ_ResumeTask
-   * SuperMask that comes from UTIL_SEQ_Run
+   * TaskPaused that comes from UTIL_SEQ_PauseTask() / UTIL_SEQ_ResumeTask
+   * SuperMasked that comes from UTIL_SEQ_Run
    * If the waited event is there, exit from  UTIL_SEQ_Run() to return to the
    * waiting task
    */
-  local_taskset = TaskSet;
-  while(((local_taskset & TaskMask & SuperMask) != 0U) && ((EvtSet & EvtWaited)==0U))
+  while((EvtSet & EvtWaited) == 0U)
   {
-    counter = 0U;
-    /**
-     * When a flag is set, the associated bit is set in TaskPrio[counter].priority mask depending
-     * on the priority parameter given from UTIL_SEQ_SetTask()
-     * The while loop is looking for a flag set from the highest priority maskr to the lower
-     */
-    while((TaskPrio[counter].priority & TaskMask & SuperMask)== 0U)
+    /** Read the flag index of the task to be executed
+	 *  Once the index is read, the associated task will be executed even though a higher priority stack is requested
+	 *  before task execution.
+	 */
+    task_idx = SEQ_SelectTask( );
+    if (task_idx == UTIL_SEQ_NOTASKRUNNING)
     {
-      counter++;
+      break;
     }
+    CurrentTaskIdx = task_idx;
 
-    current_task_set = TaskPrio[counter].priority & TaskMask & SuperMask;
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+    /** the set time is only written when the task is not pending, it can be read before the task is removed */
+    set_time = TaskSetTime[task_idx];
+#endif /* UTIL_SEQ_CONF_PROFILE */
 
-    /**
-     * The round_robin register is a mask of allowed flags to be evaluated.
-     * The concept is to make sure that on each round on UTIL_SEQ_Run(), if two same flags are always set,
-     * the sequencer does not run always only the first one.
-     * When a task has been executed, The flag is removed from the round_robin mask.
-     * If on the next UTIL_SEQ_RUN(), the two same flags are set again, the round_robin mask will mask out the first flag
-     * so that the second one can be executed.
-     * Note that the first flag is not removed from the list of pending task but just masked by the round_robin mask
-     *
-     * In the check below, the round_robin mask is reitialize in case all pending tasks haven been executed at least once
-     */
-    if ((TaskPrio[counter].round_robin & current_task_set) == 0U)
-    {
-      TaskPrio[counter].round_robin = UTIL_SEQ_ALL_BIT_SET;
-    }
+#if (UTIL_SEQ_CONF_EDF != 0)
+    /** the deadline is read before the task is removed from the deadline class */
+    deadline_set = TaskEdf[SEQ_TASK_WORD(task_idx)] & SEQ_TASK_BIT(task_idx);
+    deadline = TaskDeadline[task_idx];
+#endif /* UTIL_SEQ_CONF_EDF */
 
-    /** Read the flag index of the task to be executed
-	 *  Once the index is read, the associated task will be executed even though a higher priority stack is requested
-	 *  before task execution.
-	 */
-    CurrentTaskIdx = (SEQ_BitPosition(current_task_set & TaskPrio[counter].round_robin));
+    /** remove from the list or pending task and from its priority mask the one that has been selected to be executed */
+    SEQ_ClrTaskIdx(CurrentTaskIdx);
 
-    /** remove from the roun_robin mask the task that has been selected to be executed */
-    TaskPrio[counter].round_robin &= ~(1U << CurrentTaskIdx);
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+    start_time = UTIL_SEQ_PROFILE_GET_TIME( );
+#endif /* UTIL_SEQ_CONF_PROFILE */
 
-    UTIL_SEQ_ENTER_CRITICAL_SECTION( );
-    /** remove from the list or pending task the one that has been selected to be executed */
-    TaskSet &= ~(1U << CurrentTaskIdx);
-    /** remove from all priority mask the task that has been selected to be executed */
-    for (counter = UTIL_SEQ_CONF_PRIO_NBR; counter != 0U; counter--)
-    {
-      TaskPrio[counter - 1U].priority &= ~(1U << CurrentTaskIdx);
-    }
-    UTIL_SEQ_EXIT_CRITICAL_SECTION( );
     /** Execute the task */
     TaskCb[CurrentTaskIdx]( );
-    
-    local_taskset = TaskSet;
+
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+    /** CurrentTaskIdx may have been changed by a nested call of UTIL_SEQ_Run() */
+    SEQ_ProfileRecord(task_idx, set_time, start_time, UTIL_SEQ_PROFILE_GET_TIME( ));
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
+#if (UTIL_SEQ_CONF_EDF != 0)
+    if ((deadline_set != 0U) && SEQ_TIME_BEFORE(deadline, UTIL_SEQ_EDF_GET_TIME( )))
+    {
+      DeadlineMissCount++;
+    }
+#endif /* UTIL_SEQ_CONF_EDF */
   }
 
   /* the set of CurrentTaskIdx to no task running allows to call WaitEvt in the Pre/Post ilde context */
   CurrentTaskIdx = UTIL_SEQ_NOTASKRUNNING;
   UTIL_SEQ_PreIdle( );
-  
+
   UTIL_SEQ_ENTER_CRITICAL_SECTION_IDLE( );
-  local_taskset = TaskSet;
-  if (!(((local_taskset & TaskMask & SuperMask) != 0U) || ((EvtSet & EvtWaited)!= 0U))) 
+  if (!((SEQ_IsTaskSchedulable( ) != 0U) || ((EvtSet & EvtWaited)!= 0U)))
   {
 	UTIL_SEQ_Idle( );
   }
   UTIL_SEQ_EXIT_CRITICAL_SECTION_IDLE( );
-  
+
   UTIL_SEQ_PostIdle( );
 
   /** restore the mask from UTIL_SEQ_Run() */
-  SuperMask = super_mask_backup;
+  for (word = 0U; word < UTIL_SEQ_TASK_WORD_NBR; word++)
+  {
+    SuperMasked[word] = super_mask_backup[word];
+  }
 
   return;
 }
 
 void UTIL_SEQ_RegTask(UTIL_SEQ_bm_t TaskId_bm, uint32_t Flags, void (*Task)( void ))
+{
+  UTIL_SEQ_RegTaskId(SEQ_BitPosition(TaskId_bm), Flags, Task);
+
+  return;
+}
+
+void UTIL_SEQ_RegTaskId(uint32_t TaskId, uint32_t Flags, void (*Task)( void ))
 {
   UTIL_SEQ_ENTER_CRITICAL_SECTION();
 
-  TaskCb[SEQ_BitPosition(TaskId_bm)] = Task;
+  TaskCb[TaskId] = Task;
 
   UTIL_SEQ_EXIT_CRITICAL_SECTION();
 
@@ -312,25 +474,81 @@ void UTIL_SEQ_RegTask(UTIL_SEQ_bm_t TaskId_bm, uint32_t Flags, void (*Task)( voi
 
 void UTIL_SEQ_SetTask( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio )
 {
-  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+  uint32_t task_bm = TaskId_bm;
+  uint32_t task_idx;
 
-  TaskSet |= TaskId_bm;
-  TaskPrio[Task_Prio].priority |= TaskId_bm;
+  while (task_bm != 0U)
+  {
+    task_idx = SEQ_BitPosition(task_bm);
+    task_bm &= ~(1U << task_idx);
 
-  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+    SEQ_SetTaskIdx(task_idx, Task_Prio);
+  }
 
   return;
 }
 
+void UTIL_SEQ_SetTaskId( uint32_t TaskId , uint32_t Task_Prio )
+{
+  SEQ_SetTaskIdx(TaskId, Task_Prio);
+
+  return;
+}
+
+#if (UTIL_SEQ_CONF_EDF != 0)
+void UTIL_SEQ_SetTaskDeadline( UTIL_SEQ_bm_t TaskId_bm , uint32_t Deadline )
+{
+  uint32_t task_bm = TaskId_bm;
+  uint32_t task_idx;
+
+  while (task_bm != 0U)
+  {
+    task_idx = SEQ_BitPosition(task_bm);
+    task_bm &= ~(1U << task_idx);
+
+    SEQ_SetTaskIdxDeadline(task_idx, Deadline);
+  }
+
+  return;
+}
+
+void UTIL_SEQ_SetTaskIdDeadline( uint32_t TaskId , uint32_t Deadline )
+{
+  SEQ_SetTaskIdxDeadline(TaskId, Deadline);
+
+  return;
+}
+
+uint32_t UTIL_SEQ_GetDeadlineMiss( void )
+{
+  return DeadlineMissCount;
+}
+#endif /* UTIL_SEQ_CONF_EDF */
+
 uint32_t UTIL_SEQ_IsSchedulableTask( UTIL_SEQ_bm_t TaskId_bm)
 {
   uint32_t _status;
   UTIL_SEQ_bm_t local_taskset;
-  
+
   UTIL_SEQ_ENTER_CRITICAL_SECTION();
 
-  local_taskset = TaskSet;
-  _status = ((local_taskset & TaskMask & SuperMask & TaskId_bm) == TaskId_bm)? 1U: 0U;
+  local_taskset = TaskSet[0];
+  _status = ((local_taskset & SEQ_TASK_ALLOWED(0) & TaskId_bm) == TaskId_bm)? 1U: 0U;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION();
+  return _status;
+}
+
+uint32_t UTIL_SEQ_IsSchedulableTaskId( uint32_t TaskId )
+{
+  uint32_t _status;
+  uint32_t word = SEQ_TASK_WORD(TaskId);
+  UTIL_SEQ_bm_t local_taskset;
+
+  UTIL_SEQ_ENTER_CRITICAL_SECTION();
+
+  local_taskset = TaskSet[word];
+  _status = ((local_taskset & SEQ_TASK_ALLOWED(word) & SEQ_TASK_BIT(TaskId)) != 0U)? 1U: 0U;
 
   UTIL_SEQ_EXIT_CRITICAL_SECTION();
   return _status;
@@ -340,7 +558,18 @@ void UTIL_SEQ_PauseTask( UTIL_SEQ_bm_t TaskId_bm )
 {
   UTIL_SEQ_ENTER_CRITICAL_SECTION( );
 
-  TaskMask &= (~TaskId_bm);
+  TaskPaused[0] |= TaskId_bm;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return;
+}
+
+void UTIL_SEQ_PauseTaskId( uint32_t TaskId )
+{
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  TaskPaused[SEQ_TASK_WORD(TaskId)] |= SEQ_TASK_BIT(TaskId);
 
   UTIL_SEQ_EXIT_CRITICAL_SECTION( );
 
@@ -352,7 +581,18 @@ uint32_t UTIL_SEQ_IsPauseTask( UTIL_SEQ_bm_t TaskId_bm )
   uint32_t _status;
   UTIL_SEQ_ENTER_CRITICAL_SECTION( );
 
-  _status = ((TaskMask & TaskId_bm) == TaskId_bm) ? 0:1;
+  _status = ((TaskPaused[0] & TaskId_bm) == 0U) ? 0:1;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+  return _status;
+}
+
+uint32_t UTIL_SEQ_IsPauseTaskId( uint32_t TaskId )
+{
+  uint32_t _status;
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  _status = ((TaskPaused[SEQ_TASK_WORD(TaskId)] & SEQ_TASK_BIT(TaskId)) == 0U) ? 0:1;
 
   UTIL_SEQ_EXIT_CRITICAL_SECTION( );
   return _status;
@@ -362,7 +602,18 @@ void UTIL_SEQ_ResumeTask( UTIL_SEQ_bm_t TaskId_bm )
 {
   UTIL_SEQ_ENTER_CRITICAL_SECTION( );
 
-  TaskMask |= TaskId_bm;
+  TaskPaused[0] &= (~TaskId_bm);
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return;
+}
+
+void UTIL_SEQ_ResumeTaskId( uint32_t TaskId )
+{
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  TaskPaused[SEQ_TASK_WORD(TaskId)] &= ~SEQ_TASK_BIT(TaskId);
 
   UTIL_SEQ_EXIT_CRITICAL_SECTION( );
 
@@ -396,6 +647,7 @@ void UTIL_SEQ_WaitEvt(UTIL_SEQ_bm_t EvtId_bm)
   UTIL_SEQ_bm_t event_waited_id_backup;
   UTIL_SEQ_bm_t current_task_idx;
   UTIL_SEQ_bm_t wait_task_idx;
+  UTIL_SEQ_bm_t wait_task_masked = 0U;
   /** store in local the current_task_id_bm as the global variable CurrentTaskIdx
    *  may be overwritten in case there are nested call of UTIL_SEQ_Run()
    */
@@ -406,7 +658,14 @@ void UTIL_SEQ_WaitEvt(UTIL_SEQ_bm_t EvtId_bm)
   }
   else
   {
-    wait_task_idx = 1 << CurrentTaskIdx;
+    /**
+     * A task from 32 cannot be given in the bit mapping passed to UTIL_SEQ_EvtIdle()
+     * The waiting task is removed from the super mask until the event is received, whatever its number,
+     * so that UTIL_SEQ_EvtIdle() does not need a restrictive mask that would stop the tasks from 32
+     */
+    wait_task_idx = (CurrentTaskIdx < 32U) ? (1U << CurrentTaskIdx) : 0U;
+    wait_task_masked = ~SuperMasked[SEQ_TASK_WORD(current_task_idx)] & SEQ_TASK_BIT(current_task_idx);
+    SuperMasked[SEQ_TASK_WORD(current_task_idx)] |= wait_task_masked;
   }
 
   /** backup the event id that was currently waited */
@@ -432,6 +691,11 @@ void UTIL_SEQ_WaitEvt(UTIL_SEQ_bm_t EvtId_bm)
    */
   CurrentTaskIdx = current_task_idx;
 
+  if (wait_task_masked != 0U)
+  {
+    SuperMasked[SEQ_TASK_WORD(current_task_idx)] &= ~wait_task_masked;
+  }
+
   UTIL_SEQ_ENTER_CRITICAL_SECTION( );
 
   EvtSet &= (~EvtWaited);
@@ -448,9 +712,61 @@ UTIL_SEQ_bm_t UTIL_SEQ_IsEvtPend( void )
   return (EvtSet & EvtWaited);
 }
 
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+void UTIL_SEQ_ProfileGet( uint32_t TaskId, UTIL_SEQ_Profile_t *pProfile )
+{
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  *pProfile = TaskProfile[TaskId];
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return;
+}
+
+void UTIL_SEQ_ProfileReset( void )
+{
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  (void)UTIL_SEQ_MEMSET8(TaskProfile, 0, sizeof(TaskProfile));
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+
+  return;
+}
+
+void UTIL_SEQ_ProfileDump( void )
+{
+  UTIL_SEQ_Profile_t profile;
+  uint32_t task_idx;
+
+  UTIL_SEQ_PROFILE_PRINTF("task      count   total(k)        avg        max    lat avg    lat max\r\n");
+  for (task_idx = 0U; task_idx < UTIL_SEQ_CONF_TASK_NBR; task_idx++)
+  {
+    UTIL_SEQ_ProfileGet(task_idx, &profile);
+    if (profile.RunCount == 0U)
+    {
+      continue;
+    }
+
+    UTIL_SEQ_PROFILE_PRINTF("%4lu %10lu %10lu %10lu %10lu %10lu %10lu\r\n",
+                            (unsigned long)task_idx,
+                            (unsigned long)profile.RunCount,
+                            (unsigned long)(profile.RunTimeTotal / 1000U),
+                            (unsigned long)(profile.RunTimeTotal / profile.RunCount),
+                            (unsigned long)profile.RunTimeMax,
+                            (unsigned long)(profile.LatencyTotal / profile.RunCount),
+                            (unsigned long)profile.LatencyMax);
+  }
+
+  return;
+}
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
 __WEAK void UTIL_SEQ_EvtIdle( UTIL_SEQ_bm_t TaskId_bm, UTIL_SEQ_bm_t EvtWaited_bm )
 {
-  UTIL_SEQ_Run(~TaskId_bm);
+  /** the waiting task is already masked by UTIL_SEQ_WaitEvt() */
+  UTIL_SEQ_Run(UTIL_SEQ_DEFAULT);
   return;
 }
 
@@ -483,6 +799,324 @@ __WEAK void UTIL_SEQ_PostIdle( void )
  *  @{
  */
 
+/**
+ * @brief set a task pending on a priority
+ * @param TaskIdx index of the task
+ * @param Task_Prio priority of the task
+ * @note  A task already pending on a lower priority is moved to Task_Prio
+ */
+static void SEQ_SetTaskIdx( uint32_t TaskIdx, uint32_t Task_Prio )
+{
+  uint32_t word = SEQ_TASK_WORD(TaskIdx);
+  uint32_t bit = SEQ_TASK_BIT(TaskIdx);
+
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  if ((TaskSet[word] & bit) != 0U)
+  {
+#if (UTIL_SEQ_CONF_EDF != 0)
+    /** a task pending with a deadline is executed before any priority, it is left in the deadline class */
+    if ((TaskEdf[word] & bit) != 0U)
+    {
+      UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+      return;
+    }
+#endif /* UTIL_SEQ_CONF_EDF */
+    if (TaskPrioIdx[TaskIdx] <= Task_Prio)
+    {
+      UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+      return;
+    }
+    SEQ_ClrTaskPrio(TaskIdx);
+  }
+
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+  else
+  {
+    TaskSetTime[TaskIdx] = UTIL_SEQ_PROFILE_GET_TIME( );
+  }
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
+  TaskSet[word] |= bit;
+  TaskPrio[Task_Prio].priority[word] |= bit;
+  TaskPrio[Task_Prio].word_set |= (1U << word);
+  PrioSet |= (1U << Task_Prio);
+  TaskPrioIdx[TaskIdx] = (uint8_t)Task_Prio;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+}
+
+/**
+ * @brief remove a task from the list of pending task and from its priority mask
+ * @param TaskIdx index of the task
+ */
+static void SEQ_ClrTaskIdx( uint32_t TaskIdx )
+{
+  uint32_t word = SEQ_TASK_WORD(TaskIdx);
+  uint32_t bit = SEQ_TASK_BIT(TaskIdx);
+
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  TaskSet[word] &= ~bit;
+
+  /** the class and the priority are read in critical section as they may have been changed since the task selection */
+#if (UTIL_SEQ_CONF_EDF != 0)
+  if ((TaskEdf[word] & bit) != 0U)
+  {
+    TaskEdf[word] &= ~bit;
+  }
+  else
+#endif /* UTIL_SEQ_CONF_EDF */
+  {
+    SEQ_ClrTaskPrio(TaskIdx);
+  }
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+}
+
+/**
+ * @brief remove a task from the mask of the priority it is pending on
+ * @param TaskIdx index of the task
+ * @note  It shall be called in critical section
+ */
+static void SEQ_ClrTaskPrio( uint32_t TaskIdx )
+{
+  uint32_t word = SEQ_TASK_WORD(TaskIdx);
+  UTIL_SEQ_Priority_t *p_prio = &TaskPrio[TaskPrioIdx[TaskIdx]];
+
+  p_prio->priority[word] &= ~SEQ_TASK_BIT(TaskIdx);
+  if (p_prio->priority[word] == 0U)
+  {
+    p_prio->word_set &= ~(1U << word);
+    if (p_prio->word_set == 0U)
+    {
+      PrioSet &= ~(1U << TaskPrioIdx[TaskIdx]);
+    }
+  }
+}
+
+#if (UTIL_SEQ_CONF_EDF != 0)
+/**
+ * @brief set a task pending in the deadline class
+ * @param TaskIdx index of the task
+ * @param Deadline time the task shall have returned, in the unit of UTIL_SEQ_EDF_GET_TIME()
+ * @note  A task already pending on a priority is moved to the deadline class.
+ *        A task already pending with a deadline keeps the earliest one.
+ */
+static void SEQ_SetTaskIdxDeadline( uint32_t TaskIdx, uint32_t Deadline )
+{
+  uint32_t word = SEQ_TASK_WORD(TaskIdx);
+  uint32_t bit = SEQ_TASK_BIT(TaskIdx);
+
+  UTIL_SEQ_ENTER_CRITICAL_SECTION( );
+
+  if ((TaskSet[word] & bit) != 0U)
+  {
+    if ((TaskEdf[word] & bit) != 0U)
+    {
+      if (SEQ_TIME_BEFORE(Deadline, TaskDeadline[TaskIdx]))
+      {
+        TaskDeadline[TaskIdx] = Deadline;
+      }
+      UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+      return;
+    }
+    SEQ_ClrTaskPrio(TaskIdx);
+  }
+
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+  else
+  {
+    TaskSetTime[TaskIdx] = UTIL_SEQ_PROFILE_GET_TIME( );
+  }
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
+  TaskSet[word] |= bit;
+  TaskEdf[word] |= bit;
+  TaskDeadline[TaskIdx] = Deadline;
+
+  UTIL_SEQ_EXIT_CRITICAL_SECTION( );
+}
+
+/**
+ * @brief select the task of the deadline class with the earliest deadline
+ * @retval index of the task, UTIL_SEQ_NOTASKRUNNING when no deadline task can be executed
+ * @note  The deadline class is expected to hold a few tasks, it is scanned linearly
+ */
+static uint32_t SEQ_SelectTaskDeadline( void )
+{
+  uint32_t word;
+  uint32_t current_task_set;
+  uint32_t task_idx;
+  uint32_t selected_idx = UTIL_SEQ_NOTASKRUNNING;
+
+  for (word = 0U; word < UTIL_SEQ_TASK_WORD_NBR; word++)
+  {
+    current_task_set = TaskEdf[word] & SEQ_TASK_ALLOWED(word);
+    while (current_task_set != 0U)
+    {
+      task_idx = SEQ_BitPosition(current_task_set);
+      current_task_set &= ~(1U << task_idx);
+      task_idx += (word << 5U);
+
+      if ((selected_idx == UTIL_SEQ_NOTASKRUNNING) || SEQ_TIME_BEFORE(TaskDeadline[task_idx], TaskDeadline[selected_idx]))
+      {
+        selected_idx = task_idx;
+      }
+    }
+  }
+
+  return selected_idx;
+}
+#endif /* UTIL_SEQ_CONF_EDF */
+
+/**
+ * @brief select the next task to be executed
+ * @retval index of the task, UTIL_SEQ_NOTASKRUNNING when no task can be executed
+ * @note  The tasks of the deadline class are selected first.
+ *        The highest priority with a task set and the word of this priority are found with a bit position
+ *        operation, the words and priorities only holding paused or masked tasks are skipped.
+ */
+static uint32_t SEQ_SelectTask( void )
+{
+  uint32_t prio_set;
+  uint32_t word_set;
+  uint32_t prio;
+  uint32_t word;
+  uint32_t first_word;
+  uint32_t current_task_set;
+  uint32_t task_bit;
+
+#if (UTIL_SEQ_CONF_EDF != 0)
+  task_bit = SEQ_SelectTaskDeadline( );
+  if (task_bit != UTIL_SEQ_NOTASKRUNNING)
+  {
+    return task_bit;
+  }
+#endif /* UTIL_SEQ_CONF_EDF */
+
+  prio_set = PrioSet;
+  while (prio_set != 0U)
+  {
+    /** the highest priority is the lowest number */
+    prio = SEQ_BitPosition(prio_set & (0U - prio_set));
+    prio_set &= ~(1U << prio);
+
+    first_word = UTIL_SEQ_TASK_WORD_NBR;
+    word_set = TaskPrio[prio].word_set;
+    while (word_set != 0U)
+    {
+      word = SEQ_BitPosition(word_set);
+      word_set &= ~(1U << word);
+
+      current_task_set = TaskPrio[prio].priority[word] & SEQ_TASK_ALLOWED(word);
+      if (current_task_set == 0U)
+      {
+        continue;
+      }
+
+      /**
+       * The round_robin register is a mask of allowed flags to be evaluated.
+       * The concept is to make sure that on each round on UTIL_SEQ_Run(), if two same flags are always set,
+       * the sequencer does not run always only the first one.
+       * When a task has been executed, The flag is removed from the round_robin mask.
+       * If on the next UTIL_SEQ_RUN(), the two same flags are set again, the round_robin mask will mask out the first flag
+       * so that the second one can be executed.
+       * Note that the first flag is not removed from the list of pending task but just masked by the round_robin mask
+       */
+      if ((current_task_set & TaskPrio[prio].round_robin[word]) != 0U)
+      {
+        task_bit = SEQ_BitPosition(current_task_set & TaskPrio[prio].round_robin[word]);
+        /** remove from the roun_robin mask the task that has been selected to be executed */
+        TaskPrio[prio].round_robin[word] &= ~(1U << task_bit);
+
+        return ((word << 5U) + task_bit);
+      }
+
+      if (first_word == UTIL_SEQ_TASK_WORD_NBR)
+      {
+        first_word = word;
+      }
+    }
+
+    if (first_word != UTIL_SEQ_TASK_WORD_NBR)
+    {
+      /** the round_robin mask is reinitialized as all pending tasks have been executed at least once */
+      (void)UTIL_SEQ_MEMSET8(TaskPrio[prio].round_robin, 0xFF, sizeof(TaskPrio[prio].round_robin));
+
+      current_task_set = TaskPrio[prio].priority[first_word] & SEQ_TASK_ALLOWED(first_word);
+      task_bit = SEQ_BitPosition(current_task_set);
+      TaskPrio[prio].round_robin[first_word] &= ~(1U << task_bit);
+
+      return ((first_word << 5U) + task_bit);
+    }
+  }
+
+  return UTIL_SEQ_NOTASKRUNNING;
+}
+
+/**
+ * @brief check whether a task is set and neither paused nor masked
+ * @retval 1 when a task can be executed, 0 otherwise
+ */
+static uint32_t SEQ_IsTaskSchedulable( void )
+{
+  uint32_t word;
+
+  for (word = 0U; word < UTIL_SEQ_TASK_WORD_NBR; word++)
+  {
+    if ((TaskSet[word] & SEQ_TASK_ALLOWED(word)) != 0U)
+    {
+      return 1U;
+    }
+  }
+
+  return 0U;
+}
+
+#if (UTIL_SEQ_CONF_PROFILE != 0)
+/**
+ * @brief update the statistics of a task that has been executed
+ * @param TaskIdx index of the task
+ * @param SetTime time the task has been set
+ * @param StartTime time the task has been started
+ * @param EndTime time the task has returned, the tasks run by a nested UTIL_SEQ_Run() are included
+ */
+static void SEQ_ProfileRecord( uint32_t TaskIdx, uint32_t SetTime, uint32_t StartTime, uint32_t EndTime )
+{
+  UTIL_SEQ_Profile_t *p_profile = &TaskProfile[TaskIdx];
+  uint32_t run_time = EndTime - StartTime;
+  uint32_t latency = StartTime - SetTime;
+
+  p_profile->RunCount++;
+  p_profile->RunTimeTotal += run_time;
+  if (run_time > p_profile->RunTimeMax)
+  {
+    p_profile->RunTimeMax = run_time;
+  }
+  p_profile->LatencyTotal += latency;
+  if (latency > p_profile->LatencyMax)
+  {
+    p_profile->LatencyMax = latency;
+  }
+}
+
+#if defined(SEQ_PROFILE_HOST_TIME)
+/**
+ * @brief host time base, monotonic clock in nanoseconds
+ * @retval time
+ */
+static uint32_t SEQ_ProfileHostTime( void )
+{
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec);
+}
+#endif /* SEQ_PROFILE_HOST_TIME */
+#endif /* UTIL_SEQ_CONF_PROFILE */
+
 #if( __CORTEX_M == 0)
 static const uint8_t SEQ_clz_table_4bit[16] = { 4U, 3U, 2U, 2U, 1U, 1U, 1U, 1U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U };
 /**
@@ -40,10 +40,26 @@ extern "C" {
 /**
  *  @brief  bit mapping of the task.
  *  this value is used to represent a list of task (each corresponds to a task).
+ *  It covers the tasks 0 to 31, when UTIL_SEQ_CONF_TASK_NBR is above 32 the other
+ *  tasks are given by their number to the UTIL_SEQ_xxxTaskId() functions.
  */
 
 typedef uint32_t UTIL_SEQ_bm_t;
 
+/**
+ *  @brief  statistics of a task, recorded when UTIL_SEQ_CONF_PROFILE is enabled.
+ *  The times are given in the unit of UTIL_SEQ_PROFILE_GET_TIME(), the latency is the time between
+ *  the first UTIL_SEQ_SetTask() and the start of the task.
+ */
+typedef struct
+{
+  uint32_t RunCount;       /*!< number of executions of the task                                   */
+  uint32_t RunTimeMax;     /*!< longest execution, including the tasks run while waiting an event  */
+  uint64_t RunTimeTotal;   /*!< cumulated execution time                                           */
+  uint32_t LatencyMax;     /*!< longest time between the task set and its execution                */
+  uint64_t LatencyTotal;   /*!< cumulated time between the task set and its execution              */
+} UTIL_SEQ_Profile_t;
+
 /**
   * @}
  */
@@ -145,6 +161,8 @@ void UTIL_SEQ_PostIdle( void );
  *        This function should be called in a while loop in the application
  *
  * @param Mask_bm list of task (bit mapping) that is be kept in the sequencer list.
+ *        It applies to the tasks 0 to 31. The tasks from 32 are kept as in the calling UTIL_SEQ_Run() with
+ *        UTIL_SEQ_DEFAULT, they are all masked with any other value.
  *
  * @note   It shall not be called from an ISR.
  *
@@ -163,6 +181,19 @@ void UTIL_SEQ_Run( UTIL_SEQ_bm_t Mask_bm );
  */
 void UTIL_SEQ_RegTask( UTIL_SEQ_bm_t TaskId_bm, uint32_t Flags, void (*Task)( void ) );
 
+/**
+ * @brief This function registers a task in the sequencer from its number.
+ *
+ * @param TaskId The number of the task, from 0 to UTIL_SEQ_CONF_TASK_NBR - 1
+ * @param Flags Flags are reserved param for future use
+ * @param Task Reference of the function to be executed
+ *
+ * @note  The tasks from 32 can only be handled with the UTIL_SEQ_xxxTaskId() functions.
+ *        It may be called from an ISR.
+ *
+ */
+void UTIL_SEQ_RegTaskId( uint32_t TaskId, uint32_t Flags, void (*Task)( void ) );
+
 /**
  * @brief This function requests a task to be executed
  *
@@ -178,6 +209,57 @@ void UTIL_SEQ_RegTask( UTIL_SEQ_bm_t TaskId_bm, uint32_t Flags, void (*Task)( vo
  */
 void UTIL_SEQ_SetTask( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio );
 
+/**
+ * @brief This function requests a task to be executed from its number
+ *
+ * @param TaskId The number of the task, from 0 to UTIL_SEQ_CONF_TASK_NBR - 1
+ * @param Task_Prio The priority of the task, see UTIL_SEQ_SetTask()
+ *
+ * @note   It may be called from an ISR
+ *
+ */
+void UTIL_SEQ_SetTaskId( uint32_t TaskId , uint32_t Task_Prio );
+
+/**
+ * @brief This function requests a task to be executed before a deadline
+ *        The tasks set with a deadline are executed before the tasks set with a priority, the one with the
+ *        earliest deadline first.
+ *
+ * @param TaskId_bm The Id of the task
+ *        It shall be (1<<task_id) where task_id is the number assigned when the task has been registered
+ * @param Deadline time the task shall have returned, in the unit of UTIL_SEQ_EDF_GET_TIME()
+ *
+ * @note  Available when UTIL_SEQ_CONF_EDF is enabled.
+ *        A task already pending on a priority is moved to the deadline class, a task already pending
+ *        with a deadline keeps the earliest one.
+ *        It may be called from an ISR
+ *
+ */
+void UTIL_SEQ_SetTaskDeadline( UTIL_SEQ_bm_t TaskId_bm , uint32_t Deadline );
+
+/**
+ * @brief This function requests a task to be executed before a deadline from its number
+ *
+ * @param TaskId The number of the task, from 0 to UTIL_SEQ_CONF_TASK_NBR - 1
+ * @param Deadline time the task shall have returned, in the unit of UTIL_SEQ_EDF_GET_TIME()
+ *
+ * @note  Available when UTIL_SEQ_CONF_EDF is enabled.
+ *        It may be called from an ISR
+ *
+ */
+void UTIL_SEQ_SetTaskIdDeadline( uint32_t TaskId , uint32_t Deadline );
+
+/**
+ * @brief This function returns the number of tasks set with a deadline that have returned after it
+ *
+ * @retval number of deadline misses since UTIL_SEQ_Init()
+ *
+ * @note  Available when UTIL_SEQ_CONF_EDF is enabled.
+ *        It may be called from an ISR
+ *
+ */
+uint32_t UTIL_SEQ_GetDeadlineMiss( void );
+
 /**
  * @brief This function checks if a task could be scheduled.
  *
@@ -190,6 +272,17 @@ void UTIL_SEQ_SetTask( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio );
  */
 uint32_t UTIL_SEQ_IsSchedulableTask( UTIL_SEQ_bm_t TaskId_bm);
 
+/**
+ * @brief This function checks if a task could be scheduled from its number.
+ *
+ * @param TaskId The number of the task, from 0 to UTIL_SEQ_CONF_TASK_NBR - 1
+ * @retval 0 if not 1 if true
+ *
+ * @note   It may be called from an ISR.
+ *
+ */
+uint32_t UTIL_SEQ_IsSchedulableTaskId( uint32_t TaskId );
+
 /**
  * @brief This function prevents a task to be called by the sequencer even when set with UTIL_SEQ_SetTask()
  *        By default, all tasks are executed by the sequencer when set with UTIL_SEQ_SetTask()
@@ -203,6 +296,16 @@ uint32_t UTIL_SEQ_IsSchedulableTask( UTIL_SEQ_bm_t TaskId_bm);
  */
 void UTIL_SEQ_PauseTask( UTIL_SEQ_bm_t TaskId_bm );
 
+/**
+ * @brief This function prevents a task to be called by the sequencer from its number, see UTIL_SEQ_PauseTask()
+ *
+ * @param TaskId The number of the task, from 0 to UTIL_SEQ_CONF_TASK_NBR - 1
+ *
+ * @note  It may be called from an ISR.
+ *
+ */
+void UTIL_SEQ_PauseTaskId( uint32_t TaskId );
+
 /**
  * @brief This function allows to know if the task has been put in pause.
  *        By default, all tasks are executed by the sequencer when set with UTIL_SEQ_SetTask()
@@ -216,6 +319,16 @@ void UTIL_SEQ_PauseTask( UTIL_SEQ_bm_t TaskId_bm );
  */
 uint32_t UTIL_SEQ_IsPauseTask( UTIL_SEQ_bm_t TaskId_bm );
 
+/**
+ * @brief This function allows to know if the task has been put in pause from its number.
+ *
+ * @param TaskId The number of the task, from 0 to UTIL_SEQ_CONF_TASK_NBR - 1
+ *
+ * @note  It may be called from an ISR.
+ *
+ */
+uint32_t UTIL_SEQ_IsPauseTaskId( uint32_t TaskId );
+
 /**
  * @brief This function allows again a task to be called by the sequencer if set with UTIL_SEQ_SetTask()
  *        This is used in relation with UTIL_SEQ_PauseTask()
@@ -228,6 +341,17 @@ uint32_t UTIL_SEQ_IsPauseTask( UTIL_SEQ_bm_t TaskId_bm );
  */
 void UTIL_SEQ_ResumeTask( UTIL_SEQ_bm_t TaskId_bm );
 
+/**
+ * @brief This function allows again a task to be called by the sequencer from its number
+ *        This is used in relation with UTIL_SEQ_PauseTaskId()
+ *
+ * @param TaskId The number of the task, from 0 to UTIL_SEQ_CONF_TASK_NBR - 1
+ *
+ * @note  It may be called from an ISR.
+ *
+ */
+void UTIL_SEQ_ResumeTaskId( uint32_t TaskId );
+
 /**
  * @brief This function sets an event that is waited with UTIL_SEQ_WaitEvt()
  *
@@ -278,13 +402,45 @@ void UTIL_SEQ_WaitEvt( UTIL_SEQ_bm_t EvtId_bm );
  */
 UTIL_SEQ_bm_t UTIL_SEQ_IsEvtPend( void );
 
+/**
+ * @brief This function returns the statistics of a task
+ *
+ * @param TaskId The number of the task, from 0 to UTIL_SEQ_CONF_TASK_NBR - 1
+ * @param pProfile statistics of the task
+ *
+ * @note  Available when UTIL_SEQ_CONF_PROFILE is enabled.
+ *        It may be called from an ISR.
+ *
+ */
+void UTIL_SEQ_ProfileGet( uint32_t TaskId, UTIL_SEQ_Profile_t *pProfile );
+
+/**
+ * @brief This function clears the statistics of all tasks
+ *
+ * @note  Available when UTIL_SEQ_CONF_PROFILE is enabled.
+ *        It may be called from an ISR.
+ *
+ */
+void UTIL_SEQ_ProfileReset( void );
+
+/**
+ * @brief This function prints the statistics of the tasks that have been executed with UTIL_SEQ_PROFILE_PRINTF()
+ *
+ * @note  Available when UTIL_SEQ_CONF_PROFILE is enabled.
+ *        It shall not be called from an ISR.
+ *
+ */
+void UTIL_SEQ_ProfileDump( void );
+
 /**
  * @brief This function loops until the waited event is set
  * @param TaskId_bm The task id that is currently running. When task_id_bm = 0, it means UTIL_SEQ_WaitEvt( )
  *                     has been called outside a registered task (ie at startup before UTIL_SEQ_Run( ) has been called
+ *                     or from a task numbered from 32. The waiting task is masked by the sequencer until the event
+ *                     is set.
  * @param EvtWaited_bm The event id that is waited.
  *
- * @note  When not implemented by the application, it calls UTIL_SEQ_Run(~TaskId_bm) which means the waited
+ * @note  When not implemented by the application, it calls UTIL_SEQ_Run(UTIL_SEQ_DEFAULT) which means the waited
  *        task is suspended until the waited event and the other tasks are running or the application enter
  *        low power mode.
  *        Else the user can redefine his own function for example call sequencer UTIL_SEQ_Run(0) to suspend all